@@ -293,12 +293,23 @@ public:
     apply_cv_mapping(BYTEBEAT_SETTING_CV3, cvs, s);
     apply_cv_mapping(BYTEBEAT_SETTING_CV4, cvs, s);
 
+    bool changed = false;
     for (uint_fast8_t i = 0; i < 12; ++i) {
       s[i] = USAT16(s[i]) ;
-      s_[i] = s[i] ;
+      if (s[i] != s_[i]) {
+        s_[i] = s[i] ;
+        changed = true;
+      }
     }
 
-    bytebeat_.Configure(s, get_step_mode(), get_loop_mode()) ;
+    // Only reconfigure when something moved
+    bool step_mode = get_step_mode();
+    bool loop_mode = get_loop_mode();
+    if (changed || step_mode != step_mode_ || loop_mode != loop_mode_) {
+      step_mode_ = step_mode;
+      loop_mode_ = loop_mode;
+      bytebeat_.Configure(s, step_mode, loop_mode) ;
+    }
 
     OC::DigitalInput trigger_input = get_trigger_input();
     uint8_t gate_state = 0;
@@ -335,6 +346,8 @@ private:
   peaks::ByteBeat bytebeat_;
   bool gate_raised_;
   int32_t s_[kMaxByteBeatParameters];
+  bool step_mode_;
+  bool loop_mode_;
 
   int num_enabled_settings_;
   ByteBeatSettings enabled_settings_[BYTEBEAT_SETTING_LAST];
@@ -347,6 +360,10 @@ void ByteBeat::Init(OC::DigitalInput default_trigger) {
   apply_value(BYTEBEAT_SETTING_TRIGGER_INPUT, default_trigger);
   bytebeat_.Init();
   gate_raised_ = false;
+  // Parameters are 16-bit unsigned, so this forces the first Configure
+  for (uint_fast8_t i = 0; i < kMaxByteBeatParameters; ++i)
+    s_[i] = -1;
+  step_mode_ = loop_mode_ = false;
   update_enabled_settings();
   history_.Init(0);
 }
@@ -358,6 +358,9 @@ public:
     }
 
     void Controller() {
+        // MIDI Clock goes out first, ahead of MIDI Thru and applet output
+        HS::clock_m.MIDIClockOut();
+
         ProcessMIDI();
 
         // ClockSetup applet handles internal clock duties
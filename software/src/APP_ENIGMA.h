@@ -37,6 +37,7 @@
 #include "enigma/EnigmaStep.h"
 #include "enigma/EnigmaOutput.h"
 #include "enigma/EnigmaTrack.h"
+#include "enigma/EnigmaSongIndex.h"
 
 // Modes
 #define ENIGMA_MODE_LIBRARY 0  // Create, edit, save, favorite, sysex dump Turing Machines
@@ -69,9 +70,20 @@
 
 // Settings for various things
 #define ENIGMA_SETTING_LAST 150
-#define ENIGMA_NO_STEP_AVAILABLE 0xffff
 #define ENIGMA_INITIAL_HELP_TIME 65535
 
+// Step numbers end at x=68 in Song mode and x=30 in Play mode, with room for
+// three digits when a track can be longer than 99 steps
+#if ENIGMA_MAX_TRACK_STEPS > 99
+#define ENIGMA_STEP_NUMBER_X 50
+#define ENIGMA_PLAY_STEP_NUMBER_X 12
+#define ENIGMA_STEP_NUMBER_RANGE 100
+#else
+#define ENIGMA_STEP_NUMBER_X 56
+#define ENIGMA_PLAY_STEP_NUMBER_X 18
+#define ENIGMA_STEP_NUMBER_RANGE 10
+#endif
+
 class EnigmaTMWS : public HSApplication, public SystemExclusiveHandler,
     public settings::SettingsBase<EnigmaTMWS, ENIGMA_SETTING_LAST> {
 public:
@@ -87,10 +99,14 @@ public:
 	        track[o].InitAs(o);
 	    }
 
+	    // Clear track list; this also indexes the song for ResetSong()
+	    BuildTrackStepList(0);
+
 	    ResetSong();
 
-	    // Clear track list
-	    BuildTrackStepList(0);
+	    // A song sent as a block is received into song_rx[], and only replaces
+	    // song_step[] once the whole block is in and its CRC matches
+	    song_reader.Begin(reinterpret_cast<uint8_t *>(song_rx), sizeof(song_rx), 'T');
 	}
 
 	void Resume() {
@@ -131,6 +147,14 @@ public:
     }
 
     void OnReceiveSysEx() {
+        const SysExBlockStatus song = ReceiveSysExBlob(song_reader);
+        if (song == SYSEX_BLOCK_COMPLETE) {
+            total_steps = song_reader.Length() / sizeof(EnigmaStep);
+            memcpy(song_step, song_rx, total_steps * sizeof(EnigmaStep));
+            SongReceived();
+        }
+        if (song != SYSEX_BLOCK_IGNORED) return;
+
         byte V[48];
         if (ExtractSysExData(V, 'T')) {
             char type = V[0]; // Type of Enigma data:r=Register, s=Song step, c=Song Config, 1=single TM
@@ -292,7 +316,7 @@ private:
     byte state_prob[HS::TURING_MACHINE_COUNT]; // Remember the last probability
     bool assign_audition = 0; // Which area does Assign monitor? 0=Library, 1=Song
     bool last_assign_audition; // Temporarily save the old audition state during playback
-    uint16_t track_step[100]; // List of steps in the current track
+    uint16_t track_step[ENIGMA_MAX_TRACK_STEPS + 1]; // List of steps in the current track
     uint16_t total_steps = 0; // Total number of song_step[] entries used; index of the next step
     byte last_track_step_index = 0; // For adding the next step
     uint16_t help_countdown = 0; // Display help screen for this many more ticks
@@ -309,7 +333,10 @@ private:
     TuringMachineState track_tm[4]; // Turing Machine states for each track
 
     //////// DATA
-    EnigmaStep song_step[400]; // Max 99 steps per track
+    EnigmaStep song_step[ENIGMA_MAX_SONG_STEPS]; // Max ENIGMA_MAX_TRACK_STEPS steps per track
+    EnigmaStep song_rx[ENIGMA_MAX_SONG_STEPS]; // A song block being received
+    SysExBlockReader song_reader; // For a song sent by SendSong()
+    EnigmaSongIndex song_index; // Next step on the same track, for playback
     EnigmaOutput output[4];
     EnigmaTrack track[4];
 
@@ -459,7 +486,7 @@ private:
 
     void DrawSongInterface() {
         // Draw the memory indicator at the top
-        int pct = (39600 - (total_steps * 100)) / 396;
+        int pct = (ENIGMA_MAX_SONG_STEPS - 4 - total_steps) * 100 / (ENIGMA_MAX_SONG_STEPS - 4);
         gfxPrint(104 + pad(100, pct), 1, pct);
         gfxPrint("%");
         if (total_steps > 32) gfxInvert(110, 0, 18, 9);
@@ -481,8 +508,7 @@ private:
             // Step parameters
             uint16_t ssi = track_step[edit_index]; // The song step index
             if (ssi < ENIGMA_NO_STEP_AVAILABLE) {
-                gfxPrint(56 + pad(10, edit_index + 1), 15, edit_index + 1); // Step number (1-99)
-                gfxPrint(": ");
+                DrawStepNumber(15, edit_index + 1);
                 char name[4];
                 HS::TuringMachine::SetName(name, song_step[ssi].tm());
                 gfxPrint(name); // Turing machine name
@@ -508,7 +534,8 @@ private:
                 gfxPrint(song_step[ssi].transpose()); // Transpose
 
                 // Cursor
-                if (step_param == ENIGMA_STEP_NUMBER && CursorBlink()) gfxInvert(56, 14, 12, 9);
+                if (step_param == ENIGMA_STEP_NUMBER && CursorBlink())
+                    gfxInvert(ENIGMA_STEP_NUMBER_X, 14, 68 - ENIGMA_STEP_NUMBER_X, 9);
                 if (step_param == ENIGMA_STEP_TM) gfxCursor(81, 23, 18);
                 if (step_param == ENIGMA_STEP_P) gfxCursor(105, 23, 18);
                 if (step_param == ENIGMA_STEP_REPEATS) gfxCursor(87, 33, 12);
@@ -522,12 +549,11 @@ private:
                 bool stop = 0; // Show the Stop/Loop step only once
                 for (byte n = 0; n < 3; n++)
                 {
-                    if (edit_index + n + 1 < 99) {
+                    if (edit_index + n + 1 <= ENIGMA_MAX_TRACK_STEPS) {
                         uint16_t ssi = track_step[edit_index + n + 1];
                         byte y = 35 + (10 * n);
                         if (ssi < ENIGMA_NO_STEP_AVAILABLE) {
-                            gfxPrint(56 + pad(10, edit_index + n + 2), y, edit_index + n + 2); // Step number (1-99)
-                            gfxPrint(": ");
+                            DrawStepNumber(y, edit_index + n + 2);
                             char name[4];
                             HS::TuringMachine::SetName(name, song_step[ssi].tm());
                             gfxPrint(name); // Turing machine name
@@ -535,8 +561,7 @@ private:
                             gfxPrint(song_step[ssi].repeats()); // Number of times played
                         } else if (!stop) {
                             stop = 1;
-                            gfxPrint(56 + pad(10, edit_index + n + 2), y, edit_index + n + 2); // Step number (1-99)
-                            gfxPrint(": ");
+                            DrawStepNumber(y, edit_index + n + 2);
                             gfxPrint(track[track_cursor].loop() ? "< Loop >" : "< Stop >");
                         }
                     }
@@ -545,6 +570,12 @@ private:
         }
     }
 
+    // Step number (1-ENIGMA_MAX_TRACK_STEPS) and separator, right-aligned to x=68
+    void DrawStepNumber(byte y, int number) {
+        gfxPrint(ENIGMA_STEP_NUMBER_X + pad(ENIGMA_STEP_NUMBER_RANGE, number), y, number);
+        gfxPrint(": ");
+    }
+
     void DrawPlayInterface() {
         // The Play interface is different from the others; it's four rows, with one row
         // for each track
@@ -570,7 +601,7 @@ private:
                 if (playback_step_number[t] == 0) {
                     gfxIcon(30, y, RESET_ICON);
                 } else if (ssi != ENIGMA_NO_STEP_AVAILABLE) {
-                    gfxPrint(18 + pad(10, playback_step_number[t]), y, playback_step_number[t]);
+                    gfxPrint(ENIGMA_PLAY_STEP_NUMBER_X + pad(ENIGMA_STEP_NUMBER_RANGE, playback_step_number[t]), y, playback_step_number[t]);
                     gfxPrint(":");
                     gfxPrint(playback_step_repeat[t] + 1);
                     char name[4];
@@ -688,7 +719,7 @@ private:
             if (step_param == ENIGMA_STEP_NUMBER) {
                 if (edit_index > 0 || direction > 0) {
                     // If there's a step to move into, move into it
-                    if (edit_index + direction < 100 && edit_index + direction >= 0)
+                    if (edit_index + direction < last_track_step_index && edit_index + direction >= 0)
                         if (track_step[edit_index + direction] != ENIGMA_NO_STEP_AVAILABLE) edit_index += direction;
                 }
             }
@@ -787,15 +818,9 @@ private:
                             if (playback_step_repeat[t] >= song_step[ssi].repeats()) {
                                 playback_step_repeat[t] = 0;
                                 // Find the next step for this track
-                                bool found = 0;
-                                for (uint16_t s = ssi + 1; s < total_steps; s++)
-                                {
-                                    if (song_step[s].track() == t) {
-                                        playback_step_index[t] = s;
-                                        found = 1;
-                                        break;
-                                    }
-                                }
+                                uint16_t next = song_index.Next(ssi);
+                                bool found = (next != ENIGMA_NO_STEP_AVAILABLE);
+                                if (found) playback_step_index[t] = next;
                                 // At this point, beat and repeat are both 0, so the Turing Machine State
                                 // will be initialized on the next clock
 
@@ -857,14 +882,15 @@ private:
 
     //////// Data Collection
     void BuildTrackStepList(byte track) {
+        // The song has changed, so re-thread the per-track index first
+        song_index.Rebuild(song_step, total_steps);
+
         byte ts_ix = 0;
-        for (uint16_t ix = 0; ix < total_steps; ix++)
+        for (uint16_t ix = song_index.First(track); ix != ENIGMA_NO_STEP_AVAILABLE; ix = song_index.Next(ix))
         {
-            if (song_step[ix].track() == track) {
-                // Found a step for the selected track; add it to the track list
-                track_step[ts_ix++] = ix;
-                if (ts_ix > 99) break;
-            }
+            // Found a step for the selected track; add it to the track list
+            track_step[ts_ix++] = ix;
+            if (ts_ix > ENIGMA_MAX_TRACK_STEPS) break;
         }
         last_track_step_index = ts_ix;
 
@@ -873,12 +899,12 @@ private:
         if (edit_index < 0) edit_index = 0;
 
         // ENIGMA_NO_STEP_AVAILABLE indictates end of track
-        while (ts_ix < 100) track_step[ts_ix++] = ENIGMA_NO_STEP_AVAILABLE;
+        while (ts_ix < ENIGMA_MAX_TRACK_STEPS + 1) track_step[ts_ix++] = ENIGMA_NO_STEP_AVAILABLE;
     }
 
     // Insert a step to the end of the current track
     void InsertStep() {
-        if (last_track_step_index < 99) {
+        if (last_track_step_index < ENIGMA_MAX_TRACK_STEPS && total_steps < ENIGMA_MAX_SONG_STEPS - 1) {
             uint16_t insert_point = track_step[edit_index] + 1;
             if (insert_point < total_steps) {
                 // Insert a step after the current step; otherwise, it'll just go at the end
@@ -931,15 +957,7 @@ private:
     }
 
     uint16_t GetFirstStep(byte track) {
-        uint16_t step = ENIGMA_NO_STEP_AVAILABLE;
-        for (uint16_t s = 0; s < total_steps; s++)
-        {
-            if (song_step[s].track() == track) {
-                step = s;
-                break;
-            }
-        }
-        return step;
+        return song_index.First(track);
     }
 
     void DismissHelp() {
@@ -992,34 +1010,12 @@ private:
     }
 
     void SendSong() {
-        byte V[48];
-        byte ix;
-
-        // Send song data
-        ix = 0;
-        byte pages = (total_steps / 8) + 1;
-        for (byte p = 0; p < pages; p++)
-        {
-            V[ix++] = 's'; // Indicates a song step page is being sent
-            V[ix++] = p; // Page number
-            V[ix++] = static_cast<byte>(total_steps & 0xff); // Total steps, low byte
-            V[ix++] = static_cast<byte>((total_steps >> 8) & 0xff); // Total steps, high byte
-            for (byte s = 0; s < 10; s++)
-            {
-                byte ssi = (p * 8) + s;
-                V[ix++] = song_step[ssi].tk;
-                V[ix++] = song_step[ssi].pr;
-                V[ix++] = song_step[ssi].re;
-                V[ix++] = song_step[ssi].tr;
-            }
-            UnpackedData unpacked;
-            unpacked.set_data(ix, V);
-            PackedData packed = unpacked.pack();
-            SendSysEx(packed, 'T');
-        }
+        // Send song data as one block; ReceiveSongSteps() still takes the pages older versions sent
+        SendSysExBlob(reinterpret_cast<const uint8_t *>(song_step), total_steps * sizeof(EnigmaStep), 'T');
 
         // Send track settings
-        ix = 0;
+        byte V[48];
+        byte ix = 0;
         V[ix++] = 't'; // Indicates a set of output assignments
         for (int t = 0; t < 4; t++) V[ix++] = track[t].data;
         UnpackedData unpacked;
@@ -1067,14 +1063,20 @@ private:
         byte low = V[ix++];
         byte high = V[ix++];
         total_steps = static_cast<uint16_t>((high << 8) | low);
+        if (total_steps > ENIGMA_MAX_SONG_STEPS) total_steps = ENIGMA_MAX_SONG_STEPS;
         for (byte s = 0; s < 8; s++)
         {
-            byte ssi = (page * 8) + s;
+            uint16_t ssi = (page * 8) + s;
+            if (ssi >= ENIGMA_MAX_SONG_STEPS) break;
             song_step[ssi].tk = V[ix++];
             song_step[ssi].pr = V[ix++];
             song_step[ssi].re = V[ix++];
             song_step[ssi].tr = V[ix++];
         }
+        SongReceived();
+    }
+
+    void SongReceived() {
         BuildTrackStepList(0);
         track_cursor = 0;
         edit_index = 0;
@@ -73,6 +73,12 @@ enum HEMISPHERE_SETTINGS {
     HEMISPHERE_SETTING_LAST
 };
 
+// A nibble per input map entry, 0 meaning unset, holds sources 0-14. That's
+// all of them on T3.2; the T4.1 busses past that can't be picked here.
+static constexpr int HEM_INPUTMAP_MAX = 14;
+static constexpr int HEM_TRIGMAP_MAX = TRIGMAP_MAX < HEM_INPUTMAP_MAX ? TRIGMAP_MAX : HEM_INPUTMAP_MAX;
+static constexpr int HEM_CVMAP_MAX = CVMAP_MAX < HEM_INPUTMAP_MAX ? CVMAP_MAX : HEM_INPUTMAP_MAX;
+
 #if defined(MOAR_PRESETS)
 static constexpr int HEM_NR_OF_PRESETS = 16;
 #elif defined(PEWPEWPEW)
@@ -120,8 +126,11 @@ public:
       uint16_t cvmap = 0;
       uint16_t trigmap = 0;
       for (size_t i = 0; i < 4; ++i) {
-        trigmap |= (uint16_t(HS::trigger_mapping[i] + 1) & 0x0F) << (i*4);
-        cvmap |= (uint16_t(HS::cvmapping[i] + 1) & 0x0F) << (i*4);
+        // left unset rather than wrapped if one doesn't fit, see HEM_INPUTMAP_MAX
+        if (HS::trigger_mapping[i] <= HEM_INPUTMAP_MAX)
+          trigmap |= uint16_t(HS::trigger_mapping[i] + 1) << (i*4);
+        if (HS::cvmapping[i] <= HEM_INPUTMAP_MAX)
+          cvmap |= uint16_t(HS::cvmapping[i] + 1) << (i*4);
       }
 
       bool changed = (uint16_t(values_[HEMISPHERE_TRIGMAP]) != trigmap)
@@ -135,12 +144,13 @@ public:
       for (size_t i = 0; i < 4; ++i) {
         int val = (uint16_t(values_[HEMISPHERE_TRIGMAP]) >> (i*4)) & 0x0F;
         if (val != 0)
-          HS::trigger_mapping[i] = constrain(val - 1, 0, TRIGMAP_MAX);
+          HS::trigger_mapping[i] = constrain(val - 1, 0, HEM_TRIGMAP_MAX);
 
         val = (uint16_t(values_[HEMISPHERE_CVMAP]) >> (i*4)) & 0x0F;
         if (val != 0)
-          HS::cvmapping[i] = constrain(val - 1, 0, CVMAP_MAX);
+          HS::cvmapping[i] = constrain(val - 1, 0, HEM_CVMAP_MAX);
       }
+      HS::CompileRoutes();
     }
 
     uint64_t GetGlobals() {
@@ -363,10 +373,18 @@ public:
     // does not modify the preset, only the manager
     void SetApplet(HEM_SIDE hemisphere, int index) {
         //if (my_applet[hemisphere]) // TODO: special case for first load?
+#ifdef ARDUINO_TEENSY41
+        HS::DetachAudio(hemisphere);
+#endif
         HS::available_applets[my_applet[hemisphere]].instance[hemisphere]->Unload();
         next_applet[hemisphere] = my_applet[hemisphere] = index;
         HS::available_applets[index].instance[hemisphere]->BaseStart(hemisphere);
     }
+    // Background chores of the loaded applets, from the main loop
+    void Idle() {
+        for (int h = 0; h < 2; h++)
+            HS::available_applets[my_applet[h]].instance[h]->Idle();
+    }
     void ChangeApplet(HEM_SIDE h, int dir) {
         int index = HS::get_next_applet_index(next_applet[h], dir);
         next_applet[h] = index;
@@ -424,6 +442,9 @@ public:
     }
 
     void Controller() {
+        // MIDI Clock goes out first, ahead of MIDI Thru and applet output
+        HS::clock_m.MIDIClockOut();
+
         // top-level MIDI-to-CV handling - alters frame outputs
 #if defined(__IMXRT1062__)
   #if defined(ARDUINO_TEENSY41)
@@ -853,6 +874,7 @@ private:
         SCREENSAVER_MODE,
         CURSOR_MODE,
         AUTO_MIDI,
+        RANDOM_SEED,
 
         // Global Quantizers: 4x(Scale, Root, Octave, Mask?)
         QUANT1, QUANT2, QUANT3, QUANT4,
@@ -893,7 +915,7 @@ private:
             config_cursor = constrain(config_cursor, 0, MAX_CURSOR);
 
             if (config_cursor < CONFIG_DUMMY) config_page = LOADSAVE_POPUP;
-            else if (config_cursor <= AUTO_MIDI) config_page = CONFIG_SETTINGS;
+            else if (config_cursor <= RANDOM_SEED) config_page = CONFIG_SETTINGS;
             else if (config_cursor < TRIGMAP1) config_page = QUANTIZER_SETTINGS;
             else if (config_cursor < SHOWHIDELIST) config_page = INPUT_SETTINGS;
             //else config_page = SHOWHIDE_APPLETS;
@@ -910,13 +932,15 @@ private:
         case TRIGMAP4:
             HS::trigger_mapping[config_cursor-TRIGMAP1] = constrain(
                 HS::trigger_mapping[config_cursor-TRIGMAP1] + dir,
-                0, TRIGMAP_MAX);
+                0, HEM_TRIGMAP_MAX);
+            HS::CompileRoutes();
             break;
         case CVMAP1:
         case CVMAP2:
         case CVMAP3:
         case CVMAP4:
-            HS::cvmapping[config_cursor-CVMAP1] = constrain( HS::cvmapping[config_cursor-CVMAP1] + dir, 0, CVMAP_MAX);
+            HS::cvmapping[config_cursor-CVMAP1] = constrain( HS::cvmapping[config_cursor-CVMAP1] + dir, 0, HEM_CVMAP_MAX);
+            HS::CompileRoutes();
             break;
         case TRIG_LENGTH:
             HS::trig_length = (uint32_t) constrain( int(HS::trig_length + dir), 1, 127);
@@ -1004,6 +1028,11 @@ private:
             HS::frame.autoMIDIOut = !HS::frame.autoMIDIOut;
             break;
 
+        case RANDOM_SEED:
+            HS::random_seed = (HS::random_seed + 1) & 0x7;
+            HS::ReseedRandom();
+            break;
+
         case SHOWHIDELIST:
             if (h == 0) // left encoder inverts selection
             {
@@ -1143,6 +1172,10 @@ private:
         gfxPrint(1, 45, "Auto MIDI-Out:  ");
         gfxPrint( HS::frame.autoMIDIOut ? "On" : "Off" );
 
+        gfxPrint(1, 55, "Random Seed:  ");
+        if (HS::random_seed) gfxPrint(HS::random_seed);
+        else gfxPrint("Off");
+
         switch (config_cursor) {
         case CVMAP1:
         case CVMAP2:
@@ -1163,6 +1196,9 @@ private:
         case AUTO_MIDI:
             gfxIcon(90, 45, RIGHT_ICON);
             break;
+        case RANDOM_SEED:
+            gfxIcon(73, 55, RIGHT_ICON);
+            break;
         case CONFIG_DUMMY:
             gfxIcon(2, 1, LEFT_ICON);
             break;
@@ -1287,7 +1323,11 @@ void HEMISPHERE_handleAppEvent(OC::AppEvent event) {
     }
 }
 
-void HEMISPHERE_loop() {} // Essentially deprecated in favor of ISR
+void HEMISPHERE_loop() {
+    // Applets run in the ISR; only background chores happen here
+    manager.Idle();
+    HS::buffer_pool.Idle();
+}
 
 void HEMISPHERE_menu() {
     manager.View();
@@ -142,6 +142,8 @@ void LorenzGenerator::Init() {
   InitDefaults();
   lorenz.Init(0);
   lorenz.Init(1);
+  // Euler's attractor swells at the fast rates until the outputs wrap
+  lorenz.set_integrator(streams::LORENZ_INTEGRATOR_SEMI_IMPLICIT);
   frozen_= false;
 }
 
@@ -219,13 +219,21 @@ public:
             for (int p = 0; p < 8; p++)
                 if (values_[s * MIDI_PARAMETER_COUNT + 32 + p] == 0) values_[s * MIDI_PARAMETER_COUNT + 32 + p] = 127;
         }
+        InvalidateRoutes();
 	}
 
+    /* Call after anything that changes values_, so the ISR picks up the new setup */
+    void InvalidateRoutes() {
+        routes_dirty = 1;
+    }
+
     void Resume() {
         SelectSetup(get_setup_number(), 0);
     }
 
     void Controller() {
+        if (routes_dirty) CompileRoutes();
+
         midi_in(usbMIDI);
 #ifdef ARDUINO_TEENSY41
         midi_in(usbHostMIDI);
@@ -265,6 +273,7 @@ public:
         cursor.Scroll(prev_cursor);
         values_[MIDI_CURRENT_SETUP] = setup_number;
         screen = new_screen;
+        InvalidateRoutes();
     }
 
     void SwitchScreenOrLogView(int dir) {
@@ -396,6 +405,7 @@ public:
        int page = ix / 8; // Page within a Setup
        if (page == 4 && values_[ix] < values_[ix - 8]) values_[ix] = values_[ix - 8];
        if (page == 3 && values_[ix] > values_[ix + 8]) values_[ix] = values_[ix + 8];
+       InvalidateRoutes();
    }
 
 private:
@@ -422,6 +432,102 @@ private:
     int legato_on[4]; // The note handler may currently respond to legato note changes
     uint16_t indicator_out[4]; // A MIDI indicator will display next to MIDI Out assignment
 
+    // The active setup, compiled by CompileRoutes() so the ISR doesn't have to test
+    // every assignment against every message
+    struct {
+        uint8_t in_fn[4];
+        uint8_t in_ch[4];
+        int8_t in_transpose[4];
+        uint8_t in_low[4];
+        uint8_t in_high[4];
+        uint8_t in_cc[4]; // CC number for CC-type assignments
+        uint8_t out_fn[4];
+        uint8_t out_ch[4];
+        int8_t out_transpose[4];
+        uint8_t out_low[4];
+        uint8_t out_high[4];
+        uint8_t out_cc[4];
+        int8_t velocity_source[4]; // Input providing note velocity, or -1
+
+        // Bitmasks of the outputs each message can affect, by MIDI channel
+        uint8_t note[17];
+        uint8_t cc[17];
+        uint8_t aftertouch[17];
+        uint8_t pitchbend[17];
+        uint8_t clock; // Clock assignments ignore the channel
+    } routes;
+    volatile bool routes_dirty = 1;
+
+    // The CC an input follows, or 0. The clock assignments follow the
+    // modulation wheel too, as they always have.
+    static uint8_t in_fn_cc(int fn) {
+        if (fn == MIDI_IN_EXPRESSION) return 11;
+        if (fn == MIDI_IN_PAN) return 10;
+        if (fn == MIDI_IN_HOLD) return 64;
+        if (fn == MIDI_IN_BREATH) return 2;
+        if (fn == MIDI_IN_Y_AXIS) return 74;
+        if (fn == MIDI_IN_MOD || fn >= MIDI_IN_EXPRESSION) return 1; // Modulation wheel
+        return 0;
+    }
+
+    static uint8_t out_fn_cc(int fn) {
+        if (fn == MIDI_OUT_EXPRESSION) return 11;
+        if (fn == MIDI_OUT_PAN) return 10;
+        if (fn == MIDI_OUT_HOLD) return 64;
+        if (fn == MIDI_OUT_BREATH) return 2;
+        if (fn == MIDI_OUT_Y_AXIS) return 74;
+        return 1; // Modulation wheel
+    }
+
+    void CompileRoutes() {
+        routes_dirty = 0;
+        memset(&routes, 0, sizeof(routes));
+
+        for (int ch = 0; ch < 4; ch++)
+        {
+            const int in_fn = get_in_assign(ch);
+            const int in_ch = get_in_channel(ch);
+            const uint8_t mask = 1 << ch;
+            routes.in_fn[ch] = in_fn;
+            routes.in_ch[ch] = in_ch;
+            routes.in_transpose[ch] = get_in_transpose(ch);
+            routes.in_low[ch] = values_[24 + ch + get_setup_number() * MIDI_PARAMETER_COUNT];
+            routes.in_high[ch] = values_[32 + ch + get_setup_number() * MIDI_PARAMETER_COUNT];
+            routes.in_cc[ch] = in_fn_cc(in_fn);
+
+            if (in_fn >= MIDI_IN_CLOCK_4TH) routes.clock |= mask;
+            if (in_ch > 0 && in_ch <= 16) {
+                if (in_fn >= MIDI_IN_NOTE && in_fn <= MIDI_IN_VELOCITY) routes.note[in_ch] |= mask;
+                if (routes.in_cc[ch]) routes.cc[in_ch] |= mask;
+                if (in_fn == MIDI_IN_AFTERTOUCH) routes.aftertouch[in_ch] |= mask;
+                if (in_fn == MIDI_IN_PITCHBEND) routes.pitchbend[in_ch] |= mask;
+            }
+
+            // Note Off has to reach an output holding a note even if its assignment
+            // changed while the note was on
+            if (in_ch > 0 && in_ch <= 16 && note_in[ch] > -1) routes.note[in_ch] |= mask;
+
+            const int out_fn = get_out_assign(ch);
+            routes.out_fn[ch] = out_fn;
+            routes.out_ch[ch] = get_out_channel(ch);
+            routes.out_transpose[ch] = get_out_transpose(ch);
+            routes.out_low[ch] = values_[28 + ch + get_setup_number() * MIDI_PARAMETER_COUNT];
+            routes.out_high[ch] = values_[36 + ch + get_setup_number() * MIDI_PARAMETER_COUNT];
+            routes.out_cc[ch] = out_fn_cc(out_fn);
+        }
+
+        // The last input assigned to velocity on the same channel wins
+        for (int ch = 0; ch < 4; ch++)
+        {
+            routes.velocity_source[ch] = -1;
+            for (int vch = 0; vch < 4; vch++)
+            {
+                if (routes.out_fn[vch] == MIDI_OUT_VELOCITY && routes.out_ch[vch] == routes.out_ch[ch])
+                    routes.velocity_source[ch] = vch;
+            }
+        }
+    }
+
     void DrawSetupScreens() {
         // Create the header, showing the current Setup and Screen name
         gfxHeader("");
@@ -544,8 +650,8 @@ private:
         auto &hMIDI = HS::frame.MIDIState;
         for (int ch = 0; ch < 4; ch++)
         {
-            int out_fn = get_out_assign(ch);
-            int out_ch = get_out_channel(ch);
+            int out_fn = routes.out_fn[ch];
+            int out_ch = routes.out_ch[ch];
             if (out_ch == 0) continue;
             bool indicator = 0;
 
@@ -560,7 +666,7 @@ private:
 
                 if (note_on || legato_on[ch]) {
                     // Get a new reading when gated, or when checking for legato changes
-                    uint8_t midi_note = MIDIQuantizer::NoteNumber(In(ch), get_out_transpose(ch));
+                    uint8_t midi_note = MIDIQuantizer::NoteNumber(In(ch), routes.out_transpose[ch]);
 
                     if (legato_on[ch] && midi_note != note_out[ch]) {
                         // Send note off if the note has changed
@@ -571,17 +677,13 @@ private:
                         note_on = 1;
                     }
 
-                    if (!in_out_range(ch, midi_note)) note_on = 0; // Don't play if out of range
+                    if (midi_note < routes.out_low[ch] || midi_note > routes.out_high[ch]) note_on = 0; // Don't play if out of range
 
                     if (note_on) {
                         int velocity = 0x64;
-                        // Look for an input assigned to velocity on the same channel and, if found, use it
-                        for (int vch = 0; vch < 4; vch++)
-                        {
-                            if (get_out_assign(vch) == MIDI_OUT_VELOCITY && get_out_channel(vch) == out_ch) {
-                                velocity = Proportion(In(vch), HSAPPLICATION_5V, 127);
-                            }
-                        }
+                        // Use an input assigned to velocity on the same channel, if there is one
+                        const int vch = routes.velocity_source[ch];
+                        if (vch > -1) velocity = Proportion(In(vch), HSAPPLICATION_5V, 127);
                         velocity = constrain(velocity, 0, 127);
                         hMIDI.SendNoteOn(out_ch, midi_note, velocity);
                         UpdateLog(0, ch, 0, out_ch, midi_note, velocity);
@@ -607,12 +709,7 @@ private:
             if (Changed(ch)) {
                 // Modulation wheel
                 if (out_fn == MIDI_OUT_MOD || out_fn >= MIDI_OUT_EXPRESSION) {
-                    int cc = 1; // Modulation wheel
-                    if (out_fn == MIDI_OUT_EXPRESSION) cc = 11;
-                    if (out_fn == MIDI_OUT_PAN) cc = 10;
-                    if (out_fn == MIDI_OUT_HOLD) cc = 64;
-                    if (out_fn == MIDI_OUT_BREATH) cc = 2;
-                    if (out_fn == MIDI_OUT_Y_AXIS) cc = 74;
+                    int cc = routes.out_cc[ch];
 
                     int value = Proportion(In(ch), HSAPPLICATION_5V, 127);
                     value = constrain(value, 0, 127);
@@ -670,21 +767,34 @@ private:
         bool note_captured = 0; // A note or gate should only be captured by
         bool gate_captured = 0; // one assignment, to allow polyphony in the interface
 
-        // A MIDI message has been received; go through each channel to see if it
-        // needs to be routed to any of the CV outputs
+        // A MIDI message has been received; look up which CV outputs it can affect
+        uint8_t targets = 0;
+        const bool voice = (channel > 0 && channel <= 16);
+        switch (message) {
+        case HEM_MIDI_NOTE_ON:
+        case HEM_MIDI_NOTE_OFF:  if (voice) targets = routes.note[channel]; break;
+        case HEM_MIDI_CC:        if (voice) targets = routes.cc[channel]; break;
+        case HEM_MIDI_AFTERTOUCH: if (voice) targets = routes.aftertouch[channel]; break;
+        case HEM_MIDI_PITCHBEND: if (voice) targets = routes.pitchbend[channel]; break;
+        case HEM_MIDI_CLOCK:     targets = routes.clock; break;
+        default: break;
+        }
+
         for (int ch = 0; ch < 4; ch++)
         {
-            int in_fn = get_in_assign(ch);
-            int in_ch = get_in_channel(ch);
+            if (!(targets & (1 << ch))) continue;
+
+            int in_fn = routes.in_fn[ch];
+            int in_ch = routes.in_ch[ch];
             bool indicator = 0;
             if (message == HEM_MIDI_NOTE_ON && in_ch == channel) {
                 if (note_in[ch] == -1) { // If this channel isn't already occupied with another note, handle Note On
                     if (in_fn == MIDI_IN_NOTE && !note_captured) {
                         // Send quantized pitch CV. Isolate transposition to quantizer so that it notes off aren't
                         // misinterpreted if transposition is changed during the note.
-                        int note = data1 + get_in_transpose(ch);
+                        int note = data1 + routes.in_transpose[ch];
                         note = constrain(note, 0, 127);
-                        if (in_in_range(ch, note)) {
+                        if (note >= routes.in_low[ch] && note <= routes.in_high[ch]) {
                             Out(ch, MIDIQuantizer::CV(note));
                             UpdateLog(1, ch, 0, in_ch, note, data2);
                             indicator = 1;
@@ -734,12 +844,7 @@ private:
 
             bool cc = (in_fn == MIDI_IN_MOD || in_fn >= MIDI_IN_EXPRESSION);
             if (cc && message == HEM_MIDI_CC && in_ch == channel) {
-                uint8_t cc = 1; // Modulation wheel
-                if (in_fn == MIDI_IN_EXPRESSION) cc = 11;
-                if (in_fn == MIDI_IN_PAN) cc = 10;
-                if (in_fn == MIDI_IN_HOLD) cc = 64;
-                if (in_fn == MIDI_IN_BREATH) cc = 2;
-                if (in_fn == MIDI_IN_Y_AXIS) cc = 74;
+                uint8_t cc = routes.in_cc[ch];
 
                 // Send CC wheel to CV
                 if (data1 == cc) {
@@ -765,7 +870,7 @@ private:
                 indicator = 1;
             }
 
-            if (in_fn >= MIDI_IN_CLOCK_4TH) {
+            if (in_fn >= MIDI_IN_CLOCK_4TH && message == HEM_MIDI_CLOCK) {
                 // Clock is unlogged because there can be a lot of it
                 uint8_t mod = get_clock_mod(in_fn);
                 if (clock_count % mod == 0) ClockOut(ch);
@@ -193,6 +193,10 @@ public:
   bool frozen_;
   uint8_t freq_mult_;
 
+  // Ticks are rendered kBlockSize at a time; CVs are smoothed to ~1kHz anyway
+  static constexpr size_t kBlockSize = 4;
+  size_t block_position;
+
   // ISR update is at 16.666kHz, we don't need it that fast so smooth the values to ~1Khz
   static constexpr int32_t kSmoothing = 16;
 
@@ -207,6 +211,7 @@ void PolyLfo::Init() {
   lfo.Init();
   frozen_= false;
   freq_mult_ = 0x3; // == x2 / default
+  block_position = kBlockSize;
 }
 
 const char* const freq_range_names[12] = {
@@ -267,24 +272,8 @@ struct {
 
 } poly_lfo_state;
 
-void FASTRUN POLYLFO_isr() {
-
-  bool reset_phase = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
-  bool freeze = OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_2>();
-  bool tempo_sync = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_3>();
- 
-#ifdef ARDUINO_TEENSY41
-  poly_lfo.cv_freq.push(OC::ADC::value<ADC_CHANNEL_5>());
-  poly_lfo.cv_shape.push(OC::ADC::value<ADC_CHANNEL_6>());
-  poly_lfo.cv_spread.push(OC::ADC::value<ADC_CHANNEL_7>());
-  poly_lfo.cv_mappable.push(OC::ADC::value<ADC_CHANNEL_8>());
-#else
-  poly_lfo.cv_freq.push(OC::ADC::value<ADC_CHANNEL_1>());
-  poly_lfo.cv_shape.push(OC::ADC::value<ADC_CHANNEL_2>());
-  poly_lfo.cv_spread.push(OC::ADC::value<ADC_CHANNEL_3>());
-  poly_lfo.cv_mappable.push(OC::ADC::value<ADC_CHANNEL_4>());
-#endif
-
+// Latch the settings and smoothed CVs, and render the next block of ticks
+static void POLYLFO_render_block(bool reset_phase, bool tempo_sync) {
   // Range in settings is (0-256] so this gets scaled to (0,65535]
   // CV value is 12 bit so also needs scaling
 
@@ -370,13 +359,45 @@ void FASTRUN POLYLFO_isr() {
   int8_t freq_mult = digitalReadFast(TR4) ? 0xFF : poly_lfo.tr4_multiplier();
   poly_lfo.set_freq_mult(freq_mult);
 
-  if (!freeze && !poly_lfo.frozen())
-    poly_lfo.lfo.Render(freq, reset_phase, tempo_sync, freq_mult);
+  poly_lfo.lfo.RenderBlock(freq, reset_phase, tempo_sync, freq_mult, PolyLfo::kBlockSize);
+  poly_lfo.block_position = 0;
+}
+
+void FASTRUN POLYLFO_isr() {
+
+  bool reset_phase = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
+  bool freeze = OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_2>();
+  bool tempo_sync = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_3>();
+ 
+#ifdef ARDUINO_TEENSY41
+  poly_lfo.cv_freq.push(OC::ADC::value<ADC_CHANNEL_5>());
+  poly_lfo.cv_shape.push(OC::ADC::value<ADC_CHANNEL_6>());
+  poly_lfo.cv_spread.push(OC::ADC::value<ADC_CHANNEL_7>());
+  poly_lfo.cv_mappable.push(OC::ADC::value<ADC_CHANNEL_8>());
+#else
+  poly_lfo.cv_freq.push(OC::ADC::value<ADC_CHANNEL_1>());
+  poly_lfo.cv_shape.push(OC::ADC::value<ADC_CHANNEL_2>());
+  poly_lfo.cv_spread.push(OC::ADC::value<ADC_CHANNEL_3>());
+  poly_lfo.cv_mappable.push(OC::ADC::value<ADC_CHANNEL_4>());
+#endif
+
+  // A new block is rendered when the current one is used up, or right away on
+  // reset/sync so those stay tick-accurate. While frozen, the output holds.
+  if (!freeze && !poly_lfo.frozen()) {
+    if (poly_lfo.block_position >= PolyLfo::kBlockSize) {
+      POLYLFO_render_block(reset_phase, tempo_sync);
+    } else if (reset_phase || tempo_sync) {
+      poly_lfo.lfo.Rewind(PolyLfo::kBlockSize - poly_lfo.block_position);
+      POLYLFO_render_block(reset_phase, tempo_sync);
+    }
+    ++poly_lfo.block_position;
+  }
 
-  OC::DAC::set<DAC_CHANNEL_A>(poly_lfo.lfo.dac_code(0));
-  OC::DAC::set<DAC_CHANNEL_B>(poly_lfo.lfo.dac_code(1));
-  OC::DAC::set<DAC_CHANNEL_C>(poly_lfo.lfo.dac_code(2));
-  OC::DAC::set<DAC_CHANNEL_D>(poly_lfo.lfo.dac_code(3));
+  const size_t s = poly_lfo.block_position - 1;
+  OC::DAC::set<DAC_CHANNEL_A>(poly_lfo.lfo.block_dac_code(0, s));
+  OC::DAC::set<DAC_CHANNEL_B>(poly_lfo.lfo.block_dac_code(1, s));
+  OC::DAC::set<DAC_CHANNEL_C>(poly_lfo.lfo.block_dac_code(2, s));
+  OC::DAC::set<DAC_CHANNEL_D>(poly_lfo.lfo.block_dac_code(3, s));
 }
 
 void POLYLFO_init() {
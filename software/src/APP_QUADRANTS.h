@@ -35,6 +35,7 @@
 #include "HSicons.h"
 #include "HSMIDI.h"
 #include "HSClockManager.h"
+#include "HSPresetQueue.h"
 #include "AudioSetup.h"
 
 #include "hemisphere_config.h"
@@ -144,13 +145,18 @@ public:
       return changed;
     }
     void LoadInputMap() {
+      LoadInputMap(HS::trigger_mapping, HS::cvmapping);
+      HS::CompileRoutes();
+    }
+    // Unpack into the given maps; unset entries are left alone
+    void LoadInputMap(int *trigmap, int *cvmap) {
       int val;
       for (size_t i = 0; i < 8; ++i) {
         val = (uint32_t(values_[QUADRANTS_TRIGMAP1 + i/3]) >> (i%3 * 5)) & 0x1F;
-        if (val != 0) HS::trigger_mapping[i] = constrain(val - 1, 0, TRIGMAP_MAX);
+        if (val != 0) trigmap[i] = constrain(val - 1, 0, TRIGMAP_MAX);
 
         val = (uint32_t(values_[QUADRANTS_CVMAP1 + i/3]) >> (i%3 * 5)) & 0x1F;
-        if (val != 0) HS::cvmapping[i] = constrain(val - 1, 0, CVMAP_MAX);
+        if (val != 0) cvmap[i] = constrain(val - 1, 0, CVMAP_MAX);
       }
     }
 
@@ -308,41 +314,93 @@ public:
         preset_id = id;
     }
     void LoadFromPreset(int id) {
-        quad_active_preset = (QuadrantsPreset*)(quad_presets + id);
-        if (quad_active_preset->is_valid()) {
-            clock_data = quad_active_preset->GetClockData();
+        StagedPreset preset;
+        StagePreset(preset, id);
+        CommitPreset(preset);
+    }
+
+    /* Preset hot-swap: MIDI Program Change queues a preset, the main loop
+     * stages it, and the ISR commits it at the next beat sync, before the
+     * applets run on that tick. See HSPresetQueue.h */
+    void ProcessQueue() {
+      if (preset_queue.Poll([this](StagedPreset &preset, int id) { StagePreset(preset, id); })) {
+        __disable_irq();
+        HS::clock_m.BeatSync( &QuadrantBeatSync );
+        __enable_irq();
+      }
+    }
+    void QueuePresetLoad(int id) {
+      preset_queue.Request(id);
+    }
+    // ISR
+    void CommitQueuedPreset() {
+      preset_queue.Commit([this](const StagedPreset &preset) { CommitPreset(preset); });
+    }
+    void OnBeatSync() {
+      CommitQueuedPreset();
+    }
+
+    struct StagedPreset {
+      int id;
+      bool valid;
+      int applet_index[APPLET_SLOTS];
+      uint64_t applet_data[APPLET_SLOTS];
+      uint64_t clock_data, global_data;
+      int trigger_mapping[ADC_CHANNEL_LAST];
+      int cvmapping[ADC_CHANNEL_LAST];
+    };
+
+    // Everything that doesn't touch live state: applet lookups and unpacking
+    void StagePreset(StagedPreset &preset, int id) {
+        QuadrantsPreset *source = (QuadrantsPreset*)(quad_presets + id);
+        preset.id = id;
+        preset.valid = source->is_valid();
+        if (!preset.valid) return;
+
+        preset.clock_data = source->GetClockData();
+        preset.global_data = source->GetGlobals();
+
+        memcpy(preset.trigger_mapping, HS::trigger_mapping, sizeof(preset.trigger_mapping));
+        memcpy(preset.cvmapping, HS::cvmapping, sizeof(preset.cvmapping));
+        source->LoadInputMap(preset.trigger_mapping, preset.cvmapping);
+
+        for (int h = 0; h < APPLET_SLOTS; h++)
+        {
+            preset.applet_index[h] = HS::get_applet_index_by_id( source->GetAppletId(HEM_SIDE(h)) );
+            preset.applet_data[h] = source->GetData(HEM_SIDE(h));
+        }
+    }
+
+    void CommitPreset(const StagedPreset &preset) {
+        quad_active_preset = (QuadrantsPreset*)(quad_presets + preset.id);
+        if (preset.valid) {
+            clock_data = preset.clock_data;
             ClockSetup_instance.OnDataReceive(clock_data);
 
-            global_data = quad_active_preset->GetGlobals();
+            global_data = preset.global_data;
             ClockSetup_instance.SetGlobals(global_data);
 
-            quad_active_preset->LoadInputMap();
+            memcpy(HS::trigger_mapping, preset.trigger_mapping, sizeof(preset.trigger_mapping));
+            memcpy(HS::cvmapping, preset.cvmapping, sizeof(preset.cvmapping));
+            HS::CompileRoutes();
 
             for (int h = 0; h < APPLET_SLOTS; h++)
             {
-                int index = HS::get_applet_index_by_id( quad_active_preset->GetAppletId(HEM_SIDE(h)) );
-                applet_data[h] = quad_active_preset->GetData(HEM_SIDE(h));
+                int index = preset.applet_index[h];
+                applet_data[h] = preset.applet_data[h];
                 SetApplet(HEM_SIDE(h), index);
                 HS::available_applets[index].instance[h]->OnDataReceive(applet_data[h]);
             }
         }
-        preset_id = id;
+        preset_id = preset.id;
         PokePopup(PRESET_POPUP);
     }
-    void ProcessQueue() {
-      LoadFromPreset(queued_preset);
-    }
-    void QueuePresetLoad(int id) {
-      if (HS::clock_m.IsRunning()) {
-        queued_preset = id;
-        HS::clock_m.BeatSync( &QuadrantBeatSync );
-      }
-      else
-        LoadFromPreset(id);
-    }
 
     // does not modify the preset, only the quad_manager
     void SetApplet(HEM_SIDE hemisphere, int index) {
+#ifdef ARDUINO_TEENSY41
+        HS::DetachAudio(hemisphere);
+#endif
         if (active_applet[hemisphere])
           active_applet[hemisphere]->Unload();
 
@@ -350,6 +408,11 @@ public:
         active_applet[hemisphere] = HS::available_applets[index].instance[hemisphere];
         active_applet[hemisphere]->BaseStart(hemisphere);
     }
+    // Background chores of the loaded applets, from the main loop
+    void Idle() {
+        for (int h = 0; h < APPLET_SLOTS; h++)
+            if (active_applet[h]) active_applet[h]->Idle();
+    }
     void ChangeApplet(HEM_SIDE h, int dir) {
         int index = HS::get_next_applet_index(next_applet_index[h], dir);
         next_applet_index[h] = index;
@@ -382,14 +445,20 @@ public:
     }
 
     void Controller() {
+        // MIDI Clock goes out first, ahead of MIDI Thru and applet output
+        HS::clock_m.MIDIClockOut();
+
         // top-level MIDI-to-CV handling - alters frame outputs
         ProcessMIDI(usbMIDI, usbHostMIDI, MIDI1);
         thisUSB.Task();
         ProcessMIDI(usbHostMIDI, usbMIDI, MIDI1);
         ProcessMIDI(MIDI1, usbMIDI, usbHostMIDI);
 
-        // Clock Setup applet handles internal clock duties
+        // Clock Setup applet handles internal clock duties, and a staged
+        // preset is committed at its beat sync
         ClockSetup_instance.Controller();
+        // with the clock stopped, there's no beat to wait for
+        if (!HS::clock_m.IsRunning()) CommitQueuedPreset();
 
         // execute Applets
         for (int h = 0; h < APPLET_SLOTS; h++)
@@ -767,7 +836,7 @@ public:
 
 private:
     int preset_id = 0;
-    int queued_preset = 0;
+    HS::PresetQueue<StagedPreset> preset_queue;
     int preset_cursor = 0;
     HemisphereApplet *active_applet[4]; // Pointers to actual applets
     int active_applet_index[4]; // Indexes to available_applets
@@ -811,6 +880,7 @@ private:
         TRIG_LENGTH,
         SCREENSAVER_MODE,
         CURSOR_MODE,
+        RANDOM_SEED,
 
         // Input Remapping
         TRIGMAP1, TRIGMAP2, TRIGMAP3, TRIGMAP4,
@@ -853,6 +923,7 @@ private:
         case TRIGMAP4:
             HS::trigger_mapping[config_cursor-TRIGMAP1] = constrain(
                 HS::trigger_mapping[config_cursor-TRIGMAP1] + dir, 0, TRIGMAP_MAX);
+            HS::CompileRoutes();
             break;
         case CVMAP1:
         case CVMAP2:
@@ -860,6 +931,7 @@ private:
         case CVMAP4:
             HS::cvmapping[config_cursor-CVMAP1] =
               constrain( HS::cvmapping[config_cursor-CVMAP1] + dir, 0, CVMAP_MAX);
+            HS::CompileRoutes();
             break;
         case TRIGMAP5:
         case TRIGMAP6:
@@ -867,6 +939,7 @@ private:
         case TRIGMAP8:
             HS::trigger_mapping[config_cursor-TRIGMAP5 + 4] = constrain(
                 HS::trigger_mapping[config_cursor-TRIGMAP5 + 4] + dir, 0, TRIGMAP_MAX);
+            HS::CompileRoutes();
             break;
         case CVMAP5:
         case CVMAP6:
@@ -874,6 +947,7 @@ private:
         case CVMAP8:
             HS::cvmapping[config_cursor-CVMAP5 + 4] =
               constrain( HS::cvmapping[config_cursor-CVMAP5 + 4] + dir, 0, CVMAP_MAX);
+            HS::CompileRoutes();
             break;
         case TRIG_LENGTH:
             HS::trig_length = (uint32_t) constrain( int(HS::trig_length + dir), 1, 127);
@@ -956,6 +1030,11 @@ private:
             HS::cursor_wrap = !HS::cursor_wrap;
             break;
 
+        case RANDOM_SEED:
+            HS::random_seed = (HS::random_seed + 1) & 0x7;
+            HS::ReseedRandom();
+            break;
+
         default: break;
         }
     }
@@ -1060,6 +1139,10 @@ private:
         const char * cursor_mode_name[3] = { "modal", "modal+wrap" };
         gfxPrint(1, 35, "Cursor:  ");
         gfxPrint(cursor_mode_name[HS::cursor_wrap]);
+
+        gfxPrint(1, 45, "Random Seed:  ");
+        if (HS::random_seed) gfxPrint(HS::random_seed);
+        else gfxPrint("Off");
         
         switch (config_cursor) {
         case TRIG_LENGTH:
@@ -1071,6 +1154,9 @@ private:
         case CURSOR_MODE:
             gfxIcon(43, 35, RIGHT_ICON);
             break;
+        case RANDOM_SEED:
+            gfxIcon(73, 45, RIGHT_ICON);
+            break;
         case CONFIG_DUMMY:
             gfxIcon(2, 1, LEFT_ICON);
             break;
@@ -1149,7 +1235,7 @@ void QuadrantSysExHandler() {
         quad_active_preset->OnReceiveSysEx();
 }
 void QuadrantBeatSync() {
-  quad_manager.ProcessQueue();
+  quad_manager.OnBeatSync();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1200,7 +1286,12 @@ void QUADRANTS_handleAppEvent(OC::AppEvent event) {
     }
 }
 
-void QUADRANTS_loop() {} // Essentially deprecated in favor of ISR
+void QUADRANTS_loop() {
+    // Applets run in the ISR; only background chores happen here
+    quad_manager.ProcessQueue();
+    quad_manager.Idle();
+    HS::buffer_pool.Idle();
+}
 
 void QUADRANTS_menu() {
     quad_manager.View();
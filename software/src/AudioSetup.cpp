@@ -6,6 +6,93 @@
 #include "HSUtils.h"
 #include "HSicons.h"
 #include "OC_strings.h"
+#include "OC_audio_params.h"
+#include "HSAudioApplet.h"
+
+namespace OC {
+  namespace AudioDSP {
+    // CV-driven settings, handed from the core ISR to the audio update
+    enum ParamId {
+      LEVEL,
+      FOLD,
+      CUTOFF,
+
+      PARAMS_PER_CHANNEL
+    };
+    static inline int param(int ch, ParamId p) {
+      return ch * PARAMS_PER_CHANNEL + p;
+    }
+    ParamBridge<2 * PARAMS_PER_CHANNEL> params;
+
+    void ApplyParams();
+  } // AudioDSP namespace
+} // OC namespace
+
+// Applies parameter changes once per block. It isn't connected to anything,
+// and it's constructed before the rest of the graph so it updates first.
+class AudioParamLatch : public AudioStream {
+public:
+  AudioParamLatch() : AudioStream(0, NULL) {
+    active = true;
+  }
+  virtual void update(void) {
+    OC::AudioDSP::ApplyParams();
+  }
+};
+
+// Output VCA: ramps its gain across each block instead of stepping it
+class AudioEffectRampGain : public AudioStream {
+public:
+  AudioEffectRampGain(int param) : AudioStream(1, inputQueueArray), param_(param) { }
+  virtual void update(void) {
+    const OC::AudioDSP::ParamRamp &ramp = OC::AudioDSP::params.ramp(param_);
+    if (!ramp.moving() && ramp.to == 0.0f) {
+      audio_block_t *block = receiveReadOnly();
+      if (block) release(block);
+      return;
+    }
+    audio_block_t *block = receiveWritable();
+    if (!block) return;
+    OC::AudioDSP::ApplyGainRamp(block->data, ramp);
+    transmit(block);
+    release(block);
+  }
+private:
+  const int param_;
+  audio_block_t *inputQueueArray[1];
+};
+
+// Runs the applet kernel attached to a channel, if there is one. Teensy
+// Audio already measures each node, so processorUsageMax() here is the
+// kernel's cost.
+class AudioAppletStream : public AudioStream {
+public:
+  AudioAppletStream(int ch) : AudioStream(1, inputQueueArray), ch_(ch) { }
+  virtual void update(void) {
+    HS::AudioKernel *kernel = HS::audio_kernel[ch_];
+    if (!kernel) {
+      audio_block_t *block = receiveReadOnly();
+      if (!block) return;
+      transmit(block);
+      release(block);
+      return;
+    }
+    audio_block_t *block = receiveWritable();
+    if (!block) return;
+    kernel->Process(block->data);
+    transmit(block);
+    release(block);
+  }
+private:
+  const int ch_;
+  audio_block_t *inputQueueArray[1];
+};
+
+namespace HS {
+  AudioKernel * volatile audio_kernel[AUDIO_CHANNELS];
+}
+
+AudioParamLatch          param_latch;
 
 // Use the web GUI tool as a guide: https://www.pjrc.com/teensy/gui/
 
@@ -25,6 +112,10 @@ AudioMixer4              mixer4;         //xy=1130.2223625183105,375.33338928222
 AudioMixer4              mixer3;         //xy=1132.3332710266113,80.22221755981445
 //AudioEffectFreeverb      freeverb2;      //xy=1132.5553283691406,255.11116409301758
 //AudioEffectFreeverb      freeverb1;      //xy=1135.6664810180664,188.5555362701416
+AudioEffectRampGain      vca1(OC::AudioDSP::param(0, OC::AudioDSP::LEVEL)); // before i2s2, so it updates first
+AudioEffectRampGain      vca2(OC::AudioDSP::param(1, OC::AudioDSP::LEVEL));
+AudioAppletStream        applet_audio1(0);
+AudioAppletStream        applet_audio2(1);
 AudioOutputI2S2          i2s2;           //xy=1434.77783203125,232.5555591583252
 
 AudioConnection          patchCord1(i2s1, 0, amp1, 0);
@@ -45,8 +136,8 @@ AudioConnection          patchCord15(mixer1, 0, mixer3, 0);
 AudioConnection          patchCord16(dc2, 0, wavefolder2, 1);
 AudioConnection          patchCord17(wavefolder2, 0, mixer4, 3);
 AudioConnection          patchCord18(wavefolder1, 0, mixer3, 3);
-AudioConnection          patchCord19(mixer4, 0, i2s2, 1);
-AudioConnection          patchCord21(mixer3, 0, i2s2, 0);
+//AudioConnection          patchCord19(mixer4, 0, i2s2, 1);
+//AudioConnection          patchCord21(mixer3, 0, i2s2, 0);
 //AudioConnection          patchCord20(mixer4, freeverb2);
 //AudioConnection          patchCord22(mixer3, freeverb1);
 //AudioConnection          patchCord23(freeverb2, 0, mixer4, 1);
@@ -55,10 +146,27 @@ AudioConnection          patchCord21(mixer3, 0, i2s2, 0);
 //AudioConnection          patchCord26(freeverb1, 0, mixer4, 2);
 // GUItool: end automatically generated code
 
+// The output VCAs sit between the final mixers and the outputs
+// followed by the applet kernels, if any
+AudioConnection          patchCord27(mixer3, 0, vca1, 0);
+AudioConnection          patchCord28(vca1, 0, applet_audio1, 0);
+AudioConnection          patchCord29(applet_audio1, 0, i2s2, 0);
+AudioConnection          patchCord30(mixer4, 0, vca2, 0);
+AudioConnection          patchCord31(vca2, 0, applet_audio2, 0);
+AudioConnection          patchCord32(applet_audio2, 0, i2s2, 1);
+
 // Notes:
 //
 // amp1 and amp2 are beginning of chain, for pre-filter attenuation
 // dc1 and dc2 are control signals for modulating the wavefold amount.
+// vca1 and vca2 are end of chain, for the VCA/LPG level.
+// applet_audio1 and 2 run whatever kernel the left/right applet attached.
+//
+// CV doesn't touch these objects directly: Process() runs every core tick,
+// but settings only change once per audio block (128 samples, ~2.9ms).
+// Process() sets targets in the parameter bridge, and param_latch applies
+// the ones that moved at the start of each block. Level (vca1/vca2) and fold
+// drive (dc1/dc2) ramp per sample; cutoff and the fold mix step per block.
 //
 // The reverbs are fed from the final outputs and looped back into BOTH mixers...
 // mixer3 and mixer4 control the balance:
@@ -99,8 +207,8 @@ namespace OC {
     float bias[2][TARGET_COUNT];
     uint8_t audio_cursor[2] = { 0, 0 };
 
-    float amplevel[2] = { 1.0, 1.0 };
-    float foldamt[2] = { 0.0, 0.0 };
+    // dc ramps take milliseconds
+    static constexpr float BLOCK_MS = kBlockSamples * 1000.0f / AUDIO_SAMPLE_RATE_EXACT;
 
 
     // Right side state variable filter functions
@@ -156,33 +264,40 @@ namespace OC {
       // 4V = 9216 Hz
       float freq = abs(cv) / 64 + bias[ch][FILTER_CUTOFF];
       freq *= freq;
-
-      if (ch == 0)
-        ladder1.frequency(freq);
-      else
-        svfilter1.frequency(freq);
+      params.Set(param(ch, CUTOFF), freq);
     }
 
-
     void Wavefold(int ch, int cv) {
-      foldamt[ch] = (float)cv / MAX_CV + bias[ch][WAVEFOLD_MOD];
-      if (ch == 0) {
-        dc1.amplitude(foldamt[ch]);
-        mixer3.gain(0, amplevel[ch] * (1.0 - abs(foldamt[ch])));
-        mixer3.gain(3, foldamt[ch] * 0.9);
-      } else {
-        dc2.amplitude(foldamt[ch]);
-        mixer4.gain(0, amplevel[ch] * (1.0 - abs(foldamt[ch])));
-        mixer4.gain(3, foldamt[ch] * 0.9);
-      }
+      params.Set(param(ch, FOLD), (float)cv / MAX_CV + bias[ch][WAVEFOLD_MOD]);
     }
 
     void AmpLevel(int ch, int cv) {
-      amplevel[ch] = (float)cv / MAX_CV + bias[ch][AMP_LEVEL];
-      if (ch == 0)
-        mixer3.gain(0, amplevel[ch] * (1.0 - abs(foldamt[ch])));
-      else
-        mixer4.gain(0, amplevel[ch] * (1.0 - abs(foldamt[ch])));
+      params.Set(param(ch, LEVEL), (float)cv / MAX_CV + bias[ch][AMP_LEVEL]);
+    }
+
+    // ----- called from the audio update, once per block
+    void ApplyParams() {
+      const uint32_t changed = params.Latch();
+
+      for (int ch = 0; ch < 2; ++ch) {
+        if (changed & (1u << param(ch, CUTOFF))) {
+          const float freq = params.value(param(ch, CUTOFF));
+          if (ch == 0)
+            ladder1.frequency(freq);
+          else
+            svfilter1.frequency(freq);
+        }
+
+        if (changed & (1u << param(ch, FOLD))) {
+          const float fold = params.value(param(ch, FOLD));
+          AudioSynthWaveformDc &dc = ch ? dc2 : dc1;
+          AudioMixer4 &mixer = ch ? mixer4 : mixer3;
+          dc.amplitude(fold, BLOCK_MS);
+          mixer.gain(0, 1.0 - abs(fold));
+          mixer.gain(3, fold * 0.9);
+        }
+      }
+      // vca1 and vca2 ramp the level themselves
     }
 
     // Designated Integration Functions
@@ -190,6 +305,14 @@ namespace OC {
     void Init() {
       AudioMemory(128);
 
+      params.Init(0.0f);
+      for (int ch = 0; ch < 2; ++ch) {
+        params.Set(param(ch, LEVEL), 1.0f);
+        // ignore ADC noise
+        params.SetThreshold(param(ch, LEVEL), 1.0f / 4096);
+        params.SetThreshold(param(ch, FOLD), 1.0f / 1024);
+      }
+
       amp1.gain(0.85); // attenuate before filter
       amp2.gain(0.85); // attenuate before filter
 
@@ -133,14 +133,13 @@ public:
     }
 
     int In(int ch) {
-        const int c = cvmapping[ch];
-        if (!c) return 0;
-        return (c <= ADC_CHANNEL_LAST) ? frame.inputs[c - 1] : frame.outputs[c - 1 - ADC_CHANNEL_LAST];
+        return input_routes[ch].In();
     }
 
     // Apply small center detent to input, so it reads zero before a threshold
     int DetentedIn(int ch) {
-        return (In(ch) > 64 || In(ch) < -64) ? In(ch) : 0;
+        const int cv = In(ch);
+        return (cv > 64 || cv < -64) ? cv : 0;
     }
 
     // Standard bi-polar CV modulation scenario
@@ -155,12 +154,7 @@ public:
     }
 
     bool Gate(int ch) {
-        const int t = trigger_mapping[ch];
-        const int offset = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST;
-        if (!t) return false;
-        return (t <= offset)
-          ? frame.gate_high[t - 1]
-          : (frame.outputs[t - 1 - offset] > GATE_THRESHOLD);
+        return input_routes[ch].Gate(GATE_THRESHOLD);
     }
 
     void GateOut(int ch, bool high) {
@@ -169,19 +163,11 @@ public:
 
     bool Clock(int ch) {
         bool clocked = 0;
-        const int trmap = trigger_mapping[ch];
 
         if (HS::clock_m.IsRunning() && HS::clock_m.GetMultiply(ch) != 0)
             clocked = HS::clock_m.Tock(ch);
-        else if (trmap > 0) {
-          const int offset = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST;
-          if (trmap <= offset)
-            clocked = frame.clocked[ trmap - 1 ];
-          else {
-            clocked = frame.clockout_q[ trmap - 1 - offset ];
-            frame.clockout_q[ trmap - 1 - offset ] = false;
-          }
-        }
+        else
+            clocked = input_routes[ch].Clock();
 
         // manual triggers
         clocked = clocked || HS::clock_m.Beep(ch);
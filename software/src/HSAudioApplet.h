@@ -0,0 +1,95 @@
+/*
+ * AudioKernel
+ *   block-based audio processing for applets on Teensy 4.1
+ *
+ * An applet that wants to process audio owns a kernel and attaches it to its
+ * channel. The audio update calls Process() once per block of 128 samples, in
+ * the audio interrupt; the applet keeps running in the core ISR as usual and
+ * hands its settings over with a ParamBuffer, from Controller().
+ *
+ * Kernels must not allocate, block or touch the applet directly. Sample
+ * memory comes from the buffer pool (see HSBufferPool.h), requested by the
+ * applet in Start() and only handed to the kernel once BufferReady().
+ * No Arduino dependencies, so kernels can be rendered offline.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace HS {
+
+static constexpr int AUDIO_BLOCK_SIZE = 128;    // AUDIO_BLOCK_SAMPLES
+static constexpr float AUDIO_SAMPLE_RATE = 44117.647f; // AUDIO_SAMPLE_RATE_EXACT
+static constexpr int AUDIO_CHANNELS = 2;
+
+// Lock-free double buffer for one writer (the applet) and one reader (the
+// audio update). The writer never waits; if it writes again while the reader
+// is copying, the reader sees the sequence move and copies again.
+template <class T>
+class ParamBuffer {
+public:
+    void Write(const T &value) {
+        const uint32_t next = seq + 1;
+        slot[next & 1] = value;
+        std::atomic_signal_fence(std::memory_order_release);
+        seq = next;
+    }
+
+    // Copies the latest values into out
+    // @return false if nothing was written since the last Read()
+    bool Read(T &out) {
+        uint32_t s;
+        do {
+            s = seq;
+            if (s == last_read) return false;
+            std::atomic_signal_fence(std::memory_order_acquire);
+            out = slot[s & 1];
+            std::atomic_signal_fence(std::memory_order_acquire);
+        } while (s != seq);
+        last_read = s;
+        return true;
+    }
+
+private:
+    T slot[2]{};
+    volatile uint32_t seq = 0;
+    uint32_t last_read = 0;
+};
+
+class AudioKernel {
+public:
+    // Processes one block in place
+    virtual void Process(int16_t *block) = 0;
+};
+
+// For kernels that work in float, full scale is +/-1.0
+inline void BlockToFloat(const int16_t *in, float *out) {
+    for (int n = 0; n < AUDIO_BLOCK_SIZE; ++n) out[n] = in[n] * (1.0f / 32768.0f);
+}
+
+inline void BlockFromFloat(const float *in, int16_t *out) {
+    for (int n = 0; n < AUDIO_BLOCK_SIZE; ++n) {
+        const float s = in[n] * 32768.0f;
+        out[n] = s >= 32767.0f ? 32767 : s <= -32768.0f ? -32768 : static_cast<int16_t>(s);
+    }
+}
+
+// The kernel running on each audio channel, or nullptr to pass audio through
+extern AudioKernel * volatile audio_kernel[AUDIO_CHANNELS];
+
+// Applet slots 0 and 1 own the left and right channel; the others get none
+inline bool AttachAudio(int slot, AudioKernel *kernel) {
+    if (slot < 0 || slot >= AUDIO_CHANNELS) return false;
+    audio_kernel[slot] = kernel;
+    return true;
+}
+
+inline void DetachAudio(int slot) {
+    if (slot >= 0 && slot < AUDIO_CHANNELS) audio_kernel[slot] = nullptr;
+}
+
+} // namespace HS
@@ -0,0 +1,139 @@
+/*
+ * Audio kernels for applets on Teensy 4.1: bitcrusher, VCA/LPG and delay.
+ * See HSAudioApplet.h for how they're driven.
+ *
+ */
+
+#pragma once
+
+#include "HSAudioApplet.h"
+
+namespace HS {
+
+// Sample rate and bit depth reduction, the Dr. LoFi way
+class BitCrushKernel : public AudioKernel {
+public:
+    struct Params {
+        uint8_t rate = 1;  // hold each sample this many times, 1-64
+        uint8_t depth = 0; // bits dropped, 0-13
+    };
+
+    void Set(const Params &p) { params.Write(p); }
+
+    void Process(int16_t *block) override {
+        params.Read(p);
+        const int16_t mask = ~((1 << p.depth) - 1);
+        for (int n = 0; n < AUDIO_BLOCK_SIZE; ++n) {
+            if (--countdown <= 0) {
+                held = block[n] & mask;
+                countdown = p.rate;
+            }
+            block[n] = held;
+        }
+    }
+
+private:
+    ParamBuffer<Params> params;
+    Params p;
+    int countdown = 0;
+    int16_t held = 0;
+};
+
+// VCA, or a low pass gate when lowpass is set: the filter closes with the
+// level. The level ramps across each block.
+class VcaLpgKernel : public AudioKernel {
+public:
+    struct Params {
+        float level = 0.0f; // 1.0 is unity gain
+        bool lowpass = false;
+    };
+
+    void Set(const Params &p) { params.Write(p); }
+
+    void Process(int16_t *block) override {
+        params.Read(p);
+        const float step = (p.level - gain) * (1.0f / AUDIO_BLOCK_SIZE);
+
+        float x[AUDIO_BLOCK_SIZE];
+        BlockToFloat(block, x);
+        for (int n = 0; n < AUDIO_BLOCK_SIZE; ++n) {
+            const float g = gain + step * (n + 1);
+            x[n] *= g;
+            if (p.lowpass) {
+                // one pole, fully open at unity
+                float coef = g * g;
+                if (coef > 1.0f) coef = 1.0f;
+                if (coef < 0.0005f) coef = 0.0005f;
+                lp += coef * (x[n] - lp);
+                x[n] = lp;
+            }
+        }
+        gain = p.level;
+        if (!p.lowpass) lp = 0.0f;
+        BlockFromFloat(x, block);
+    }
+
+private:
+    ParamBuffer<Params> params;
+    Params p;
+    float gain = 0.0f;
+    float lp = 0.0f;
+};
+
+// Feedback delay on a buffer from the pool. Changes of delay time glide one
+// sample per sample, like a tape head, rather than jumping.
+class DelayKernel : public AudioKernel {
+public:
+    struct Params {
+        uint32_t time = 1;      // in samples
+        uint16_t feedback = 0;  // 0-32767 for 0-1
+        uint16_t mix = 16384;   // 0 dry - 32767 wet
+    };
+
+    // Call before attaching; the buffer must already be cleared
+    void Init(int16_t *buffer_, size_t length_) {
+        buffer = buffer_;
+        length = length_;
+        write = 0;
+        time = 1;
+    }
+
+    size_t max_time() const { return length ? length - 1 : 0; }
+
+    void Set(const Params &p) { params.Write(p); }
+
+    void Process(int16_t *block) override {
+        if (!buffer || length < 2) return;
+        params.Read(p);
+        uint32_t target = p.time;
+        if (target < 1) target = 1;
+        if (target > max_time()) target = max_time();
+
+        for (int n = 0; n < AUDIO_BLOCK_SIZE; ++n) {
+            if (time < target) ++time;
+            else if (time > target) --time;
+
+            const size_t r = write >= time ? write - time : write + length - time;
+            const int32_t wet = buffer[r];
+            const int32_t in = block[n];
+
+            int32_t fb = in + ((wet * p.feedback) >> 15);
+            if (fb > 32767) fb = 32767;
+            if (fb < -32768) fb = -32768;
+            buffer[write] = fb;
+            if (++write == length) write = 0;
+
+            block[n] = in + (((wet - in) * p.mix) >> 15);
+        }
+    }
+
+private:
+    ParamBuffer<Params> params;
+    Params p;
+    int16_t *buffer = nullptr;
+    size_t length = 0;
+    size_t write = 0;
+    uint32_t time = 1;
+};
+
+} // namespace HS
@@ -0,0 +1,156 @@
+/*
+ * BufferPool
+ *   fixed sample memory for applets, handed out per applet slot
+ *
+ * Each memory region is split evenly between the applet slots, so a request
+ * is just a size check: no heap, no fragmentation, safe to call from Start()
+ * in the ISR. Regions are tried in the order they were added, so put the
+ * fastest memory first (RAM/DMAMEM, then PSRAM where there is some).
+ *
+ * A new buffer holds whatever was there before until Idle(), called from the
+ * main loop, has filled it with the requested value; ready() says when.
+ * No Arduino dependencies beyond __disable_irq()/__enable_irq().
+ *
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace HS {
+
+class BufferPool {
+public:
+    static constexpr int MAX_REGIONS = 2;
+    static constexpr int MAX_OWNERS = 4;
+
+    void Init(int owners_) {
+        owners = owners_ > MAX_OWNERS ? MAX_OWNERS : owners_;
+        region_count = 0;
+        for (int o = 0; o < MAX_OWNERS; ++o) {
+            slot[o].active = false;
+            slot[o].generation = 0;
+            clearing[o].generation = 0;
+            clearing[o].pos = 0;
+        }
+    }
+
+    // Adds memory to the pool; each owner gets size / owners bytes of it
+    void AddRegion(uint8_t *memory, size_t size) {
+        if (!memory || region_count == MAX_REGIONS) return;
+        region[region_count].memory = memory;
+        region[region_count].share = (size / owners) & ~size_t(3);
+        ++region_count;
+    }
+
+    // Largest buffer a slot can get
+    size_t max_size() const {
+        size_t largest = 0;
+        for (int r = 0; r < region_count; ++r)
+            if (region[r].share > largest) largest = region[r].share;
+        return largest;
+    }
+
+    // @return a buffer of at least size bytes for this owner, or nullptr if
+    // none of the regions is big enough. Replaces any buffer it already had.
+    void *Request(int owner, size_t size, uint8_t fill = 0) {
+        if (owner < 0 || owner >= owners) return nullptr;
+        for (int r = 0; r < region_count; ++r) {
+            if (size <= region[r].share) {
+                Slot &s = slot[owner];
+                s.region = r;
+                s.size = size;
+                s.fill = fill;
+                s.active = true;
+                ++s.generation; // restarts clearing
+                return region[r].memory + region[r].share * owner;
+            }
+        }
+        return nullptr;
+    }
+
+    void Release(int owner) {
+        if (owner < 0 || owner >= owners) return;
+        slot[owner].active = false;
+        ++slot[owner].generation;
+    }
+
+    // true once the owner's buffer has been filled
+    bool ready(int owner) const {
+        const Slot &s = slot[owner];
+        return s.active && clearing[owner].generation == s.generation && clearing[owner].pos >= s.size;
+    }
+
+    // Fills pending buffers, at most chunk bytes per call. Main loop only.
+    void Idle(size_t chunk = 1024) {
+        Idle(chunk, [](int) { });
+    }
+
+    // As Idle(), with preempted(owner) called where the ISR could run between
+    // taking a slot's request and filling it, for tests
+    template <class Preempted>
+    void Idle(size_t chunk, Preempted preempted) {
+        for (int o = 0; o < owners; ++o) {
+            // Request() in the ISR can replace the slot's request at any time,
+            // so the fill works from a consistent copy of it
+            __disable_irq();
+            const uint32_t generation = slot[o].generation;
+            const bool active = slot[o].active;
+            const Region &r = region[slot[o].region];
+            const size_t size = slot[o].size;
+            const uint8_t fill = slot[o].fill;
+            __enable_irq();
+
+            Clearing &c = clearing[o];
+            if (c.generation != generation) {
+                c.generation = generation;
+                c.pos = 0;
+            }
+            if (!active || c.pos >= size) continue;
+
+            const size_t n = size - c.pos < chunk ? size - c.pos : chunk;
+            uint8_t *dest = r.memory + r.share * o + c.pos;
+            preempted(o);
+
+            // If a new Request() came in since, the generation has moved on and
+            // the next call starts over with its size and value. Should one
+            // land during the memset, it's only writing the slot's old share.
+            if (slot[o].generation != generation) continue;
+            memset(dest, fill, n);
+            c.pos += n;
+        }
+    }
+
+private:
+    struct Region {
+        uint8_t *memory;
+        size_t share;
+    };
+
+    // Written by the ISR
+    struct Slot {
+        volatile bool active;
+        volatile uint8_t region;
+        volatile uint8_t fill;
+        volatile size_t size;
+        volatile uint32_t generation;
+    };
+
+    // Written by the main loop
+    struct Clearing {
+        uint32_t generation;
+        size_t pos;
+    };
+
+    int owners = 1;
+    int region_count = 0;
+    Region region[MAX_REGIONS];
+    Slot slot[MAX_OWNERS];
+    Clearing clearing[MAX_OWNERS];
+};
+
+extern BufferPool buffer_pool;
+
+} // namespace HS
@@ -0,0 +1,272 @@
+/*
+ * CV stream
+ *   compact recordings of two CV/gate channels, written in the background
+ *
+ * Each sample is a CVFrame. The codec stores a frame as the change from the
+ * one before, and repeats of a frame as a run:
+ *
+ *   0rrrrrrr              the last frame again, r+1 times
+ *   1000mmgg [bytes]      a new frame with gates gg, and CVs by mode mm:
+ *                           00 unchanged
+ *                           01 both deltas in -8..7, a nibble each, 1 byte
+ *                           10 both deltas in -128..127, 2 bytes
+ *                           11 both values, int16 little endian, 4 bytes
+ *
+ * Held gates and flat CV cost a byte per 128 samples; slow modulation 2-3
+ * bytes per sample.
+ *
+ * A StreamWriter gets the encoded bytes from the ISR into a take in slow
+ * memory (PSRAM) without the ISR ever touching it: bytes go into one of two
+ * RAM pages, and the main loop copies full pages over in Idle(). If the loop
+ * falls a whole page behind, the writer refuses further writes and says so,
+ * rather than blocking or overwriting a page that's still queued.
+ * No Arduino dependencies.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace HS {
+
+struct CVFrame {
+    int16_t cv[2] = {0, 0};
+    uint8_t gates = 0; // bit per channel
+
+    bool operator==(const CVFrame &f) const {
+        return cv[0] == f.cv[0] && cv[1] == f.cv[1] && gates == f.gates;
+    }
+    bool operator!=(const CVFrame &f) const { return !(*this == f); }
+};
+
+class CVStreamEncoder {
+public:
+    static constexpr size_t MAX_BYTES = 6; // a run and the longest frame
+
+    void Reset() {
+        prev = CVFrame();
+        run = 0;
+    }
+
+    // Encodes f into out, which has room for MAX_BYTES. A repeat is held back
+    // as part of a run, so this may write nothing.
+    // @return bytes written
+    size_t Encode(const CVFrame &f, uint8_t *out) {
+        if (f == prev) {
+            if (++run < 128) return 0;
+            return Flush(out);
+        }
+
+        size_t n = Flush(out);
+        const int d0 = f.cv[0] - prev.cv[0];
+        const int d1 = f.cv[1] - prev.cv[1];
+        uint8_t mode;
+        if (d0 == 0 && d1 == 0) {
+            mode = 0;
+            out[n++] = 0x80 | (f.gates & 3);
+        } else if (d0 >= -8 && d0 <= 7 && d1 >= -8 && d1 <= 7) {
+            mode = 1;
+            out[n++] = 0x80 | (mode << 2) | (f.gates & 3);
+            out[n++] = (d0 & 0x0f) | ((d1 & 0x0f) << 4);
+        } else if (d0 >= -128 && d0 <= 127 && d1 >= -128 && d1 <= 127) {
+            mode = 2;
+            out[n++] = 0x80 | (mode << 2) | (f.gates & 3);
+            out[n++] = static_cast<uint8_t>(d0);
+            out[n++] = static_cast<uint8_t>(d1);
+        } else {
+            mode = 3;
+            out[n++] = 0x80 | (mode << 2) | (f.gates & 3);
+            for (int ch = 0; ch < 2; ++ch) {
+                out[n++] = static_cast<uint16_t>(f.cv[ch]) & 0xff;
+                out[n++] = static_cast<uint16_t>(f.cv[ch]) >> 8;
+            }
+        }
+        prev = f;
+        return n;
+    }
+
+    // Writes out a pending run; call at the end of a recording
+    // @return bytes written
+    size_t Flush(uint8_t *out) {
+        if (!run) return 0;
+        out[0] = run - 1;
+        run = 0;
+        return 1;
+    }
+
+    // Frames given to Encode() that aren't in the output yet
+    uint32_t pending() const { return run; }
+
+private:
+    CVFrame prev;
+    uint32_t run = 0;
+};
+
+class CVStreamDecoder {
+public:
+    void Reset() {
+        prev = CVFrame();
+        run = 0;
+        pos = 0;
+    }
+
+    // Decodes the next frame from the first size bytes of data. Returns false,
+    // consuming nothing, if its bytes aren't all there yet.
+    bool Next(const uint8_t *data, const size_t size, CVFrame &out) {
+        if (!run) {
+            if (pos >= size) return false;
+            const uint8_t token = data[pos];
+            if (token < 0x80) {
+                run = token + 1;
+                ++pos;
+            } else {
+                static constexpr uint8_t length[4] = {0, 1, 2, 4};
+                const uint8_t mode = (token >> 2) & 3;
+                if (pos + 1 + length[mode] > size) return false;
+                const uint8_t *b = data + pos + 1;
+                switch (mode) {
+                case 1:
+                    prev.cv[0] += static_cast<int8_t>(b[0] << 4) >> 4;
+                    prev.cv[1] += static_cast<int8_t>(b[0] & 0xf0) >> 4;
+                    break;
+                case 2:
+                    prev.cv[0] += static_cast<int8_t>(b[0]);
+                    prev.cv[1] += static_cast<int8_t>(b[1]);
+                    break;
+                case 3:
+                    prev.cv[0] = static_cast<int16_t>(b[0] | (b[1] << 8));
+                    prev.cv[1] = static_cast<int16_t>(b[2] | (b[3] << 8));
+                    break;
+                }
+                prev.gates = token & 3;
+                pos += 1 + length[mode];
+                out = prev;
+                return true;
+            }
+        }
+        --run;
+        out = prev;
+        return true;
+    }
+
+    size_t position() const { return pos; }
+
+private:
+    CVFrame prev;
+    uint32_t run = 0;
+    size_t pos = 0;
+};
+
+// A recording in slow memory
+struct StreamTake {
+    uint8_t *data = nullptr;
+    size_t capacity = 0;
+    volatile size_t size = 0;    // bytes accepted by the writer
+    volatile size_t flushed = 0; // bytes copied into data so far, safe to read
+    uint32_t length = 0;         // frames, once finished
+    volatile uint32_t pass = 0;  // counts the writer's passes over it
+};
+
+// The default page holds what a looper overdubbing at 400% can write in a
+// 10ms main loop: 4 frames a tick, up to MAX_BYTES each.
+template <size_t PAGE_SIZE = 4096>
+class StreamWriter {
+public:
+    // Starts writing take t from the beginning. Pages still queued from an
+    // earlier pass over t land first, so they can't overwrite this one. ISR.
+    void Start(StreamTake &t) {
+        ++t.pass;
+        t.size = 0;
+        t.flushed = 0;
+        t.length = 0;
+        take = &t;
+        pos = 0;
+        offset = 0;
+        overrun_ = false;
+    }
+
+    // Appends n <= PAGE_SIZE bytes, all or nothing. ISR.
+    // @return false if the take is full, or on overrun()
+    bool Write(const uint8_t *src, size_t n) {
+        if (!take || take->size + n > take->capacity) return false;
+        if (page[cur].full || (pos + n > PAGE_SIZE && page[cur ^ 1].full)) {
+            overrun_ = true;
+            return false;
+        }
+        const size_t first = (pos + n > PAGE_SIZE) ? PAGE_SIZE - pos : n;
+        memcpy(page[cur].bytes + pos, src, first);
+        pos += first;
+        take->size = take->size + n;
+        if (pos == PAGE_SIZE) Submit();
+        if (first < n) {
+            memcpy(page[cur].bytes, src + first, n - first);
+            pos = n - first;
+        }
+        return true;
+    }
+
+    // Queues the last partial page; the take is complete once flushed ==
+    // size. ISR.
+    void Finish() {
+        if (take && pos) Submit();
+        take = nullptr;
+    }
+
+    // Drops anything queued, for when the takes go away. ISR.
+    void Abort() {
+        for (Page &p : page) p.full = false;
+        take = nullptr;
+        pos = 0;
+    }
+
+    bool overrun() const { return overrun_; }
+
+    // Copies queued pages into their takes, in order. Main loop only.
+    void Idle() {
+        while (page[flush_next].full) {
+            Page &p = page[flush_next];
+            memcpy(p.take->data + p.offset, p.bytes, p.length);
+            if (p.pass == p.take->pass) p.take->flushed = p.offset + p.length;
+            std::atomic_signal_fence(std::memory_order_release);
+            p.full = false;
+            flush_next ^= 1;
+        }
+    }
+
+private:
+    struct Page {
+        uint8_t bytes[PAGE_SIZE];
+        StreamTake *take = nullptr;
+        uint32_t pass = 0;
+        size_t offset = 0;
+        size_t length = 0;
+        volatile bool full = false;
+    };
+
+    void Submit() {
+        Page &done = page[cur];
+        done.take = take;
+        done.pass = take->pass;
+        done.offset = offset;
+        done.length = pos;
+        std::atomic_signal_fence(std::memory_order_release);
+        done.full = true;
+        cur ^= 1;
+        offset += pos;
+        pos = 0;
+    }
+
+    Page page[2];
+    StreamTake *take = nullptr;
+    size_t pos = 0;     // in page[cur]
+    size_t offset = 0;  // of page[cur] in the take
+    uint8_t cur = 0;    // page the ISR fills
+    uint8_t flush_next = 0; // page the loop copies next
+    bool overrun_ = false;
+};
+
+} // namespace HS
@@ -27,6 +27,7 @@
 #define CLOCK_MANAGER_H
 
 #include "HSMIDI.h"
+#include "HSMIDIClock.h"
 
 namespace HS {
 
@@ -50,12 +51,14 @@ public:
         LEFT2_CLOCK2,
         RIGHT2_CLOCK1,
         RIGHT2_CLOCK2,
-        MIDI_CLOCK,
+        MIDI_CLOCK, // keeps beat bookkeeping; MIDI Clock output comes from midi_clock
         NR_OF_CLOCKS
     };
 
     uint16_t tempo; // The set tempo, for display somewhere else
     uint32_t ticks_per_beat; // Based on the selected tempo in BPM
+    uint32_t beat_remainder = 0; // Fractional part of ticks_per_beat, in 1/tempo ticks
+    uint32_t beat_frac = 0; // Accumulated beat_remainder
     bool running = 0; // Specifies whether the clock is running for interprocess communication
     bool paused = 0; // Specifies whethr the clock is paused
     bool auto_reset = 0; // on clock start
@@ -75,6 +78,9 @@ public:
 
     bool boop[8] = {0,0,0,0,0,0,0,0}; // Manual triggers
 
+    MIDIClockGenerator midi_clock{MIDI_OUT_PPQN}; // MIDI Clock runs off its own phase, not the tocks
+    bool midi_tock = 0;
+
     void (*sync_func)(); // callback function
 
     ClockManager() {
@@ -95,13 +101,15 @@ public:
     }
 
     /* Set ticks per tock, based on one million ticks per minute divided by beats per minute.
-     * This is approximate, because the arithmetical value is likely to be fractional, and we
-     * need to live with a certain amount of imprecision here. So I'm not even rounding up.
+     * The arithmetical value is likely to be fractional, so the remainder is carried from
+     * beat to beat to keep the tempo from drifting against the MIDI Clock.
      */
     void SetTempoBPM(uint16_t bpm) {
         bpm = constrain(bpm, CLOCK_TEMPO_MIN, CLOCK_TEMPO_MAX);
         ticks_per_beat = 1000000 / bpm;
+        beat_remainder = 1000000 % bpm;
         tempo = bpm;
+        midi_clock.SetTempoBPM(bpm);
     }
     
     void SetTempoFromTaps(uint32_t *taps, int count) {
@@ -113,7 +121,9 @@ public:
         // update the tempo
         uint32_t clock_diff = total / count;
         ticks_per_beat = constrain(clock_diff, CLOCK_TICKS_MIN, CLOCK_TICKS_MAX); // time since last clock is new tempo
+        beat_remainder = 0;
         tempo = 1000000 / ticks_per_beat; // imprecise, for display purposes
+        midi_clock.SetTicksPerBeat(ticks_per_beat);
     }
 
     int GetMultiply(int ch = 0) {return tocks_per_beat[ch];}
@@ -145,6 +155,18 @@ public:
         if (0 == count_skip) {
             clock_tick[0] = 0;
             clock_tick[1] = 0;
+            beat_frac = 0;
+        } else {
+            midi_clock.Beat(); // MIDI Clock follows the beat
+
+            if (beat_remainder) {
+                // every so often a beat is one tick longer
+                beat_frac += beat_remainder;
+                if (beat_frac >= tempo) {
+                    beat_frac -= tempo;
+                    ++beat_tick;
+                }
+            }
         }
         for (int ch = 0; ch < NR_OF_CLOCKS; ch++) {
             if (tocks_per_beat[ch] > 0 || 0 == count_skip) count[ch] = count_skip;
@@ -159,6 +181,7 @@ public:
         if (diff > 0) diff--;
         if (diff < 0) diff++;
         beat_tick += diff;
+        midi_clock.Nudge(diff);
     }
 
     // call this on every tick when clock is running, before all Controllers
@@ -227,7 +250,9 @@ public:
 
                 // update the tempo
                 ticks_per_beat = constrain(clock_ppqn * avg_diff, CLOCK_TICKS_MIN, CLOCK_TICKS_MAX);
+                beat_remainder = 0;
                 tempo = 1000000 / ticks_per_beat; // imprecise, for display purposes
+                midi_clock.SetTicksPerBeat(ticks_per_beat);
 
                 int ticks_per_clock = ticks_per_beat / clock_ppqn; // rounded down
 
@@ -258,17 +283,31 @@ public:
 
     void Start(bool p = 0) {
         Reset();
+        midi_clock.Start();
         running = 1;
         paused = p;
         auto_reset = !p;
         if (!p && midi_out_enabled) {
-            usbMIDI.sendRealTime(usbMIDI.Start);
-#if defined(__IMXRT1062__)
-            usbHostMIDI.sendRealTime(usbMIDI.Start);
-#ifdef ARDUINO_TEENSY41
-            MIDI1.sendRealTime(midi::MidiType(usbMIDI.Start));
-#endif
-#endif
+            SendSongPosition(0);
+            SendRealTime(usbMIDI.Start);
+        }
+    }
+
+    // Song Position Pointer, for the next Continue(); only meaningful while stopped
+    void SetSongPosition(uint16_t position) {
+        midi_clock.Start(position);
+    }
+
+    // Pick up from where Stop() left off, or from SetSongPosition()
+    void Continue() {
+        const uint16_t position = midi_clock.SongPosition();
+        Reset();
+        midi_clock.Start(position);
+        running = 1;
+        paused = 0;
+        if (midi_out_enabled) {
+            SendSongPosition(position);
+            SendRealTime(usbMIDI.Continue);
         }
     }
 
@@ -276,15 +315,34 @@ public:
         running = 0;
         paused = 0;
         extsync = false;
-        if (midi_out_enabled) {
-            usbMIDI.sendRealTime(usbMIDI.Stop);
+        if (midi_out_enabled) SendRealTime(usbMIDI.Stop);
+    }
+
+    // Call once per tick from the app Controller, before anything else sends MIDI,
+    // so Clock bytes go out at their exact tick ahead of other traffic
+    void MIDIClockOut() {
+        midi_tock = IsRunning() && midi_clock.Tick() && midi_out_enabled;
+        if (midi_tock) SendRealTime(usbMIDI.Clock);
+    }
+
+    void SendRealTime(uint8_t type) {
+        usbMIDI.sendRealTime(type);
 #if defined(__IMXRT1062__)
-            usbHostMIDI.sendRealTime(usbMIDI.Stop);
+        usbHostMIDI.sendRealTime(type);
 #ifdef ARDUINO_TEENSY41
-            MIDI1.sendRealTime(midi::MidiType(usbMIDI.Stop));
+        MIDI1.sendRealTime(midi::MidiType(type));
+#endif
+#endif
+    }
+
+    void SendSongPosition(uint16_t position) {
+        usbMIDI.sendSongPosition(position);
+#if defined(__IMXRT1062__)
+        usbHostMIDI.sendSongPosition(position);
+#ifdef ARDUINO_TEENSY41
+        MIDI1.sendSongPosition(position);
 #endif
 #endif
-        }
     }
 
     void Pause() {paused = 1;}
@@ -310,9 +368,9 @@ public:
         return tock[ch];
     }
 
-    // Returns true if MIDI Clock should be sent on this tick
+    // Returns true if MIDI Clock was sent on this tick
     bool MIDITock() {
-        return midi_out_enabled && Tock(MIDI_CLOCK);
+        return midi_tock;
     }
 
     bool EndOfBeat(int ch = 0) {
@@ -0,0 +1,106 @@
+/*
+ * DrumMap levels
+ *   the Grids map, mixed once per X/Y instead of on every clock
+ *
+ * A level is the bilinear mix of the four map nodes around (x, y).
+ * DrumMapCache keeps the levels of all 32 steps of the three parts for one
+ * (x, y), so a clock costs a table read. It's double-buffered: the main loop
+ * fills the back table in Update() and flips it to the front, and the ISR
+ * reads the front one, or mixes on the spot while the front is for some
+ * other (x, y), as when X/Y are under CV.
+ *
+ * Works with either set of Grids resources. No Arduino dependencies.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+namespace HS {
+
+static constexpr int DRUMMAP_STEPS = 32;
+static constexpr int DRUMMAP_PARTS = 3;
+
+// nodes is grids::drum_map[5][5], row by row
+inline uint8_t DrumMapLevel(const uint8_t *const *nodes, uint8_t step, uint8_t part, uint8_t x, uint8_t y) {
+    const uint8_t i = x >> 6;
+    const uint8_t j = y >> 6;
+    const uint8_t offset = (part * DRUMMAP_STEPS) + step;
+    const uint8_t a = nodes[i * 5 + j][offset];
+    const uint8_t b = nodes[(i + 1) * 5 + j][offset];
+    const uint8_t c = nodes[i * 5 + j + 1][offset];
+    const uint8_t d = nodes[(i + 1) * 5 + j + 1][offset];
+    const uint8_t quad_x = x << 2;
+    const uint8_t quad_y = y << 2;
+    // U8Mix(U8Mix(a, b, quad_x), U8Mix(c, d, quad_x), quad_y)
+    const uint8_t ab_fade = (b * quad_x + a * (255 - quad_x)) >> 8;
+    const uint8_t cd_fade = (d * quad_x + c * (255 - quad_x)) >> 8;
+    return (cd_fade * quad_y + ab_fade * (255 - quad_y)) >> 8;
+}
+
+// Whether a part with this level fires, with randomness added, at a fill.
+// An accent also needs a loud step.
+inline bool DrumMapFires(int level, uint8_t randomness, uint8_t fill, bool accent) {
+    level += randomness;
+    if (level > 255) level = 255;
+    const uint8_t threshold = ~fill;
+    return level > threshold && (!accent || level > 192);
+}
+
+class DrumMapCache {
+public:
+    explicit DrumMapCache(const uint8_t *const *nodes_) : nodes(nodes_) { }
+
+    // Asks Update() for the table at (x, y). ISR.
+    void Request(uint8_t x, uint8_t y) {
+        want_x = x;
+        want_y = y;
+    }
+
+    uint8_t Level(uint8_t step, uint8_t part, uint8_t x, uint8_t y) const {
+        if (cached(x, y)) return table[front].level[part][step];
+        return DrumMapLevel(nodes, step, part, x, y);
+    }
+
+    // Brings the table up to the last Request(). Main loop only.
+    void Update() {
+        const uint8_t x = want_x;
+        const uint8_t y = want_y;
+        if (cached(x, y)) return;
+
+        Table &b = table[front ^ 1];
+        for (uint8_t part = 0; part < DRUMMAP_PARTS; ++part) {
+            for (uint8_t step = 0; step < DRUMMAP_STEPS; ++step)
+                b.level[part][step] = DrumMapLevel(nodes, step, part, x, y);
+        }
+        b.x = x;
+        b.y = y;
+        b.valid = true;
+        std::atomic_signal_fence(std::memory_order_release);
+        front ^= 1;
+    }
+
+    // Whether Level() at (x, y) is a table read
+    bool cached(uint8_t x, uint8_t y) const {
+        const Table &t = table[front];
+        return t.valid && t.x == x && t.y == y;
+    }
+
+private:
+    struct Table {
+        uint8_t level[DRUMMAP_PARTS][DRUMMAP_STEPS];
+        uint8_t x = 0;
+        uint8_t y = 0;
+        bool valid = false;
+    };
+
+    const uint8_t *const *nodes;
+    Table table[2];
+    volatile uint8_t front = 0;
+    volatile uint8_t want_x = 0;
+    volatile uint8_t want_y = 0;
+};
+
+} // namespace HS
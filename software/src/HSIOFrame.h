@@ -10,6 +10,8 @@
 #pragma once
 
 #include "HSMIDI.h"
+#include "HSVoiceAllocator.h"
+#include "HSRandom.h"
 
 #ifdef ARDUINO_TEENSY41
 namespace OC {
@@ -23,7 +25,8 @@ namespace HS {
 
 static constexpr int GATE_THRESHOLD = 15 << 7; // 1.25 volts
 static constexpr int TRIGMAP_MAX = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST + DAC_CHANNEL_LAST;
-static constexpr int CVMAP_MAX = ADC_CHANNEL_LAST + DAC_CHANNEL_LAST;
+static constexpr int CVMAP_MAX = ADC_CHANNEL_LAST + DAC_CHANNEL_LAST * 2; // with busses, see HSRouting.h
+static constexpr int MIDI_RX_MAX = 8; // channel messages kept per tick
 
 typedef struct MIDILogEntry {
     int message;
@@ -31,6 +34,12 @@ typedef struct MIDILogEntry {
     int data2;
 } MIDILogEntry;
 
+typedef struct MIDIMessage {
+    uint8_t status; // with the channel
+    uint8_t data1;
+    uint8_t data2;
+} MIDIMessage;
+
 // shared IO Frame, updated every tick
 // this will allow chaining applets together, multiple stages of processing
 typedef struct IOFrame {
@@ -44,6 +53,8 @@ typedef struct IOFrame {
     int clock_countdown[DAC_CHANNEL_LAST];
     uint8_t clockskip[DAC_CHANNEL_LAST] = {0};
     bool clockout_q[DAC_CHANNEL_LAST]; // for loopback
+    int bus[DAC_CHANNEL_LAST]; // outputs as of the end of the last tick, for chaining applets
+    bool bus_changed[DAC_CHANNEL_LAST];
     int adc_lag_countdown[ADC_CHANNEL_LAST]; // Time between a clock event and an ADC read event
     uint32_t last_clock[ADC_CHANNEL_LAST]; // Tick number of the last clock observed by the child class
     uint32_t cycle_ticks[ADC_CHANNEL_LAST]; // Number of ticks between last two clocks
@@ -58,7 +69,7 @@ typedef struct IOFrame {
         uint16_t semitone_mask[ADC_CHANNEL_LAST]; // which notes are currently on
 
         // MIDI input stuff handled by MIDIIn applet
-        int8_t notes_on[16]; // attempts to track how many notes are on, per MIDI channel
+        VoiceAllocator voices[16]; // note stack and voice assignment, per MIDI channel
         int outputs[DAC_CHANNEL_LAST]; // translated CV values
         bool trigout_q[DAC_CHANNEL_LAST];
 
@@ -66,7 +77,9 @@ typedef struct IOFrame {
         bool clock_run = 0;
         bool clock_q;
         bool start_q;
+        bool continue_q;
         bool stop_q;
+        int song_position = -1; // Song Position Pointer for continue_q, if one came
         uint8_t clock_count; // MIDI clock counter (24ppqn)
         int last_msg_tick; // Tick of last received message
 
@@ -110,6 +123,24 @@ typedef struct IOFrame {
         MIDILogEntry log[7];
         int log_index;
 
+        // Channel messages received on tick rx_tick, for recording
+        MIDIMessage rx[MIDI_RX_MAX];
+        int rx_count = 0;
+        uint32_t rx_tick = 0;
+
+        void Receive(const int midi_chan, const int message, const int data1, const int data2) {
+            if (rx_tick != OC::CORE::ticks) {
+                rx_tick = OC::CORE::ticks;
+                rx_count = 0;
+            }
+            if (rx_count < MIDI_RX_MAX)
+                rx[rx_count++] = {uint8_t(message | ((midi_chan - 1) & 0x0f)), uint8_t(data1), uint8_t(data2)};
+        }
+        // @return how many messages came in on this tick, in rx
+        int Received() const {
+            return (rx_tick == OC::CORE::ticks) ? rx_count : 0;
+        }
+
         void UpdateLog(int message, int data1, int data2) {
             log[log_index++] = {message, data1, data2};
             if (log_index == 7) {
@@ -122,6 +153,9 @@ typedef struct IOFrame {
             last_msg_tick = OC::CORE::ticks;
         }
         void ProcessMIDIMsg(const int midi_chan, const int message, const int data1, const int data2) {
+            if (message >= usbMIDI.NoteOff && message <= usbMIDI.PitchBend)
+                Receive(midi_chan, message, data1, data2);
+
             switch (message) {
             case usbMIDI.Clock:
                 if (++clock_count == 1) {
@@ -137,9 +171,19 @@ typedef struct IOFrame {
                 return;
                 break;
 
-            case usbMIDI.Continue: // treat Continue like Start
+            case usbMIDI.SongPosition:
+                song_position = data1 | (data2 << 7);
+                return;
+                break;
+
+            case usbMIDI.Continue:
             case usbMIDI.Start:
-                start_q = 1;
+                if (message == usbMIDI.Continue) {
+                    continue_q = 1;
+                } else {
+                    start_q = 1;
+                    song_position = -1;
+                }
                 clock_count = 0;
                 clock_run = true;
                 for(int ch = 0; ch < ADC_CHANNEL_LAST; ++ch)
@@ -158,15 +202,17 @@ typedef struct IOFrame {
                 stop_q = 1;
                 clock_run = false;
                 // a way to reset stuck notes
-                for (int i = 0; i < 16; ++i) notes_on[i] = 0;
+                for (int i = 0; i < 16; ++i) voices[i].AllNotesOff();
+                for (int ch = 0; ch < ADC_CHANNEL_LAST; ++ch) {
+                    if (function[ch] == HEM_MIDI_GATE_OUT) outputs[ch] = 0;
+                }
                 return;
                 break;
 
             case usbMIDI.NoteOn:
-                ++notes_on[midi_chan - 1];
-                break;
             case usbMIDI.NoteOff:
-                --notes_on[midi_chan - 1];
+                ProcessNote(midi_chan - 1, message, data1, data2);
+                return;
                 break;
 
             }
@@ -181,45 +227,12 @@ typedef struct IOFrame {
                 bool log_this = false;
 
                 switch (message) {
-                case usbMIDI.NoteOn:
-                    semitone_mask[ch] = semitone_mask[ch] | (1u << (data1 % 12));
-
-                    // Should this message go out on this channel?
-                    if (function[ch] == HEM_MIDI_NOTE_OUT)
-                        outputs[ch] = MIDIQuantizer::CV(data1);
-
-                    if (function[ch] == HEM_MIDI_TRIG_OUT)
-                        trigout_q[ch] = 1;
-
-                    if (function[ch] == HEM_MIDI_GATE_OUT)
-                        outputs[ch] = PULSE_VOLTAGE * (12 << 7);
-
-                    if (function[ch] == HEM_MIDI_VEL_OUT)
-                        outputs[ch] = Proportion(data2, 127, HEMISPHERE_MAX_CV);
-
-                    log_this = 1; // Log all MIDI notes. Other stuff is conditional.
-                    break;
-
-                case usbMIDI.NoteOff:
-                    semitone_mask[ch] = semitone_mask[ch] & ~(1u << (data1 % 12));
-
-                    // turn gate off only when all notes are off
-                    if (notes_on[midi_chan - 1] <= 0)
-                    {
-                        notes_on[midi_chan - 1] = 0; // just in case it becomes negative...
-                        if (function[ch] == HEM_MIDI_GATE_OUT) {
-                            outputs[ch] = 0;
-                            log_this = 1;
-                        }
-                    }
-                    break;
-
                 case usbMIDI.ControlChange: // Modulation wheel or other CC
                     if (function[ch] == HEM_MIDI_CC_OUT) {
                         if (function_cc[ch] < 0) function_cc[ch] = data1;
 
                         if (function_cc[ch] == data1) {
-                            outputs[ch] = Proportion(data2, 127, HEMISPHERE_MAX_CV);
+                            outputs[ch] = Proportion<127>(data2, HEMISPHERE_MAX_CV);
                             log_this = 1;
                         }
                     }
@@ -228,7 +241,7 @@ typedef struct IOFrame {
                 // TODO: consider adding support for AfterTouchPoly
                 case usbMIDI.AfterTouchChannel:
                     if (function[ch] == HEM_MIDI_AT_OUT) {
-                        outputs[ch] = Proportion(data1, 127, HEMISPHERE_MAX_CV);
+                        outputs[ch] = Proportion<127>(data1, HEMISPHERE_MAX_CV);
                         log_this = 1;
                     }
                     break;
@@ -236,7 +249,7 @@ typedef struct IOFrame {
                 case usbMIDI.PitchBend:
                     if (function[ch] == HEM_MIDI_PB_OUT) {
                         int data = (data2 << 7) + data1 - 8192;
-                        outputs[ch] = Proportion(data, 8192, HEMISPHERE_3V_CV);
+                        outputs[ch] = Proportion<8192>(data, HEMISPHERE_3V_CV);
                         log_this = 1;
                     }
                     break;
@@ -246,6 +259,75 @@ typedef struct IOFrame {
                 if (log_this) UpdateLog(message, data1, data2);
             }
         }
+
+        // Each Note, Trig, Gate and Velocity output listening to a MIDI channel belongs
+        // to one voice of that channel, numbered in output order per function. A single
+        // Note/Gate pair plays mono. Two pairs on the same channel play the same note in
+        // Unison, the default, and two voices in the other modes (see SetVoiceMode()).
+        void ProcessNote(const int midi_ch, const int message, const int note, const int velocity) {
+            VoiceAllocator &alloc = voices[midi_ch];
+            const bool note_on = (message == usbMIDI.NoteOn && velocity > 0);
+
+            uint8_t voice_of[ADC_CHANNEL_LAST];
+            uint8_t count[HEM_MIDI_MAX_FUNCTION + 1] = {0};
+            int voice_count = 1;
+            for (int ch = 0; ch < ADC_CHANNEL_LAST; ++ch) {
+                if (channel[ch] != midi_ch) continue;
+                const int fn = function[ch];
+                voice_of[ch] = count[fn]++;
+                if (fn >= HEM_MIDI_NOTE_OUT && fn <= HEM_MIDI_VEL_OUT && count[fn] > voice_count)
+                    voice_count = count[fn];
+            }
+            alloc.set_voice_count(voice_count);
+
+            if (note_on) alloc.NoteOn(note, velocity);
+            else alloc.NoteOff(note);
+
+            const uint8_t changed = alloc.changed_voices();
+            const uint8_t triggered = alloc.triggered_voices();
+
+            for(int ch = 0; ch < ADC_CHANNEL_LAST; ++ch)
+            {
+                if (function[ch] == HEM_MIDI_NOOP) continue;
+                if (channel[ch] != midi_ch) continue;
+
+                if (note_on)
+                    semitone_mask[ch] = semitone_mask[ch] | (1u << (note % 12));
+                else
+                    semitone_mask[ch] = semitone_mask[ch] & ~(1u << (note % 12));
+
+                const uint8_t bit = 1u << voice_of[ch];
+                const VoiceAllocator::Voice &voice = alloc.voice(voice_of[ch]);
+                bool log_this = note_on; // Log all MIDI notes. Other stuff is conditional.
+
+                switch (function[ch]) {
+                case HEM_MIDI_NOTE_OUT:
+                    if (changed & bit) outputs[ch] = MIDIQuantizer::CV(voice.note);
+                    break;
+
+                case HEM_MIDI_TRIG_OUT:
+                    if (triggered & bit) trigout_q[ch] = 1;
+                    break;
+
+                case HEM_MIDI_GATE_OUT:
+                    if (changed & bit) {
+                        outputs[ch] = voice.gate ? PULSE_VOLTAGE * (12 << 7) : 0;
+                        if (!voice.gate) log_this = 1;
+                    }
+                    break;
+
+                case HEM_MIDI_VEL_OUT:
+                    if (triggered & bit) outputs[ch] = Proportion<127>(voice.velocity, HEMISPHERE_MAX_CV);
+                    break;
+                }
+
+                if (log_this) UpdateLog(message, note, velocity);
+            }
+        }
+        void SetVoiceMode(const int midi_ch, VoiceAllocMode mode) {
+            voices[midi_ch].set_mode(mode);
+        }
+
         void Send(const int *outvals) {
 
           // first pass - calculate things and turn off notes
@@ -344,6 +426,16 @@ typedef struct IOFrame {
 #ifdef ARDUINO_TEENSY41
           usbHostMIDI.sendNoteOn(note, vel, midi_ch + 1);
           MIDI1.sendNoteOn(note, vel, midi_ch + 1);
+#endif
+        }
+        // Sends a channel message as it was received
+        void SendMessage(const MIDIMessage &msg) {
+          const uint8_t type = msg.status & 0xf0;
+          const uint8_t midi_ch = (msg.status & 0x0f) + 1;
+          usbMIDI.send(type, msg.data1, msg.data2, midi_ch, 0);
+#ifdef ARDUINO_TEENSY41
+          usbHostMIDI.send(type, msg.data1, msg.data2, midi_ch, 0);
+          MIDI1.send((midi::MidiType)type, msg.data1, msg.data2, midi_ch);
 #endif
         }
         void SendNoteOff(const int midi_ch, int note = -1, uint8_t vel = 0) {
@@ -368,7 +460,7 @@ typedef struct IOFrame {
     }
     void ClockOut(DAC_CHANNEL ch, const int pulselength = HEMISPHERE_CLOCK_TICKS * HS::trig_length) {
       // short circuit if skip probability is zero to avoid consuming random numbers
-      if (0 == clockskip[ch] || random(100) >= clockskip[ch]) {
+      if (0 == clockskip[ch] || HS::random_streams[HS::RANDOM_STREAM_CLOCK_SKIP].Below(100) >= clockskip[ch]) {
         clock_countdown[ch] = pulselength;
         outputs[ch] = PULSE_VOLTAGE * (12 << 7);
         clockout_q[ch] = true;
@@ -381,6 +473,12 @@ typedef struct IOFrame {
     // TODO: Hardware IO should be extracted
     // --- Hard IO ---
     void Load() {
+        // latch the busses before anything writes this tick's outputs
+        for (int i = 0; i < DAC_CHANNEL_LAST; ++i) {
+            bus_changed[i] = (bus[i] != outputs[i]);
+            bus[i] = outputs[i];
+        }
+
         clocked[0] = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
         clocked[1] = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_2>();
         clocked[2] = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_3>();
@@ -31,22 +31,33 @@ class LorenzGeneratorManager {
     uint32_t freq[2]; // Frequency per hemisphere
     bool reset[2]; // Reset per hemisphere
     uint32_t last_process_tick;
+    uint32_t last_active_tick[2]; // When each hemisphere last asked for output
     streams::LorenzGenerator lorenz;
 
     LorenzGeneratorManager() {
+        Init();
+    }
+
+public:
+    static LorenzGeneratorManager *get() {
+        if (!instance) instance = new LorenzGeneratorManager;
+        return instance;
+    }
+
+    // Both generators back at their starting point
+    void Init() {
         lorenz.Init(0);
         lorenz.Init(1);
+        lorenz.set_integrator(streams::LORENZ_INTEGRATOR_SEMI_IMPLICIT);
         lorenz.set_out_a(streams::LORENZ_OUTPUT_X1);
         lorenz.set_out_b(streams::LORENZ_OUTPUT_Y1);
         lorenz.set_out_c(streams::LORENZ_OUTPUT_X2);
         lorenz.set_out_d(streams::LORENZ_OUTPUT_Y2);
         last_process_tick = 0;
-    }
-
-public:
-    static LorenzGeneratorManager *get() {
-        if (!instance) instance = new LorenzGeneratorManager;
-        return instance;
+        last_active_tick[0] = 0;
+        last_active_tick[1] = 0;
+        reset[0] = 0;
+        reset[1] = 0;
     }
 
     int GetOut(int out) {
@@ -60,6 +71,7 @@ public:
 
     void SetFreq(bool hemisphere, uint32_t freq_) {
         freq[hemisphere] = freq_;
+        last_active_tick[hemisphere] = OC::CORE::ticks;
     }
 
     void Reset(bool hemisphere) {
@@ -69,6 +81,11 @@ public:
     void Process() {
         if (OC::CORE::ticks - last_process_tick >= LORENZ_PROCESS_TICKS) {
             last_process_tick = OC::CORE::ticks;
+
+            // A generator is only integrated while its hemisphere is running
+            // LowerRenz and not frozen
+            for (int h = 0; h < 2; h++)
+                lorenz.set_generator_enabled(h, OC::CORE::ticks - last_active_tick[h] <= LORENZ_PROCESS_TICKS);
             lorenz.Process(freq[0], freq[1], reset[0], reset[1], 2, 2);
             reset[0] = 0;
             reset[1] = 0;
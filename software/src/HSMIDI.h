@@ -22,6 +22,7 @@
 // This file contains MIDI utilities for Hemisphere Suite, including:
 // * System Exclusive Handler base class
 // * Data packing structure
+// * Streaming block transfer for longer app state (see HSSysEx.h)
 // * Teensyduino USB MIDI message number table
 // * MIDI note number-name and MIDI channel tables
 // * MIDI note/CV quantizer functions
@@ -42,6 +43,8 @@ extern MIDIDevice usbHostMIDI;
 extern midi::MidiInterface<midi::SerialMIDI<HardwareSerial> > MIDI1;
 #endif
 
+#include "HSSysEx.h"
+
 #define HEM_MIDI_NOTE_ON usbMIDI.NoteOn
 #define HEM_MIDI_NOTE_OFF usbMIDI.NoteOff
 #define HEM_MIDI_CC usbMIDI.ControlChange
@@ -232,6 +235,10 @@ typedef struct _SysExData {
  * byte. This leaves 55 bytes for application data. However, these
  * are 7-bit MIDI data bytes. Once the bytes are packed, each app
  * may transmit up to 48 bytes, or up to 24 16-bit words.
+ *
+ * Apps with more state than that can send it as a single blob with
+ * SendSysExBlob(), which splits it into a block of messages that each
+ * fit the same buffer, and reassemble it with ReceiveSysExBlob().
  */
 class SystemExclusiveHandler {
 public:
@@ -318,6 +325,28 @@ protected:
         return verify;
     }
 
+    /* Sends length bytes of app state as one block. The blob is packed a message at a time
+     * straight from data, so it can be as large as the app's state. Each message is flushed
+     * as it goes, as SendSysEx() does, so a receiver reading one per tick keeps up.
+     */
+    void SendSysExBlob(const uint8_t *data, uint32_t length, char target_id) {
+        SysExBlockWriter writer(data, length, target_id);
+        uint8_t msg[SYSEX_BLOCK_MSG_MAX];
+        uint32_t size;
+        while ((size = writer.Next(msg))) {
+            usbMIDI.sendSysEx(size, msg, true);
+            usbMIDI.send_now();
+        }
+    }
+
+    /* Call for each SysEx message received while reader is collecting a block. The data
+     * lands in the buffer given to reader.Begin(); SYSEX_BLOCK_COMPLETE means it's all
+     * there and intact.
+     */
+    SysExBlockStatus ReceiveSysExBlob(SysExBlockReader &reader) {
+        return reader.Feed(usbMIDI.getSysExArray(), usbMIDI.getSysExArrayLength());
+    }
+
     char LastSysExApplicationCode() {return last_app_code;}
 
 private:
@@ -0,0 +1,120 @@
+// MIDI Clock generator for the ClockManager.
+//
+// The pulse rate is kept as an exact fraction, pulses per tick = step / period,
+// so 24 PPQN at any BPM lands every pulse on the tick at or just before its
+// ideal time with no accumulated drift. With a tempo in BPM that's
+// (24 * bpm) / 1000000, since there are a million ticks per minute.
+//
+// The ClockManager calls Beat() as each of its beats starts, which puts the
+// generator back on the beat after tempo changes and external sync, and keeps
+// it to 24 pulses per beat.
+
+#pragma once
+
+#ifndef HS_MIDI_CLOCK_H
+#define HS_MIDI_CLOCK_H
+
+#include <stdint.h>
+
+namespace HS {
+
+static constexpr uint32_t MIDI_CLOCK_TICKS_PER_MINUTE = 1000000;
+static constexpr int MIDI_CLOCKS_PER_SPP_BEAT = 6; // Song Position counts 16th notes
+static constexpr uint16_t MIDI_SPP_MAX = 16383;
+
+class MIDIClockGenerator {
+public:
+    MIDIClockGenerator(uint32_t ppqn = 24) : ppqn(ppqn), step(0), period(0), phase(0), pulses(0), beat_pulses(0), hold(0) {
+        SetTempoBPM(120);
+        Start();
+    }
+
+    void SetTempoBPM(uint16_t bpm) {
+        SetRate(ppqn * bpm, MIDI_CLOCK_TICKS_PER_MINUTE);
+    }
+
+    // For tempos that only exist as a measured beat length (tap tempo, external sync)
+    void SetTicksPerBeat(uint32_t ticks_per_beat) {
+        if (ticks_per_beat) SetRate(ppqn, ticks_per_beat);
+    }
+
+    // The next Tick() sends a pulse. position is in MIDI beats (16th notes), as in
+    // Song Position Pointer.
+    void Start(uint16_t position = 0) {
+        phase = 0;
+        pulses = static_cast<uint32_t>(position) * MIDI_CLOCKS_PER_SPP_BEAT;
+        beat_pulses = 0;
+        hold = 0;
+    }
+
+    // Call once per tick while the clock runs; true when a MIDI Clock is due
+    bool Tick() {
+        // a pulse is due if a multiple of period falls within [phase, phase + step)
+        bool due = (phase == 0 || phase > period - step);
+        phase += step;
+        if (phase >= period) phase -= period;
+        if (due && hold) {
+            --hold; // already sent ahead of the beat
+            due = false;
+        }
+        if (due) {
+            ++pulses;
+            ++beat_pulses;
+        }
+        return due;
+    }
+
+    // Call after Tick() on the tick a beat starts. A beat pulse sent on this tick
+    // or the one before is on time. One sent earlier restarts the pulse spacing
+    // from here, and any more of this beat's pulses that went out early are held
+    // back. A late one goes on the next Tick(), and pulses that didn't fit into
+    // the last beat are dropped.
+    void Beat() {
+        if (beat_pulses > ppqn) {
+            if (phase == 0 || phase > 2 * step) phase = step;
+            beat_pulses -= ppqn;
+            hold = beat_pulses - 1;
+        } else {
+            if (phase != 0 && phase <= period - step) phase = 0;
+            beat_pulses = 0;
+            hold = 0;
+        }
+    }
+
+    // Shift the phase to follow a beat that moved by diff ticks (positive = later)
+    void Nudge(int diff) {
+        int64_t p = static_cast<int64_t>(phase) - static_cast<int64_t>(diff) * step;
+        p %= static_cast<int64_t>(period);
+        if (p < 0) p += period;
+        phase = static_cast<uint32_t>(p);
+    }
+
+    // Song position of the next pulse, rounded up to a whole MIDI beat
+    uint16_t SongPosition() const {
+        uint32_t pos = (pulses + MIDI_CLOCKS_PER_SPP_BEAT - 1) / MIDI_CLOCKS_PER_SPP_BEAT;
+        return pos > MIDI_SPP_MAX ? MIDI_SPP_MAX : pos;
+    }
+
+    uint32_t Pulses() const { return pulses; }
+
+private:
+    uint32_t ppqn;
+    uint32_t step; // numerator of pulses per tick
+    uint32_t period; // denominator of pulses per tick
+    uint32_t phase; // 0 <= phase < period
+    uint32_t pulses; // since Start
+    uint32_t beat_pulses; // since the last Beat()
+    uint32_t hold; // pulses of this beat that went out before it
+
+    void SetRate(uint32_t step_, uint32_t period_) {
+        if (step_ == 0 || step_ >= period_) return;
+        // keep the same fraction of a pulse when the tempo changes mid-pulse
+        if (period) phase = static_cast<uint32_t>(static_cast<uint64_t>(phase) * period_ / period);
+        step = step_;
+        period = period_;
+    }
+};
+
+} // namespace HS
+
+#endif // HS_MIDI_CLOCK_H
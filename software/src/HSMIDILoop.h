@@ -0,0 +1,292 @@
+/*
+ * MIDI loop
+ *   compact recordings of MIDI channel messages, in layers, and playback
+ *
+ * Events are timed in pulses from the start of the loop, MIDILOOP_PPQN to the
+ * beat. Each is stored as in a Standard MIDI File track: the pulses since the
+ * event before as a varint, the status byte, left out when it's the same as
+ * the last one (running status), then the data bytes. A note in a busy
+ * passage costs 3 bytes.
+ *
+ * A recording is a stack of layers in one fixed buffer: the first pass, then
+ * one per pass of overdub. Undo drops the top layer. The player merges the
+ * layers back into one stream, and can move each note-on to the nearest step
+ * of a grid, and its note-off by as much, so notes keep their length.
+ *
+ * Recording an event and playing a tick do a bounded amount of work, for the
+ * ISR. No Arduino dependencies.
+ *
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace HS {
+
+static constexpr uint32_t MIDILOOP_PPQN = 960;
+
+struct MIDIEvent {
+    uint32_t time = 0; // pulses
+    uint8_t status = 0; // channel message, with the channel
+    uint8_t data1 = 0;
+    uint8_t data2 = 0;
+};
+
+// Data bytes after a channel message status
+inline int MIDIDataLength(const uint8_t status) {
+    const uint8_t type = status & 0xf0;
+    return (type == 0xc0 || type == 0xd0) ? 1 : 2;
+}
+
+class MIDILoop {
+public:
+    static constexpr int MAX_LAYERS = 16;
+    static constexpr size_t MAX_EVENT_BYTES = 4 + 3; // varint, status, data
+    static constexpr uint32_t MAX_DELTA = (1u << 28) - 1; // largest 4-byte varint
+
+    void Init(uint8_t *memory, size_t capacity) {
+        data = memory;
+        cap = memory ? capacity : 0;
+        Clear();
+    }
+
+    void Clear() {
+        layer_count = 0;
+        open = false;
+        used = 0;
+        loop_length = 0;
+    }
+
+    // Pulses in one pass of the loop
+    uint32_t length() const { return loop_length; }
+    void set_length(uint32_t pulses) { loop_length = pulses; }
+
+    // Opens a new layer on top
+    // @return false if there are too many
+    bool BeginLayer() {
+        if (open || layer_count == MAX_LAYERS) return false;
+        start[layer_count++] = used;
+        last_time = 0;
+        last_status = 0;
+        open = true;
+        return true;
+    }
+
+    // Appends an event to the open layer. One timed before the event ahead of
+    // it is moved up to the same time.
+    // @return false if it doesn't fit, or isn't a channel message
+    bool Record(uint32_t time, uint8_t status, uint8_t data1, uint8_t data2) {
+        if (time < last_time) time = last_time;
+        if (!open || time - last_time > MAX_DELTA) return false;
+        if (status < 0x80 || status >= 0xf0) return false;
+        if (used + MAX_EVENT_BYTES > cap) return false;
+
+        uint8_t *p = data + used;
+        uint32_t delta = time - last_time;
+        uint8_t groups[4];
+        int n = 0;
+        do {
+            groups[n++] = delta & 0x7f;
+            delta >>= 7;
+        } while (delta);
+        while (n > 1) *p++ = groups[--n] | 0x80;
+        *p++ = groups[0];
+
+        if (status != last_status) *p++ = status;
+        *p++ = data1 & 0x7f;
+        if (MIDIDataLength(status) == 2) *p++ = data2 & 0x7f;
+
+        used = p - data;
+        last_time = time;
+        last_status = status;
+        return true;
+    }
+
+    // Closes the open layer. An empty one is dropped.
+    void EndLayer() {
+        if (!open) return;
+        open = false;
+        if (start[layer_count - 1] == used) --layer_count;
+    }
+
+    // Drops the top layer, open or closed
+    // @return false if there wasn't one
+    bool Undo() {
+        if (!layer_count) return false;
+        used = start[--layer_count];
+        open = false;
+        return true;
+    }
+
+    int layers() const { return layer_count; }
+    int closed_layers() const { return open ? layer_count - 1 : layer_count; }
+    bool recording() const { return open; }
+    size_t size() const { return used; }
+    size_t capacity() const { return cap; }
+
+    // Bytes of layer i
+    size_t layer_start(int i) const { return start[i]; }
+    size_t layer_end(int i) const { return (i + 1 < layer_count) ? start[i + 1] : used; }
+
+    // Decodes the event at pos. e holds the event before it in the layer, or
+    // a default MIDIEvent for the first.
+    // @return position of the next event
+    size_t Decode(size_t pos, MIDIEvent &e) const {
+        uint32_t delta = 0;
+        uint8_t b;
+        do {
+            b = data[pos++];
+            delta = (delta << 7) | (b & 0x7f);
+        } while (b & 0x80);
+        e.time += delta;
+        if (data[pos] & 0x80) e.status = data[pos++];
+        e.data1 = data[pos++];
+        e.data2 = (MIDIDataLength(e.status) == 2) ? data[pos++] : 0;
+        return pos;
+    }
+
+private:
+    uint8_t *data = nullptr;
+    size_t cap = 0;
+    size_t used = 0;
+    size_t start[MAX_LAYERS];
+    int layer_count = 0;
+    bool open = false;
+    uint32_t last_time = 0;
+    uint8_t last_status = 0;
+    uint32_t loop_length = 0;
+};
+
+class MIDILoopPlayer {
+public:
+    static constexpr int MAX_PENDING = 32; // events read ahead, waiting for their time
+    static constexpr int MAX_READS = 16;   // events read from the loop per call
+
+    // Plays the closed layers from the pass that starts at pulse base, a
+    // multiple of the loop length
+    void Start(const MIDILoop &l, uint32_t base) {
+        loop = &l;
+        cursor_count = 0;
+        pending_count = 0;
+        head = 0;
+        for (int i = 0; i < l.closed_layers(); ++i) AddLayer(base);
+    }
+
+    // Starts playing the next closed layer from the pass at base
+    void AddLayer(uint32_t base) {
+        if (!loop || cursor_count >= loop->closed_layers()) return;
+        Cursor &c = cursor[cursor_count];
+        c.pos = loop->layer_start(cursor_count);
+        c.base = base;
+        c.next = MIDIEvent();
+        c.pos = loop->Decode(c.pos, c.next);
+        ++cursor_count;
+    }
+
+    // Forgets layers that have been undone, and their queued events
+    void Drop() {
+        if (!loop) return;
+        if (cursor_count > loop->closed_layers()) cursor_count = loop->closed_layers();
+        int n = 0;
+        for (int i = 0; i < pending_count; ++i)
+            if (At(i).layer < cursor_count) At(n++) = At(i);
+        pending_count = n;
+    }
+
+    // Grid in pulses to move note-ons to, 0 for none
+    void set_quantize(uint32_t pulses) { grid = pulses; }
+
+    // Writes the events due by pulse now, in order, to out
+    // @return how many
+    int Advance(uint32_t now, MIDIEvent *out, int max_out) {
+        if (!loop || !loop->length()) return 0;
+
+        // read ahead by half a step, for note-ons that move earlier
+        const uint32_t horizon = now + grid / 2;
+        int reads = 0;
+        for (int i = 0; i < cursor_count; ++i) {
+            Cursor &c = cursor[i];
+            while (reads < MAX_READS && pending_count < MAX_PENDING
+                   && Due(c.base + c.next.time, horizon)) {
+                Schedule(c, i);
+                Fetch(c, i);
+                ++reads;
+            }
+        }
+
+        int n = 0;
+        while (n < max_out && pending_count && Due(At(0).e.time, now)) {
+            out[n++] = At(0).e;
+            head = (head + 1) % MAX_PENDING;
+            --pending_count;
+        }
+        return n;
+    }
+
+    int layers() const { return cursor_count; }
+
+private:
+    struct Cursor {
+        size_t pos;      // after next
+        uint32_t base;   // pulse the current pass started on
+        MIDIEvent next;  // time from base
+    };
+    struct Pending {
+        MIDIEvent e;     // absolute time
+        uint8_t layer;
+    };
+
+    // i-th queued event, in playing order
+    Pending &At(int i) { return pending[(head + i) % MAX_PENDING]; }
+
+    static bool Due(uint32_t time, uint32_t now) {
+        return static_cast<int32_t>(time - now) <= 0;
+    }
+
+    // Queues c.next at its playing time, after anything due at the same time
+    void Schedule(const Cursor &c, int layer) {
+        Pending p;
+        p.e = c.next;
+        p.e.time = c.base + c.next.time;
+        p.layer = layer;
+
+        if (grid) {
+            const uint8_t type = p.e.status & 0xf0;
+            const uint8_t note = p.e.data1 & 0x7f;
+            if (type == 0x90 && p.e.data2) {
+                const uint32_t q = c.base + (c.next.time + grid / 2) / grid * grid;
+                shift[note] = static_cast<int16_t>(q - p.e.time);
+                p.e.time = q;
+            } else if (type == 0x80 || type == 0x90) {
+                p.e.time += shift[note];
+            }
+        }
+
+        int i = pending_count++;
+        for (; i > 0 && !Due(At(i - 1).e.time, p.e.time); --i) At(i) = At(i - 1);
+        At(i) = p;
+    }
+
+    // Reads the event after c.next, from the next pass at the end of the layer
+    void Fetch(Cursor &c, int layer) {
+        if (c.pos >= loop->layer_end(layer)) {
+            c.base += loop->length();
+            c.pos = loop->layer_start(layer);
+            c.next = MIDIEvent();
+        }
+        c.pos = loop->Decode(c.pos, c.next);
+    }
+
+    const MIDILoop *loop = nullptr;
+    Cursor cursor[MIDILoop::MAX_LAYERS];
+    int cursor_count = 0;
+    Pending pending[MAX_PENDING]; // ring, sorted by time from head
+    int head = 0;
+    int pending_count = 0;
+    uint32_t grid = 0;
+    int16_t shift[128] = {0}; // of the last note-on, per note number
+};
+
+} // namespace HS
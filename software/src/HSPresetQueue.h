@@ -0,0 +1,70 @@
+/*
+ * PresetQueue
+ *   switches presets on the beat without loading them in the ISR
+ *
+ * Request() queues a preset from anywhere; Program Change is read in the
+ * ISR. The main loop's Poll() unpacks it into a staged copy, and the ISR
+ * commits that with Commit() from the ClockManager's beat sync, before the
+ * applets run on the beat's tick, however late the main loop got to it. With
+ * the clock stopped there's no beat to wait for, and the ISR commits it on
+ * its next tick.
+ *
+ * The app provides the staged type and what staging and committing mean.
+ * No Arduino dependencies beyond __disable_irq()/__enable_irq().
+ *
+ */
+
+#pragma once
+
+namespace HS {
+
+template <class Staged>
+class PresetQueue {
+public:
+    // Any context; a newer request replaces one that hasn't been staged yet
+    void Request(int id) {
+        queued = id;
+    }
+
+    bool pending() const {
+        return ready || queued >= 0;
+    }
+
+    // Main loop. Stages a queued preset with stage(Staged&, id), once the
+    // last one has been committed.
+    // @return true when it staged one, which now waits for Commit()
+    template <class Stage>
+    bool Poll(Stage stage) {
+        if (ready) return false;
+
+        __disable_irq();
+        const int id = queued;
+        queued = -1;
+        __enable_irq();
+        if (id < 0) return false;
+
+        stage(staged, id);
+        __disable_irq(); // and the staged copy is all written before the ISR sees it
+        ready = true;
+        __enable_irq();
+        return true;
+    }
+
+    // ISR, at the beat sync or on a tick with the clock stopped. Commits the
+    // staged preset with commit(const Staged&).
+    // @return true if there was one
+    template <class Apply>
+    bool Commit(Apply commit) {
+        if (!ready) return false;
+        commit(staged);
+        ready = false;
+        return true;
+    }
+
+private:
+    Staged staged;
+    volatile int queued = -1; // waiting to be staged by the main loop
+    volatile bool ready = false; // staged, waiting for the ISR to commit it
+};
+
+} // namespace HS
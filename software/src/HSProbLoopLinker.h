@@ -45,6 +45,11 @@ public:
         return instance;
     }
 
+    // Unlinked and not looping, as it starts
+    void Reset() {
+        *this = ProbLoopLinker();
+    }
+
     void RegisterDiv(HEM_SIDE hemisphere) {
       registered[0] = OC::CORE::ticks;
     }
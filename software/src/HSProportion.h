@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+
+// Simulated fixed floats by multiplying and dividing by powers of 2
+#ifndef int2simfloat
+#define int2simfloat(x) (x << 14)
+#define simfloat2int(x) (x >> 14)
+typedef int32_t simfloat;
+#endif
+
+namespace HS {
+
+/* Division by a fixed denominator as a multiply and a shift.
+ *
+ * divide(x) is exactly x / d for 0 <= x < 2^31: the multiplier is the
+ * reciprocal of d rounded up, with enough bits that the rounding error never
+ * reaches the next integer. It's one 32x32->64 multiply, where the hardware
+ * divide takes up to 12 cycles and can't be pipelined.
+ */
+struct Reciprocal {
+    uint32_t mul;
+    uint8_t shift;
+
+    static constexpr uint8_t CeilLog2(uint32_t d) {
+        return d <= 1 ? 0 : 1 + CeilLog2((d + 1) >> 1);
+    }
+
+    // d must be > 0
+    static constexpr Reciprocal Of(uint32_t d) {
+        return Reciprocal{
+            static_cast<uint32_t>((uint64_t(1) << (31 + CeilLog2(d))) / d + 1),
+            static_cast<uint8_t>(31 + CeilLog2(d))
+        };
+    }
+
+    constexpr uint32_t divide(uint32_t x) const {
+        return static_cast<uint32_t>((uint64_t(x) * mul) >> shift);
+    }
+};
+
+// The reciprocal of a constant, worked out at compile time
+template <uint32_t D>
+struct ReciprocalOf {
+    static constexpr uint32_t mul = Reciprocal::Of(D).mul;
+    static constexpr uint8_t shift = Reciprocal::Of(D).shift;
+
+    static constexpr uint32_t divide(uint32_t x) {
+        return static_cast<uint32_t>((uint64_t(x) * mul) >> shift);
+    }
+};
+
+// simfloat2int(proportion * max_value), with the sign of the numerator
+constexpr int ScaleProportion(const int numerator, const simfloat proportion, const int max_value) {
+    return numerator >= 0 ? simfloat2int(proportion * max_value) : -simfloat2int(proportion * max_value);
+}
+
+} // namespace HS
+
+/* Proportion method using simfloat, useful for calculating scaled values given
+ * a fractional value.
+ *
+ * Solves this:  numerator        ???
+ *              ----------- = -----------
+ *              denominator       max
+ *
+ * For example, to convert a parameter with a range of 1 to 100 into value scaled
+ * to HEMISPHERE_MAX_CV, to be sent to the DAC:
+ *
+ * Out(ch, Proportion(value, 100, HEMISPHERE_MAX_CV));
+ *
+ */
+constexpr int Proportion(const int numerator, const int denominator, const int max_value) {
+    // the Cortex-M divide gives 0 for a zero denominator; the host's traps
+    return denominator == 0 ? 0 : HS::ScaleProportion(numerator,
+        int2simfloat((int32_t)(numerator < 0 ? -numerator : numerator)) / (int32_t)denominator,
+        max_value);
+}
+
+/* Same result, for a denominator known at compile time, without a division:
+ *
+ * Out(ch, Proportion<127>(velocity, HEMISPHERE_MAX_CV));
+ */
+template <int DENOMINATOR>
+constexpr int Proportion(const int numerator, const int max_value) {
+    static_assert(DENOMINATOR > 0, "Proportion<> needs a positive denominator");
+    return HS::ScaleProportion(numerator,
+        HS::ReciprocalOf<DENOMINATOR>::divide(int2simfloat((uint32_t)(numerator < 0 ? -numerator : numerator))),
+        max_value);
+}
+
+/* Same again, for a denominator that only changes now and then, like a step
+ * count or a length. The reciprocal is worked out when it does.
+ *
+ * CachedProportion proportion;
+ * cv = proportion(step, steps, HEMISPHERE_MAX_CV);
+ */
+class CachedProportion {
+public:
+    int operator()(const int numerator, const int denominator, const int max_value) {
+        if (denominator <= 0) return Proportion(numerator, denominator, max_value);
+        if (denominator != cached) {
+            r = HS::Reciprocal::Of(denominator);
+            cached = denominator;
+        }
+        return HS::ScaleProportion(numerator,
+            r.divide(int2simfloat((uint32_t)(numerator < 0 ? -numerator : numerator))), max_value);
+    }
+
+private:
+    int cached = 1;
+    HS::Reciprocal r = HS::Reciprocal::Of(1);
+};
@@ -0,0 +1,84 @@
+/*
+ * Random
+ *   fast, seedable random number streams for applets and the ISR
+ *
+ * Each applet slot draws from its own stream, so one applet's noise doesn't
+ * shift another's pattern, and a fixed seed makes a patch repeat exactly.
+ * The generator is xorshift32 with a multiply on the output (xorshift32*):
+ * 32-bit state, three shifts and one multiply per draw, period 2^32 - 1.
+ * No Arduino dependencies.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace HS {
+
+class Random {
+public:
+    Random(uint32_t seed = 1) { Seed(seed); }
+
+    // Nearby seeds are mixed into unrelated states; 0 is allowed
+    void Seed(uint32_t seed) {
+        state = Mix(seed);
+        if (!state) state = 0x6d2b79f5;
+    }
+
+    uint32_t Next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state * 0x9e3779bbu;
+    }
+
+    // Uniform in [0, n) from the high bits; 0 if n is 0
+    uint32_t Below(uint32_t n) {
+        return (static_cast<uint64_t>(Next()) * n) >> 32;
+    }
+
+    // Uniform in [lo, hi), or lo if hi <= lo, like Arduino's random(lo, hi)
+    int32_t Range(int32_t lo, int32_t hi) {
+        return hi > lo ? lo + static_cast<int32_t>(Below(static_cast<uint32_t>(hi - lo))) : lo;
+    }
+
+    static uint32_t Mix(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x85ebca6bu;
+        x ^= x >> 13;
+        x *= 0xc2b2ae35u;
+        x ^= x >> 16;
+        return x;
+    }
+
+private:
+    uint32_t state;
+};
+
+// Applet slots use the stream with their own index; the rest are for the core
+enum RandomStreamId {
+    RANDOM_STREAM_CLOCK_SKIP = 6,
+    RANDOM_STREAM_TURING = 7,
+
+    RANDOM_STREAM_COUNT
+};
+
+class RandomStreams {
+public:
+    // Every stream gets a distinct seed derived from the one given
+    void Reseed(uint32_t seed) {
+        for (int i = 0; i < RANDOM_STREAM_COUNT; ++i)
+            streams[i].Seed(seed * RANDOM_STREAM_COUNT + i);
+    }
+
+    Random &operator[](int i) { return streams[i]; }
+
+private:
+    Random streams[RANDOM_STREAM_COUNT];
+};
+
+extern RandomStreams random_streams;
+extern uint8_t random_seed; // 0 = free-running, 1-7 = fixed seed, stored with presets
+
+} // namespace HS
@@ -0,0 +1,111 @@
+/*
+ * InputRoute
+ *   applet inputs compiled down to pointers into the IO frame
+ *
+ * The trigger and CV mappings are small numbers picking a physical input, a
+ * DAC output looped back, or a bus. Rather than decode them on every In(),
+ * Gate() and Clock(), each input gets a route whenever the mappings change,
+ * and applet I/O is a load through it.
+ *
+ * Mapping values, CV:
+ *   0                     none
+ *   1 .. ADC              CV inputs
+ *   ADC+1 .. ADC+DAC      outputs, as written so far this tick
+ *   ADC+DAC+1 .. ADC+2DAC busses, the outputs as they were at the end of the
+ *                         last tick
+ *
+ * Mapping values, trigger:
+ *   0                     none
+ *   1 .. DIG+ADC          digital inputs, then CV inputs as gates
+ *   DIG+ADC+1 .. +DAC     outputs, as gates and clocks
+ *
+ * A loopback reads whatever the output holds at the time, so it has no
+ * latency from a slot that runs earlier in the tick and one tick from a slot
+ * that runs later. A bus always lags by one tick, whatever the order, which
+ * is what chaining applets in series wants.
+ * No Arduino dependencies, so the routing can be tested on the host.
+ *
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+namespace HS {
+
+// Where unmapped inputs point
+static const int ROUTE_NO_CV = 0;
+static const bool ROUTE_NO_GATE = false;
+
+// The arrays of the IO frame a route may point into
+struct RouteSources {
+    int digital_count;
+    int adc_count;
+    int dac_count;
+
+    const int *inputs;
+    const int *outputs;
+    const int *bus;
+    const bool *gate_high;
+    const bool *clocked;
+    bool *clockout_q;
+    const bool *changed_cv;
+    const bool *bus_changed;
+};
+
+struct InputRoute {
+    const int *cv = &ROUTE_NO_CV;
+    const bool *changed = &ROUTE_NO_GATE;
+    int adc = -1;                  // CV input for SmoothedIn(), or -1
+
+    const bool *gate = &ROUTE_NO_GATE;
+    const int *gate_cv = nullptr;  // an output, compared to the threshold instead
+    const bool *clocked = &ROUTE_NO_GATE;
+    bool *clock_q = nullptr;       // an output's clock queue, consumed by Clock()
+
+    int In() const { return *cv; }
+    bool Changed() const { return *changed; }
+
+    bool Gate(const int threshold) const {
+        return gate_cv ? *gate_cv > threshold : *gate;
+    }
+
+    // Looks without consuming
+    bool PeekClock() const { return clock_q ? *clock_q : *clocked; }
+
+    bool Clock() const {
+        if (!clock_q) return *clocked;
+        const bool c = *clock_q;
+        *clock_q = false;
+        return c;
+    }
+};
+
+inline InputRoute CompileRoute(const int cvmap, const int trigmap, const RouteSources &src) {
+    InputRoute route;
+
+    int c = cvmap - 1;
+    if (c >= 0 && c < src.adc_count) {
+        route.cv = &src.inputs[c];
+        route.changed = &src.changed_cv[c];
+        route.adc = c;
+    } else if ((c -= src.adc_count) >= 0 && c < src.dac_count) {
+        route.cv = &src.outputs[c];
+    } else if ((c -= src.dac_count) >= 0 && c < src.dac_count) {
+        route.cv = &src.bus[c];
+        route.changed = &src.bus_changed[c];
+    }
+
+    int t = trigmap - 1;
+    if (t >= 0 && t < src.digital_count + src.adc_count) {
+        route.gate = &src.gate_high[t];
+        route.clocked = &src.clocked[t];
+    } else if ((t -= src.digital_count + src.adc_count) >= 0 && t < src.dac_count) {
+        route.gate_cv = &src.outputs[t];
+        route.clock_q = &src.clockout_q[t];
+    }
+
+    return route;
+}
+
+} // namespace HS
@@ -0,0 +1,221 @@
+//////////////////////////////////////////////////////////////////////////
+// Streaming SysEx packing and block transfer for Hemisphere Suite.
+//
+// The packing is the same 8-byte packet scheme as PackedData in HSMIDI.h
+// (a byte of high bits, then up to seven 7-bit bytes), but it works
+// straight from the caller's buffer into the caller's buffer, with no
+// size limit and no intermediate copies.
+//
+// A block carries an app state blob of nearly any length (up to
+// SYSEX_BLOCK_MAX_LENGTH, about 670KB) as a run of short SysEx messages,
+// so each one still fits the 60-byte receive buffer of Teensy 3.2:
+//
+//   header: F0 7D 63 <app> 00 00 <length: 3 x 7 bits> <CRC-16: 3 x 7 bits> F7
+//   data:   F0 7D 63 <app> <index: 2 x 7 bits> <packed chunk> F7
+//
+// Data messages are numbered from 1 and each carries SYSEX_BLOCK_CHUNK
+// bytes of the blob, except the last. The receiver unpacks every chunk
+// directly into place and checks the CRC once the length is reached.
+//
+// This file has no Arduino dependencies.
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef HS_SYSEX_H
+#define HS_SYSEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SYSEX_BLOCK_ID 0x63     // Beige Maze block transfer; 0x62 is the legacy single message
+#define SYSEX_BLOCK_CHUNK 42    // Blob bytes per message; packs to 48
+#define SYSEX_BLOCK_HEADER 6    // F0, manufacturer, block ID, app, 2-byte index
+#define SYSEX_BLOCK_MSG_MAX (SYSEX_BLOCK_HEADER + 48 + 1)
+#define SYSEX_BLOCK_MAX_LENGTH (16383UL * SYSEX_BLOCK_CHUNK) // limited by the 14-bit message index
+
+/* Number of bytes that n bytes pack into */
+static inline uint32_t SysExPackedSize(uint32_t n) {
+    return n + (n + 6) / 7;
+}
+
+/* Packs n bytes from src into dst, which must hold SysExPackedSize(n) bytes. Returns bytes written. */
+static inline uint32_t SysExPack(const uint8_t *src, uint32_t n, uint8_t *dst) {
+    uint8_t *out = dst;
+    while (n >= 7) {
+        uint8_t hi = 0;
+        for (int i = 0; i < 7; i++) {
+            hi |= (src[i] >> 7) << i;
+            out[i + 1] = src[i] & 0x7f;
+        }
+        out[0] = hi;
+        out += 8;
+        src += 7;
+        n -= 7;
+    }
+    if (n) {
+        uint8_t hi = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            hi |= (src[i] >> 7) << i;
+            out[i + 1] = src[i] & 0x7f;
+        }
+        out[0] = hi;
+        out += n + 1;
+    }
+    return out - dst;
+}
+
+/* Unpacks n packed bytes from src into dst, writing at most capacity bytes. Returns bytes written. */
+static inline uint32_t SysExUnpack(const uint8_t *src, uint32_t n, uint8_t *dst, uint32_t capacity) {
+    uint32_t size = 0;
+    while (n > 1 && size < capacity) {
+        const uint8_t hi = src[0];
+        uint32_t count = n - 1 < 7 ? n - 1 : 7;
+        if (count > capacity - size) count = capacity - size;
+        for (uint32_t i = 0; i < count; i++) {
+            dst[size++] = (src[i + 1] & 0x7f) | (((hi >> i) & 0x01) << 7);
+        }
+        src += 8;
+        n = n > 8 ? n - 8 : 0;
+    }
+    return size;
+}
+
+/* CRC-16/CCITT-FALSE, continuing from crc */
+static inline uint16_t SysExCRC16(const uint8_t *data, uint32_t n, uint16_t crc = 0xffff) {
+    while (n--) {
+        crc ^= static_cast<uint16_t>(*data++) << 8;
+        for (int b = 0; b < 8; b++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
+}
+
+/* Produces the messages of a block, one at a time, reading the blob in place */
+class SysExBlockWriter {
+public:
+    SysExBlockWriter(const uint8_t *data_, uint32_t length_, char target_id_)
+        : data(data_), length(length_), target_id(target_id_), index(0) {
+        if (length > SYSEX_BLOCK_MAX_LENGTH) length = SYSEX_BLOCK_MAX_LENGTH;
+    }
+
+    /* Writes the next complete message (F0 ... F7) into msg, which must hold SYSEX_BLOCK_MSG_MAX
+     * bytes. Returns the message size, or 0 once the block has been sent.
+     */
+    uint32_t Next(uint8_t *msg) {
+        const uint32_t offset = index ? (index - 1) * SYSEX_BLOCK_CHUNK : 0;
+        if (index && offset >= length) return 0;
+
+        uint32_t size = 0;
+        msg[size++] = 0xf0;
+        msg[size++] = 0x7d;
+        msg[size++] = SYSEX_BLOCK_ID;
+        msg[size++] = target_id;
+        msg[size++] = index & 0x7f;
+        msg[size++] = (index >> 7) & 0x7f;
+        if (index == 0) {
+            const uint16_t crc = SysExCRC16(data, length);
+            size = Put21(msg, size, length);
+            size = Put21(msg, size, crc);
+        } else {
+            const uint32_t n = length - offset < SYSEX_BLOCK_CHUNK ? length - offset : SYSEX_BLOCK_CHUNK;
+            size += SysExPack(data + offset, n, msg + size);
+        }
+        msg[size++] = 0xf7;
+        ++index;
+        return size;
+    }
+
+    /* Total number of messages in the block */
+    uint32_t MessageCount() const {
+        return 1 + (length + SYSEX_BLOCK_CHUNK - 1) / SYSEX_BLOCK_CHUNK;
+    }
+
+private:
+    const uint8_t *data;
+    uint32_t length;
+    char target_id;
+    uint32_t index; // next message; 0 is the header
+
+    static uint32_t Put21(uint8_t *msg, uint32_t size, uint32_t value) {
+        msg[size++] = value & 0x7f;
+        msg[size++] = (value >> 7) & 0x7f;
+        msg[size++] = (value >> 14) & 0x7f;
+        return size;
+    }
+};
+
+enum SysExBlockStatus {
+    SYSEX_BLOCK_IGNORED,  // not a block message for this app
+    SYSEX_BLOCK_PENDING,  // accepted, more to come
+    SYSEX_BLOCK_COMPLETE, // whole blob received and the CRC matches
+    SYSEX_BLOCK_ERROR     // too long, out of sequence, truncated, or bad CRC; waits for a new header
+};
+
+/* Reassembles a block straight into the caller's buffer */
+class SysExBlockReader {
+public:
+    SysExBlockReader() : dest(nullptr), capacity(0), target_id(0), active(false) { }
+
+    void Begin(uint8_t *dest_, uint32_t capacity_, char target_id_) {
+        dest = dest_;
+        capacity = capacity_;
+        target_id = target_id_;
+        active = false;
+        length = received = 0;
+    }
+
+    /* Feed one complete SysEx message, including F0 and F7 */
+    SysExBlockStatus Feed(const uint8_t *msg, uint32_t size) {
+        if (size < SYSEX_BLOCK_HEADER + 1 || msg[0] != 0xf0 || msg[1] != 0x7d
+            || msg[2] != SYSEX_BLOCK_ID || msg[3] != target_id)
+            return SYSEX_BLOCK_IGNORED;
+        if (msg[size - 1] != 0xf7) return Fail();
+        const uint32_t index = msg[4] | (msg[5] << 7);
+        const uint8_t *payload = msg + SYSEX_BLOCK_HEADER;
+        const uint32_t payload_size = size - SYSEX_BLOCK_HEADER - 1;
+
+        if (index == 0) {
+            if (payload_size != 6) return Fail();
+            length = Get21(payload);
+            crc = Get21(payload + 3);
+            if (length > capacity) return Fail();
+            received = 0;
+            next_index = 1;
+            active = true;
+            return length ? SYSEX_BLOCK_PENDING : Finish();
+        }
+
+        if (!active || index != next_index) return Fail();
+        const uint32_t expect = length - received < SYSEX_BLOCK_CHUNK ? length - received : SYSEX_BLOCK_CHUNK;
+        if (payload_size != SysExPackedSize(expect)) return Fail();
+        received += SysExUnpack(payload, payload_size, dest + received, expect);
+        ++next_index;
+        return received == length ? Finish() : SYSEX_BLOCK_PENDING;
+    }
+
+    uint32_t Length() const { return length; }
+
+private:
+    uint8_t *dest;
+    uint32_t capacity;
+    char target_id;
+    bool active;
+    uint32_t length;
+    uint32_t received;
+    uint32_t next_index;
+    uint16_t crc;
+
+    SysExBlockStatus Fail() {
+        active = false;
+        return SYSEX_BLOCK_ERROR;
+    }
+
+    SysExBlockStatus Finish() {
+        active = false;
+        return SysExCRC16(dest, length) == crc ? SYSEX_BLOCK_COMPLETE : SYSEX_BLOCK_ERROR;
+    }
+
+    static uint32_t Get21(const uint8_t *p) {
+        return (p[0] & 0x7f) | ((p[1] & 0x7f) << 7) | ((uint32_t)(p[2] & 0x7f) << 14);
+    }
+};
+
+#endif // HS_SYSEX_H
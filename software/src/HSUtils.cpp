@@ -2,13 +2,52 @@
 #include "OC_core.h"
 #include "HemisphereApplet.h"
 #include "HSUtils.h"
+#include "vector_osc/HSVectorOscillator.h"
+#include "enigma/TuringMachine.h"
 
 #ifdef ARDUINO_TEENSY41
 #include "AudioSetup.h"
+extern "C" uint8_t external_psram_size;
 #endif
 
 namespace HS {
 
+  // Sample memory for the applets that use the pool, split between the slots
+  // and sized for the applets each build has: DrLoFi's 2K, MIDILooper's 16K on
+  // Teensy 4.x, and PSRAM on 4.1 for CVLooper, which takes all there is. None
+  // is reserved without Hemisphere. A build can set BUFFER_POOL_RAM_SLOT and
+  // BUFFER_POOL_PSRAM_SLOT (bytes per slot, 0 for none) to size it itself.
+#ifndef BUFFER_POOL_RAM_SLOT
+#if defined(NO_HEMISPHERE)
+#define BUFFER_POOL_RAM_SLOT 0
+#elif defined(__IMXRT1062__)
+#define BUFFER_POOL_RAM_SLOT 16384
+#else
+#define BUFFER_POOL_RAM_SLOT 2048
+#endif
+#endif
+#ifndef BUFFER_POOL_PSRAM_SLOT
+#if defined(ARDUINO_TEENSY41) && !defined(NO_HEMISPHERE)
+#define BUFFER_POOL_PSRAM_SLOT 262144
+#else
+#define BUFFER_POOL_PSRAM_SLOT 0
+#endif
+#endif
+
+#if BUFFER_POOL_RAM_SLOT
+  static constexpr size_t BUFFER_POOL_RAM = APPLET_SLOTS * BUFFER_POOL_RAM_SLOT;
+#if defined(__IMXRT1062__)
+  DMAMEM static uint8_t buffer_pool_ram[BUFFER_POOL_RAM] __attribute__((aligned(32)));
+#else
+  static uint8_t buffer_pool_ram[BUFFER_POOL_RAM] __attribute__((aligned(4)));
+#endif
+#endif
+#if defined(ARDUINO_TEENSY41) && BUFFER_POOL_PSRAM_SLOT
+  static constexpr size_t BUFFER_POOL_PSRAM = APPLET_SLOTS * BUFFER_POOL_PSRAM_SLOT;
+  EXTMEM static uint8_t buffer_pool_psram[BUFFER_POOL_PSRAM];
+#endif
+  BufferPool buffer_pool;
+
   uint32_t popup_tick; // for button feedback
   PopupType popup_type = MENU_POPUP;
   uint8_t qview = 0; // which quantizer's setting is shown in popup
@@ -37,8 +76,13 @@ namespace HS {
   int trigger_mapping[] = { 1, 2, 3, 4 };
   int cvmapping[] = { 1, 2, 3, 4 };
 #endif
+  InputRoute input_routes[ADC_CHANNEL_LAST];
   uint8_t trig_length = 10; // in ms, multiplier for HEMISPHERE_CLOCK_TICKS
   uint8_t screensaver_mode = 3; // 0 = blank, 1 = Meters, 2 = Scope/Zaps, 3 = Zips/Stars
+  uint8_t random_seed = 0;
+  RandomStreams random_streams;
+  DMAMEM VOSegment user_waveforms[VO_SEGMENT_COUNT];
+  DMAMEM TuringMachine user_turing_machines[TURING_MACHINE_COUNT];
 
   void Init() {
     for (int i = 0; i < ADC_CHANNEL_LAST; ++i)
@@ -46,8 +90,36 @@ namespace HS {
 
     for (int i = 0; i < QUANT_CHANNEL_COUNT; ++i)
       quantizer[i].Init();
+
+    ReseedRandom();
+    CompileRoutes();
+
+    buffer_pool.Init(APPLET_SLOTS);
+#if BUFFER_POOL_RAM_SLOT
+    buffer_pool.AddRegion(buffer_pool_ram, BUFFER_POOL_RAM);
+#endif
+#if defined(ARDUINO_TEENSY41) && BUFFER_POOL_PSRAM_SLOT
+    // EXTMEM is only there if a PSRAM chip is fitted
+    if (external_psram_size)
+      buffer_pool.AddRegion(buffer_pool_psram, BUFFER_POOL_PSRAM);
+#endif
   }
 
+  void ReseedRandom() {
+    random_streams.Reseed(random_seed ? random_seed : ARM_DWT_CYCCNT ^ micros());
+  }
+
+
+  void CompileRoutes() {
+    const RouteSources sources = {
+      OC::DIGITAL_INPUT_LAST, ADC_CHANNEL_LAST, DAC_CHANNEL_LAST,
+      frame.inputs, frame.outputs, frame.bus,
+      frame.gate_high, frame.clocked, frame.clockout_q,
+      frame.changed_cv, frame.bus_changed
+    };
+    for (int i = 0; i < ADC_CHANNEL_LAST; ++i)
+      input_routes[i] = CompileRoute(cvmapping[i], trigger_mapping[i], sources);
+  }
 
   void PokePopup(PopupType pop) {
     popup_type = pop;
@@ -355,16 +427,9 @@ void gfxPrintVoltage(int cv) {
 #else
     int v = (cv * 100) / (12 << 7);
 #endif
-    bool neg = v < 0 ? 1 : 0;
-    if (v < 0) v = -v;
-    int wv = v / 100; // whole volts
-    int dv = v - (wv * 100); // decimal
-    gfxPrint(neg ? "-" : "+");
-    gfxPrint(wv);
-    gfxPrint(".");
-    if (dv < 10) gfxPrint("0");
-    gfxPrint(dv);
-    gfxPrint("V");
+    char str[12];
+    weegfx::format_centivolts(str, sizeof(str), v);
+    gfxPrint(str);
 }
 
 void gfxPixel(int x, int y) {
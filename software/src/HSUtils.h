@@ -1,16 +1,15 @@
 #pragma once
 
 #include "OC_scales.h"
+#include "HSRandom.h"
+#include "HSBufferPool.h"
+#include "HSRouting.h"
 
 // misc. utility functions extracted from Hemisphere
 // -NJM
 
-// Simulated fixed floats by multiplying and dividing by powers of 2
-#ifndef int2simfloat
-#define int2simfloat(x) (x << 14)
-#define simfloat2int(x) (x >> 14)
-typedef int32_t simfloat;
-#endif
+// Simulated fixed floats and Proportion()
+#include "HSProportion.h"
 
 // Reference Constants
 #ifdef NORTHERNLIGHT
@@ -56,6 +55,8 @@ enum HEM_SIDE {
 
   APPLET_SLOTS
 };
+static_assert(int(APPLET_SLOTS) <= int(RANDOM_STREAM_CLOCK_SKIP), "each applet slot needs its own random stream");
+static_assert(APPLET_SLOTS <= BufferPool::MAX_OWNERS, "each applet slot needs its own buffer");
 
 // Codes for help system labels
 enum HELP_SECTIONS {
@@ -87,25 +88,6 @@ static constexpr uint32_t HEMISPHERE_PULSE_ANIMATION_TIME_LONG = 1200;
 //////////////// Calculation methods
 ////////////////////////////////////////////////////////////////////////////////
 
-/* Proportion method using simfloat, useful for calculating scaled values given
- * a fractional value.
- *
- * Solves this:  numerator        ???
- *              ----------- = -----------
- *              denominator       max
- *
- * For example, to convert a parameter with a range of 1 to 100 into value scaled
- * to HEMISPHERE_MAX_CV, to be sent to the DAC:
- *
- * Out(ch, Proportion(value, 100, HEMISPHERE_MAX_CV));
- *
- */
-constexpr int Proportion(const int numerator, const int denominator, const int max_value) {
-    simfloat proportion = int2simfloat((int32_t)abs(numerator)) / (int32_t)denominator;
-    int scaled = simfloat2int(proportion * max_value);
-    return numerator >= 0 ? scaled : -scaled;
-}
-
 /* Proportion CV values into pixels for display purposes.
  *
  * Solves this:     cv_value           ???
@@ -114,7 +96,7 @@ constexpr int Proportion(const int numerator, const int denominator, const int m
  */
 constexpr int ProportionCV(const int cv_value, const int max_pixels) {
     // TODO: variable scaling for VOR?
-    int prop = constrain(Proportion(cv_value, HEMISPHERE_MAX_INPUT_CV, max_pixels), -max_pixels, max_pixels);
+    int prop = constrain(Proportion<HEMISPHERE_MAX_INPUT_CV>(cv_value, max_pixels), -max_pixels, max_pixels);
     return prop;
 }
 
@@ -210,11 +192,18 @@ namespace HS {
   extern bool auto_save_enabled;
   extern int trigger_mapping[ADC_CHANNEL_LAST];
   extern int cvmapping[ADC_CHANNEL_LAST];
+  extern InputRoute input_routes[ADC_CHANNEL_LAST]; // compiled from the two above
   extern uint8_t trig_length;
   extern uint8_t screensaver_mode;
 
   void Init();
 
+  // Restarts the random streams from random_seed, or from the clock if it's 0
+  void ReseedRandom();
+
+  // Call after changing trigger_mapping or cvmapping
+  void CompileRoutes();
+
   // --- Quantizer helpers
   int GetLatestNoteNumber(int ch);
   int Quantize(int ch, int cv, int root = 0, int transpose = 0);
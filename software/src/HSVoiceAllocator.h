@@ -0,0 +1,232 @@
+/*
+ * VoiceAllocator
+ *   fixed-capacity note stack and voice assignment for MIDI-to-CV
+ *
+ * One allocator per MIDI channel. Every Note On/Off rebuilds the set of
+ * sounding notes from the stack according to the mode, and only voices whose
+ * note actually changed are reassigned, so held notes never jump between
+ * outputs. No allocation, no Arduino dependencies.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace HS {
+
+// Unison comes first: it's how every output on a channel followed the latest
+// note before voices, and it's what a saved MIDIIn without a mode loads as
+enum VoiceAllocMode : uint8_t {
+    VOICE_UNISON,       // every voice plays the most recent note
+    VOICE_LAST,         // most recent notes win
+    VOICE_LOW,          // lowest notes win
+    VOICE_HIGH,         // highest notes win
+    VOICE_ROUND_ROBIN,  // most recent notes, rotating through the voices
+
+    VOICE_MODE_COUNT
+};
+
+class VoiceAllocator {
+public:
+    static constexpr int MAX_VOICES = 8;
+    static constexpr int STACK_SIZE = 12; // held notes remembered per channel
+
+    struct Voice {
+        int8_t note;
+        uint8_t velocity;
+        bool gate;
+    };
+
+    VoiceAllocator() { Init(); }
+
+    void Init(VoiceAllocMode mode_ = VOICE_UNISON) {
+        mode = mode_;
+        voice_count = 1;
+        held = 0;
+        cursor = 0;
+        changed = triggered = 0;
+        for (int v = 0; v < MAX_VOICES; ++v) voices[v] = {60, 0, false};
+    }
+
+    void set_mode(VoiceAllocMode mode_) {
+        if (mode_ >= VOICE_MODE_COUNT || mode_ == mode) return;
+        mode = mode_;
+        Assign(-1);
+    }
+    VoiceAllocMode get_mode() const { return mode; }
+
+    // Number of voices fed by this channel; reassigns held notes when it changes
+    void set_voice_count(int count) {
+        if (count < 1) count = 1;
+        if (count > MAX_VOICES) count = MAX_VOICES;
+        if (count == voice_count) return;
+        for (int v = count; v < voice_count; ++v) voices[v].gate = false;
+        voice_count = count;
+        if (cursor >= voice_count) cursor = 0;
+        Assign(-1);
+    }
+    int get_voice_count() const { return voice_count; }
+
+    void NoteOn(int note, int velocity) {
+        if (velocity == 0) {
+            NoteOff(note);
+            return;
+        }
+        Remove(note);
+        if (held == STACK_SIZE) Drop(0); // forget the oldest note
+        stack[held].note = note;
+        stack[held].velocity = velocity;
+        ++held;
+        Assign(note);
+    }
+
+    void NoteOff(int note) {
+        if (Remove(note)) Assign(-1);
+        else changed = triggered = 0;
+    }
+
+    void AllNotesOff() {
+        held = 0;
+        Assign(-1);
+    }
+
+    const Voice &voice(int v) const { return voices[v]; }
+    int held_notes() const { return held; }
+    bool any_gate() const {
+        for (int v = 0; v < voice_count; ++v)
+            if (voices[v].gate) return true;
+        return false;
+    }
+
+    // Results of the most recent event, one bit per voice
+    uint8_t changed_voices() const { return changed; }   // note or gate changed
+    uint8_t triggered_voices() const { return triggered; } // a new note started
+
+private:
+    struct HeldNote {
+        int8_t note;
+        uint8_t velocity;
+    };
+
+    VoiceAllocMode mode;
+    uint8_t voice_count;
+    uint8_t held;
+    uint8_t cursor; // next voice to try in round-robin mode
+    uint8_t changed;
+    uint8_t triggered;
+    HeldNote stack[STACK_SIZE]; // oldest first
+    Voice voices[MAX_VOICES];
+
+    void Drop(int i) {
+        for (--held; i < held; ++i) stack[i] = stack[i + 1];
+    }
+
+    bool Remove(int note) {
+        for (int i = 0; i < held; ++i) {
+            if (stack[i].note == note) {
+                Drop(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Picks up to voice_count stack indices in priority order
+    int Select(int *wanted) const {
+        const int count = (mode == VOICE_UNISON) ? 1 : voice_count;
+        int n = 0;
+        if (mode == VOICE_LOW || mode == VOICE_HIGH) {
+            // partial selection sort; the stack is at most STACK_SIZE long
+            bool taken[STACK_SIZE] = {false};
+            for (; n < count && n < held; ++n) {
+                int best = -1;
+                for (int i = 0; i < held; ++i) {
+                    if (taken[i]) continue;
+                    if (best < 0
+                        || (mode == VOICE_LOW && stack[i].note < stack[best].note)
+                        || (mode == VOICE_HIGH && stack[i].note > stack[best].note))
+                        best = i;
+                }
+                taken[best] = true;
+                wanted[n] = best;
+            }
+        } else {
+            for (int i = held - 1; i >= 0 && n < count; --i) wanted[n++] = i;
+        }
+        return n;
+    }
+
+    void SetVoice(int v, int8_t note, uint8_t velocity, bool retrig) {
+        Voice &vc = voices[v];
+        if (vc.note != note || !vc.gate) changed |= (1u << v);
+        if (retrig || !vc.gate) triggered |= (1u << v);
+        vc.note = note;
+        vc.velocity = velocity;
+        vc.gate = true;
+    }
+
+    // new_note is the note just pressed, or -1 after a release
+    void Assign(int new_note) {
+        changed = triggered = 0;
+
+        int wanted[MAX_VOICES];
+        const int n = Select(wanted);
+
+        if (mode == VOICE_UNISON) {
+            for (int v = 0; v < voice_count; ++v) {
+                if (n) SetVoice(v, stack[wanted[0]].note, stack[wanted[0]].velocity, stack[wanted[0]].note == new_note);
+                else if (voices[v].gate) {
+                    voices[v].gate = false;
+                    changed |= (1u << v);
+                }
+            }
+            return;
+        }
+
+        // keep voices that are already playing a wanted note
+        uint8_t keep = 0;
+        bool placed[MAX_VOICES] = {false};
+        for (int v = 0; v < voice_count; ++v) {
+            if (!voices[v].gate) continue;
+            for (int w = 0; w < n; ++w) {
+                if (!placed[w] && stack[wanted[w]].note == voices[v].note) {
+                    placed[w] = true;
+                    keep |= (1u << v);
+                    if (voices[v].note == new_note) SetVoice(v, voices[v].note, stack[wanted[w]].velocity, true);
+                    break;
+                }
+            }
+        }
+
+        // hand the remaining wanted notes to free voices, idle ones first
+        for (int w = 0; w < n; ++w) {
+            if (placed[w]) continue;
+            const int v = FreeVoice(keep, stack[wanted[w]].note);
+            keep |= (1u << v);
+            SetVoice(v, stack[wanted[w]].note, stack[wanted[w]].velocity, stack[wanted[w]].note == new_note);
+        }
+
+        for (int v = 0; v < voice_count; ++v) {
+            if (!(keep & (1u << v)) && voices[v].gate) {
+                voices[v].gate = false;
+                changed |= (1u << v);
+            }
+        }
+    }
+
+    int FreeVoice(uint8_t busy, int8_t note) {
+        int best = -1;
+        for (int i = 0; i < voice_count; ++i) {
+            const int v = (mode == VOICE_ROUND_ROBIN) ? (cursor + i) % voice_count : i;
+            if (busy & (1u << v)) continue;
+            // a released voice that last played this pitch is ideal, unless rotating
+            if (mode != VOICE_ROUND_ROBIN && !voices[v].gate && voices[v].note == note) { best = v; break; }
+            if (best < 0 || (voices[best].gate && !voices[v].gate)) best = v;
+        }
+        if (mode == VOICE_ROUND_ROBIN) cursor = (best + 1) % voice_count;
+        return best;
+    }
+};
+
+} // namespace HS
@@ -4,6 +4,7 @@ HS::IOFrame HS::frame;
 HS::ClockManager HS::clock_m;
 
 int HemisphereApplet::cursor_countdown[APPLET_SLOTS];
+weegfx::TextStrip<12> HemisphereApplet::header_text[APPLET_SLOTS];
 const char* HemisphereApplet::help[HELP_LABEL_COUNT];
 
 void HemisphereApplet::BaseController() {
@@ -14,7 +15,57 @@ void HemisphereApplet::BaseController() {
     // Cursor countdowns. See CursorBlink(), ResetCursor(), gfxCursor()
     if (--cursor_countdown[hemisphere] < -HEMISPHERE_CURSOR_TICKS) cursor_countdown[hemisphere] = HEMISPHERE_CURSOR_TICKS;
 
-    Controller();
+    if (ControlDue()) {
+        Controller();
+    } else {
+        // Nothing was written this tick, so don't let a stale difference
+        // keep re-firing the T4.1 auto-trigger outputs
+        ForEachChannel(ch) frame.output_diff[io_offset + ch] = 0;
+    }
+}
+
+bool HemisphereApplet::ControlDue() {
+    const uint8_t rate = ControlRate();
+    if (rate == CONTROL_RATE_TICK) return true;
+
+    bool due = InputEvent();
+    if (rate != CONTROL_RATE_EVENT && --control_countdown == 0) {
+        control_countdown = rate;
+        due = true;
+    }
+    return due;
+}
+
+/*
+ * Would anything the applet reads this tick be new? Only peeks at the frame and
+ * clock manager, so Clock() still consumes as usual once Controller() runs.
+ */
+bool HemisphereApplet::InputEvent() {
+    bool event = 0;
+
+    ForEachChannel(ch) {
+        const InputRoute &route = input_routes[ch + io_offset];
+        event = event || route.PeekClock();
+
+        const uint8_t mask = 1 << ch;
+        const bool gate = Gate(ch);
+        if (gate != bool(last_gates & mask)) {
+            last_gates ^= mask;
+            event = 1;
+        }
+
+        event = event || route.Changed();
+
+#ifdef ARDUINO_TEENSY41
+        const size_t virt_chan = (ch + io_offset) % 8;
+#else
+        const size_t virt_chan = (ch + io_offset) % 4;
+#endif
+        event = event || clock_m.boop[virt_chan];
+        if (clock_m.IsRunning()) event = event || clock_m.Tock(virt_chan);
+    }
+
+    return event;
 }
 
 void HemisphereApplet::BaseView(bool full_screen) {
@@ -44,20 +95,11 @@ bool HemisphereApplet::Clock(int ch, bool physical) {
     const size_t virt_chan = (ch + io_offset) % 4;
 #endif
 
-    const int trmap = trigger_mapping[ch + io_offset];
-    const int offset = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST;
-
     // clock triggers
     if (useTock && HS::clock_m.GetMultiply(virt_chan) != 0)
         clocked = HS::clock_m.Tock(virt_chan);
-    else if (trmap > 0) {
-      if (trmap <= offset)
-        clocked = frame.clocked[ trmap - 1 ];
-      else {
-        clocked = frame.clockout_q[ trmap - 1 - offset ];
-        frame.clockout_q[ trmap - 1 - offset ] = false;
-      }
-    }
+    else
+        clocked = input_routes[ch + io_offset].Clock();
 
     // Try to eat a boop
     clocked = clocked || clock_m.Beep(virt_chan);
@@ -44,6 +44,9 @@
 
 #include "HSUtils.h"
 #include "HSIOFrame.h"
+#ifdef ARDUINO_TEENSY41
+#include "HSAudioApplet.h"
+#endif
 
 class HemisphereApplet;
 
@@ -65,6 +68,7 @@ using namespace HS;
 class HemisphereApplet {
 public:
     static int cursor_countdown[APPLET_SLOTS];
+    static weegfx::TextStrip<12> header_text[APPLET_SLOTS]; // applet names, rendered once
     static const char* help[HELP_LABEL_COUNT];
 
     virtual const char* applet_name() = 0; // Maximum of 9 characters
@@ -82,6 +86,17 @@ public:
     virtual void OnButtonPress() { CursorToggle(); };
     virtual void OnEncoderMove(int direction) = 0;
 
+    /* Control rate scheduling. By default Controller() runs every tick. Applets that
+     * don't need that can return a divider N from ControlRate() to run every Nth tick,
+     * or CONTROL_RATE_EVENT to run only when one of their inputs fires. Either way,
+     * Controller() also runs on any clock, gate change, or CV change on the applet's
+     * inputs, so Clock() and Changed() are never missed. Slots are staggered so
+     * low-rate applets don't all land on the same tick.
+     */
+    static constexpr uint8_t CONTROL_RATE_EVENT = 0;
+    static constexpr uint8_t CONTROL_RATE_TICK = 1;
+    virtual uint8_t ControlRate() { return CONTROL_RATE_TICK; }
+
     //void BaseStart(const HEM_SIDE hemisphere_);
     void BaseController();
     void BaseView(bool full_screen = false);
@@ -91,6 +106,8 @@ public:
 
         // Initialize some things for startup
         cursor_countdown[hemisphere] = HEMISPHERE_CURSOR_TICKS;
+        control_countdown = hemisphere + 1;
+        last_gates = 0;
 
         // Maintain previous app state by skipping Start
         if (!applet_started) {
@@ -103,6 +120,10 @@ public:
     }
     virtual void Unload() { }
 
+    // Background work, called from the main loop while the applet is loaded;
+    // the ISR can interrupt it anywhere. Copying to slow memory and the like.
+    virtual void Idle() { }
+
     // Screensavers are deprecated in favor of screen blanking, but the BaseScreensaverView() remains
     // to avoid breaking applets based on the old boilerplate
     void BaseScreensaverView() {}
@@ -189,24 +210,20 @@ public:
 
     //////////////// Offset I/O methods
     ////////////////////////////////////////////////////////////////////////////////
+    // Inputs go through the routes compiled from the mappings, see HSRouting.h
     int In(const int ch) {
-        const int c = cvmapping[ch + io_offset];
-        if (!c) return 0;
-        return (c <= ADC_CHANNEL_LAST) ? frame.inputs[c - 1] : frame.outputs[c - 1 - ADC_CHANNEL_LAST];
+        return input_routes[ch + io_offset].In();
     }
 
     // Apply small center detent to input, so it reads zero before a threshold
     int DetentedIn(int ch) {
-        return (In(ch) > (HEMISPHERE_CENTER_CV + HEMISPHERE_CENTER_DETENT) || In(ch) < (HEMISPHERE_CENTER_CV - HEMISPHERE_CENTER_DETENT))
-            ? In(ch) : HEMISPHERE_CENTER_CV;
+        const int cv = In(ch);
+        return (cv > (HEMISPHERE_CENTER_CV + HEMISPHERE_CENTER_DETENT) || cv < (HEMISPHERE_CENTER_CV - HEMISPHERE_CENTER_DETENT))
+            ? cv : HEMISPHERE_CENTER_CV;
     }
     int SmoothedIn(int ch) {
-      const int x = cvmapping[ch + io_offset];
-      if (x && x <= ADC_CHANNEL_LAST) {
-        ADC_CHANNEL channel = (ADC_CHANNEL)( x - 1 );
-        return OC::ADC::value(channel);
-      }
-      return 0;
+      const int adc = input_routes[ch + io_offset].adc;
+      return (adc < 0) ? 0 : OC::ADC::value((ADC_CHANNEL)adc);
     }
     int SemitoneIn(int ch) {
       return input_quant[ch].Process(In(ch));
@@ -216,10 +233,7 @@ public:
     bool Clock(int ch, bool physical = 0);
 
     bool Gate(int ch) {
-        const int t = trigger_mapping[ch + io_offset];
-        const int offset = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST;
-        if (!t) return false;
-        return (t <= offset) ? frame.gate_high[t - 1] : (frame.outputs[t - 1 - offset] > GATE_THRESHOLD);
+        return input_routes[ch + io_offset].Gate(GATE_THRESHOLD);
     }
     void Out(int ch, int value, int octave = 0) {
         frame.Out( (DAC_CHANNEL)(ch + io_offset), value + (octave * (12 << 7)));
@@ -278,7 +292,7 @@ public:
     void Modulate(T &param, const int ch, const int min = 0, const int max = 255) {
         // small ranges use Semitone quantizer for hysteresis
         int increment = (max < 70) ? SemitoneIn(ch) :
-          Proportion(DetentedIn(ch), HEMISPHERE_MAX_INPUT_CV, max);
+          Proportion<HEMISPHERE_MAX_INPUT_CV>(DetentedIn(ch), max);
         param = constrain(param + increment, min, max);
     }
 
@@ -289,10 +303,46 @@ public:
     // Override HSUtils function to only return positive values
     // Not ideal, but too many applets rely on this.
     constexpr int ProportionCV(const int cv_value, const int max_pixels) {
-        int prop = constrain(Proportion(cv_value, HEMISPHERE_MAX_INPUT_CV, max_pixels), 0, max_pixels);
+        int prop = constrain(Proportion<HEMISPHERE_MAX_INPUT_CV>(cv_value, max_pixels), 0, max_pixels);
         return prop;
     }
 
+    // Shadow Arduino random() with this slot's own stream, so applets don't
+    // share one global generator and a fixed seed repeats per applet
+    uint32_t random(uint32_t howbig) {
+        return HS::random_streams[hemisphere].Below(howbig);
+    }
+    int32_t random(int32_t howsmall, int32_t howbig) {
+        return HS::random_streams[hemisphere].Range(howsmall, howbig);
+    }
+    HS::Random &RandomStream() {
+        return HS::random_streams[hemisphere];
+    }
+
+    // Sample memory from the buffer pool, for this slot. Request it in Start()
+    // and release it in Unload(); it's filled with fill once BufferReady().
+    void *RequestBuffer(size_t size, uint8_t fill = 0) {
+        return HS::buffer_pool.Request(hemisphere, size, fill);
+    }
+    void ReleaseBuffer() {
+        HS::buffer_pool.Release(hemisphere);
+    }
+    bool BufferReady() {
+        return HS::buffer_pool.ready(hemisphere);
+    }
+
+#ifdef ARDUINO_TEENSY41
+    // Runs kernel on this slot's audio channel, from the next block on. The
+    // manager detaches it before Unload(); kernels get their settings from
+    // Controller() through a ParamBuffer. See HSAudioApplet.h
+    bool AttachAudio(HS::AudioKernel *kernel) {
+        return HS::AttachAudio(hemisphere, kernel);
+    }
+    void DetachAudio() {
+        HS::DetachAudio(hemisphere);
+    }
+#endif
+
     //////////////// Offset graphics methods
     ////////////////////////////////////////////////////////////////////////////////
     void gfxCursor(int x, int y, int w, int h = 9) { // assumes standard text height for highlighting
@@ -454,9 +504,12 @@ public:
         gfxIcon(x, 2, icon);
         x += 9;
       }
+      weegfx::TextStrip<12> &text = header_text[hemisphere];
+      text.Set(str);
       if (hemisphere & 1) // right side
-        x = 62 - strlen(str) * 6;
-      gfxPrint(x, 2, str);
+        x = 62 - text.width();
+      gfxPos(x, 2);
+      graphics.print(text);
       gfxDottedLine(0, 10, 62, 10);
     }
 
@@ -503,6 +556,11 @@ protected:
 
 private:
     bool applet_started; // Allow the app to maintain state during switching
+    uint8_t control_countdown; // Ticks until a divided-rate Controller() is due
+    uint8_t last_gates; // Gate state per channel, for event detection
+
+    bool ControlDue();
+    bool InputEvent();
     int16_t cursor_start_x;
     int16_t cursor_start_y;
 };
@@ -37,6 +37,7 @@
 #include "OC_menus.h"
 #include "OC_strings.h"
 #include "OC_ui.h"
+#include "OC_frame_scheduler.h"
 #include "OC_options.h"
 #include "src/drivers/display.h"
 #include "src/drivers/ADC/OC_util_ADC.h"
@@ -58,6 +59,7 @@ MIDI_CREATE_INSTANCE(HardwareSerial, Serial8, MIDI1);
 
 unsigned long LAST_REDRAW_TIME = 0;
 uint_fast8_t MENU_REDRAW = true;
+OC::FrameScheduler OC::frame_scheduler;
 OC::UiMode ui_mode = OC::UI_MODE_MENU;
 const bool DUMMY = false;
 
@@ -185,6 +187,7 @@ void setup() {
 
   OC::menu::Init();
   OC::ui.Init();
+  OC::frame_scheduler.Init(millis());
   OC::ui.configure_encoders(OC::calibration_data.encoder_config());
 
   SERIAL_PRINTLN("* CORE ISR @%luus", OC_CORE_TIMER_RATE);
@@ -237,6 +240,7 @@ void FASTRUN loop() {
     // Refresh display
     if (MENU_REDRAW) {
       GRAPHICS_BEGIN_FRAME(false); // Don't busy wait
+        OC::frame_scheduler.BeginFrame(millis());
         if (OC::UI_MODE_MENU == ui_mode) {
           OC_DEBUG_RESET_CYCLES(menu_redraws, 512, OC::DEBUG::MENU_draw_cycles);
           OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::MENU_draw_cycles);
@@ -254,6 +258,7 @@ void FASTRUN loop() {
         }
         MENU_REDRAW = 0;
         LAST_REDRAW_TIME = millis();
+        OC::ui.FrameDrawn();
       GRAPHICS_END_FRAME();
     }
 
@@ -272,7 +277,9 @@ void FASTRUN loop() {
       ui_mode = mode;
     }
 
-    if (millis() - LAST_REDRAW_TIME > REDRAW_TIMEOUT_MS)
+    // Periodic redraw, slower while the ISR is busy; unchanged frames aren't sent
+    OC::frame_scheduler.Update(millis());
+    if (OC::frame_scheduler.Due(millis() - LAST_REDRAW_TIME))
       MENU_REDRAW = 1;
 
     static size_t cap_idx = 0;
@@ -22,6 +22,7 @@
 
 #include "OC_core.h"
 #include "OC_ui.h"
+#include "OC_frame_scheduler.h"
 #include "OC_apps.h"
 #include "OC_menus.h"
 #include "OC_config.h"
@@ -342,6 +343,7 @@ namespace apps {
 void set_current_app(int index) {
   current_app = &available_apps[index];
   global_settings.current_app_id = current_app->id;
+  frame_scheduler.RequestInterval(0);
   #ifdef VOR
   VBiasManager *vbias_m = vbias_m->get();
   vbias_m->SetStateForApp(current_app);
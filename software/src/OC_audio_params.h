@@ -0,0 +1,96 @@
+#ifndef OC_AUDIO_PARAMS_H_
+#define OC_AUDIO_PARAMS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace OC {
+namespace AudioDSP {
+
+// Samples per audio block, as AUDIO_BLOCK_SAMPLES in the Teensy Audio library
+static constexpr int kBlockSamples = 128;
+
+// A parameter's path across one audio block: it starts just after from and
+// reaches to on the last sample, so consecutive blocks join without a step.
+struct ParamRamp {
+  float from;
+  float to;
+
+  bool moving() const { return from != to; }
+  float step() const { return (to - from) * (1.0f / kBlockSamples); }
+};
+
+// Hands CV-driven settings from the core ISR to the audio update.
+//
+// The core ISR runs far more often than audio blocks are processed, so it
+// only stores the latest target with Set(). Once per block the audio update
+// calls Latch(), which ramps each parameter from where it was to its new
+// target and reports which ones moved; only those need their setter called.
+// A threshold per parameter keeps ADC noise from causing updates.
+template <int N>
+class ParamBridge {
+public:
+  static_assert(N <= 32, "changed parameters are reported as a 32-bit mask");
+
+  void Init(float value = 0.0f) {
+    for (int i = 0; i < N; ++i) {
+      target_[i] = value;
+      ramp_[i].from = ramp_[i].to = value;
+      threshold_[i] = 0.0f;
+    }
+  }
+
+  // Smallest change worth an update
+  void SetThreshold(int i, float threshold) {
+    threshold_[i] = threshold;
+  }
+
+  // Core ISR: the latest value wins, nothing is applied yet
+  void Set(int i, float value) {
+    target_[i] = value;
+  }
+
+  // Audio update, once per block.
+  // @return mask of parameters whose setters need calling for this block
+  uint32_t Latch() {
+    uint32_t changed = 0;
+    for (int i = 0; i < N; ++i) {
+      ParamRamp &r = ramp_[i];
+      r.from = r.to;
+      const float target = target_[i];
+      const float delta = target > r.to ? target - r.to : r.to - target;
+      if (delta > threshold_[i]) {
+        r.to = target;
+        changed |= 1u << i;
+      }
+    }
+    return changed;
+  }
+
+  const ParamRamp &ramp(int i) const { return ramp_[i]; }
+  float value(int i) const { return ramp_[i].to; }
+
+private:
+  volatile float target_[N];
+  float threshold_[N];
+  ParamRamp ramp_[N];
+};
+
+// Applies a gain ramp to one block in place, saturating to 16 bits
+inline void ApplyGainRamp(int16_t *samples, const ParamRamp &ramp) {
+  if (!ramp.moving() && ramp.to == 1.0f) return;
+
+  const float step = ramp.step();
+  for (int n = 0; n < kBlockSamples; ++n) {
+    const float gain = ramp.from + step * (n + 1);
+    int32_t s = static_cast<int32_t>(samples[n] * gain);
+    if (s > 32767) s = 32767;
+    if (s < -32768) s = -32768;
+    samples[n] = s;
+  }
+}
+
+} // namespace AudioDSP
+} // namespace OC
+
+#endif // OC_AUDIO_PARAMS_H_
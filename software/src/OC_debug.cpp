@@ -7,6 +7,7 @@
 #include "OC_debug.h"
 #include "OC_menus.h"
 #include "OC_ui.h"
+#include "OC_frame_scheduler.h"
 #include "OC_strings.h"
 #include "util/util_misc.h"
 #include "extern/dspinst.h"
@@ -54,6 +55,8 @@ namespace DEBUG {
   uint32_t UI_event_count;
   uint32_t UI_max_queue_depth;
   uint32_t UI_queue_overflow;
+  uint32_t UI_coalesced;
+  debug::AveragedCycles UI_latency;
 
   void Init() {
     debug::CycleMeasurement::Init();
@@ -82,8 +85,17 @@ static void debug_menu_core() {
 
 #ifdef OC_UI_DEBUG
   graphics.setPrintPos(2, 42);
-  graphics.printf("UI   !%lu #%lu", DEBUG::UI_queue_overflow, DEBUG::UI_event_count);
+  graphics.printf("UI !%lu #%lu ^%lu +%lu", DEBUG::UI_queue_overflow, DEBUG::UI_event_count,
+                  DEBUG::UI_max_queue_depth, DEBUG::UI_coalesced);
   graphics.setPrintPos(2, 52);
+  // min is still the reset sentinel until the first frame with input
+  if (DEBUG::UI_latency.min_value() > DEBUG::UI_latency.max_value())
+    graphics.print("LAT  -");
+  else
+    graphics.printf("LAT%3lu", DEBUG::UI_latency.min_value() / 1000);
+  graphics.printf("/%3lu/%3lums",
+                  DEBUG::UI_latency.value() / 1000,
+                  DEBUG::UI_latency.max_value() / 1000);
 #endif
 }
 
@@ -117,6 +129,13 @@ static void debug_menu_gfx() {
                   debug::cycles_to_us(DEBUG::MENU_draw_cycles.min_value()),
                   debug::cycles_to_us(DEBUG::MENU_draw_cycles.value()),
                   debug::cycles_to_us(DEBUG::MENU_draw_cycles.max_value()));
+
+  graphics.setPrintPos(2, 32);
+  graphics.printf("FPS %3lu SKIP %3lu/s", frame_scheduler.fps(), frame_scheduler.skipped_per_s());
+  graphics.setPrintPos(2, 42);
+  graphics.printf("DRAW %2lu.%lu%% x%lu %2lums",
+                  frame_scheduler.draw_permille() / 10, frame_scheduler.draw_permille() % 10,
+                  frame_scheduler.backoff(), frame_scheduler.interval());
 }
 
 static void debug_menu_adc() {
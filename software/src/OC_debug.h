@@ -19,6 +19,8 @@ namespace DEBUG {
   extern uint32_t UI_event_count;
   extern uint32_t UI_max_queue_depth;
   extern uint32_t UI_queue_overflow;
+  extern uint32_t UI_coalesced;
+  extern debug::AveragedCycles UI_latency; // poll to drawn frame, in us, not cycles
 };
 
 class DebugPins {
@@ -0,0 +1,109 @@
+#ifndef OC_FRAME_SCHEDULER_H_
+#define OC_FRAME_SCHEDULER_H_
+
+#include <stdint.h>
+#include "OC_config.h"
+#include "OC_debug.h"
+#include "src/drivers/display.h"
+
+namespace OC {
+
+// Decides when the main loop redraws on its own, i.e. without MENU_REDRAW
+// being set by an event. The periodic interval backs off while the core ISR
+// is busy, since every frame that changes costs the ISR a full transfer.
+// Frames that don't change are dropped by the frame buffer, except for a
+// refresh every kRefreshMs so the panel recovers from glitches.
+class FrameScheduler {
+public:
+  static constexpr uint32_t kMaxIntervalMs = 50;
+  static constexpr uint32_t kRefreshMs = 1000;
+  static constexpr uint32_t kStatsWindowMs = 1000;
+  static constexpr uint32_t kBusyLoad = 75;     // % of ISR period: double the interval
+  static constexpr uint32_t kOverloadLoad = 90; // quadruple it
+
+  void Init(uint32_t now) {
+    requested_ms_ = 0;
+    backoff_ = 1;
+    last_refresh_ = window_start_ = now;
+    window_draws_ = 0;
+    written_ = display::frame_buffer.frames_written();
+    skipped_ = display::frame_buffer.frames_skipped();
+    fps_ = skipped_per_s_ = draw_permille_ = isr_load_ = 0;
+  }
+
+  // Apps that animate slowly can ask for a longer interval; 0 restores the
+  // default. Reset whenever the current app changes.
+  void RequestInterval(uint32_t ms) {
+    requested_ms_ = ms;
+  }
+
+  uint32_t interval() const {
+    const uint32_t base = requested_ms_ ? requested_ms_ : REDRAW_TIMEOUT_MS;
+    const uint32_t ms = base * backoff_;
+    const uint32_t limit = base > kMaxIntervalMs ? base : kMaxIntervalMs;
+    return ms < limit ? ms : limit;
+  }
+
+  // @return true if a periodic redraw is due, elapsed ms after the last one
+  bool Due(uint32_t elapsed) const {
+    return elapsed > interval();
+  }
+
+  // Call just before drawing a frame
+  void BeginFrame(uint32_t now) {
+    if (now - last_refresh_ >= kRefreshMs) {
+      display::frame_buffer.force_next();
+      last_refresh_ = now;
+    }
+    ++window_draws_;
+  }
+
+  // Call once per loop: tracks ISR load and rolls the stats window
+  void Update(uint32_t now) {
+    isr_load_ = debug::cycles_to_us(DEBUG::ISR_cycles.value()) * 100 / OC_CORE_TIMER_RATE;
+    if (isr_load_ >= kOverloadLoad) backoff_ = 4;
+    else if (isr_load_ >= kBusyLoad) backoff_ = 2;
+    else backoff_ = 1;
+
+    const uint32_t window = now - window_start_;
+    if (window >= kStatsWindowMs) {
+      const uint32_t written = display::frame_buffer.frames_written();
+      const uint32_t skipped = display::frame_buffer.frames_skipped();
+      fps_ = (written - written_) * 1000 / window;
+      skipped_per_s_ = (skipped - skipped_) * 1000 / window;
+      // average draw time * draws / window, in us per ms = permille
+      draw_permille_ = debug::cycles_to_us(DEBUG::MENU_draw_cycles.value()) * window_draws_ / window;
+      written_ = written;
+      skipped_ = skipped;
+      window_draws_ = 0;
+      window_start_ = now;
+    }
+  }
+
+  uint32_t fps() const { return fps_; }
+  uint32_t skipped_per_s() const { return skipped_per_s_; }
+  uint32_t draw_permille() const { return draw_permille_; }
+  uint32_t isr_load() const { return isr_load_; }
+  uint32_t backoff() const { return backoff_; }
+
+private:
+  uint32_t requested_ms_;
+  uint32_t backoff_;
+  uint32_t last_refresh_;
+
+  uint32_t window_start_;
+  uint32_t window_draws_;
+  uint32_t written_;
+  uint32_t skipped_;
+
+  uint32_t fps_;
+  uint32_t skipped_per_s_;
+  uint32_t draw_permille_;
+  uint32_t isr_load_;
+};
+
+extern FrameScheduler frame_scheduler;
+
+}; // namespace OC
+
+#endif // OC_FRAME_SCHEDULER_H_
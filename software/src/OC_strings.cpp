@@ -71,6 +71,11 @@ namespace OC {
     "A", "B", "C", "D",
 #ifdef ARDUINO_TEENSY41
     "E", "F", "G", "H",
+#endif
+    // busses: outputs delayed by one tick
+    "A'", "B'", "C'", "D'",
+#ifdef ARDUINO_TEENSY41
+    "E'", "F'", "G'", "H'",
 #endif
   };
 
@@ -64,6 +64,9 @@ void Ui::Init() {
   button_ignore_mask_ = 0;
   screensaver_ = false;
   preempt_screensaver_ = false;
+  input_time_ = 0;
+  input_pending_ = false;
+  frames_drawn_ = 0;
 
   encoder_right_.Init(OC_GPIO_ENC_PINMODE);
   encoder_left_.Init(OC_GPIO_ENC_PINMODE);
@@ -99,6 +102,7 @@ void Ui::_preemptScreensaver(bool v) {
 void FASTRUN Ui::Poll() {
 
   uint32_t now = ++ticks_;
+  const uint32_t stamp = micros();
   uint16_t button_state = 0;
 
 #if defined(ARDUINO_TEENSY41)
@@ -115,16 +119,16 @@ void FASTRUN Ui::Poll() {
     auto &button = buttons_[i];
     if (button.just_pressed()) {
       button_press_time_[i] = now;
-      PushEvent(UI::EVENT_BUTTON_DOWN, control_mask(i), 0, button_state);
+      PushEvent(UI::EVENT_BUTTON_DOWN, control_mask(i), 0, button_state, stamp);
     } else if (button.released()) {
       if (now - button_press_time_[i] < kLongPressTicks)
-        PushEvent(UI::EVENT_BUTTON_PRESS, control_mask(i), 0, button_state);
+        PushEvent(UI::EVENT_BUTTON_PRESS, control_mask(i), 0, button_state, stamp);
       else
-        PushEvent(UI::EVENT_BUTTON_LONG_RELEASE, control_mask(i), 0, button_state);
+        PushEvent(UI::EVENT_BUTTON_LONG_RELEASE, control_mask(i), 0, button_state, stamp);
 
       button_press_time_[i] = 0;
     } else if (button.pressed() && (now - button_press_time_[i] == kLongPressTicks)) {
-      PushEvent(UI::EVENT_BUTTON_LONG_PRESS, control_mask(i), 0, button_state);
+      PushEvent(UI::EVENT_BUTTON_LONG_PRESS, control_mask(i), 0, button_state, stamp);
     }
   }
 
@@ -134,22 +138,44 @@ void FASTRUN Ui::Poll() {
   int32_t increment;
   increment = encoder_right_.Read();
   if (increment)
-    PushEvent(UI::EVENT_ENCODER, CONTROL_ENCODER_R, increment, button_state);
+    PushEvent(UI::EVENT_ENCODER, CONTROL_ENCODER_R, increment, button_state, stamp);
 
   increment = encoder_left_.Read();
   if (increment)
-    PushEvent(UI::EVENT_ENCODER, CONTROL_ENCODER_L, increment, button_state);
+    PushEvent(UI::EVENT_ENCODER, CONTROL_ENCODER_L, increment, button_state, stamp);
 
   button_state_ = button_state;
 }
 
+void Ui::FrameDrawn() {
+  // Everything dispatched before this frame is now on it
+  if (input_pending_) {
+    input_pending_ = false;
+#ifdef OC_UI_DEBUG
+    OC_DEBUG_RESET_CYCLES(frames_drawn_, 512, DEBUG::UI_latency);
+    DEBUG::UI_latency.push(micros() - input_time_);
+    ++frames_drawn_;
+#endif
+  }
+}
+
 UiMode Ui::DispatchEvents(const App *app) {
 
+#ifdef OC_UI_DEBUG
+  if (event_queue_.depth() > DEBUG::UI_max_queue_depth)
+    DEBUG::UI_max_queue_depth = event_queue_.depth();
+#endif
+
   while (event_queue_.available()) {
     const UI::Event event = event_queue_.PullEvent();
     if (IgnoreEvent(event))
       continue;
 
+    if (!input_pending_) {
+      input_time_ = event.time;
+      input_pending_ = true;
+    }
+
     switch (event.type) {
       case UI::EVENT_BUTTON_PRESS:
 #ifdef VOR
@@ -84,6 +84,7 @@ public:
   UiMode DispatchEvents(const OC::App *app);
 
   void Poll();
+  void FrameDrawn();
   void _Poke();
   void _preemptScreensaver(bool v);
 
@@ -144,6 +145,11 @@ private:
   bool screensaver_;
   bool preempt_screensaver_;
 
+  // Oldest dispatched input that hasn't been drawn yet
+  uint32_t input_time_;
+  bool input_pending_;
+  uint32_t frames_drawn_;
+
   /* Reverse the left and right encoders if Hemisphere Suite is installed on the left-hand
    * side of a Northern Light 2OC 4U module.
    */
@@ -157,13 +163,17 @@ private:
 
   UI::EventQueue<kEventQueueDepth> event_queue_;
 
-  inline void PushEvent(UI::EventType t, uint16_t c, int16_t v, uint16_t m) {
+  inline void PushEvent(UI::EventType t, uint16_t c, int16_t v, uint16_t m, uint32_t time) {
 #ifdef OC_UI_DEBUG
-    if (!event_queue_.writable())
-      ++DEBUG::UI_queue_overflow;
+    switch (event_queue_.PushEvent(t, c, v, m, time)) {
+      case UI::EVENT_DROPPED: ++DEBUG::UI_queue_overflow; break;
+      case UI::EVENT_COALESCED: ++DEBUG::UI_coalesced; break;
+      default: break;
+    }
     ++DEBUG::UI_event_count;
+#else
+    event_queue_.PushEvent(t, c, v, m, time);
 #endif
-    event_queue_.PushEvent(t, c, v, m);
   }
 
   bool IgnoreEvent(const UI::Event &event) {
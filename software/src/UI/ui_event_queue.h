@@ -29,13 +29,24 @@
 
 namespace UI {
 
+enum EventPushResult {
+  EVENT_QUEUED,
+  EVENT_COALESCED,
+  EVENT_DROPPED
+};
+
 // Event queue for UI events
 // Meant for single producer/single consumer setting
 //
 // Yes, looks similar to stmlib::EventQueue, but hey, it's a queue for UI events.
+//
+// A fast encoder spin during a long redraw would otherwise fill the queue with
+// one event per detent, so encoder deltas are merged into a queued event for the
+// same encoder, and the last kButtonReserve slots are kept for button events.
 template <size_t size = 16>
 class EventQueue {
 public:
+  static constexpr size_t kButtonReserve = 4;
 
   EventQueue() { }
 
@@ -58,9 +69,23 @@ public:
     Poke();
   }
 
-  inline void PushEvent(EventType t, uint16_t c, int16_t v, uint16_t m) {
-    events_.Write(Event(t, c, v, m));
+  inline EventPushResult PushEvent(EventType t, uint16_t c, int16_t v, uint16_t m, uint32_t time) {
+    if (EVENT_ENCODER == t) {
+      // merge with the newest event if it's the same encoder with the same buttons held;
+      // when short of room, with the latest event for that encoder anywhere in the queue
+      if (Coalesce(c, v, m, false) || (events_.writable() <= kButtonReserve && Coalesce(c, v, m, true))) {
+        Poke();
+        return EVENT_COALESCED;
+      }
+      if (events_.writable() <= kButtonReserve)
+        return EVENT_DROPPED;
+    } else if (!events_.writable()) {
+      return EVENT_DROPPED;
+    }
+
+    events_.Write(Event(t, c, v, m, time));
     Poke();
+    return EVENT_QUEUED;
   }
 
   inline Event PullEvent() {
@@ -80,8 +105,31 @@ public:
     return events_.writable();
   }
 
+  inline size_t depth() const {
+    return events_.readable();
+  }
+
 private:
 
+  // The oldest unread event might be halfway through PullEvent(), so it's never
+  // touched; the producer runs in the UI ISR, so nothing else can interleave.
+  bool Coalesce(uint16_t c, int16_t v, uint16_t m, bool search) {
+    const size_t queued = events_.readable();
+    for (size_t i = 0; i + 1 < queued; ++i) {
+      Event *e = events_.Recent(i);
+      if (EVENT_ENCODER == e->type && c == e->control && (search || m == e->mask)) {
+        const int32_t value = e->value + v;
+        if (value > INT16_MAX || value < INT16_MIN)
+          return false;
+        e->value = value;
+        return true;
+      }
+      if (!search)
+        break;
+    }
+    return false;
+  }
+
   util::RingBuffer<Event, size> events_;
   uint32_t last_event_time_;
 };
@@ -44,10 +44,11 @@ struct Event {
   uint16_t control;
   int16_t value;
   uint16_t mask;
+  uint32_t time; // micros() when the input was polled, for latency stats
 
   Event() { }
-  Event(EventType t, uint16_t c, int16_t v, uint16_t m)
-  : type(t), control(c), value(v), mask(m) { }
+  Event(EventType t, uint16_t c, int16_t v, uint16_t m, uint32_t when = 0)
+  : type(t), control(c), value(v), mask(m), time(when) { }
 };
 
 }; // namespace UI
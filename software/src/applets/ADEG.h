@@ -59,13 +59,13 @@ public:
 
             //if (signal != target) { // Logarhythm fix 8/2020
                 int segment = phase == 1
-                    ? effective_attack + Proportion(DetentedIn(0), HEMISPHERE_MAX_INPUT_CV, HEM_ADEG_MAX_VALUE)
-                    : effective_decay + Proportion(DetentedIn(1), HEMISPHERE_MAX_INPUT_CV, HEM_ADEG_MAX_VALUE);
+                    ? effective_attack + Proportion<HEMISPHERE_MAX_INPUT_CV>(DetentedIn(0), HEM_ADEG_MAX_VALUE)
+                    : effective_decay + Proportion<HEMISPHERE_MAX_INPUT_CV>(DetentedIn(1), HEM_ADEG_MAX_VALUE);
                 segment = constrain(segment, 0, HEM_ADEG_MAX_VALUE);
                 simfloat remaining = target - signal;
 
                 // The number of ticks it would take to get from 0 to HEMISPHERE_MAX_CV
-                int max_change = Proportion(segment, HEM_ADEG_MAX_VALUE, HEM_ADEG_MAX_TICKS);
+                int max_change = Proportion<HEM_ADEG_MAX_VALUE>(segment, HEM_ADEG_MAX_TICKS);
 
                 // The number of ticks it would take to move the remaining amount at max_change
                 int ticks_to_remaining = Proportion(simfloat2int(remaining), HEMISPHERE_MAX_CV, max_change);
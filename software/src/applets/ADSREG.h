@@ -153,7 +153,7 @@ public:
     void OnEncoderMove(int direction) {
         //-ghostils:Reference curEG as the indexer to current ADSR when editing stages:
         int adsr[4] = {attack[curEG], decay[curEG], sustain[curEG], release[curEG]};
-        adsr[edit_stage] = constrain(adsr[edit_stage] += direction, 1, HEM_EG_MAX_VALUE);
+        adsr[edit_stage] = constrain(adsr[edit_stage] + direction, 1, HEM_EG_MAX_VALUE);
         attack[curEG] = adsr[HEM_EG_ATTACK];
         decay[curEG] = adsr[HEM_EG_DECAY];
         sustain[curEG] = adsr[HEM_EG_SUSTAIN];
@@ -289,7 +289,7 @@ private:
         //-Remove attack_mod CV:
         //int effective_attack = constrain(attack[ch] + attack_mod, 1, HEM_EG_MAX_VALUE);
         int effective_attack = constrain(attack[ch], 1, HEM_EG_MAX_VALUE);
-        int total_stage_ticks = Proportion(effective_attack, HEM_EG_MAX_VALUE, HEM_EG_MAX_TICKS_AD);
+        int total_stage_ticks = Proportion<HEM_EG_MAX_VALUE>(effective_attack, HEM_EG_MAX_TICKS_AD);
         int ticks_remaining = total_stage_ticks - stage_ticks[ch];
         if (effective_attack == 1) ticks_remaining = 0;
         if (ticks_remaining <= 0) { // End of attack; move to decay
@@ -305,14 +305,14 @@ private:
 
     void DecayAmplitude(int ch) {
         //-ghostils:Update to reference current channel:
-        int total_stage_ticks = Proportion(decay[ch], HEM_EG_MAX_VALUE, HEM_EG_MAX_TICKS_AD);
+        int total_stage_ticks = Proportion<HEM_EG_MAX_VALUE>(decay[ch], HEM_EG_MAX_TICKS_AD);
         int ticks_remaining = total_stage_ticks - stage_ticks[ch];
-        simfloat amplitude_remaining = amplitude[ch] - int2simfloat(Proportion(sustain[ch], HEM_EG_MAX_VALUE, HEMISPHERE_MAX_CV));
+        simfloat amplitude_remaining = amplitude[ch] - int2simfloat(Proportion<HEM_EG_MAX_VALUE>(sustain[ch], HEMISPHERE_MAX_CV));
         if (sustain[ch] == 255) ticks_remaining = 0; // skip decay if sustain is maxed
         if (ticks_remaining <= 0) { // End of decay; move to sustain
             stage[ch] = HEM_EG_SUSTAIN;
             stage_ticks[ch] = 0;
-            amplitude[ch] = int2simfloat(Proportion(sustain[ch], HEM_EG_MAX_VALUE, HEMISPHERE_MAX_CV));
+            amplitude[ch] = int2simfloat(Proportion<HEM_EG_MAX_VALUE>(sustain[ch], HEMISPHERE_MAX_CV));
         } else {
             simfloat decrease = amplitude_remaining / ticks_remaining;
             amplitude[ch] -= decrease;
@@ -321,14 +321,14 @@ private:
 
     void SustainAmplitude(int ch) {
         //-ghostils:Update to reference current channel:
-        amplitude[ch] = int2simfloat(Proportion(sustain[ch] - 1, HEM_EG_MAX_VALUE, HEMISPHERE_MAX_CV));
+        amplitude[ch] = int2simfloat(Proportion<HEM_EG_MAX_VALUE>(sustain[ch] - 1, HEMISPHERE_MAX_CV));
     }
 
     void ReleaseAmplitude(int ch) {
         //-ghostils:Update to reference current channel:
         //-CV1 = ADSR A release MOD, CV2 = ADSR A release MOD
         int effective_release = constrain(release[ch] + release_mod[ch], 1, HEM_EG_MAX_VALUE) - 1;
-        int total_stage_ticks = Proportion(effective_release, HEM_EG_MAX_VALUE, HEM_EG_MAX_TICKS_R);
+        int total_stage_ticks = Proportion<HEM_EG_MAX_VALUE>(effective_release, HEM_EG_MAX_TICKS_R);
         int ticks_remaining = total_stage_ticks - stage_ticks[ch];
         if (effective_release == 0) ticks_remaining = 0;
         if (ticks_remaining <= 0 || amplitude[ch] <= 0) { // End of release; turn off envelope
@@ -343,7 +343,7 @@ private:
 
     int get_modification_with_input(int in) {
         int mod = 0;
-        mod = Proportion(DetentedIn(in), HEMISPHERE_MAX_INPUT_CV, HEM_EG_MAX_VALUE / 2);
+        mod = Proportion<HEMISPHERE_MAX_INPUT_CV>(DetentedIn(in), HEM_EG_MAX_VALUE / 2);
         return mod;
     }
 };
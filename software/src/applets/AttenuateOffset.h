@@ -42,7 +42,7 @@ public:
         
         ForEachChannel(ch)
         {
-            int signal = Proportion(level[ch], ATTENOFF_MAX_LEVEL, In(ch)) + (offset[ch] * ATTENOFF_INCREMENTS);
+            int signal = Proportion<ATTENOFF_MAX_LEVEL>(level[ch], In(ch)) + (offset[ch] * ATTENOFF_INCREMENTS);
             if (ch == 1 && mix_final) {
                 signal = signal + prevSignal;
             }
@@ -98,8 +98,8 @@ public:
         int32_t bd_signal = 0;
         int32_t sd_signal = 0;
         int32_t ns_signal = 0;
-        cv_kick = Proportion(DetentedIn(CH_KICK), HEMISPHERE_MAX_INPUT_CV, BNC_MAX_PARAM);
-        cv_snare = Proportion(DetentedIn(CH_SNARE), HEMISPHERE_MAX_INPUT_CV, BNC_MAX_PARAM);
+        cv_kick = Proportion<HEMISPHERE_MAX_INPUT_CV>(DetentedIn(CH_KICK), BNC_MAX_PARAM);
+        cv_snare = Proportion<HEMISPHERE_MAX_INPUT_CV>(DetentedIn(CH_SNARE), BNC_MAX_PARAM);
 
         // Kick drum
         if (cv_mode_kick == CV_MODE_TONE) {
@@ -134,14 +134,14 @@ public:
             int freq_kick = Proportion(_tone_kick, BNC_MAX_PARAM, 3000) + 3000;
             // punchy FM drop
             if (!env_punch.GetEOC()) {
-                int df = Proportion(env_punch.Next(), HEMISPHERE_3V_CV, freq_kick);
-                df = Proportion(_punch, BNC_MAX_PARAM/4, df);
+                int df = Proportion<HEMISPHERE_3V_CV>(env_punch.Next(), freq_kick);
+                df = Proportion<BNC_MAX_PARAM/4>(_punch, df);
                 freq_kick += df;
             }
             kick.SetFrequency(freq_kick);
             levels[0] = env_kick.Next();
             if (cv_mode_kick == CV_MODE_ATTEN) {
-                levels[0] = Proportion(BNC_MAX_PARAM - cv_kick, BNC_MAX_PARAM, levels[0]);
+                levels[0] = Proportion<BNC_MAX_PARAM>(BNC_MAX_PARAM - cv_kick, levels[0]);
             }
             bd_signal = Proportion(levels[0], HEMISPHERE_MAX_CV, kick.Next());
             // Because of overtones induced by the linear interpolation of the
@@ -183,8 +183,8 @@ public:
             int64_t freq_snare = Proportion(_tone_snare, BNC_MAX_PARAM, 600) + 100;
             freq_snare *= 100;
             if (!env_snap.GetEOC()) {
-                int64_t df = Proportion(env_snap.Next(), HEMISPHERE_3V_CV, freq_snare/1024);
-                df = Proportion(_snap, BNC_MAX_PARAM/4, df);
+                int64_t df = Proportion<HEMISPHERE_3V_CV>(env_snap.Next(), freq_snare/1024);
+                df = Proportion<BNC_MAX_PARAM/4>(_snap, df);
                 df *= 1024;
                 freq_snare += df;
             }
@@ -193,18 +193,18 @@ public:
             // noise levels
             levels[1] = env_noise.Next();
             if (cv_mode_snare == CV_MODE_ATTEN) {
-                levels[1] = Proportion(BNC_MAX_PARAM - cv_snare, BNC_MAX_PARAM, levels[1]);
+                levels[1] = Proportion<BNC_MAX_PARAM>(BNC_MAX_PARAM - cv_snare, levels[1]);
             }
-            ns_signal = Proportion(levels[1], HEMISPHERE_3V_CV, noise);
+            ns_signal = Proportion<HEMISPHERE_3V_CV>(levels[1], noise);
             filter_sv.feed(ns_signal, (Proportion(_tone_snare, BNC_MAX_PARAM, 60000) + 100000), 500);
             ns_signal = filter_sv.get_bp();
 
             // osc levels
             levels[2] = env_snare.Next();
             if (cv_mode_snare == CV_MODE_ATTEN) {
-                levels[2] = Proportion(BNC_MAX_PARAM - cv_snare, BNC_MAX_PARAM, levels[2]);
+                levels[2] = Proportion<BNC_MAX_PARAM>(BNC_MAX_PARAM - cv_snare, levels[2]);
             }
-            sd_signal = Proportion(levels[2], HEMISPHERE_3V_CV, snare.Next());
+            sd_signal = Proportion<HEMISPHERE_3V_CV>(levels[2], snare.Next());
             sd_signal = filter_lp2.filter(sd_signal, freq_snare);
 
             // blend osc and noise
@@ -0,0 +1,369 @@
+/*
+ * Long-form CV/gate looper. Records both CV inputs at up to one sample per
+ * tick into the slot's share of the buffer pool (PSRAM when fitted), packed
+ * with the CV stream codec, and loops them back with overdub and variable
+ * speed.
+ *
+ * The memory is split into two takes. While one plays, every pass is copied
+ * into the other, mixed with the inputs wherever overdub was on; at the end of
+ * a pass that had any overdub, the copy becomes the loop.
+ *
+ * Each take gets half the slot's share: 128K of PSRAM is at least 25s of busy
+ * CV at the default rate of /16, but only 1.5s at /1. Flat CV and held gates
+ * cost next to nothing. A take that fills up stops recording and plays; if the
+ * main loop falls behind instead, the pass stops short and "!" shows by Rate.
+ */
+
+#include "../HSCVStream.h"
+
+#define CVLOOPER_MAX_RATE 6 // capture every 2^rate ticks
+
+class CVLooper : public HemisphereApplet {
+public:
+
+    enum CVLooperCursor {
+        RATE, SPEED, TYPE_A, TYPE_B, TRANSPORT, CLEAR,
+
+        CURSOR_LAST = CLEAR
+    };
+
+    enum LooperState : uint8_t {
+        EMPTY, RECORDING, PLAYING, OVERDUB
+    };
+
+    const char* applet_name() {
+        return "CV Looper";
+    }
+    const uint8_t* applet_icon() { return LOOP_ICON; }
+
+    void Start() {
+        const size_t size = HS::buffer_pool.max_size() & ~size_t(1);
+        memory = (uint8_t*)RequestBuffer(size);
+        for (int i = 0; i < 2; ++i) {
+            take[i].data = memory + i * size / 2;
+            take[i].capacity = size / 2;
+        }
+        Clear();
+        AllowRestart(); // memory is released in Unload
+    }
+
+    void Unload() override {
+        writer.Abort();
+        if (memory) ReleaseBuffer();
+        memory = nullptr;
+        state = EMPTY;
+    }
+
+    void Idle() override {
+        writer.Idle();
+    }
+
+    void Controller() {
+        if (!memory || !BufferReady()) return;
+
+        if (clear_q) Clear();
+        if (Clock(0) || advance_q) Advance();
+        if (Clock(1)) Restart();
+        advance_q = clear_q = false;
+
+        switch (state) {
+        case EMPTY:
+            Monitor();
+            break;
+
+        case RECORDING:
+            if (--countdown <= 0) {
+                countdown = 1 << loop_rate;
+                if (!Capture(Input())) CloseLoop();
+            }
+            Monitor();
+            break;
+
+        case PLAYING:
+        case OVERDUB:
+            phase += speed;
+            while (phase >= (100 << loop_rate)) {
+                phase -= (100 << loop_rate);
+                if (!Step()) {
+                    phase = 0; // not flushed yet; hold
+                    break;
+                }
+            }
+            ForEachChannel(ch) {
+                if (gate_type & (1 << ch)) GateOut(ch, now.gates & (1 << ch));
+                else Out(ch, now.cv[ch]);
+            }
+            break;
+        }
+    }
+
+    void View() {
+        DrawInterface();
+    }
+
+    void OnButtonPress() {
+        // transport changes happen in Controller
+        if (cursor == TRANSPORT) advance_q = true;
+        else if (cursor == CLEAR) clear_q = true;
+        else CursorToggle();
+    }
+
+    void OnEncoderMove(int direction) {
+        if (!EditMode()) {
+            MoveCursor(cursor, direction, CURSOR_LAST);
+            return;
+        }
+
+        switch (cursor) {
+        case RATE:
+            rate = constrain(rate + direction, 0, CVLOOPER_MAX_RATE);
+            break;
+        case SPEED:
+            speed = constrain(speed + direction * 5, 25, 400);
+            break;
+        case TYPE_A:
+        case TYPE_B:
+            gate_type ^= 1 << (cursor - TYPE_A);
+            break;
+        default: break;
+        }
+    }
+
+    uint64_t OnDataRequest() {
+        uint64_t data = 0;
+        Pack(data, PackLocation {0,3}, rate);
+        Pack(data, PackLocation {3,9}, speed);
+        Pack(data, PackLocation {12,2}, gate_type);
+        return data;
+    }
+
+    void OnDataReceive(uint64_t data) {
+        rate = constrain(Unpack(data, PackLocation {0,3}), 0, CVLOOPER_MAX_RATE);
+        speed = constrain(Unpack(data, PackLocation {3,9}), 25, 400);
+        gate_type = Unpack(data, PackLocation {12,2});
+    }
+
+protected:
+  void SetHelp() {
+    //                    "-------" <-- Label size guide
+    help[HELP_DIGITAL1] = "Rec/Dub";
+    help[HELP_DIGITAL2] = "Restart";
+    help[HELP_CV1]      = "Input A";
+    help[HELP_CV2]      = "Input B";
+    help[HELP_OUT1]     = "Loop A";
+    help[HELP_OUT2]     = "Loop B";
+    help[HELP_EXTRA1] = "Rec>Play>Dub>Play";
+    help[HELP_EXTRA2] = "Busy CV 25s at /16";
+    //                  "---------------------" <-- Extra text size guide
+  }
+
+private:
+    int cursor = 0;
+
+    // settings
+    int rate = 4;      // capture every 2^rate ticks
+    int speed = 100;   // playback, percent
+    uint8_t gate_type = 0; // bit per channel: record as gate rather than CV
+
+    // memory and streams
+    uint8_t *memory = nullptr;
+    HS::StreamTake take[2];
+    HS::StreamWriter<> writer;
+    HS::CVStreamEncoder encoder;
+    HS::CVStreamDecoder decoder;
+
+    // transport
+    LooperState state = EMPTY;
+    bool advance_q = false;
+    bool clear_q = false;
+    int play = 0;          // take that's looping; the other is being written
+    int loop_rate = 4;     // rate the loop was recorded at; changes apply to the next one
+    int countdown = 0;
+    int phase = 0;
+    uint32_t frames = 0;    // given to the encoder this pass
+    uint32_t committed = 0; // of those, how many are in the take
+    uint32_t position = 0;  // playback, in frames
+    bool dubbed = false;    // this pass had overdub in it
+    bool dub_ok = false;    // and the copy is complete so far
+    bool overrun = false;   // a pass stopped short because the main loop fell behind
+    HS::CVFrame now;
+
+    HS::CVFrame Input() {
+        HS::CVFrame f;
+        ForEachChannel(ch) {
+            if (gate_type & (1 << ch)) {
+                if (In(ch) > GATE_THRESHOLD) f.gates |= 1 << ch;
+            } else {
+                f.cv[ch] = constrain(In(ch), -32768, 32767);
+            }
+        }
+        return f;
+    }
+
+    void Monitor() {
+        ForEachChannel(ch) Out(ch, In(ch));
+    }
+
+    // Starts a pass into take t
+    void BeginPass(int t) {
+        encoder.Reset();
+        writer.Start(take[t]);
+        frames = committed = 0;
+    }
+
+    // @return false if the frame couldn't be written
+    bool Capture(const HS::CVFrame &f) {
+        uint8_t buf[HS::CVStreamEncoder::MAX_BYTES];
+        const size_t n = encoder.Encode(f, buf);
+        ++frames;
+        if (n && !writer.Write(buf, n)) {
+            if (writer.overrun()) overrun = true;
+            return false;
+        }
+        committed = frames - encoder.pending();
+        return true;
+    }
+
+    // Ends the pass, with everything captured if it can be
+    uint32_t EndPass() {
+        uint8_t buf[HS::CVStreamEncoder::MAX_BYTES];
+        const size_t n = encoder.Flush(buf);
+        if (!n || writer.Write(buf, n)) committed = frames;
+        else if (writer.overrun()) overrun = true;
+        writer.Finish();
+        return committed;
+    }
+
+    void Clear() {
+        writer.Abort();
+        state = EMPTY;
+        now = HS::CVFrame();
+        play = 0;
+        overrun = false;
+    }
+
+    void Advance() {
+        switch (state) {
+        case EMPTY:
+            overrun = false;
+            BeginPass(play);
+            loop_rate = rate;
+            countdown = 0;
+            state = RECORDING;
+            break;
+        case RECORDING:
+            CloseLoop();
+            break;
+        case PLAYING:
+            dubbed = true;
+            state = OVERDUB;
+            break;
+        case OVERDUB:
+            state = PLAYING;
+            break;
+        }
+    }
+
+    // Stops recording and plays what was captured
+    void CloseLoop() {
+        take[play].length = EndPass();
+        if (take[play].length == 0) {
+            state = EMPTY;
+            return;
+        }
+        state = PLAYING;
+        Restart();
+    }
+
+    // Back to the top of the loop. Overdub since the last wrap is lost.
+    void Restart() {
+        if (state != PLAYING && state != OVERDUB) return;
+        if (dub_ok) writer.Finish();
+        decoder.Reset();
+        position = 0;
+        phase = 0;
+        BeginPass(1 - play);
+        dubbed = (state == OVERDUB);
+        dub_ok = true;
+    }
+
+    // Plays the next frame, and copies it over, with overdub
+    // @return false if its bytes aren't in the take yet
+    bool Step() {
+        const HS::StreamTake &t = take[play];
+        HS::CVFrame f;
+        if (!decoder.Next(t.data, t.flushed, f)) return false;
+
+        if (state == OVERDUB) {
+            const HS::CVFrame in = Input();
+            ForEachChannel(ch)
+                f.cv[ch] = constrain(f.cv[ch] + in.cv[ch], -32768, 32767);
+            f.gates |= in.gates;
+        }
+        if (dub_ok) dub_ok = Capture(f);
+        now = f;
+
+        if (++position >= t.length) {
+            // the end of the loop; keep the copy if it was overdubbed
+            const bool swap = dub_ok && dubbed && EndPass() == t.length;
+            if (!swap && dub_ok) writer.Finish();
+            if (swap) {
+                take[1 - play].length = t.length;
+                play = 1 - play;
+            }
+            decoder.Reset();
+            position = 0;
+            BeginPass(1 - play);
+            dubbed = (state == OVERDUB);
+            dub_ok = true;
+        }
+        return true;
+    }
+
+    void DrawInterface() {
+        // transport and loop length
+        const uint8_t *icon = (state == RECORDING || state == OVERDUB) ? RECORD_ICON
+                            : (state == PLAYING) ? PLAY_ICON : STOP_ICON;
+        if (state == EMPTY || state == PLAYING || CursorBlink()) gfxIcon(1, 15, icon);
+        const char *names[] = {"Empty", "Rec", "Play", "Dub"};
+        gfxPrint(11, 15, names[state]);
+        if (state != EMPTY) {
+            const uint32_t len = (state == RECORDING) ? frames : take[play].length;
+            // ticks are 60us
+            const uint32_t tenths = (uint64_t(len) << loop_rate) * 60 / 100000;
+            gfxPrint(35, 15, tenths / 10);
+            gfxPrint(".");
+            gfxPrint(tenths % 10);
+            gfxPrint("s");
+        }
+
+        gfxPrint(1, 25, "Rate /");
+        gfxPrint(1 << rate);
+        if (overrun) gfxPrint(57, 25, "!");
+        gfxPrint(1, 35, "Speed ");
+        gfxPrint(speed);
+        gfxPrint("%");
+
+        ForEachChannel(ch) {
+            gfxPrint(1 + ch * 32, 45, OutputLabel(ch));
+            gfxIcon(9 + ch * 32, 45, (gate_type & (1 << ch)) ? GATE_ICON : CV_ICON);
+        }
+
+        // memory used by the take being written, under the length, clear of
+        // the cursors
+        const HS::StreamTake &t = take[state == RECORDING ? play : 1 - play];
+        if (state != EMPTY && t.capacity)
+            gfxRect(1, 23, (uint64_t)t.size * 62 / t.capacity, 1);
+        gfxPrint(1, 54, "Rec");
+        gfxPrint(38, 54, "Clear");
+
+        switch (cursor) {
+        case RATE: gfxCursor(37, 33, 26); break;
+        case SPEED: gfxCursor(37, 43, 26); break;
+        case TYPE_A: gfxCursor(8, 53, 10); break;
+        case TYPE_B: gfxCursor(40, 53, 10); break;
+        case TRANSPORT: gfxCursor(1, 62, 19); break;
+        case CLEAR: gfxCursor(38, 62, 31); break;
+        }
+    }
+};
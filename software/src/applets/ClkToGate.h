@@ -46,6 +46,9 @@ public:
     void Reset() {
     }
 
+    // Only does anything on a clock
+    uint8_t ControlRate() { return CONTROL_RATE_EVENT; }
+
     void Controller() {
       ForEachChannel(ch) {
         if (Clock(ch)) {
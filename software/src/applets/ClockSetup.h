@@ -71,6 +71,15 @@ public:
             clock_m.DisableMIDIOut();
             clock_m.Start();
         }
+        if (frame.MIDIState.continue_q) {
+            frame.MIDIState.continue_q = 0;
+            clock_m.DisableMIDIOut();
+            if (frame.MIDIState.song_position >= 0) {
+                clock_m.SetSongPosition(frame.MIDIState.song_position);
+                frame.MIDIState.song_position = -1;
+            }
+            clock_m.Continue();
+        }
         if (frame.MIDIState.stop_q) {
             frame.MIDIState.stop_q = 0;
             clock_m.Stop();
@@ -81,15 +90,15 @@ public:
         if (clock_m.IsPaused() && clock_sync)
             clock_m.Start();
 
+        // With a fixed random seed, every stream restarts with the clock
+        const bool running = clock_m.IsRunning();
+        if (running && !was_running && HS::random_seed) HS::ReseedRandom();
+        was_running = running;
+
         // Advance internal clock, sync to external clock / reset
         if (clock_m.IsRunning())
             clock_m.SyncTrig( clock_sync );
 
-        // ------------ //
-        if (clock_m.IsRunning() && clock_m.MIDITock()) {
-            usbMIDI.sendRealTime(usbMIDI.Clock);
-        }
-
         // 4 internal clock flashers
         /*
         for (int i = 0; i < 4; ++i) {
@@ -173,6 +182,7 @@ public:
         case TRIG3:
         case TRIG4:
             HS::trigger_mapping[cursor-TRIG1] = constrain( HS::trigger_mapping[cursor-TRIG1] + direction, 0, TRIGMAP_MAX);
+            HS::CompileRoutes();
             break;
 
         case OUTSKIP1:
@@ -252,6 +262,7 @@ public:
         Pack(data, PackLocation { 1, 1 }, HS::cursor_wrap);
         Pack(data, PackLocation { 2, 2 }, HS::screensaver_mode);
         Pack(data, PackLocation { 4, 7 }, HS::trig_length);
+        Pack(data, PackLocation { 13, 3 }, HS::random_seed);
 
 #ifdef VOR
         // remember Vbias per preset
@@ -265,6 +276,8 @@ public:
         HS::cursor_wrap = Unpack(data, PackLocation { 1, 1 });
         HS::screensaver_mode = Unpack(data, PackLocation { 2, 2 });
         HS::trig_length = constrain( Unpack(data, PackLocation { 4, 7 }), 1, 127);
+        HS::random_seed = Unpack(data, PackLocation { 13, 3 });
+        HS::ReseedRandom();
 
 #ifdef VOR
         VBiasManager *v = v->get();
@@ -290,6 +303,7 @@ private:
     int button_ticker;
     int slide_anim = 0;
     uint32_t view_tick = 0;
+    bool was_running = false;
 
     static const int NR_OF_TAPS = 3;
 
@@ -78,6 +78,15 @@ public:
             HS::clock_m.DisableMIDIOut();
             HS::clock_m.Start();
         }
+        if (frame.MIDIState.continue_q) {
+            frame.MIDIState.continue_q = 0;
+            HS::clock_m.DisableMIDIOut();
+            if (frame.MIDIState.song_position >= 0) {
+                HS::clock_m.SetSongPosition(frame.MIDIState.song_position);
+                frame.MIDIState.song_position = -1;
+            }
+            HS::clock_m.Continue();
+        }
         if (frame.MIDIState.stop_q) {
             frame.MIDIState.stop_q = 0;
             HS::clock_m.Stop();
@@ -89,19 +98,15 @@ public:
             HS::clock_m.Start();
         // TODO: automatically stop...
 
+        // With a fixed random seed, every stream restarts with the clock
+        const bool running = HS::clock_m.IsRunning();
+        if (running && !was_running && HS::random_seed) HS::ReseedRandom();
+        was_running = running;
+
         // Advance internal clock, sync to external clock / reset
         if (HS::clock_m.IsRunning())
             HS::clock_m.SyncTrig( clock_sync );
 
-        // ------------ //
-        if (HS::clock_m.IsRunning() && HS::clock_m.MIDITock()) {
-          usbMIDI.sendRealTime(usbMIDI.Clock);
-          usbHostMIDI.sendRealTime(usbMIDI.Clock);
-#ifdef ARDUINO_TEENSY41
-          MIDI1.sendRealTime(midi::MidiType(usbMIDI.Clock));
-#endif
-        }
-
         // 8 internal clock flashers
         for (int i = 0; i < 8; ++i) {
             if (HS::clock_m.Tock(i))
@@ -183,6 +188,7 @@ public:
         case TRIG7:
         case TRIG8:
             HS::trigger_mapping[cursor-TRIG1] = constrain( HS::trigger_mapping[cursor-TRIG1] + direction, 0, TRIGMAP_MAX);
+            HS::CompileRoutes();
             break;
 
         /* the boops shall return in a hidden form
@@ -270,7 +276,8 @@ public:
         Pack(data, PackLocation { 2, 2 }, HS::screensaver_mode);
         Pack(data, PackLocation { 4, 7 }, HS::trig_length);
         Pack(data, PackLocation { 11, 5 }, HS::clock_m.GetClockPPQN());
-        // 48 bits free
+        Pack(data, PackLocation { 16, 3 }, HS::random_seed);
+        // 45 bits free
         return data;
     }
     void SetGlobals(const uint64_t &data) {
@@ -279,6 +286,8 @@ public:
         HS::screensaver_mode = Unpack(data, PackLocation { 2, 2 });
         HS::trig_length = constrain( Unpack(data, PackLocation { 4, 7 }), 1, 127);
         HS::clock_m.SetClockPPQN(Unpack(data, PackLocation { 11, 5 }));
+        HS::random_seed = Unpack(data, PackLocation { 16, 3 });
+        HS::ReseedRandom();
     }
 
 protected:
@@ -297,6 +306,7 @@ private:
     int button_ticker;
     int slide_anim = 0;
     uint32_t view_tick = 0;
+    bool was_running = false;
 
     static const int NR_OF_TAPS = 3;
 
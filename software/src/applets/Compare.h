@@ -34,7 +34,7 @@ public:
     }
 
     void Controller() {
-        int cv_level = Proportion(level, HEM_COMPARE_MAX_VALUE, HEMISPHERE_MAX_CV);
+        int cv_level = Proportion<HEM_COMPARE_MAX_VALUE>(level, HEMISPHERE_MAX_CV);
         mod_cv = cv_level + DetentedIn(1);
         mod_cv = constrain(mod_cv, 0, HEMISPHERE_MAX_CV);
 
@@ -57,6 +57,10 @@ public:
 
 
 
+    // The register only moves on clocks; the modulated values are for the
+    // display between them
+    uint8_t ControlRate() { return 8; }
+
     void Controller() {
         b_constant_mod = b_constant;
         Modulate(b_constant_mod, 1, 0, ACC_MAX_B);
@@ -22,14 +22,18 @@
  * with concepts from armandvedel, implementation by djphazer
  */
 
+#ifdef ARDUINO_TEENSY41
+#include "HSAudioKernels.h"
+#endif
+
 #define HEM_LOFI_PCM_BUFFER_SIZE 2048
 #define HEM_LOFI_PCM_SPEED 4
 
 // #define CLIPLIMIT 32512
 #define CLIPLIMIT HEMISPHERE_3V_CV
 
-#define PCM_TO_CV(S) Proportion((int)S - 127, 127, CLIPLIMIT)
-#define CV_TO_PCM(S) Proportion(constrain(S, -CLIPLIMIT, CLIPLIMIT), CLIPLIMIT, 127) + 127
+#define PCM_TO_CV(S) Proportion<127>((int)S - 127, CLIPLIMIT)
+#define CV_TO_PCM(S) Proportion<CLIPLIMIT>(constrain(S, -CLIPLIMIT, CLIPLIMIT), 127) + 127
 
 class DrLoFi : public HemisphereApplet {
 public:
@@ -42,18 +46,24 @@ public:
 
     void Start() {
         countdown = HEM_LOFI_PCM_SPEED;
-        // this might take too long, which causes crashes. It's not crucial.
-        //for (int i = 0; i < HEM_LOFI_PCM_BUFFER_SIZE; i++) lofi_pcm_buffer[i] = 127;
         cursor = 1; //for gui
-        lofi_pcm_buffer = new uint8_t[HEM_LOFI_PCM_BUFFER_SIZE];
+        // filled with silence (127) by the main loop, not here in the ISR
+        lofi_pcm_buffer = (uint8_t*)RequestBuffer(HEM_LOFI_PCM_BUFFER_SIZE, 127);
         AllowRestart();
+#ifdef ARDUINO_TEENSY41
+        crush.Set(HS::BitCrushKernel::Params()); // passes audio through until enabled
+        AttachAudio(&crush);
+#endif
     }
 
     void Unload() override {
-        delete lofi_pcm_buffer;
+        if (lofi_pcm_buffer) ReleaseBuffer();
+        lofi_pcm_buffer = nullptr;
     }
 
     void Controller() {
+        if (!lofi_pcm_buffer || !BufferReady()) return;
+
         play = !Gate(0); // Continuously play unless gated
         fdbk_g = Gate(1) ? 100 : feedback; // Feedback = 100 when gated
 
@@ -86,6 +96,16 @@ public:
             SmoothedOut(0, PCM_TO_CV(lofi_pcm_buffer[head]), (rate_mod+1)/2);
             SmoothedOut(1, PCM_TO_CV(lofi_pcm_buffer[length-1 - head]), (rate_mod+1)/2); // reverse buffer!
         }
+
+#ifdef ARDUINO_TEENSY41
+        // the same sample rate and depth on this side's audio output
+        HS::BitCrushKernel::Params p;
+        if (crush_audio) {
+            p.rate = rate_mod;
+            p.depth = depth;
+        }
+        crush.Set(p);
+#endif
     }
 
     void View() {
@@ -97,7 +117,7 @@ public:
 
     void OnEncoderMove(int direction) {
         if (!EditMode()) {
-            MoveCursor(cursor, direction, 3);
+            MoveCursor(cursor, direction, LOFI_LAST_SETTING);
             return;
         }
 
@@ -114,6 +134,11 @@ public:
         case 3:
             depth = constrain(depth + direction, 0, 13);
             break;
+#ifdef ARDUINO_TEENSY41
+        case 4:
+            crush_audio = !crush_audio;
+            break;
+#endif
         }
     }
 
@@ -123,6 +148,7 @@ public:
         Pack(data, PackLocation {7,7}, feedback);
         Pack(data, PackLocation {14,5}, rate);
         Pack(data, PackLocation {19,4}, depth);
+        Pack(data, PackLocation {23,1}, crush_audio);
         return data;
     }
 
@@ -131,6 +157,7 @@ public:
         feedback = Unpack(data, PackLocation {7,7});
         rate = Unpack(data, PackLocation {14,5});
         depth = Unpack(data, PackLocation {19,4});
+        crush_audio = Unpack(data, PackLocation {23,1});
     }
 
 protected:
@@ -143,11 +170,22 @@ protected:
     help[HELP_OUT1]     = "Signal";
     help[HELP_OUT2]     = "Reverse";
     help[HELP_EXTRA1] = "Set: Time / Feedback";
+#ifdef ARDUINO_TEENSY41
+    help[HELP_EXTRA2] = "Rate / Crush / Audio";
+#else
     help[HELP_EXTRA2] = "SamplRate / Bitcrush";
+#endif
     //                  "---------------------" <-- Extra text size guide
   }
 
 private:
+#ifdef ARDUINO_TEENSY41
+    static constexpr int LOFI_LAST_SETTING = 4;
+    HS::BitCrushKernel crush;
+#else
+    static constexpr int LOFI_LAST_SETTING = 3;
+#endif
+    bool crush_audio = 0; // SamplRate and Bitcrush apply to the audio output too
     bool play = 0; //play always on unless gated on Digital 1
     uint16_t head = 0; // Location of read/play head
     uint16_t head_w = 0; // Location of write/record head
@@ -160,9 +198,10 @@ private:
     int depth = 0; // bit reduction depth aka bitcrush
     int cursor; //for gui
 
-    uint8_t* lofi_pcm_buffer;
+    uint8_t* lofi_pcm_buffer = nullptr;
     
     void DrawWaveform() {
+        if (!lofi_pcm_buffer) return;
         int inc = rate_mod/2 + 1;
         int pos = head - (inc * 31) - random(1,3); // Try to center the head
         if (pos < 0) pos += length;
@@ -185,7 +224,7 @@ private:
             gfxPrint(4 + pad(100, dt_pct), 15, dt_pct);
             gfxPrint(36 + pad(1000, fdbk_g), 15, fdbk_g);
             gfxCursor(10 + 31 * cursor, 23, 20);
-        } else {
+        } else if (cursor < 4) {
             gfxIcon(0, 15, WAVEFORM_ICON);
             gfxIcon(8, 15, BURST_ICON);
             gfxIcon(22, 15, LEFT_RIGHT_ICON);
@@ -193,6 +232,11 @@ private:
             gfxIcon(42, 15, UP_DOWN_ICON);
             gfxPrint(50, 15, depth);
             gfxCursor(30 + (cursor-2)*20, 23, 14);
+        } else {
+            gfxIcon(0, 15, WAVEFORM_ICON);
+            gfxPrint(10, 15, "Audio");
+            gfxIcon(44, 15, crush_audio ? CHECK_ON_ICON : CHECK_OFF_ICON);
+            gfxCursor(43, 23, 10);
         }
     }
 
@@ -25,6 +25,7 @@
 #else
 #include "../grids_resources.h"
 #endif
+#include "../HSDrumMap.h"
 
 #define HEM_DRUMMAP_PULSE_ANIMATION_TICKS 1000
 #define HEM_DRUMMAP_VALUE_ANIMATION_TICKS 16000
@@ -69,6 +70,8 @@ public:
           break;
         }
 
+        cache.Request(_x, _y);
+
         if (Clock(1)) Reset();
 
         if (Clock(0)) {
@@ -82,20 +85,12 @@ public:
             ForEachChannel(ch) {
                 // accent on ch 1 will be for whatever part ch 0 is set to
                 uint8_t part = (ch == 1 && mode[ch] == 3) ? mode[0] : mode[ch];
-                int level = ReadDrumMap(step, part, _x, _y);
-                level = constrain(level + randomness[part], 0, MAX_VAL);
+                const uint8_t level = cache.Level(step, part, _x, _y);
                 // use ch 0 fill if ch 1 is in accent mode
-                uint8_t threshold = (ch == 1 && mode[ch] == 3) ? ~_fill[0] : ~_fill[ch];
-                if (level > threshold) {
-                    if (mode[ch] < 3) {
-                        // normal part
-                        ClockOut(ch);
-                        pulse_animation[ch] = HEM_DRUMMAP_PULSE_ANIMATION_TICKS;
-                    } else if (level > 192) {
-                        // accent
-                        ClockOut(ch);
-                        pulse_animation[ch] = HEM_DRUMMAP_PULSE_ANIMATION_TICKS;
-                    }
+                const bool accent = (ch == 1 && mode[ch] == 3);
+                if (HS::DrumMapFires(level, randomness[part], accent ? _fill[0] : _fill[ch], accent)) {
+                    ClockOut(ch);
+                    pulse_animation[ch] = HEM_DRUMMAP_PULSE_ANIMATION_TICKS;
                 }
             }
 
@@ -133,6 +128,10 @@ public:
         DrawInterface();
     }
 
+    void Idle() override {
+        cache.Update();
+    }
+
     //void OnButtonPress() { }
 
     void OnEncoderMove(int direction) {
@@ -259,26 +258,8 @@ private:
     int _chaos = 0;
     int8_t cv_mode = 0; // 0 = Fill A/B, 1 = X/Y, 2 = Fill A/Chaos
 
-    uint8_t ReadDrumMap(uint8_t step, uint8_t part, uint8_t x, uint8_t y) {
-      uint8_t i = x >> 6;
-      uint8_t j = y >> 6;
-      const uint8_t* a_map = grids::drum_map[i][j];
-      const uint8_t* b_map = grids::drum_map[i + 1][j];
-      const uint8_t* c_map = grids::drum_map[i][j + 1];
-      const uint8_t* d_map = grids::drum_map[i + 1][j + 1];
-      uint8_t offset = (part * 32) + step;
-      uint8_t a = a_map[offset];
-      uint8_t b = b_map[offset];
-      uint8_t c = c_map[offset];
-      uint8_t d = d_map[offset];
-      uint8_t quad_x = x << 2;
-      uint8_t quad_y = y << 2;
-      // return U8Mix(U8Mix(a, b, x << 2), U8Mix(c, d, x << 2), y << 2);
-      // U8Mix returns b * x + a * (255 - x) >> 8 
-      uint8_t ab_fade = (b * quad_x + a * (255 - quad_x)) >> 8;
-      uint8_t cd_fade = (d * quad_x + c * (255 - quad_x)) >> 8;
-      return (cd_fade * quad_y + ab_fade * (255 - quad_y)) >> 8;
-    }
+    // levels at (_x, _y), refreshed from Idle()
+    HS::DrumMapCache cache{&grids::drum_map[0][0]};
     
     void DrawInterface() {
         // output selection
@@ -358,7 +339,7 @@ private:
     void DrawTracks(int y, int ch) {
         uint8_t part = (ch == 1 && mode[ch] == 3) ? mode[0] : mode[ch];
         for (int i=0; i < 32; i++) {
-            int level = ReadDrumMap((step + i) % 32, part, _x, _y);
+            int level = cache.Level((step + i) % 32, part, _x, _y);
             int h = level >> 6;
             if (level > 0) h++;
             gfxRect(2 * i, y + 4 - h, 2, h);
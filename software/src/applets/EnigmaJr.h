@@ -47,6 +47,9 @@ public:
         length = tm_state.GetLength();
     }
 
+    // Only does anything on a clock
+    uint8_t ControlRate() { return CONTROL_RATE_EVENT; }
+
     void Controller() {
         if (Clock(1)) {
             Reset();
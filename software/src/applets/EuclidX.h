@@ -70,6 +70,10 @@ public:
         step = 0;
     }
 
+    // Clocks step the pattern straight away; the pattern itself only needs
+    // to catch up with edits for the display
+    uint8_t ControlRate() { return 8; }
+
     void Controller() {
         if (Clock(1)) Reset();
 
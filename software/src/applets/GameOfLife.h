@@ -23,6 +23,9 @@ public:
         AddToBoard(32, 28);
     }
 
+    // The board only advances on clocks; density outputs can lag a little
+    uint8_t ControlRate() { return 8; }
+
     void Controller() {
         tx = ProportionCV(In(0), 63);
         ty = ProportionCV(In(1), 39);
@@ -54,7 +57,7 @@ public:
     }
 
     void OnEncoderMove(int direction) {
-        weight = constrain(weight += direction, 0, 100);
+        weight = constrain(weight + direction, 0, 100);
     }
 
     uint64_t OnDataRequest() {
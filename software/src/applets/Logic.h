@@ -84,9 +84,9 @@ public:
             return;
         }
 
-        operation[selected] += direction;
-        if (operation[selected] == HEMISPHERE_NUMBER_OF_LOGIC) operation[selected] = 0;
-        if (operation[selected] < 0) operation[selected] = HEMISPHERE_NUMBER_OF_LOGIC - 1;
+        // wrap around, also for accelerated moves of more than one step
+        operation[selected] = (operation[selected] + direction) % HEMISPHERE_NUMBER_OF_LOGIC;
+        if (operation[selected] < 0) operation[selected] += HEMISPHERE_NUMBER_OF_LOGIC;
     }
 
     uint64_t OnDataRequest() {
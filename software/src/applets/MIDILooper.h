@@ -0,0 +1,341 @@
+/*
+ * MIDI looper. Records channel messages from any MIDI input, timed against
+ * the clock's beats, and loops them back out over MIDI, with the last note as
+ * pitch and gate on the outputs. Overdub adds a layer per pass; Undo takes
+ * the last one back off. Playback can be quantized without touching the
+ * recording.
+ */
+
+#include "../HSMIDILoop.h"
+
+#define MIDILOOPER_MAX_BYTES 16384
+
+class MIDILooper : public HemisphereApplet {
+public:
+
+    enum MIDILooperCursor {
+        CHANNEL, QUANTIZE, TRANSPORT, UNDO, CLEAR,
+
+        CURSOR_LAST = CLEAR
+    };
+
+    enum LooperState : uint8_t {
+        EMPTY, RECORDING, PLAYING, OVERDUB
+    };
+
+    const char* applet_name() {
+        return "MIDI Loop";
+    }
+    const uint8_t* applet_icon() { return MIDI_ICON; }
+
+    void Start() {
+        size_t size = HS::buffer_pool.max_size();
+        if (size > MIDILOOPER_MAX_BYTES) size = MIDILOOPER_MAX_BYTES;
+        memory = (uint8_t*)RequestBuffer(size);
+        loop.Init(memory, size);
+        Clear();
+        AllowRestart(); // memory is released in Unload
+    }
+
+    void Unload() override {
+        Silence();
+        if (memory) ReleaseBuffer();
+        memory = nullptr;
+        loop.Init(nullptr, 0);
+        state = EMPTY;
+    }
+
+    void Controller() {
+        Pulse();
+        if (!memory || !BufferReady()) return;
+
+        if (clear_q) Clear();
+        if (Clock(0) || advance_q) Advance();
+        if (Clock(1) || undo_q) Undo();
+        advance_q = undo_q = clear_q = false;
+
+        const uint32_t now = pulse - origin;
+        if (state == OVERDUB && now / loop.length() != dub_pass) NextDubPass(now);
+        if (state == RECORDING || state == OVERDUB) RecordInput(now);
+        if (state == PLAYING || state == OVERDUB) Play(now);
+
+        Out(0, MIDIQuantizer::CV(last_note));
+        GateOut(1, notes_on > 0);
+    }
+
+    void View() {
+        DrawInterface();
+    }
+
+    void OnButtonPress() {
+        // transport changes happen in Controller
+        if (cursor == TRANSPORT) advance_q = true;
+        else if (cursor == UNDO) undo_q = true;
+        else if (cursor == CLEAR) clear_q = true;
+        else CursorToggle();
+    }
+
+    void OnEncoderMove(int direction) {
+        if (!EditMode()) {
+            MoveCursor(cursor, direction, CURSOR_LAST);
+            return;
+        }
+
+        switch (cursor) {
+        case CHANNEL:
+            channel = constrain(channel + direction, 0, 16);
+            break;
+        case QUANTIZE:
+            quantize = constrain(quantize + direction, 0, QUANTIZE_COUNT - 1);
+            player.set_quantize(grid[quantize]);
+            break;
+        default: break;
+        }
+    }
+
+    uint64_t OnDataRequest() {
+        uint64_t data = 0;
+        Pack(data, PackLocation {0,5}, channel);
+        Pack(data, PackLocation {5,3}, quantize);
+        return data;
+    }
+
+    void OnDataReceive(uint64_t data) {
+        channel = constrain(Unpack(data, PackLocation {0,5}), 0, 16);
+        quantize = constrain(Unpack(data, PackLocation {5,3}), 0, QUANTIZE_COUNT - 1);
+        player.set_quantize(grid[quantize]);
+    }
+
+protected:
+  void SetHelp() {
+    //                    "-------" <-- Label size guide
+    help[HELP_DIGITAL1] = "Rec/Dub";
+    help[HELP_DIGITAL2] = "Undo";
+    help[HELP_CV1]      = "";
+    help[HELP_CV2]      = "";
+    help[HELP_OUT1]     = "Pitch";
+    help[HELP_OUT2]     = "Gate";
+    help[HELP_EXTRA1] = "Rec>Play>Dub>Play";
+    help[HELP_EXTRA2] = "MIDI in, loop out";
+    //                  "---------------------" <-- Extra text size guide
+  }
+
+private:
+    static constexpr int QUANTIZE_COUNT = 7;
+    const uint32_t grid[QUANTIZE_COUNT] = {0, 960, 480, 320, 240, 160, 120};
+    const char * const grid_name[QUANTIZE_COUNT] = {"Off", "1/4", "1/8", "1/8T", "1/16", "1/16T", "1/32"};
+
+    int cursor = 0;
+
+    // settings
+    int channel = 0;  // 0 is omni, or 1-16
+    int quantize = 0;
+
+    // memory
+    uint8_t *memory = nullptr;
+    HS::MIDILoop loop;
+    HS::MIDILoopPlayer player;
+
+    // time, in pulses at the clock's tempo
+    uint32_t pulse = 0;
+    uint32_t phase = 0;
+    uint32_t origin = 0;   // first beat of the loop
+    uint32_t dub_pass = 0; // pass of the loop being overdubbed
+
+    // transport
+    LooperState state = EMPTY;
+    bool advance_q = false;
+    bool undo_q = false;
+    bool clear_q = false;
+    bool full = false;
+
+    // what's sounding
+    uint16_t held[128] = {0}; // channels holding each note, from playback
+    int notes_on = 0;
+    uint8_t last_note = 60;
+
+    // Counts pulses at the clock's tempo, and lines them up with its beats
+    void Pulse() {
+        const uint32_t ticks_per_beat = HS::clock_m.ticks_per_beat;
+        phase += HS::MIDILOOP_PPQN;
+        while (phase >= ticks_per_beat) {
+            phase -= ticks_per_beat;
+            ++pulse;
+        }
+        if (HS::clock_m.IsRunning() && HS::clock_m.EndOfBeat()) {
+            pulse = (pulse + HS::MIDILOOP_PPQN / 2) / HS::MIDILOOP_PPQN * HS::MIDILOOP_PPQN;
+            phase = 0;
+        }
+    }
+
+    void RecordInput(const uint32_t now) {
+        const int count = frame.MIDIState.Received();
+        for (int i = 0; i < count; ++i) {
+            const HS::MIDIMessage &msg = frame.MIDIState.rx[i];
+            if (channel && (msg.status & 0x0f) != channel - 1) continue;
+
+            const uint32_t time = (state == RECORDING) ? now : now - dub_pass * loop.length();
+            if (!loop.Record(time, msg.status, msg.data1, msg.data2)) full = true;
+            if (state == RECORDING) Voice(msg);
+        }
+    }
+
+    void Play(const uint32_t now) {
+        HS::MIDIEvent events[8];
+        const int count = player.Advance(now, events, 8);
+        for (int i = 0; i < count; ++i) {
+            const HS::MIDIMessage msg = {events[i].status, events[i].data1, events[i].data2};
+            frame.MIDIState.SendMessage(msg);
+            Voice(msg);
+            Hold(msg);
+        }
+    }
+
+    // Follows notes on the outputs
+    void Voice(const HS::MIDIMessage &msg) {
+        const uint8_t type = msg.status & 0xf0;
+        if (type == 0x90 && msg.data2) {
+            last_note = msg.data1;
+            ++notes_on;
+        } else if ((type == 0x80 || type == 0x90) && notes_on) {
+            --notes_on;
+        }
+    }
+
+    // Keeps track of notes sent, so they can be stopped
+    void Hold(const HS::MIDIMessage &msg) {
+        const uint8_t type = msg.status & 0xf0;
+        const uint16_t bit = 1 << (msg.status & 0x0f);
+        if (type == 0x90 && msg.data2) held[msg.data1] |= bit;
+        else if (type == 0x80 || type == 0x90) held[msg.data1] &= ~bit;
+    }
+
+    // Note-offs for everything playback left on
+    void Silence() {
+        for (uint8_t note = 0; note < 128; ++note) {
+            for (uint8_t ch = 0; held[note]; ++ch) {
+                if (!(held[note] & (1 << ch))) continue;
+                frame.MIDIState.SendMessage({uint8_t(0x80 | ch), note, 0});
+                held[note] &= ~(1 << ch);
+            }
+        }
+        notes_on = 0;
+    }
+
+    void Clear() {
+        Silence();
+        loop.Clear();
+        player.Start(loop, 0);
+        player.set_quantize(grid[quantize]);
+        state = EMPTY;
+        full = false;
+    }
+
+    void Advance() {
+        const uint32_t now = pulse - origin;
+        switch (state) {
+        case EMPTY:
+            if (!loop.BeginLayer()) break;
+            origin = pulse / HS::MIDILOOP_PPQN * HS::MIDILOOP_PPQN;
+            notes_on = 0;
+            state = RECORDING;
+            break;
+        case RECORDING:
+            CloseLoop(now);
+            break;
+        case PLAYING:
+            if (loop.BeginLayer()) {
+                dub_pass = now / loop.length();
+                state = OVERDUB;
+            } else full = true;
+            break;
+        case OVERDUB:
+            // what was just played in goes round from the next pass
+            EndDubPass((now / loop.length() + 1) * loop.length());
+            state = PLAYING;
+            break;
+        }
+    }
+
+    // Ends the first pass at the next beat, and plays it from there
+    void CloseLoop(const uint32_t now) {
+        loop.EndLayer();
+        notes_on = 0;
+        if (!loop.layers()) {
+            state = EMPTY;
+            return;
+        }
+        uint32_t beats = (now + HS::MIDILOOP_PPQN - 1) / HS::MIDILOOP_PPQN;
+        if (beats == 0) beats = 1;
+        loop.set_length(beats * HS::MIDILOOP_PPQN);
+        player.Start(loop, loop.length());
+        state = PLAYING;
+    }
+
+    void EndDubPass(const uint32_t base) {
+        const int before = loop.closed_layers();
+        loop.EndLayer();
+        if (loop.closed_layers() > before) player.AddLayer(base);
+    }
+
+    // Each pass of overdub is a layer of its own, for Undo
+    void NextDubPass(const uint32_t now) {
+        EndDubPass(now / loop.length() * loop.length());
+        dub_pass = now / loop.length();
+        if (!loop.BeginLayer()) {
+            full = true;
+            state = PLAYING;
+        }
+    }
+
+    void Undo() {
+        if (state == EMPTY) return;
+        if (state == RECORDING || loop.layers() == 1) {
+            Clear();
+            return;
+        }
+        loop.Undo();
+        player.Drop();
+        Silence();
+        full = false;
+        state = PLAYING;
+    }
+
+    void DrawInterface() {
+        // transport and loop length
+        const uint8_t *icon = (state == RECORDING || state == OVERDUB) ? RECORD_ICON
+                            : (state == PLAYING) ? PLAY_ICON : STOP_ICON;
+        if (state == EMPTY || state == PLAYING || CursorBlink()) gfxIcon(1, 15, icon);
+        const char *names[] = {"Empty", "Rec", "Play", "Dub"};
+        gfxPrint(11, 15, names[state]);
+        if (state != EMPTY) {
+            const uint32_t pulses = (state == RECORDING) ? pulse - origin : loop.length();
+            gfxPrint(38, 15, (int)(pulses / HS::MIDILOOP_PPQN));
+            gfxPrint("b");
+        }
+
+        gfxPrint(1, 25, "Ch ");
+        if (channel) gfxPrint(channel);
+        else gfxPrint("Omni");
+        gfxPrint(1, 35, "Q ");
+        gfxPrint(grid_name[quantize]);
+
+        // layers and memory
+        gfxPrint(1, 45, full ? "Full" : "Lyr ");
+        if (!full) gfxPrint(loop.layers());
+        if (loop.capacity())
+            gfxRect(33, 48, (uint64_t)loop.size() * 30 / loop.capacity() + 1, 3);
+
+        gfxPrint(1, 55, "Rec");
+        gfxPrint(22, 55, "Undo");
+        gfxPrint(49, 55, "Clr");
+
+        switch (cursor) {
+        case CHANNEL: gfxCursor(19, 33, 25); break;
+        case QUANTIZE: gfxCursor(13, 43, 31); break;
+        case TRANSPORT: gfxCursor(1, 63, 19); break;
+        case UNDO: gfxCursor(22, 63, 25); break;
+        case CLEAR: gfxCursor(49, 63, 19); break;
+        }
+    }
+};
@@ -28,6 +28,9 @@ public:
 
     void Start() { }
 
+    // Only does anything on a clock or tock
+    uint8_t ControlRate() { return CONTROL_RATE_EVENT; }
+
     void Controller() {
         // Check the clock so that the little Metronome icon animates while
         // Metronome is selected
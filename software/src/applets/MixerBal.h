@@ -36,11 +36,11 @@ public:
         int signal1 = In(0);
         int signal2 = In(1);
 
-        int mix1 = Proportion(balance, MIXER_MAX_VALUE, signal2)
-                 + Proportion(MIXER_MAX_VALUE - balance, MIXER_MAX_VALUE, signal1);
+        int mix1 = Proportion<MIXER_MAX_VALUE>(balance, signal2)
+                 + Proportion<MIXER_MAX_VALUE>(MIXER_MAX_VALUE - balance, signal1);
 
-        int mix2 = Proportion(balance, MIXER_MAX_VALUE, signal1)
-                 + Proportion(MIXER_MAX_VALUE - balance, MIXER_MAX_VALUE, signal2);
+        int mix2 = Proportion<MIXER_MAX_VALUE>(balance, signal1)
+                 + Proportion<MIXER_MAX_VALUE>(MIXER_MAX_VALUE - balance, signal2);
 
         Out(0, mix1);
         Out(1, mix2);
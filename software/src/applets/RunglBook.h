@@ -32,6 +32,9 @@ public:
         threshold = (12 << 7) * 2;
     }
 
+    // Only does anything on a clock
+    uint8_t ControlRate() { return CONTROL_RATE_EVENT; }
+
     void Controller() {
         if (Clock(0)) {
             if (Gate(1)) {
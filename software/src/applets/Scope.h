@@ -73,7 +73,7 @@ public:
                 ++sample_num %= 128;
 
                 for (int n = 0; n < 2; n++) {
-                  int sample = Proportion(In(n) + HEMISPHERE_MAX_INPUT_CV, 2*HEMISPHERE_MAX_INPUT_CV, 255);
+                  int sample = Proportion<2*HEMISPHERE_MAX_INPUT_CV>(In(n) + HEMISPHERE_MAX_INPUT_CV, 255);
                   sample = constrain(sample, 0, 255);
                   snapshot[n][sample_num] = (uint8_t)sample;
                 }
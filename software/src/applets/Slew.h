@@ -46,10 +46,10 @@ public:
                 simfloat remaining = input - signal[ch];
 
                 // The number of ticks it would take to get from 0 to HEMISPHERE_MAX_INPUT_CV
-                int max_change = Proportion(segment, HEM_SLEW_MAX_VALUE, HEM_SLEW_MAX_TICKS);
+                int max_change = Proportion<HEM_SLEW_MAX_VALUE>(segment, HEM_SLEW_MAX_TICKS);
 
                 // The number of ticks it would take to move the remaining amount at max_change
-                int ticks_to_remaining = Proportion(simfloat2int(remaining), HEMISPHERE_MAX_INPUT_CV, max_change);
+                int ticks_to_remaining = Proportion<HEMISPHERE_MAX_INPUT_CV>(simfloat2int(remaining), max_change);
                 if (ticks_to_remaining < 0) ticks_to_remaining = -ticks_to_remaining;
 
                 simfloat delta;
@@ -72,6 +72,9 @@ public:
         reverse = (dir != 2) ? 0 : 1;  // Reset reverse (really just for up/down mode)
     }
 
+    // Steps only move on clocks; CV position control is polled
+    uint8_t ControlRate() { return 4; }
+
     void Controller() {
 
         int curr_step_pv = curr_step;  // Detect if an input changes the step this update
@@ -170,7 +173,7 @@ public:
           // Compute a new random offset if required
           if(rand)
           {
-            cv_rand = Proportion(1, steps, HEMISPHERE_MAX_CV);  // 0-5v, scaled with fixed-point
+            cv_rand = step_proportion(1, steps, HEMISPHERE_MAX_CV);  // 0-5v, scaled with fixed-point
             cv_rand = random(0, cv_rand/4);  // Deviate up to 1/x step amount
             // Randomly choose offset direction
             cv_rand *= (random(0,100) > 50) ? 1 : -1;
@@ -178,7 +181,7 @@ public:
         }
 
         // Steps will either be counting up or down, but it will always be an index into the cv range
-        cv_out = Proportion(curr_step, steps, HEMISPHERE_MAX_CV);  // 0-5v, scaled with fixed-point
+        cv_out = step_proportion(curr_step, steps, HEMISPHERE_MAX_CV);  // 0-5v, scaled with fixed-point
         if(rand && (curr_step != 0 && curr_step != steps))  // Don't randomize 1st and last steps so it always hits 0 and 5v?
         {
           cv_out += cv_rand;
@@ -274,6 +277,7 @@ private:
     int cv_out;       // CV currently being output (track for display)
 
     int cv_rand;            // track last computed random offset for cv
+    CachedProportion step_proportion; // steps rarely changes
     bool step_cv_lock;      // 1 if cv is controlling the current step (show on display)
     bool position_cv_lock;  // 1 if cv is controlling the current step (show on display)
     bool reset_gate;        // Track if currently held in reset (show an icon)
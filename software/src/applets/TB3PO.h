@@ -390,8 +390,7 @@ private:
   }
 
   void reseed() {
-    randomSeed(micros());
-    seed = random(0, 65535); // 16 bits
+    seed = random(0, 65535); // 16 bits, from this slot's stream
     regenerate_all();
   }
 
@@ -415,6 +414,8 @@ private:
       return;
     }
 
+    // Patterns come from the global Arduino generator, not the slot stream, so that
+    // seeds saved before the streams existed still give the same pattern
     randomSeed(seed + regenerate_phase); // Ensure random()'s seed at each phase for determinism (note: offset to decouple phase behavior correllations that would result)
 
     switch (regenerate_phase) {
@@ -479,7 +480,7 @@ private:
       if (s > 0 && rand_bit(force_repeat_note_prob)) {
         notes[s] = notes[s - 1];
       } else {
-        notes[s] = random(0, available_pitches + 1); // Looking at the source, random(min,max) appears to return the range: min to max-1
+        notes[s] = ::random(0, available_pitches + 1); // Looking at the source, random(min,max) appears to return the range: min to max-1
 
         oct_ups <<= 1;
         oct_downs <<= 1;
@@ -572,7 +573,7 @@ private:
   }
 
   int rand_bit(int prob) {
-    return (random(1, 100) <= prob) ? 1 : 0;
+    return (::random(1, 100) <= prob) ? 1 : 0;
   }
 
   // deprecated - only used to cache num_notes
@@ -41,6 +41,9 @@ public:
         ForEachChannel(ch) step[ch] = -1;
     }
 
+    // Only does anything on a clock
+    uint8_t ControlRate() { return CONTROL_RATE_EVENT; }
+
     void Controller() {
         if (Clock(1)) {
             Reset();
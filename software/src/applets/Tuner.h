@@ -71,6 +71,9 @@ public:
       }
     }
 
+    // FreqMeasure buffers readings between calls
+    uint8_t ControlRate() { return 4; }
+
     void Controller() {
         if (TUNER_ENABLED && freq_measure.available())
         {
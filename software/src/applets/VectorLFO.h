@@ -222,6 +222,7 @@ private:
     void SwitchWaveform(byte ch, int waveform) {
         osc[ch] = WaveformManager::VectorOscillatorFromWaveform(waveform);
         waveform_number[ch] = waveform;
+        osc[ch].PhaseMode();
         osc[ch].SetFrequency(freq[ch]);
 #ifdef NORTHERNLIGHT
         osc[ch].Offset((12 << 7) * 4);
@@ -172,6 +172,7 @@ private:
     void SwitchWaveform(byte ch, int waveform) {
         osc[ch] = WaveformManager::VectorOscillatorFromWaveform(waveform);
         waveform_number[ch] = waveform;
+        osc[ch].PhaseMode();
         osc[ch].SetScale(HEMISPHERE_MAX_CV);
     }
 };
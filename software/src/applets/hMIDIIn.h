@@ -23,6 +23,9 @@
 #ifndef _HEM_H_MIDI_IN_H_
 #define _HEM_H_MIDI_IN_H_
 
+// Short names for HS::VoiceAllocMode
+const char* const midi_voice_mode_name[HS::VOICE_MODE_COUNT] = {"Uni", "Lst", "Low", "Hi", "Rot"};
+
 class hMIDIIn : public HemisphereApplet {
 public:
 
@@ -31,6 +34,7 @@ public:
         MIDI_CHANNEL_B,
         OUTPUT_MODE_A,
         OUTPUT_MODE_B,
+        VOICE_MODE,
         LOG_VIEW,
 
         MIDI_CURSOR_LAST = LOG_VIEW
@@ -50,6 +54,8 @@ public:
             frame.MIDIState.outputs[ch_] = 0;
             Out(ch, 0);
         }
+        voice_mode = HS::VOICE_UNISON;
+        ApplyVoiceMode();
 
         frame.MIDIState.log_index = 0;
         frame.MIDIState.clock_count = 0;
@@ -101,6 +107,11 @@ public:
         if (cursor == MIDI_CHANNEL_A || cursor == MIDI_CHANNEL_B) {
             int ch = io_offset + cursor - MIDI_CHANNEL_A;
             frame.MIDIState.channel[ch] = constrain(frame.MIDIState.channel[ch] + direction, 0, 15);
+            ApplyVoiceMode();
+        }
+        else if (cursor == VOICE_MODE) {
+            voice_mode = constrain(voice_mode + direction, 0, HS::VOICE_MODE_COUNT - 1);
+            ApplyVoiceMode();
         }
         else {
             int ch = io_offset + cursor - OUTPUT_MODE_A;
@@ -119,6 +130,7 @@ public:
         Pack(data, PackLocation {11,3}, frame.MIDIState.function[io_offset + 1]);
         Pack(data, PackLocation {14,7}, frame.MIDIState.function_cc[io_offset + 0] + 1);
         Pack(data, PackLocation {21,7}, frame.MIDIState.function_cc[io_offset + 1] + 1);
+        Pack(data, PackLocation {28,3}, voice_mode);
         return data;
     }
 
@@ -129,6 +141,8 @@ public:
         frame.MIDIState.function[io_offset + 1] = Unpack(data, PackLocation {11,3});
         frame.MIDIState.function_cc[io_offset + 0] = Unpack(data, PackLocation {14,7}) - 1;
         frame.MIDIState.function_cc[io_offset + 1] = Unpack(data, PackLocation {21,7}) - 1;
+        voice_mode = constrain(Unpack(data, PackLocation {28,3}), 0, HS::VOICE_MODE_COUNT - 1);
+        ApplyVoiceMode();
     }
 
 protected:
@@ -148,6 +162,14 @@ protected:
 private:
     // Housekeeping
     int cursor; // 0=MIDI channel, 1=A/C function, 2=B/D function
+    int voice_mode; // HS::VoiceAllocMode for the channels of both outputs
+
+    // The mode belongs to the MIDI channel, so the last applet to set it wins
+    void ApplyVoiceMode() {
+        ForEachChannel(ch) {
+            frame.MIDIState.SetVoiceMode(frame.MIDIState.channel[io_offset + ch], HS::VoiceAllocMode(voice_mode));
+        }
+    }
     
     void DrawMonitor() {
         if (OC::CORE::ticks - frame.MIDIState.last_msg_tick < 4000) {
@@ -161,6 +183,7 @@ private:
         char out_label[] = { 'C', 'h', (char)('A' + io_offset), ':', '\0'  };
         gfxPrint(1, 15, out_label);
         gfxPrint(24, 15, frame.MIDIState.channel[io_offset + 0] + 1);
+        gfxPrint(45, 15, midi_voice_mode_name[voice_mode]);
         ++out_label[2];
         gfxPrint(1, 25, out_label);
         gfxPrint(24, 25, frame.MIDIState.channel[io_offset + 1] + 1);
@@ -180,7 +203,8 @@ private:
             gfxPrint(frame.MIDIState.function_cc[io_offset + 1]);
 
         // Cursor
-        gfxCursor(24, 23 + (cursor * 10), 39);
+        if (cursor == VOICE_MODE) gfxCursor(45, 23, 18);
+        else gfxCursor(24, 23 + (cursor * 10), cursor == MIDI_CHANNEL_A ? 18 : 39);
 
         // Last log entry
         if (frame.MIDIState.log_index > 0) {
@@ -130,7 +130,7 @@ public:
 
                 // Pitch Bend
                 if (function == HEM_MIDI_PB_IN) {
-                    uint16_t bend = Proportion(In(1) + HEMISPHERE_3V_CV, HEMISPHERE_3V_CV * 2, 16383);
+                    uint16_t bend = Proportion<HEMISPHERE_3V_CV * 2>(In(1) + HEMISPHERE_3V_CV, 16383);
                     bend = constrain(bend, 0, 16383);
                     if (bend != last_bend) {
                       hMIDI.SendPitchBend(channel, bend);
@@ -0,0 +1,52 @@
+#ifndef ENIGMASONGINDEX_H
+#define ENIGMASONGINDEX_H
+
+#include <stdint.h>
+
+#ifndef ENIGMA_NO_STEP_AVAILABLE
+#define ENIGMA_NO_STEP_AVAILABLE 0xffff
+#endif
+
+// Teensy 4.x has the RAM for longer songs. The build can set both instead,
+// as the host tests do.
+#ifndef ENIGMA_MAX_SONG_STEPS
+#if defined(__IMXRT1062__)
+#define ENIGMA_MAX_TRACK_STEPS 250
+#define ENIGMA_MAX_SONG_STEPS 1024
+#else
+#define ENIGMA_MAX_TRACK_STEPS 99
+#define ENIGMA_MAX_SONG_STEPS 400
+#endif
+#endif
+
+// Per-track threading of the song step array. Each step links to the next step
+// on the same track, so playback can advance in constant time instead of
+// scanning the song on every clock. Rebuild() is called whenever the song is
+// edited or received, which is outside the clock path.
+class EnigmaSongIndex {
+public:
+    template <class Step>
+    void Rebuild(Step *steps, uint16_t total_steps) {
+        uint16_t last[4];
+        for (uint8_t t = 0; t < 4; t++) first[t] = last[t] = ENIGMA_NO_STEP_AVAILABLE;
+
+        for (uint16_t s = 0; s < total_steps; s++)
+        {
+            uint8_t t = steps[s].track();
+            next[s] = ENIGMA_NO_STEP_AVAILABLE;
+            if (last[t] == ENIGMA_NO_STEP_AVAILABLE) first[t] = s;
+            else next[last[t]] = s;
+            last[t] = s;
+        }
+    }
+
+    uint16_t First(uint8_t track) const {return first[track];}
+    uint16_t Next(uint16_t step) const {return next[step];}
+
+private:
+    uint16_t first[4] = {ENIGMA_NO_STEP_AVAILABLE, ENIGMA_NO_STEP_AVAILABLE,
+                         ENIGMA_NO_STEP_AVAILABLE, ENIGMA_NO_STEP_AVAILABLE};
+    uint16_t next[ENIGMA_MAX_SONG_STEPS];
+};
+
+#endif // ENIGMASONGINDEX_H
@@ -92,4 +92,7 @@ private:
     }
 };
 
+// Songs are sent over SysEx straight from song_step[]
+static_assert(sizeof(EnigmaStep) == 4, "EnigmaStep is four bytes");
+
 #endif // ENIGMASTEP_H
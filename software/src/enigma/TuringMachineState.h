@@ -31,7 +31,7 @@ public:
     void Init(byte ix_) {
         ix = constrain(ix_, 0, HS::TURING_MACHINE_COUNT - 1);
         if (HS::user_turing_machines[ix].len == 0 || HS::user_turing_machines[ix].len > 17) {
-            HS::user_turing_machines[ix].reg = (random(0, 0xff) << 8) + random(0, 0xff);
+            HS::user_turing_machines[ix].reg = HS::random_streams[HS::RANDOM_STREAM_TURING].Below(0x10000);
             HS::user_turing_machines[ix].len = 16;
             HS::user_turing_machines[ix].favorite = 0;
         }
@@ -58,7 +58,7 @@ public:
         uint16_t last = (reg >> (len - 1)) & 0x01;
 
         // Does it change?
-        if (!fav && random(0, 99) < p) last = 1 - last;
+        if (!fav && HS::random_streams[HS::RANDOM_STREAM_TURING].Below(99) < p) last = 1 - last;
 
         // Shift left, then potentially add the bit from the other side
         reg = (reg << 1) + last;
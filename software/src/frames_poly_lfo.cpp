@@ -51,6 +51,7 @@ void PolyLfo::Init() {
   attenuation_ = 58880;
   offset_ = 0 ;
   freq_div_b_ = freq_div_c_ = freq_div_d_ = POLYLFO_FREQ_MULT_NONE ;
+  b_xor_a_ = c_xor_a_ = d_xor_a_ = 0 ;
   b_am_by_a_ = 0 ;
   c_am_by_b_ = 0 ;
   d_am_by_c_ = 0 ;
@@ -61,6 +62,11 @@ void PolyLfo::Init() {
   std::fill(&value_[0], &value_[kNumChannels], 0);
   std::fill(&wt_value_[0], &wt_value_[kNumChannels], 0);
   std::fill(&phase_[0], &phase_[kNumChannels], 0);
+  std::fill(&phase_increment_[0], &phase_increment_[kNumChannels], 0);
+  std::fill(&block_dac_code_[0][0], &block_dac_code_[kNumChannels - 1][kMaxBlockSize], 0);
+  std::fill(&level_[0], &level_[kNumChannels], 0);
+  std::fill(&dac_code_[0], &dac_code_[kNumChannels], 0);
+  block_size_ = 0;
   last_phase_difference_ = 0;
   last_phase_difference_ = 0;
   pattern_predictor_.Init();
@@ -132,6 +138,73 @@ uint32_t PolyLfo::FrequencyToPhaseIncrement(int32_t frequency, uint16_t frq_rng)
 }
 
 void PolyLfo::Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8_t freq_mult) {
+  ProcessSync(tempo_sync);
+
+  // reset phase
+  if (reset_phase || phase_reset_flag_) {
+    ResetPhase();
+  } else {
+    ComputePhaseIncrements(frequency, freq_mult);
+    AdvancePhase();
+  }
+  RenderChannels();
+}
+
+void PolyLfo::RenderBlock(int32_t frequency, bool reset_phase, bool tempo_sync, uint8_t freq_mult, size_t size) {
+  if (size > kMaxBlockSize) size = kMaxBlockSize;
+
+  SaveState(block_state_[0]);
+  block_size_ = size;
+
+  // Increments only depend on the block's parameters, so they're computed once
+  bool increments_valid = false;
+  for (size_t s = 0; s < size; ++s) {
+    if (s) ++sync_counter_;
+    else ProcessSync(tempo_sync);
+
+    if ((!s && reset_phase) || phase_reset_flag_) {
+      ResetPhase();
+    } else {
+      if (!increments_valid) {
+        ComputePhaseIncrements(frequency, freq_mult);
+        increments_valid = true;
+      }
+      AdvancePhase();
+    }
+    RenderChannels();
+
+    for (size_t i = 0; i < kNumChannels; ++i)
+      block_dac_code_[i][s] = dac_code_[i];
+    SaveState(block_state_[s + 1]);
+  }
+}
+
+void PolyLfo::Rewind(size_t ticks) {
+  if (ticks > block_size_) ticks = block_size_;
+  block_size_ -= ticks;
+
+  sync_counter_ -= ticks;
+  const ChannelState *state = block_state_[block_size_];
+  for (uint8_t i = 0; i < kNumChannels; ++i) {
+    uint32_t increment = phase_increment_[i];
+    if (spread_ < 0 && i) increment -= i * (phase_increment_ch1_ >> 16) * spread_;
+    phase_[i] -= ticks * increment;
+
+    value_[i] = state[i].value;
+    level_[i] = state[i].level;
+    dac_code_[i] = state[i].dac_code;
+  }
+}
+
+void PolyLfo::SaveState(ChannelState *state) const {
+  for (uint8_t i = 0; i < kNumChannels; ++i) {
+    state[i].value = value_[i];
+    state[i].level = level_[i];
+    state[i].dac_code = dac_code_[i];
+  }
+}
+
+void PolyLfo::ProcessSync(bool tempo_sync) {
     ++sync_counter_;
     if (tempo_sync && sync_) {
         if (sync_counter_ < kSyncCounterMaxTime) {
@@ -150,63 +223,70 @@ void PolyLfo::Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8
         }
         sync_counter_ = 0;
     }
+}
 
-  
-  // reset phase
-  if (reset_phase || phase_reset_flag_) {
-    std::fill(&phase_[0], &phase_[kNumChannels], 0);
-    phase_reset_flag_ = false ;
+void PolyLfo::ResetPhase() {
+  std::fill(&phase_[0], &phase_[kNumChannels], 0);
+  phase_reset_flag_ = false ;
+}
+
+void PolyLfo::ComputePhaseIncrements(int32_t frequency, uint8_t freq_mult) {
+  // increment freqs for each LFO
+  if (sync_) {
+    phase_increment_ch1_ = sync_phase_increment_;
   } else {
-    // increment freqs for each LFO
-    if (sync_) {
-      phase_increment_ch1_ = sync_phase_increment_;
-    } else {
-      phase_increment_ch1_ = FrequencyToPhaseIncrement(frequency, freq_range_);
-    }
-    
-    // double F (via TR4) ? ... "/8", "/4", "/2", "x2", "x4", "x8"
-    if (freq_mult < 0xFF) {
-      phase_increment_ch1_ = (freq_mult < 0x3) ? (phase_increment_ch1_ >> (0x3 - freq_mult)) : phase_increment_ch1_ << (freq_mult - 0x2);
-    }
-    
-    phase_[0] += phase_increment_ch1_;
-    PolyLfoFreqMultipliers FreqDivs[] = {POLYLFO_FREQ_MULT_NONE, freq_div_b_, freq_div_c_ , freq_div_d_} ;
-    for (uint8_t i = 1; i < kNumChannels; ++i) {
-        if (FreqDivs[i] == POLYLFO_FREQ_MULT_NONE) {
-            phase_[i] += phase_increment_ch1_;
-        } else {
-            phase_[i] += multiply_u32xu32_rshift24(phase_increment_ch1_, PolyLfoFreqMultNumerators[FreqDivs[i]]) ;
-        }  
-    }
+    phase_increment_ch1_ = FrequencyToPhaseIncrement(frequency, freq_range_);
+  }
 
-    // Advance phasors.
-    if (spread_ >= 0) {
-      phase_difference_ = static_cast<uint32_t>(spread_) << 15;
-      if (freq_div_b_ == POLYLFO_FREQ_MULT_NONE) {
-        phase_[1] = phase_[0] + phase_difference_;
-      } else {
-        phase_[1] = phase_[1] - last_phase_difference_ + phase_difference_;
-      }
-      if (freq_div_c_ == POLYLFO_FREQ_MULT_NONE) {
-        phase_[2] = phase_[0] + (2 * phase_difference_);
-      } else {
-        phase_[2] = phase_[2] - last_phase_difference_  + phase_difference_;
-      }
-      if (freq_div_d_ == POLYLFO_FREQ_MULT_NONE) {
-        phase_[3] = phase_[0] + (3 * phase_difference_);
+  // double F (via TR4) ? ... "/8", "/4", "/2", "x2", "x4", "x8"
+  if (freq_mult < 0xFF) {
+    phase_increment_ch1_ = (freq_mult < 0x3) ? (phase_increment_ch1_ >> (0x3 - freq_mult)) : phase_increment_ch1_ << (freq_mult - 0x2);
+  }
+
+  phase_increment_[0] = phase_increment_ch1_;
+  PolyLfoFreqMultipliers FreqDivs[] = {POLYLFO_FREQ_MULT_NONE, freq_div_b_, freq_div_c_ , freq_div_d_} ;
+  for (uint8_t i = 1; i < kNumChannels; ++i) {
+      if (FreqDivs[i] == POLYLFO_FREQ_MULT_NONE) {
+          phase_increment_[i] = phase_increment_ch1_;
       } else {
-        phase_[3] = phase_[3] - last_phase_difference_  + phase_difference_;
+          phase_increment_[i] = multiply_u32xu32_rshift24(phase_increment_ch1_, PolyLfoFreqMultNumerators[FreqDivs[i]]) ;
       }
+  }
+}
+
+void PolyLfo::AdvancePhase() {
+  for (uint8_t i = 0; i < kNumChannels; ++i)
+    phase_[i] += phase_increment_[i];
+
+  // Advance phasors.
+  if (spread_ >= 0) {
+    phase_difference_ = static_cast<uint32_t>(spread_) << 15;
+    if (freq_div_b_ == POLYLFO_FREQ_MULT_NONE) {
+      phase_[1] = phase_[0] + phase_difference_;
     } else {
-      for (uint8_t i = 1; i < kNumChannels; ++i) { 
-        // phase_[i] += FrequencyToPhaseIncrement(frequency, freq_range_);
-        phase_[i] -= i * (phase_increment_ch1_ >> 16) * spread_ ;
-        // frequency -= 5040 * spread_ >> 15;
-      }
+      phase_[1] = phase_[1] - last_phase_difference_ + phase_difference_;
+    }
+    if (freq_div_c_ == POLYLFO_FREQ_MULT_NONE) {
+      phase_[2] = phase_[0] + (2 * phase_difference_);
+    } else {
+      phase_[2] = phase_[2] - last_phase_difference_  + phase_difference_;
+    }
+    if (freq_div_d_ == POLYLFO_FREQ_MULT_NONE) {
+      phase_[3] = phase_[0] + (3 * phase_difference_);
+    } else {
+      phase_[3] = phase_[3] - last_phase_difference_  + phase_difference_;
+    }
+  } else {
+    for (uint8_t i = 1; i < kNumChannels; ++i) { 
+      // phase_[i] += FrequencyToPhaseIncrement(frequency, freq_range_);
+      phase_[i] -= i * (phase_increment_ch1_ >> 16) * spread_ ;
+      // frequency -= 5040 * spread_ >> 15;
     }
-    last_phase_difference_ = phase_difference_;
   }
-  
+  last_phase_difference_ = phase_difference_;
+}
+
+void PolyLfo::RenderChannels() {
   const uint8_t* sine = &wt_lfo_waveforms[17 * 257];
   
   uint16_t wavetable_index = shape_;
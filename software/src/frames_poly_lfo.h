@@ -41,6 +41,7 @@ const uint32_t kSyncCounterMaxTime = 8 * 16667;
 namespace frames {
 
 const size_t kNumChannels = 4;
+const size_t kMaxBlockSize = 8;
 
 enum PolyLfoFreqMultipliers {
   POLYLFO_FREQ_MULT_BY16,     // 0
@@ -134,6 +135,13 @@ class PolyLfo {
   
   void Init();
   void Render(int32_t frequency, bool reset_phase, bool tempo_sync, uint8_t freq_mult);
+  // Render size ticks for all channels at once; parameters are held for the
+  // whole block and reset/sync only apply to the first tick. Output is the same
+  // as calling Render() size times, and ends up in block_dac_code.
+  void RenderBlock(int32_t frequency, bool reset_phase, bool tempo_sync, uint8_t freq_mult, size_t size);
+  // Undo the last ticks of the block, rendered but never output: phases, and
+  // the channel values the next tick's coupling reads
+  void Rewind(size_t ticks);
   void RenderPreview(uint16_t shape, uint16_t *buffer, size_t size);
 
   inline void set_freq_range(uint16_t freq_range) {
@@ -265,10 +273,27 @@ class PolyLfo {
     return dac_code_[index];
   }
 
+  inline const uint16_t block_dac_code(uint8_t index, size_t sample) const {
+    return block_dac_code_[index][sample];
+  }
+
   static uint32_t FrequencyToPhaseIncrement(int32_t frequency, uint16_t frq_rng);
 
 
  private:
+  struct ChannelState {
+    int16_t value;
+    uint8_t level;
+    uint16_t dac_code;
+  };
+
+  void ProcessSync(bool tempo_sync);
+  void ResetPhase();
+  void ComputePhaseIncrements(int32_t frequency, uint8_t freq_mult);
+  void AdvancePhase();
+  void RenderChannels();
+  void SaveState(ChannelState *state) const;
+
   uint16_t freq_range_ ;
   uint16_t shape_;
   int16_t shape_spread_;
@@ -291,8 +316,15 @@ class PolyLfo {
   int16_t wt_value_[kNumChannels];
   uint32_t phase_[kNumChannels];
   uint32_t phase_increment_ch1_;
+  uint32_t phase_increment_[kNumChannels];
   uint8_t level_[kNumChannels];
   uint16_t dac_code_[kNumChannels];
+  uint16_t block_dac_code_[kNumChannels][kMaxBlockSize];
+
+  // value_, level_ and dac_code_ before the block and after each of its
+  // ticks, for Rewind()
+  ChannelState block_state_[kMaxBlockSize + 1][kNumChannels];
+  size_t block_size_;
 
   bool sync_ ;
   uint32_t sync_counter_;
@@ -25,6 +25,9 @@
 #include "applets/Button.h"
 #include "applets/Cumulus.h"
 #include "applets/CVRecV2.h"
+#ifdef ARDUINO_TEENSY41
+#include "applets/CVLooper.h"
+#endif
 #include "applets/Calculate.h"
 #include "applets/Calibr8.h"
 #include "applets/Carpeggio.h"
@@ -93,6 +96,9 @@
 #include "applets/Voltage.h"
 #include "applets/hMIDIIn.h"
 #include "applets/hMIDIOut.h"
+#if defined(__IMXRT1062__)
+#include "applets/MIDILooper.h"
+#endif
 
 template<class A>
 struct DeclareApplet {
@@ -125,7 +131,9 @@ private:
   }
 };
 
-AppletRegistry reg{
+// IDs are stored in presets, so they must be unique and never reused.
+// The table is constexpr so duplicates are caught at build time below.
+constexpr AppletRegistry reg{
     DeclareApplet<ADSREG>{8, 0x01},
     DeclareApplet<ADEG>{34, 0x01},
     DeclareApplet<ASR>{47, 0x09},
@@ -144,8 +152,11 @@ AppletRegistry reg{
     DeclareApplet<ClkToGate>{78, 0x04},
     DeclareApplet<ClockSkip>{28, 0x04},
     DeclareApplet<Compare>{30, 0x10},
-    DeclareApplet<Cumulus>{74, 0x40},
+    DeclareApplet<Cumulus>{79, 0x40},
     DeclareApplet<CVRecV2>{24, 0x02},
+#ifdef ARDUINO_TEENSY41
+    DeclareApplet<CVLooper>{89, 0x02},
+#endif
     DeclareApplet<DivSeq>{68, 0x06},
     DeclareApplet<DrLoFi>{16, 0x80},
     DeclareApplet<DrumMap>{57, 0x02},
@@ -163,6 +174,9 @@ AppletRegistry reg{
     DeclareApplet<Metronome>{50, 0x04},
     DeclareApplet<hMIDIIn>{150, 0x20},
     DeclareApplet<hMIDIOut>{27, 0x20},
+#if defined(__IMXRT1062__)
+    DeclareApplet<MIDILooper>{90, 0x20},
+#endif
     DeclareApplet<MixerBal>{33, 0x10},
     DeclareApplet<MultiScale>{73, 0x08},
     DeclareApplet<Palimpsest>{20, 0x02},
@@ -216,13 +230,41 @@ namespace HS {
     hidden_applets[seg] = hidden_applets[seg] ^ (uint64_t(1) << (index%64));
   }
 
-  constexpr int get_applet_index_by_id(const int& id) {
-    int index = 0;
+  constexpr int max_applet_id() {
+    int max_id = 0;
     for (int i = 0; i < HEMISPHERE_AVAILABLE_APPLETS; i++)
     {
-        if (available_applets[i].id == id) index = i;
+        if (available_applets[i].id > max_id) max_id = available_applets[i].id;
     }
-    return index;
+    return max_id;
+  }
+  static constexpr int HEMISPHERE_MAX_APPLET_ID = max_applet_id();
+
+  constexpr bool applet_ids_unique() {
+    for (int i = 0; i < HEMISPHERE_AVAILABLE_APPLETS; i++)
+    {
+        for (int j = i + 1; j < HEMISPHERE_AVAILABLE_APPLETS; j++)
+            if (available_applets[i].id == available_applets[j].id) return false;
+    }
+    return true;
+  }
+  static_assert(applet_ids_unique(), "Duplicate applet ID in hemisphere_config.h");
+  static_assert(HEMISPHERE_AVAILABLE_APPLETS <= 255, "Applet index table is 8-bit");
+
+  // Dense id -> index table; unknown IDs map to index 0, as they always have
+  struct AppletIdTable {
+    uint8_t index[HEMISPHERE_MAX_APPLET_ID + 1];
+  };
+  constexpr AppletIdTable make_applet_id_table() {
+    AppletIdTable table{};
+    for (int i = 0; i < HEMISPHERE_AVAILABLE_APPLETS; i++)
+        table.index[available_applets[i].id] = i;
+    return table;
+  }
+  static constexpr AppletIdTable applet_id_table = make_applet_id_table();
+
+  constexpr int get_applet_index_by_id(const int& id) {
+    return (id >= 0 && id <= HEMISPHERE_MAX_APPLET_ID) ? applet_id_table.index[id] : 0;
   }
 
   int get_next_applet_index(int index, const int dir) {
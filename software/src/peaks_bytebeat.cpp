@@ -56,6 +56,8 @@ void ByteBeat::Init() {
   p2_ = 127;
   stepmode_ = false ;
   last_sample_ = 13 ;
+  equation_index_ = 0 ;
+  bytepitch_ = 1 ;
 
 }
 
@@ -29,6 +29,8 @@ public:
     write_ptr_ = read_ptr_ = 0;
     capture_on_next_write = false;
     capture_is_valid = false;
+    force_next_ = false;
+    frames_written_ = frames_skipped_ = 0;
   }
 
   size_t writeable() const {
@@ -53,15 +55,35 @@ public:
     ++read_ptr_;
   }
 
-  void written() {
+  // A frame identical to the last one submitted is dropped rather than sent
+  // again, which saves the ISR a full frame of transfers. The previous frame is
+  // either queued or being transferred, so it's safe to read here.
+  // @return true if the frame was submitted
+  bool written() {
+    if (write_ptr_ && !force_next_ && !capture_on_next_write &&
+        !memcmp(frame_buffers_[write_ptr_ % frames], frame_buffers_[(write_ptr_ - 1) % frames], kFrameSize)) {
+      ++frames_skipped_;
+      return false;
+    }
+    force_next_ = false;
+    ++frames_written_;
     if (capture_on_next_write) {
       capture_on_next_write = false;
       memcpy(capture_memory_, frame_buffers_[write_ptr_ % frames], kFrameSize);
       capture_is_valid = true;
     }
     ++write_ptr_;
+    return true;
+  }
+
+  // Submit the next frame even if nothing changed
+  void force_next() {
+    force_next_ = true;
   }
 
+  uint32_t frames_written() const { return frames_written_; }
+  uint32_t frames_skipped() const { return frames_skipped_; }
+
   void capture_request() {
     capture_on_next_write = true;
   }
@@ -82,6 +104,9 @@ private:
   volatile size_t read_ptr_;
   volatile bool capture_on_next_write;
   volatile bool capture_is_valid;
+  bool force_next_;
+  uint32_t frames_written_;
+  uint32_t frames_skipped_;
 
   DISALLOW_COPY_AND_ASSIGN(FrameBuffer);
 };
@@ -18,7 +18,11 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#ifdef ARDUINO
 #include <Arduino.h>
+#else  // host tests
+#define PROGMEM
+#endif
 #include <string.h>
 
 #include "weegfx.h"
@@ -448,9 +452,34 @@ template <PIXEL_OP pixel_op>
 void Graphics::print_impl(const char *s)
 {
   coord_t x = text_x_;
-  coord_t y = text_y_;
+  const coord_t y = text_y_;
+
+  // Glyphs that are entirely on screen all share the same page and shift, so
+  // they can skip the per-char clipping; only partial glyphs go through blit_char.
+  if (y >= 0 && y + kFixedFontH <= kHeight) {
+    while (*s && x < 0) {
+      blit_char<pixel_op>(*s++, x, y);
+      x += kFixedFontW;
+    }
+
+    const int shift = y & 0x7;
+    uint8_t *dst = get_frame_ptr(x, y);
+    while (*s && x + kFixedFontW <= kWidth) {
+      const char c = *s++;
+      if (c > 32 && c <= 127) {
+        font_glyph data = get_char_glyph(c);
+        if (!shift) {
+          draw_pixel_row<pixel_op>(dst, kFixedFontW, data);
+        } else {
+          draw_pixel_row_lshift<pixel_op>(dst, kFixedFontW, data, shift);
+          draw_pixel_row_rshift<pixel_op>(dst + kWidth, kFixedFontW, data, 8 - shift);
+        }
+      }
+      dst += kFixedFontW;
+      x += kFixedFontW;
+    }
+  }
 
-  // TODO Track position, only clip when necessary or early-out?
   while (*s) {
     blit_char<pixel_op>(*s++, x, y);
     x += kFixedFontW;
@@ -459,6 +488,18 @@ void Graphics::print_impl(const char *s)
   text_x_ = x;
 }
 
+void render_glyphs(const char *s, size_t len, uint8_t *columns)
+{
+  while (len--) {
+    const char c = *s++;
+    if (c > 32 && c <= 127)
+      memcpy(columns, get_char_glyph(c), kFixedFontW);
+    else
+      memset(columns, 0, kFixedFontW);
+    columns += kFixedFontW;
+  }
+}
+
 void Graphics::print(char c)
 {
   blit_char<PIXEL_OP_OR>(c, text_x_, text_y_);
@@ -529,10 +570,10 @@ void Graphics::print(uint16_t value, unsigned width)
   print(str);
 }
 
-void Graphics::print(uint32_t value, size_t width)
+void Graphics::print(uint32_t value, unsigned width)
 {
   char *str = itos<uint32_t, false>(value, print_buf, sizeof(print_buf));
-  while (str > print_buf && (size_t)(str - print_buf) >= sizeof(print_buf) - width) *--str = ' ';
+  while (str > print_buf && (unsigned)(str - print_buf) >= sizeof(print_buf) - width) *--str = ' ';
   print(str);
 }
 
@@ -613,9 +654,12 @@ void Graphics::write_right(const char *s)
 
 void Graphics::printf(const char *fmt, ...)
 {
-  va_list args;
+  va_list args, fallback;
   va_start(args, fmt);
-  vsnprintf(print_buf, sizeof(print_buf), fmt, args);
+  va_copy(fallback, args);
+  if (!format(print_buf, sizeof(print_buf), fmt, args))
+    vsnprintf(print_buf, sizeof(print_buf), fmt, fallback);
+  va_end(fallback);
   va_end(args);
   print(print_buf);
 }
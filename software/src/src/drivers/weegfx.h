@@ -26,6 +26,7 @@
 
 #include <stdint.h>
 #include <string.h>
+#include "weegfx_format.h"
 
 namespace weegfx {
 
@@ -44,6 +45,49 @@ enum PIXEL_OP {
 
 enum CLEAR_FRAME { CLEAR_FRAME_DISABLE, CLEAR_FRAME_ENABLE };
 
+// Renders len chars of s into len * kFixedFontW page-aligned glyph columns
+void render_glyphs(const char *s, size_t len, uint8_t *columns);
+
+// Text pre-rendered as glyph columns, for labels and values that are drawn
+// every frame but rarely change. Set() only re-renders when the content
+// differs, after which Graphics::print(strip) is a single bitmap blit.
+template <size_t max_chars>
+class TextStrip {
+public:
+  TextStrip() : len_(0), value_valid_(false) { }
+
+  // @return true if the strip was re-rendered
+  bool Set(const char *s) {
+    value_valid_ = false;
+    size_t len = 0;
+    while (len < max_chars && s[len]) ++len;
+    if (len == len_ && !memcmp(s, text_, len)) return false;
+    memcpy(text_, s, len);
+    len_ = len;
+    render_glyphs(text_, len_, columns_);
+    return true;
+  }
+
+  // Number right-aligned in width chars; skips formatting when unchanged
+  bool Set(long value, int width = 0);
+
+  void Invalidate() {
+    len_ = 0;
+    value_valid_ = false;
+  }
+
+  coord_t width() const { return len_ * kFixedFontW; }
+  const uint8_t *columns() const { return columns_; }
+
+private:
+  char text_[max_chars];
+  uint8_t columns_[max_chars * kFixedFontW];
+  size_t len_;
+  bool value_valid_;
+  long value_;
+  int value_width_;
+};
+
 // Quick & dirty graphics for 128x64 framebuffer with vertical pixels.
 // - Writes to provided framebuffer
 // - Makes some assumptions based on fixed size and pixel orientation
@@ -108,7 +152,10 @@ public:
   // Print string at absolute coords, doesn't move print pos
   void drawStr(coord_t x, coord_t y, const char *str);
 
-  // Might be time-consuming
+  // Print pre-rendered text at current print pos and move print pos
+  template <size_t max_chars> void print(const TextStrip<max_chars> &strip);
+
+  // Common conversions are formatted in place; anything else goes through vsnprintf
   void printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
 
   inline void drawAlignedByte(coord_t x, coord_t y, uint8_t byte) __attribute__((always_inline));
@@ -137,6 +184,26 @@ inline void Graphics::drawAlignedByte(coord_t x, coord_t y, uint8_t byte)
   *get_frame_ptr(x, y) = byte;
 }
 
+template <size_t max_chars>
+inline void Graphics::print(const TextStrip<max_chars> &strip)
+{
+  drawBitmap8(text_x_, text_y_, strip.width(), strip.columns());
+  text_x_ += strip.width();
+}
+
+template <size_t max_chars>
+bool TextStrip<max_chars>::Set(long value, int width)
+{
+  if (value_valid_ && value == value_ && width == value_width_) return false;
+  char buf[max_chars + 1];
+  format_int(buf, sizeof(buf), value, width);
+  const bool changed = Set(buf);
+  value_valid_ = true;
+  value_ = value;
+  value_width_ = width;
+  return changed;
+}
+
 inline void Graphics::setPrintPos(coord_t x, coord_t y)
 {
   text_x_ = x;
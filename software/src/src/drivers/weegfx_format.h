@@ -0,0 +1,177 @@
+#ifndef WEEGFX_FORMAT_H_
+#define WEEGFX_FORMAT_H_
+
+// Small integer formatting for on-screen text, without going through
+// vsnprintf. format() handles the subset of printf that the UI actually uses
+// (flags -+0 and space, width, l/h, and d i u x X c s %); anything else makes
+// it return false so the caller can fall back to vsnprintf.
+// No Arduino dependencies.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace weegfx {
+
+// Bounded output with vsnprintf's truncation rules
+class FormatWriter {
+public:
+  FormatWriter(char *buf, size_t size) : pos_(buf), end_(buf + (size ? size - 1 : 0)) { }
+
+  void put(char c) {
+    if (pos_ < end_) *pos_++ = c;
+  }
+
+  void put(const char *s, size_t n) {
+    while (n--) put(*s++);
+  }
+
+  void pad(char c, int n) {
+    while (n-- > 0) put(c);
+  }
+
+  // Emits sign + digits padded to width, as printf would
+  void field(char sign, const char *digits, size_t len, int width, bool left, bool zero) {
+    const int padding = width - static_cast<int>(len) - (sign ? 1 : 0);
+    if (!left && !zero) pad(' ', padding);
+    if (sign) put(sign);
+    if (!left && zero) pad('0', padding);
+    put(digits, len);
+    if (left) pad(' ', padding);
+  }
+
+  char *finish() {
+    *pos_ = '\0';
+    return pos_;
+  }
+
+private:
+  char *pos_;
+  char *end_;
+};
+
+// Writes value backwards so it ends just before end; returns the first digit
+static inline char *format_decimal(char *end, unsigned long value) {
+  do {
+    *--end = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  return end;
+}
+
+static inline char *format_hex(char *end, unsigned long value, bool upper) {
+  const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  do {
+    *--end = digits[value & 0xf];
+    value >>= 4;
+  } while (value);
+  return end;
+}
+
+// Equivalent to snprintf(buf, size, "%*ld", width, value)
+static inline size_t format_int(char *buf, size_t size, long value, int width = 0) {
+  char digits[24];
+  char *end = digits + sizeof(digits);
+  const unsigned long magnitude = value < 0 ? 0UL - static_cast<unsigned long>(value) : value;
+  const char *first = format_decimal(end, magnitude);
+  FormatWriter out(buf, size);
+  out.field(value < 0 ? '-' : 0, first, end - first, width, false, false);
+  return out.finish() - buf;
+}
+
+// Signed volts with two decimals and a unit, e.g. +1.25V, from hundredths of a volt
+static inline size_t format_centivolts(char *buf, size_t size, int centivolts) {
+  FormatWriter out(buf, size);
+  out.put(centivolts < 0 ? '-' : '+');
+  const unsigned v = centivolts < 0 ? -centivolts : centivolts;
+  char digits[12];
+  char *end = digits + sizeof(digits);
+  const char *first = format_decimal(end, v / 100);
+  out.put(first, end - first);
+  out.put('.');
+  out.put('0' + (v % 100) / 10);
+  out.put('0' + v % 10);
+  out.put('V');
+  return out.finish() - buf;
+}
+
+// vsnprintf for the common conversions. Returns false, leaving buf
+// unspecified and args partly consumed, if fmt needs anything more.
+static inline bool format(char *buf, size_t size, const char *fmt, va_list args) {
+  FormatWriter out(buf, size);
+  char digits[24];
+  char *const end = digits + sizeof(digits);
+
+  while (*fmt) {
+    if (*fmt != '%') {
+      out.put(*fmt++);
+      continue;
+    }
+    ++fmt;
+
+    bool left = false, zero = false;
+    char plus = 0;
+    for (;; ++fmt) {
+      if (*fmt == '-') left = true;
+      else if (*fmt == '0') zero = true;
+      else if (*fmt == '+') plus = '+';
+      else if (*fmt == ' ') { if (!plus) plus = ' '; }
+      else break;
+    }
+    int width = 0;
+    while (*fmt >= '0' && *fmt <= '9') width = width * 10 + (*fmt++ - '0');
+    bool is_long = false;
+    while (*fmt == 'l' || *fmt == 'h') {
+      if (*fmt == 'l') is_long = true;
+      ++fmt;
+    }
+
+    switch (*fmt++) {
+      case 'd':
+      case 'i': {
+        const long value = is_long ? va_arg(args, long) : va_arg(args, int);
+        const unsigned long magnitude = value < 0 ? 0UL - static_cast<unsigned long>(value) : value;
+        const char *first = format_decimal(end, magnitude);
+        out.field(value < 0 ? '-' : plus, first, end - first, width, left, zero && !left);
+        break;
+      }
+      case 'u': {
+        const unsigned long value = is_long ? va_arg(args, unsigned long) : va_arg(args, unsigned);
+        const char *first = format_decimal(end, value);
+        out.field(0, first, end - first, width, left, zero && !left);
+        break;
+      }
+      case 'x':
+      case 'X': {
+        const unsigned long value = is_long ? va_arg(args, unsigned long) : va_arg(args, unsigned);
+        const char *first = format_hex(end, value, fmt[-1] == 'X');
+        out.field(0, first, end - first, width, left, zero && !left);
+        break;
+      }
+      case 'c': {
+        const char c = static_cast<char>(va_arg(args, int));
+        out.field(0, &c, 1, width, left, false);
+        break;
+      }
+      case 's': {
+        const char *s = va_arg(args, const char *);
+        if (!s) s = "(null)";
+        size_t len = 0;
+        while (s[len]) ++len;
+        out.field(0, s, len, width, left, false);
+        break;
+      }
+      case '%':
+        out.put('%');
+        break;
+      default:
+        return false;
+    }
+  }
+  out.finish();
+  return true;
+}
+
+}  // namespace weegfx
+
+#endif  // WEEGFX_FORMAT_H_
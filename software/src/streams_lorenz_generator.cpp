@@ -51,6 +51,8 @@ const int64_t b = 0.1 * (1 << 24);
 // const int64_t c = 13.0 * (1 << 24);
 
 void LorenzGenerator::Init(uint8_t index) {
+  // outputs read 0 until the next Process(), which sets them all again
+  for (size_t i = 0; i < kNumChannels; ++i) dac_code_[i] = 0;
   if (index) {
     Lx2_ = 0.1 * (1 << 24);
     Ly2_ = 0;
@@ -68,6 +70,116 @@ void LorenzGenerator::Init(uint8_t index) {
   }
 }
 
+struct LorenzEquations {
+  static inline int64_t dx(int64_t x, int64_t y, int64_t, int64_t) {
+    return (sigma * (y - x)) >> 24;
+  }
+  static inline int64_t dy(int64_t x, int64_t y, int64_t z, int64_t rho) {
+    return (x * (rho - z) >> 24) - y;
+  }
+  static inline int64_t dz(int64_t x, int64_t y, int64_t z, int64_t) {
+    return (x * y >> 24) - (beta * z >> 24);
+  }
+};
+
+struct RosslerEquations {
+  static inline int64_t dx(int64_t, int64_t y, int64_t z, int64_t) {
+    return -y - z;
+  }
+  static inline int64_t dy(int64_t x, int64_t y, int64_t, int64_t) {
+    return x + ((a * y) >> 24);
+  }
+  static inline int64_t dz(int64_t x, int64_t, int64_t z, int64_t c) {
+    return b + ((z * (x - c)) >> 24);
+  }
+};
+
+// Advance one system by dt (8.24). Euler matches the original Streams code;
+// semi-implicit Euler costs the same but stays bounded at larger steps, and
+// RK4 is four times the work but accurate enough for heavy decimation.
+template <typename System>
+static void Integrate(int32_t &x_, int32_t &y_, int32_t &z_, int64_t dt, int64_t p, LorenzIntegrator integrator) {
+  int64_t x = x_, y = y_, z = z_;
+  switch (integrator) {
+    case LORENZ_INTEGRATOR_SEMI_IMPLICIT:
+      x += dt * System::dx(x, y, z, p) >> 24;
+      y += dt * System::dy(x, y, z, p) >> 24;
+      z += dt * System::dz(x, y, z, p) >> 24;
+      break;
+    case LORENZ_INTEGRATOR_RK4: {
+      int64_t k1x = System::dx(x, y, z, p);
+      int64_t k1y = System::dy(x, y, z, p);
+      int64_t k1z = System::dz(x, y, z, p);
+      int64_t x2 = x + (dt * k1x >> 25), y2 = y + (dt * k1y >> 25), z2 = z + (dt * k1z >> 25);
+      int64_t k2x = System::dx(x2, y2, z2, p);
+      int64_t k2y = System::dy(x2, y2, z2, p);
+      int64_t k2z = System::dz(x2, y2, z2, p);
+      int64_t x3 = x + (dt * k2x >> 25), y3 = y + (dt * k2y >> 25), z3 = z + (dt * k2z >> 25);
+      int64_t k3x = System::dx(x3, y3, z3, p);
+      int64_t k3y = System::dy(x3, y3, z3, p);
+      int64_t k3z = System::dz(x3, y3, z3, p);
+      int64_t x4 = x + (dt * k3x >> 24), y4 = y + (dt * k3y >> 24), z4 = z + (dt * k3z >> 24);
+      int64_t k4x = System::dx(x4, y4, z4, p);
+      int64_t k4y = System::dy(x4, y4, z4, p);
+      int64_t k4z = System::dz(x4, y4, z4, p);
+      x += (dt * (k1x + 2 * (k2x + k3x) + k4x) >> 24) / 6;
+      y += (dt * (k1y + 2 * (k2y + k3y) + k4y) >> 24) / 6;
+      z += (dt * (k1z + 2 * (k2z + k3z) + k4z) >> 24) / 6;
+      break;
+    }
+    case LORENZ_INTEGRATOR_EULER:
+    default: {
+      int64_t dx = System::dx(x, y, z, p);
+      int64_t dy = System::dy(x, y, z, p);
+      int64_t dz = System::dz(x, y, z, p);
+      x += dt * dx >> 24;
+      y += dt * dy >> 24;
+      z += dt * dz >> 24;
+      break;
+    }
+  }
+  x_ = x;
+  y_ = y;
+  z_ = z;
+}
+
+/* static */
+uint8_t LorenzGenerator::OutputSystems(uint8_t out) {
+  switch (out) {
+    case LORENZ_OUTPUT_X1:
+    case LORENZ_OUTPUT_Y1:
+    case LORENZ_OUTPUT_Z1:
+    case LORENZ_OUTPUT_LX1_XOR_LY1:
+      return LORENZ_SYSTEM_L1;
+    case LORENZ_OUTPUT_X2:
+    case LORENZ_OUTPUT_Y2:
+    case LORENZ_OUTPUT_Z2:
+      return LORENZ_SYSTEM_L2;
+    case ROSSLER_OUTPUT_X1:
+    case ROSSLER_OUTPUT_Y1:
+    case ROSSLER_OUTPUT_Z1:
+      return LORENZ_SYSTEM_R1;
+    case ROSSLER_OUTPUT_X2:
+    case ROSSLER_OUTPUT_Y2:
+    case ROSSLER_OUTPUT_Z2:
+      return LORENZ_SYSTEM_R2;
+    case LORENZ_OUTPUT_LX1_PLUS_RX1:
+    case LORENZ_OUTPUT_LX1_PLUS_RZ1:
+    case LORENZ_OUTPUT_LX1_XOR_RX1:
+      return LORENZ_SYSTEM_L1 | LORENZ_SYSTEM_R1;
+    case LORENZ_OUTPUT_LX1_PLUS_LY2:
+    case LORENZ_OUTPUT_LX1_PLUS_LZ2:
+    case LORENZ_OUTPUT_LX1_XOR_LX2:
+      return LORENZ_SYSTEM_L1 | LORENZ_SYSTEM_L2;
+    case LORENZ_OUTPUT_LX1_PLUS_RX2:
+    case LORENZ_OUTPUT_LX1_PLUS_RZ2:
+    case LORENZ_OUTPUT_LX1_XOR_RX2:
+      return LORENZ_SYSTEM_L1 | LORENZ_SYSTEM_R2;
+    default:
+      return 0;
+  }
+}
+
 void LorenzGenerator::Process(
     int32_t freq1,
     int32_t freq2,
@@ -85,52 +197,47 @@ void LorenzGenerator::Process(
   if (reset1) Init(0) ;
   if (reset2) Init(1) ; 
 
-  // yes, yes, these should be functions...
+  // Only integrate the systems that are routed to an output, on this
+  // generator's decimated steps
+  uint8_t active = routed_ & ~disabled_;
+  if (++decimation_counter_[0] >= decimation_[0]) decimation_counter_[0] = 0;
+  else active &= ~(LORENZ_SYSTEM_L1 | LORENZ_SYSTEM_R1);
+  if (++decimation_counter_[1] >= decimation_[1]) decimation_counter_[1] = 0;
+  else active &= ~(LORENZ_SYSTEM_L2 | LORENZ_SYSTEM_R2);
+
   // Lorenz 1
-  int64_t Ldt1 = static_cast<int64_t>(lut_lorenz_rate[rate1] >> (5 - freq_range1)); // was 5
-  int32_t Lx1 = Lx1_ + (Ldt1 * ((sigma * (Ly1_ - Lx1_)) >> 24) >> 24);
-  int32_t Ly1 = Ly1_ + (Ldt1 * ((Lx1_ * (rho1_ - Lz1_) >> 24) - Ly1_) >> 24);
-  int32_t Lz1 = Lz1_ + (Ldt1 * ((Lx1_ * int64_t(Ly1_) >> 24) - (beta * Lz1_ >> 24)) >> 24); 
-  Lx1_ = Lx1;
-  Ly1_ = Ly1;
-  Lz1_ = Lz1; 
-  int32_t Lz1_scaled = ((Lz1 * 3) >> 16);
-  int32_t Lx1_scaled = ((Lx1 * 3) >> 16) + 32769;
-  int32_t Ly1_scaled = ((Ly1 * 3) >> 16) + 32769;
+  if (active & LORENZ_SYSTEM_L1) {
+    int64_t Ldt1 = static_cast<int64_t>(lut_lorenz_rate[rate1] >> (5 - freq_range1)) * decimation_[0]; // was 5
+    Integrate<LorenzEquations>(Lx1_, Ly1_, Lz1_, Ldt1, rho1_, integrator_);
+  }
+  int32_t Lz1_scaled = ((Lz1_ * 3) >> 16);
+  int32_t Lx1_scaled = ((Lx1_ * 3) >> 16) + 32769;
+  int32_t Ly1_scaled = ((Ly1_ * 3) >> 16) + 32769;
   // Rossler 1
-  int64_t Rdt1 = static_cast<int64_t>(lut_lorenz_rate[rate1] >> 0);
-  int32_t Rx1 = Rx1_ + ((Rdt1 * (-Ry1_ - Rz1_ )) >> 24);
-  int32_t Ry1 = Ry1_ + ((Rdt1 * (Rx1_ + ((a * Ry1_) >> 24))) >> 24);
-  int32_t Rz1 = Rz1_ + ((Rdt1 * (b + ((Rz1_ * (Rx1_ - c1_)) >> 24)))  >> 24);
-  Rx1_ = Rx1;
-  Ry1_ = Ry1;
-  Rz1_ = Rz1; 
-  int32_t Rz1_scaled = (Rz1 >> 14);
-  int32_t Rx1_scaled = (Rx1 >> 14) + 32769;
-  int32_t Ry1_scaled = (Ry1 >> 14) + 32769;
+  if (active & LORENZ_SYSTEM_R1) {
+    int64_t Rdt1 = static_cast<int64_t>(lut_lorenz_rate[rate1] >> 0) * decimation_[0];
+    Integrate<RosslerEquations>(Rx1_, Ry1_, Rz1_, Rdt1, c1_, integrator_);
+  }
+  int32_t Rz1_scaled = (Rz1_ >> 14);
+  int32_t Rx1_scaled = (Rx1_ >> 14) + 32769;
+  int32_t Ry1_scaled = (Ry1_ >> 14) + 32769;
 
   // Lorenz 2
-  int64_t Ldt2 = static_cast<int64_t>(lut_lorenz_rate[rate2] >> (5 - freq_range2)); // was 5
-  int32_t Lx2 = Lx2_ + (Ldt2 * ((sigma * (Ly2_ - Lx2_)) >> 24) >> 24);
-  int32_t Ly2 = Ly2_ + (Ldt2 * ((Lx2_ * (rho2_ - Lz2_) >> 24) - Ly2_) >> 24);
-  int32_t Lz2 = Lz2_ + (Ldt2 * ((Lx2_ * int64_t(Ly2_) >> 24) - (beta * Lz2_ >> 24)) >> 24); 
-  Lx2_ = Lx2;
-  Ly2_ = Ly2;
-  Lz2_ = Lz2; 
-  int32_t Lz2_scaled = ((Lz2 * 3) >> 16);
-  int32_t Lx2_scaled = ((Lx2 * 3) >> 16) + 32769;
-  int32_t Ly2_scaled = ((Ly2 * 3) >> 16) + 32769;
+  if (active & LORENZ_SYSTEM_L2) {
+    int64_t Ldt2 = static_cast<int64_t>(lut_lorenz_rate[rate2] >> (5 - freq_range2)) * decimation_[1]; // was 5
+    Integrate<LorenzEquations>(Lx2_, Ly2_, Lz2_, Ldt2, rho2_, integrator_);
+  }
+  int32_t Lz2_scaled = ((Lz2_ * 3) >> 16);
+  int32_t Lx2_scaled = ((Lx2_ * 3) >> 16) + 32769;
+  int32_t Ly2_scaled = ((Ly2_ * 3) >> 16) + 32769;
   // Rossler 2
-  int64_t Rdt2 = static_cast<int64_t>(lut_lorenz_rate[rate2] >> 0);
-  int32_t Rx2 = Rx2_ + ((Rdt2 * (-Ry2_ - Rz2_ )) >> 24);
-  int32_t Ry2 = Ry2_ + ((Rdt2 * (Rx2_ + ((a * Ry2_) >> 24))) >> 24);
-  int32_t Rz2 = Rz2_ + ((Rdt2 * (b + ((Rz2_ * (Rx2_ - c2_)) >> 24)))  >> 24);
-  Rx2_ = Rx2;
-  Ry2_ = Ry2;
-  Rz2_ = Rz2; 
-  int32_t Rz2_scaled = (Rz2 >> 14);
-  int32_t Rx2_scaled = (Rx2 >> 14) + 32769;
-  int32_t Ry2_scaled = (Ry2 >> 14) + 32769;
+  if (active & LORENZ_SYSTEM_R2) {
+    int64_t Rdt2 = static_cast<int64_t>(lut_lorenz_rate[rate2] >> 0) * decimation_[1];
+    Integrate<RosslerEquations>(Rx2_, Ry2_, Rz2_, Rdt2, c2_, integrator_);
+  }
+  int32_t Rz2_scaled = (Rz2_ >> 14);
+  int32_t Rx2_scaled = (Rx2_ >> 14) + 32769;
+  int32_t Ry2_scaled = (Ry2_ >> 14) + 32769;
 
   uint8_t out_channel ;
   
@@ -69,14 +69,41 @@ enum ELorenzOutputMap {
   LORENZ_OUTPUT_LAST,
 };
 
+enum LorenzIntegrator {
+  LORENZ_INTEGRATOR_EULER,
+  LORENZ_INTEGRATOR_SEMI_IMPLICIT,
+  LORENZ_INTEGRATOR_RK4,
+  LORENZ_INTEGRATOR_LAST
+};
+
+// The four systems, as a bitmask of what needs to be integrated
+enum LorenzSystem {
+  LORENZ_SYSTEM_L1 = 1 << 0,
+  LORENZ_SYSTEM_R1 = 1 << 1,
+  LORENZ_SYSTEM_L2 = 1 << 2,
+  LORENZ_SYSTEM_R2 = 1 << 3,
+};
+
 class LorenzGenerator {
  public:
-  LorenzGenerator() { }
+  LorenzGenerator() :
+    out_a_(LORENZ_OUTPUT_LAST),
+    out_b_(LORENZ_OUTPUT_LAST),
+    out_c_(LORENZ_OUTPUT_LAST),
+    out_d_(LORENZ_OUTPUT_LAST),
+    integrator_(LORENZ_INTEGRATOR_EULER),
+    routed_(0),
+    disabled_(0),
+    decimation_ { 1, 1 },
+    decimation_counter_ { 0, 0 } { }
   ~LorenzGenerator() { }
   
   void Init(uint8_t index);
   
   void Process(int32_t freq1, int32_t freq2, bool reset1, bool reset2, uint8_t freq_range1, uint8_t freq_range2);
+
+  // Systems needed by an output setting
+  static uint8_t OutputSystems(uint8_t out);
  
   void set_index(uint8_t index) {
     index_ = index;
@@ -98,19 +125,59 @@ class LorenzGenerator {
   }
 
   inline void set_out_a(uint8_t out_a) {
-    out_a_ = out_a;
+    if (out_a != out_a_) {
+      out_a_ = out_a;
+      update_routing();
+    }
   }
 
   inline void set_out_b(uint8_t out_b) {
-    out_b_ = out_b;
+    if (out_b != out_b_) {
+      out_b_ = out_b;
+      update_routing();
+    }
   }
 
   inline void set_out_c(uint8_t out_c) {
-    out_c_ = out_c;
+    if (out_c != out_c_) {
+      out_c_ = out_c;
+      update_routing();
+    }
   }
 
   inline void set_out_d(uint8_t out_d) {
-    out_d_ = out_d;
+    if (out_d != out_d_) {
+      out_d_ = out_d;
+      update_routing();
+    }
+  }
+
+  inline void set_integrator(LorenzIntegrator integrator) {
+    integrator_ = integrator;
+  }
+
+  // A disabled generator (0 or 1) holds its state, even if it's routed
+  inline void set_generator_enabled(uint8_t index, bool enabled) {
+    uint8_t mask = index ? (LORENZ_SYSTEM_L2 | LORENZ_SYSTEM_R2) : (LORENZ_SYSTEM_L1 | LORENZ_SYSTEM_R1);
+    if (enabled) disabled_ &= ~mask;
+    else disabled_ |= mask;
+  }
+
+  // Integrate a generator only every n calls to Process(), with an n times
+  // larger step, so the rate stays the same. Larger steps want RK4.
+  inline void set_decimation(uint8_t index, uint8_t n) {
+    decimation_[index] = n ? n : 1;
+  }
+
+  // Raw state in 8.24 fixed point; axis is 0-2 for x, y, z
+  inline int32_t lorenz_state(uint8_t index, uint8_t axis) const {
+    if (index) return axis == 0 ? Lx2_ : (axis == 1 ? Ly2_ : Lz2_);
+    return axis == 0 ? Lx1_ : (axis == 1 ? Ly1_ : Lz1_);
+  }
+
+  inline int32_t rossler_state(uint8_t index, uint8_t axis) const {
+    if (index) return axis == 0 ? Rx2_ : (axis == 1 ? Ry2_ : Rz2_);
+    return axis == 0 ? Rx1_ : (axis == 1 ? Ry1_ : Rz1_);
   }
  
  inline const uint16_t dac_code(uint8_t index) const {
@@ -118,6 +185,10 @@ class LorenzGenerator {
   }
 
  private:
+  void update_routing() {
+    routed_ = OutputSystems(out_a_) | OutputSystems(out_b_) | OutputSystems(out_c_) | OutputSystems(out_d_);
+  }
+
   int32_t Lx1_, Ly1_, Lz1_;
   int32_t Rx1_, Ry1_, Rz1_;
   int32_t Lx2_, Ly2_, Lz2_;
@@ -126,6 +197,12 @@ class LorenzGenerator {
   uint8_t out_a_, out_b_, out_c_, out_d_ ;
 
   int64_t sigma_, rho1_, rho2_, beta_, c1_,  c2_ ;
+
+  LorenzIntegrator integrator_;
+  uint8_t routed_; // LorenzSystem mask of systems used by the outputs
+  uint8_t disabled_; // LorenzSystem mask of systems on hold
+  uint8_t decimation_[2];
+  uint8_t decimation_counter_[2];
   
   // O+C
   uint16_t dac_code_[kNumChannels];
@@ -40,32 +40,48 @@
 
 inline uint32_t USAT16(uint32_t value) __attribute__((always_inline));
 inline uint32_t USAT16(uint32_t value) {
+#if defined(__arm__)
   uint32_t result;
   __asm("usat %0, %1, %2" : "=r" (result) : "I" (16), "r" (value));
   return result;
+#else
+  return static_cast<int32_t>(value) < 0 ? 0 : (value > 65535 ? 65535 : value);
+#endif
 }
 
 inline uint32_t USAT16(int32_t value) __attribute__((always_inline));
 inline uint32_t USAT16(int32_t value) {
+#if defined(__arm__)
   uint32_t result;
   __asm("usat %0, %1, %2" : "=r" (result) : "I" (16), "r" (value));
   return result;
+#else
+  return value < 0 ? 0 : (value > 65535 ? 65535 : value);
+#endif
 }
 
 static inline uint32_t multiply_u32xu32_rshift24(uint32_t a, uint32_t b) __attribute__((always_inline));
 static inline uint32_t multiply_u32xu32_rshift24(uint32_t a, uint32_t b)
 {
+#if defined(__arm__)
   uint32_t lo, hi;
   asm volatile("umull %0, %1, %2, %3" : "=r" (lo), "=r" (hi) : "r" (a), "r" (b));
   return (lo >> 24) | (hi << 8);
+#else
+  return static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> 24);
+#endif
 }
 
 static inline uint32_t multiply_u32xu32_rshift(uint32_t a, uint32_t b, uint32_t shift) __attribute__((always_inline));
 static inline uint32_t multiply_u32xu32_rshift(uint32_t a, uint32_t b, uint32_t shift)
 {
+#if defined(__arm__)
   uint32_t lo, hi;
   asm volatile("umull %0, %1, %2, %3" : "=r" (lo), "=r" (hi) : "r" (a), "r" (b));
   return (lo >> shift) | (hi << (32 - shift));
+#else
+  return static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> shift);
+#endif
 }
 
 template <typename T, T smoothing>
@@ -68,6 +68,11 @@ public:
     write_ptr_ = read_ptr_ = 0;
   }
 
+  // Unread item, counting back from the most recent write; offset < readable()
+  inline T *Recent(size_t offset) {
+    return &buffer_[(write_ptr_ - 1 - offset) & (size - 1)];
+  }
+
   inline T Poke(size_t index_offset) {
     size_t read_ptr = (poke_ptr_ - 1) - index_offset;
     T value = buffer_[read_ptr & (size - 1)];
@@ -26,6 +26,11 @@ namespace HS {
 const byte VO_SEGMENT_COUNT = 64; // The total number of segments in user memory
 const byte VO_MAX_SEGMENTS = 12; // The maximum number of segments in a waveform
 
+// Phase increment per tick for 1 centihertz, in 16.16 fixed point: (2^32 / 1666666.67) << 16
+const uint32_t VO_PHASE_INCREMENT_K = 168884986;
+// Phase units per tenth of a degree: 2^32 / 3600
+const uint32_t VO_PHASE_PER_DECIDEGREE = 1193046;
+
 /*
  * The VOSegment is a single segment of the VectorOscillator that specifies a target
  * level and relative time.
@@ -48,7 +53,7 @@ struct VOSegment {
 
 };
 
-DMAMEM VOSegment user_waveforms[VO_SEGMENT_COUNT];
+extern VOSegment user_waveforms[VO_SEGMENT_COUNT]; // in HSUtils.cpp
 
 }; // namespace HS
 
@@ -73,6 +78,16 @@ public:
     /* Oscillator defaults to non-sustaining. Turing on for EGs, etc. */
     void Sustain(bool sustain_ = 1) {sustain = sustain_;}
 
+    /* Phase accumulator rendering. The waveform is traversed by a 32-bit phase using a
+     * breakpoint table that's only rebuilt when the segments or scale change, so frequency
+     * changes are cheap and the cycle length doesn't drift. Sustaining oscillators always
+     * use the segment-by-segment rise method.
+     */
+    void PhaseMode(bool phase_mode_ = 1) {
+        phase_mode = phase_mode_;
+        breakpoints_dirty = 1;
+    }
+
     /* Move to the release stage after sustain */
     void Release() {
         sustained = 0;
@@ -90,6 +105,7 @@ public:
             memcpy(&segments[segment_count], &segment, sizeof(segments[segment_count]));
             total_time += segments[segment_count].time;
             segment_count++;
+            breakpoints_dirty = 1;
         }
     }
 
@@ -100,6 +116,7 @@ public:
         memcpy(&segments[ix], &segment, sizeof(segments[ix]));
         total_time += segments[ix].time;
         if (ix == segment_count) segment_count++;
+        breakpoints_dirty = 1;
     }
 
     HS::VOSegment GetSegment(byte ix) {
@@ -107,13 +124,17 @@ public:
         return segments[ix];
     }
 
-    void SetScale(uint16_t scale_) {scale = scale_;}
+    void SetScale(uint16_t scale_) {
+        if (scale_ != scale) breakpoints_dirty = 1;
+        scale = scale_;
+    }
 
     /* frequency is centihertz (e.g., 440 Hz is 44000) */
     void SetFrequency(uint32_t frequency_) {
         if (frequency_ != frequency) {
             frequency = frequency_;
-            rise = calculate_rise(segment_index);
+            phase_increment = static_cast<uint32_t>((static_cast<uint64_t>(frequency) * HS::VO_PHASE_INCREMENT_K) >> 16);
+            if (!phase_mode || sustain) rise = calculate_rise(segment_index);
         }
     }
 
@@ -134,6 +155,8 @@ public:
         rise = calculate_rise(segment_index);
         sustained = 0;
         eoc = !cycle;
+        phase = 0;
+        breakpoint_index = 0;
     }
 
     int32_t Next() {
@@ -142,6 +165,7 @@ public:
     			vosignal_t nr_signal = scale_level(segments[segment_count - 1].level);
     			return signal2int(nr_signal) + offset;
     		}
+        if (phase_mode && !sustain) return NextPhase();
         if (!sustained) { // Observe sustain state
 			eoc = 0;
 			if (validate()) {
@@ -165,6 +189,15 @@ public:
     		degrees = degrees % 3600;
     		degrees = abs(degrees);
 
+        if (phase_mode) {
+            if (breakpoints_dirty) build_breakpoints();
+            if (!breakpoints_valid) return offset;
+            uint32_t p = static_cast<uint32_t>(degrees) * HS::VO_PHASE_PER_DECIDEGREE;
+            byte bp = 0;
+            while (bp < segment_count - 1 && p >= bp_phase[bp + 1]) bp++;
+            return level_at(bp, p) + offset;
+        }
+
     		// I need to find out which segment the specified phase occurs in
     		byte time_index = Proportion(degrees, 3600, total_time);
     		byte segment = 0;
@@ -201,14 +234,25 @@ private:
     bool eoc = 1; // The most recent tick's next() read was the end of a cycle
     byte segment_index = 0; // Which segment the Oscillator is currently traversing
     vosignal_t rise; // The amount (per tick) the signal must rise to reach the target
-    uint32_t frequency; // In centihertz
-    uint16_t scale; // The maximum (and minimum negative) output for this Oscillator
+    uint32_t frequency = 0; // In centihertz
+    uint16_t scale = 0; // The maximum (and minimum negative) output for this Oscillator
     uint32_t countdown; // Ticks left for a segment with a rise of 0
     bool cycle = 1; // Waveform will cycle
     int32_t offset = 0; // Amount added to each voltage output (e.g., to make it unipolar)
     bool sustain = 0; // Waveform stops when it reaches the end of the penultimate stage
     bool sustained = 0; // Current state of sustain. Only active when sustain = 1
 
+    // Phase accumulator mode
+    bool phase_mode = 0; // Render with the phase accumulator instead of per-segment rise
+    uint32_t phase = 0; // Position in the cycle; a full cycle is 2^32
+    uint32_t phase_increment = 0; // Phase added per tick, derived from frequency
+    byte breakpoint_index = 0; // Which breakpoint the phase is currently traversing
+    bool breakpoints_dirty = 1; // Segments or scale have changed since the table was built
+    bool breakpoints_valid = 0; // Waveform has more than one segment, nonzero time and nonzero scale
+    uint32_t bp_phase[HS::VO_MAX_SEGMENTS]; // Phase at which each segment starts
+    int32_t bp_level[HS::VO_MAX_SEGMENTS]; // Output level at the start of each segment
+    int64_t bp_slope[HS::VO_MAX_SEGMENTS]; // Level change per phase unit for each segment, << 32
+
     /*
      * The Oscillator can only oscillate if the following conditions are true:
      *     (1) The frequency must be greater than 0
@@ -254,6 +298,59 @@ private:
         }
     }
 
+    /* Precompute the start phase, start level, and slope of each segment. A segment starts at
+     * the level of the previous segment (the last segment, for the first one) and ends at its own.
+     */
+    void build_breakpoints() {
+        breakpoints_dirty = 0;
+        breakpoints_valid = (segment_count > 1 && total_time > 0 && scale > 0);
+        if (!breakpoints_valid) return;
+
+        uint32_t elapsed = 0;
+        int32_t start = signal2int(scale_level(segments[segment_count - 1].level));
+        for (byte ix = 0; ix < segment_count; ix++)
+        {
+            uint64_t seg_start = (static_cast<uint64_t>(elapsed) << 32) / total_time;
+            elapsed += segments[ix].time;
+            uint64_t seg_end = (static_cast<uint64_t>(elapsed) << 32) / total_time;
+            if (seg_start > 0xffffffff) seg_start = 0xffffffff;
+
+            int32_t end = signal2int(scale_level(segments[ix].level));
+            uint64_t span = seg_end - seg_start;
+            bp_phase[ix] = static_cast<uint32_t>(seg_start);
+            bp_level[ix] = start;
+            bp_slope[ix] = span ? (static_cast<int64_t>(end - start) << 32) / static_cast<int64_t>(span) : 0;
+            start = end;
+        }
+    }
+
+    int32_t level_at(byte bp, uint32_t p) {
+        return bp_level[bp] + static_cast<int32_t>((bp_slope[bp] * static_cast<int64_t>(p - bp_phase[bp])) >> 32);
+    }
+
+    int32_t NextPhase() {
+        if (breakpoints_dirty) build_breakpoints();
+        eoc = 0;
+        if (!breakpoints_valid || phase_increment == 0) return signal2int(signal) + offset;
+
+        uint32_t prev_phase = phase;
+        phase += phase_increment;
+        if (phase < prev_phase) { // Wrapped around to a new cycle
+            eoc = 1;
+            breakpoint_index = 0;
+            if (!cycle) {
+                phase = 0;
+                signal = scale_level(segments[segment_count - 1].level);
+                return signal2int(signal) + offset;
+            }
+        }
+        while (breakpoint_index < segment_count - 1 && phase >= bp_phase[breakpoint_index + 1]) breakpoint_index++;
+
+        int32_t level = level_at(breakpoint_index, phase);
+        signal = int2signal(level);
+        return level + offset;
+    }
+
     vosignal_t calculate_rise(byte ix) {
         // Determine the target level for this segment
         byte level = segments[ix].level;
@@ -0,0 +1,172 @@
+#ifndef OC_TEST_HOST_ARDUINO_H_
+#define OC_TEST_HOST_ARDUINO_H_
+
+// Stand-in for the Teensyduino core, so firmware headers that include
+// <Arduino.h> build on the host. Only what the Hemisphere applets and their
+// framework touch; time comes from the harness, see oc_test_host.h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+typedef uint8_t byte;
+
+#define DMAMEM
+#define FLASHMEM
+#define PROGMEM
+
+// the portable paths in extern/dspinst.h
+#define KINETISL
+#define FASTRUN
+
+#define F_CPU 600000000
+#define F_BUS 60000000
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define OUTPUT_OPENDRAIN 4
+#define INPUT_DISABLE 5
+
+// as Teensyduino has it, evaluating each argument once
+#define constrain(amt, low, high) ({ \
+  __typeof__(amt) _amt = (amt); \
+  __typeof__(low) _low = (low); \
+  __typeof__(high) _high = (high); \
+  (_amt < _low) ? _low : ((_amt > _high) ? _high : _amt); \
+})
+
+template <class A, class B>
+constexpr auto min(A &&a, B &&b) -> decltype(a < b ? std::forward<A>(a) : std::forward<B>(b)) {
+    return a < b ? std::forward<A>(a) : std::forward<B>(b);
+}
+template <class A, class B>
+constexpr auto max(A &&a, B &&b) -> decltype(a < b ? std::forward<A>(a) : std::forward<B>(b)) {
+    return a >= b ? std::forward<A>(a) : std::forward<B>(b);
+}
+
+inline void pinMode(uint8_t, uint8_t) { }
+inline void digitalWrite(uint8_t, uint8_t) { }
+inline void digitalWriteFast(uint8_t, uint8_t) { }
+inline uint8_t digitalRead(uint8_t) { return HIGH; }
+inline uint8_t digitalReadFast(uint8_t) { return HIGH; }
+
+// The harness calls the ISR's work itself, so there's nothing to mask
+inline void __disable_irq() { }
+inline void __enable_irq() { }
+
+uint32_t millis();
+uint32_t micros();
+
+// Arduino's global generator, seeded by the harness
+void randomSeed(uint32_t seed);
+int32_t random(int32_t howbig);
+int32_t random(int32_t howsmall, int32_t howbig);
+
+class elapsedMillis {
+public:
+    elapsedMillis() : ms(millis()) { }
+    operator uint32_t() const { return millis() - ms; }
+    elapsedMillis &operator=(uint32_t val) { ms = millis() - val; return *this; }
+private:
+    uint32_t ms;
+};
+
+extern uint32_t ARM_DWT_CYCCNT;
+extern uint32_t ARM_DEMCR;
+extern uint32_t ARM_DWT_CTRL;
+#define ARM_DEMCR_TRCENA 0
+#define ARM_DWT_CTRL_CYCCNTENA 0
+
+// Teensy USB MIDI; sends are counted, SysEx sent is kept with the number of
+// send_now() flushes before it, and read() gets what the harness queues with
+// Receive() and ReceiveSysEx(), a message per call
+class usb_midi_class {
+public:
+    void sendNoteOn(uint8_t, uint8_t, uint8_t, uint8_t = 0) { ++sent; }
+    void sendNoteOff(uint8_t, uint8_t, uint8_t, uint8_t = 0) { ++sent; }
+    void sendControlChange(uint8_t, uint8_t, uint8_t, uint8_t = 0) { ++sent; }
+    void sendPitchBend(int, uint8_t, uint8_t = 0) { ++sent; }
+    void sendAfterTouch(uint8_t, uint8_t, uint8_t = 0) { ++sent; }
+    void sendProgramChange(uint8_t, uint8_t, uint8_t = 0) { ++sent; }
+    void sendRealTime(uint8_t, uint8_t = 0) { ++sent; }
+    void sendSongPosition(uint16_t, uint8_t = 0) { ++sent; }
+    void sendSysEx(uint32_t length, const uint8_t *data, bool = false, uint8_t = 0) {
+        ++sent;
+        sysex_sent.emplace_back(data, data + length);
+        sysex_flushed.push_back(flushes);
+    }
+    void send(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t = 0) { ++sent; }
+    void send_now() { ++flushes; }
+
+    bool read(uint8_t = 0) {
+        if (received.empty()) {
+            type = 0;
+            return false;
+        }
+        const Message &m = received.front();
+        type = m.type;
+        channel = m.channel;
+        data1 = m.data1;
+        data2 = m.data2;
+        received.pop_front();
+        return true;
+    }
+    uint8_t getType() { return type; }
+    uint8_t getChannel() { return channel; }
+    uint8_t getData1() { return data1; }
+    uint8_t getData2() { return data2; }
+    uint8_t *getSysExArray() { return sysex; }
+    uint16_t getSysExArrayLength() { return sysex_length; }
+
+    // Queues a channel or real-time message; channel is 1-16
+    void Receive(uint8_t type_, uint8_t channel_ = 0, uint8_t data1_ = 0, uint8_t data2_ = 0) {
+        received.push_back({type_, channel_, data1_, data2_});
+    }
+
+    // Queues this message, F0 to F7. There's room for one at a time.
+    void ReceiveSysEx(const uint8_t *data, uint16_t length) {
+        sysex_length = length < sizeof(sysex) ? length : sizeof(sysex);
+        memcpy(sysex, data, sysex_length);
+        Receive(SystemExclusive);
+    }
+
+    size_t pending() const { return received.size(); }
+
+    enum {
+        NoteOff = 0x80, NoteOn = 0x90, AfterTouchPoly = 0xA0, ControlChange = 0xB0,
+        ProgramChange = 0xC0, AfterTouchChannel = 0xD0, PitchBend = 0xE0,
+        SystemExclusive = 0xF0, SongPosition = 0xF2, Clock = 0xF8, Start = 0xFA, Continue = 0xFB,
+        Stop = 0xFC, SystemReset = 0xFF
+    };
+
+    uint32_t sent = 0;
+    uint32_t flushes = 0;
+    std::vector<std::vector<uint8_t>> sysex_sent;
+    std::vector<uint32_t> sysex_flushed;
+
+private:
+    struct Message {
+        uint8_t type, channel, data1, data2;
+    };
+    std::deque<Message> received;
+    uint8_t sysex[128] = { };
+    uint16_t sysex_length = 0;
+    uint8_t type = 0;
+    uint8_t channel = 0;
+    uint8_t data1 = 0;
+    uint8_t data2 = 0;
+};
+extern usb_midi_class usbMIDI;
+
+#endif // OC_TEST_HOST_ARDUINO_H_
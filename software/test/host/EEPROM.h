@@ -0,0 +1,7 @@
+#ifndef OC_TEST_HOST_EEPROM_H_
+#define OC_TEST_HOST_EEPROM_H_
+
+// Stand-in for the Teensyduino EEPROM library. Apps include it, but settings
+// go through EEPROMStorage, which oc_test_host.h replaces.
+
+#endif // OC_TEST_HOST_EEPROM_H_
@@ -0,0 +1,498 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "gtest/gtest.h"
+
+// Golden traces of every applet in hemisphere_config.h, on the host board.
+//
+// Each applet runs in both slots through the same script: clocks on the
+// trigger inputs, ramps and steps on the CV inputs, and encoder and button
+// events, with the random streams seeded. The trace keeps the outputs, as a
+// hash of every tick and the values at the end of each segment, and what
+// OnDataRequest() packs after each event. It has to match the one checked in
+// under golden/; after an intended change, rerun with OC_TEST_UPDATE_GOLDEN=1
+// to rewrite it, and review the diff.
+//
+// The time Controller() takes per tick is reported alongside, not checked.
+//
+// The loopers are only built for the Teensy 4.x, so they're traced from their
+// own registry here, with a pool of sample memory of their own and MIDI notes
+// for the MIDI looper to record.
+
+#include "oc_test_host.h"
+#include "OC_core.h"
+#include "OC_apps.h"
+#include "OC_menus.h"
+#include "OC_calibration.h"
+#include "OC_patterns.h"
+#include "OC_DAC.h"
+#include "OC_ui.h"
+#include "HemisphereApplet.h"
+#include "HSicons.h"
+#include "HSMIDI.h"
+#include "HSClockManager.h"
+#include "hemisphere_config.h"
+#ifndef ARDUINO_TEENSY41
+#include "applets/CVLooper.h"
+#endif
+#if !defined(__IMXRT1062__)
+#include "applets/MIDILooper.h"
+#endif
+
+namespace {
+
+constexpr AppletRegistry looper_reg{
+    DeclareApplet<CVLooper>{89, 0x02},
+    DeclareApplet<MIDILooper>{90, 0x20},
+};
+
+static constexpr const char *kGoldenFile = "golden/hemisphere_applets.txt";
+
+static constexpr uint32_t kTicks = 16384; // about a second
+static constexpr uint32_t kSegment = 1024;
+static constexpr uint32_t kViewTicks = 256;
+static constexpr uint8_t kSeed = 5; // a fixed seed, 1-7 as presets store it
+
+static constexpr int kVolt = 12 << 7;
+
+// Encoder and button events, to both slots
+enum ScriptEvent { MOVE, PRESS, AUX };
+struct ScriptStep {
+  uint32_t tick;
+  ScriptEvent event;
+  int direction;
+};
+static constexpr ScriptStep kScript[] = {
+  { 1500, MOVE, 1 },
+  { 2500, PRESS, 0 },
+  { 3000, MOVE, 2 },
+  { 4000, MOVE, -1 },
+  { 5000, PRESS, 0 },
+  { 6000, MOVE, 1 },
+  { 6500, PRESS, 0 },
+  { 7000, MOVE, 5 },
+  { 8500, PRESS, 0 },
+  { 9000, MOVE, 1 },
+  { 10000, PRESS, 0 },
+  { 10500, MOVE, -3 },
+  { 11500, PRESS, 0 },
+  { 12500, MOVE, 2 },
+  { 13000, PRESS, 0 },
+  { 13500, MOVE, 1 },
+  { 14000, PRESS, 0 },
+  { 15000, AUX, 0 },
+};
+
+// The script's inputs at tick t: a steady clock and an uneven one per slot,
+// and per slot a triangle and random steps (left), or a saw and a square
+// (right) on the CV inputs
+static uint32_t ScriptGates(uint32_t t) {
+  uint32_t gates = 0;
+  if (t % 1000 < 100) gates |= 1 << 0;
+  if (t % 3100 < 200 || t % 3100 - 1400 < 60) gates |= 1 << 1;
+  if ((t + 300) % 1500 < 50) gates |= 1 << 2;
+  if ((t + 1200) % 4100 < 1000) gates |= 1 << 3;
+  return gates;
+}
+
+static uint32_t StepValue(uint32_t step) {
+  uint32_t x = step * 2654435761u + kSeed;
+  x ^= x >> 15;
+  x *= 2246822519u;
+  x ^= x >> 13;
+  return x;
+}
+
+static void ScriptCV(uint32_t t, int32_t cv[4]) {
+  const int32_t tri = t % 8192;
+  cv[0] = (tri < 4096 ? tri : 8192 - tri) * 7 * kVolt / 4096 - 2 * kVolt;
+  cv[1] = int32_t(StepValue(t / 1200) % (8 * kVolt)) - 3 * kVolt;
+  cv[2] = int32_t(t % 5000) * 5 * kVolt / 5000;
+  cv[3] = (t % 2900 < 1450) ? 5 * kVolt : 0;
+}
+
+// Notes for the MIDI looper, on the left slot's steady clock
+static void ScriptMIDI(uint32_t t) {
+  const uint8_t note = 48 + StepValue(t / 1000) % 24;
+  if (t % 1000 == 250) HS::frame.MIDIState.ProcessMIDIMsg(1, usbMIDI.NoteOn, note, 100);
+  if (t % 1000 == 600) HS::frame.MIDIState.ProcessMIDIMsg(1, usbMIDI.NoteOff, note, 0);
+}
+
+struct Trace {
+  std::vector<std::string> lines;
+  uint64_t nanoseconds = 0;
+};
+
+static std::string Hex(uint64_t v) {
+  char buf[20];
+  snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)v);
+  return buf;
+}
+
+// Puts the applet at index back the way it was first built, so a run doesn't
+// depend on what ran before it
+template <class... A>
+static void Reconstruct(const AppletRegistry<A...> &, int index, HemisphereApplet *applet) {
+  using Rebuild = void (*)(HemisphereApplet *);
+  static constexpr Rebuild rebuild[] = {
+    [](HemisphereApplet *p) {
+      A *a = static_cast<A *>(p);
+      a->~A();
+      new (a) A();
+    }...
+  };
+  rebuild[index](applet);
+}
+
+// The framework state the Hemisphere app would set up
+static void ResetFramework() {
+  OC::Host::Reset(kSeed);
+  HS::frame = HS::IOFrame();
+  HS::clock_m = HS::ClockManager();
+  HS::random_seed = kSeed;
+  HS::Init();
+  WaveformManager::Setup(); // the user waveforms, as saved once the editor has run
+  OC::Patterns::Init(); // the sequences MiniSeq applets share
+  ProbLoopLinker::get()->Reset(); // the link between ProbDiv and ProbMelo
+  LorenzGeneratorManager::get()->Init(); // LowerRenz's generators
+  buffer_m = RingBufferManager(); // ASR's ring buffer
+  for (int i = 0; i < HS::QUANT_CHANNEL_COUNT; ++i) {
+    HS::QuantizerConfigure(i, OC::Scales::SCALE_SEMI, 0xffff);
+    HS::root_note[i] = 0;
+    HS::q_octave[i] = 0;
+  }
+}
+
+static void Record(Trace &trace, const std::string &line) {
+  trace.lines.push_back(line);
+}
+
+// The loopers' pool, and the fastest tempo, so that loops of a beat or more go
+// round a few times in the script
+static void LooperFramework() {
+  static uint8_t memory[APPLET_SLOTS * 65536];
+  HS::buffer_pool.Init(APPLET_SLOTS);
+  HS::buffer_pool.AddRegion(memory, sizeof(memory));
+  HS::clock_m.SetTempoBPM(HS::CLOCK_TEMPO_MAX);
+}
+
+template <class... A>
+static Trace Play(const AppletRegistry<A...> &registry, int index, bool looper = false) {
+  Trace trace;
+  ResetFramework();
+  if (looper) LooperFramework();
+
+  HemisphereApplet *slot[2];
+  for (int h = 0; h < 2; ++h) {
+    slot[h] = registry.applets[index].instance[h];
+    Reconstruct(registry, index, slot[h]);
+    slot[h]->BaseStart(HEM_SIDE(h));
+  }
+
+  static uint8_t frame_buffer[weegfx::Graphics::kFrameSize];
+  size_t next_step = 0;
+  uint64_t hash = 14695981039346656037ull; // FNV-1a of every tick's outputs
+
+  for (uint32_t t = 0; t < kTicks; ++t) {
+    int32_t cv[4];
+    ScriptCV(t, cv);
+    for (int ch = 0; ch < 4; ++ch) OC::Host::SetCV(ch, cv[ch]);
+    OC::Host::SetGates(ScriptGates(t));
+    OC::Host::Tick();
+
+    // as the Hemisphere app's ISR does it
+    HS::frame.Load();
+    if (looper) ScriptMIDI(t);
+    const auto start = std::chrono::steady_clock::now();
+    for (int h = 0; h < 2; ++h) {
+      if (HS::clock_m.auto_reset) slot[h]->Reset();
+      slot[h]->BaseController();
+    }
+    trace.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    HS::clock_m.auto_reset = false;
+
+    // and its main loop
+    for (int h = 0; h < 2; ++h) slot[h]->Idle();
+    HS::buffer_pool.Idle();
+
+    if (t % kViewTicks == 0) {
+      graphics.Begin(frame_buffer, weegfx::CLEAR_FRAME_ENABLE);
+      for (int h = 0; h < 2; ++h) slot[h]->BaseView();
+      graphics.End();
+    }
+
+    for (int ch = 0; ch < 4; ++ch) {
+      uint32_t v = HS::frame.outputs[ch];
+      for (int b = 0; b < 4; ++b, v >>= 8) hash = (hash ^ (v & 0xff)) * 1099511628211ull;
+    }
+
+    if (next_step < ARRAY_SIZE(kScript) && kScript[next_step].tick == t) {
+      const ScriptStep &s = kScript[next_step++];
+      for (int h = 0; h < 2; ++h) {
+        switch (s.event) {
+        case MOVE: slot[h]->OnEncoderMove(s.direction); break;
+        case PRESS: slot[h]->OnButtonPress(); break;
+        case AUX: slot[h]->AuxButton(); break;
+        }
+      }
+      const char *names[] = {"move", "press", "aux"};
+      std::ostringstream line;
+      line << t << ' ' << names[s.event];
+      if (s.event == MOVE) line << ' ' << s.direction;
+      line << " data " << Hex(slot[0]->OnDataRequest()) << ' ' << Hex(slot[1]->OnDataRequest());
+      Record(trace, line.str());
+    }
+
+    if ((t + 1) % kSegment == 0) {
+      std::ostringstream line;
+      line << t + 1 << " out";
+      for (int ch = 0; ch < 4; ++ch) line << ' ' << HS::frame.outputs[ch];
+      line << " midi " << usbMIDI.sent << " hash " << Hex(hash);
+      Record(trace, line.str());
+    }
+  }
+
+  // the help screen, then saving and restoring into a new instance
+  graphics.Begin(frame_buffer, weegfx::CLEAR_FRAME_ENABLE);
+  for (int h = 0; h < 2; ++h) slot[h]->BaseView(true);
+  graphics.End();
+
+  std::ostringstream line;
+  line << "saved";
+  for (int h = 0; h < 2; ++h) {
+    const uint64_t data = slot[h]->OnDataRequest();
+    slot[h]->Unload();
+    Reconstruct(registry, index, slot[h]);
+    slot[h]->BaseStart(HEM_SIDE(h));
+    slot[h]->OnDataReceive(data);
+    line << ' ' << Hex(data) << ' ' << Hex(slot[h]->OnDataRequest());
+    slot[h]->Unload();
+  }
+  Record(trace, line.str());
+
+  return trace;
+}
+
+template <class... A>
+static std::string SectionName(const AppletRegistry<A...> &registry, int index) {
+  std::ostringstream name;
+  name << '[' << registry.applets[index].id << ' '
+       << registry.applets[index].instance[0]->applet_name() << ']';
+  return name.str();
+}
+
+// Golden traces by section name, in file order
+typedef std::vector<std::pair<std::string, std::vector<std::string>>> Golden;
+
+static bool ReadGolden(Golden &golden) {
+  std::ifstream in(kGoldenFile);
+  if (!in) return false;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    if (line[0] == '[') golden.emplace_back(line, std::vector<std::string>());
+    else if (!golden.empty()) golden.back().second.push_back(line);
+  }
+  return true;
+}
+
+static void WriteGolden(const Golden &golden) {
+  std::ofstream out(kGoldenFile);
+  out << "# Golden traces of the Hemisphere applets, see oc_test_applets.cpp\n"
+      << "# Rewrite with OC_TEST_UPDATE_GOLDEN=1 after an intended change\n";
+  for (const auto &section : golden) {
+    out << '\n' << section.first << '\n';
+    for (const std::string &line : section.second) out << line << '\n';
+  }
+}
+
+// Plays the applet and checks its trace against the golden one, or rewrites it
+template <class... A>
+static void CheckGolden(const AppletRegistry<A...> &registry, int index, bool looper = false) {
+  const std::string name = SectionName(registry, index);
+  const Trace trace = Play(registry, index, looper);
+
+  printf("[   COST   ] %-22s %6llu ns/tick\n", name.c_str(),
+         (unsigned long long)(trace.nanoseconds / (kTicks * 2)));
+
+  Golden golden;
+  const bool have_golden = ReadGolden(golden);
+  auto section = golden.begin();
+  while (section != golden.end() && section->first != name) ++section;
+
+  const char *update = getenv("OC_TEST_UPDATE_GOLDEN");
+  if (update && *update && *update != '0') {
+    if (section != golden.end()) section->second = trace.lines;
+    else golden.emplace_back(name, trace.lines);
+    WriteGolden(golden);
+    return;
+  }
+
+  ASSERT_TRUE(have_golden) << "can't read " << kGoldenFile << "; run from software/test";
+  ASSERT_TRUE(section != golden.end()) << "no golden trace for " << name;
+  const std::vector<std::string> &expected = section->second;
+  for (size_t i = 0; i < std::max(expected.size(), trace.lines.size()); ++i) {
+    ASSERT_EQ(i < expected.size() ? expected[i] : "(end)",
+              i < trace.lines.size() ? trace.lines[i] : "(end)")
+        << name << " first differs at line " << i + 1 << " of its trace";
+  }
+}
+
+template <const auto &registry>
+static std::string TestName(const ::testing::TestParamInfo<int> &info) {
+  std::string name = registry.applets[info.param].instance[0]->applet_name();
+  std::string id;
+  for (char c : name) if (isalnum((unsigned char)c)) id += c;
+  return id + "_" + std::to_string(registry.applets[info.param].id);
+}
+
+class AppletTrace : public ::testing::TestWithParam<int> { };
+
+TEST_P(AppletTrace, MatchesGolden) {
+  CheckGolden(reg, GetParam());
+}
+
+INSTANTIATE_TEST_SUITE_P(Hemisphere, AppletTrace,
+                         ::testing::Range(0, int(HS::HEMISPHERE_AVAILABLE_APPLETS)),
+                         TestName<reg>);
+
+class LooperTrace : public ::testing::TestWithParam<int> { };
+
+TEST_P(LooperTrace, MatchesGolden) {
+  CheckGolden(looper_reg, GetParam(), true);
+}
+
+INSTANTIATE_TEST_SUITE_P(Hemisphere, LooperTrace,
+                         ::testing::Range(0, int(looper_reg.applets.size())),
+                         TestName<looper_reg>);
+
+// Controller() calls counted, for the control rate replay
+template <class A>
+struct Counted final : A {
+  uint32_t calls = 0;
+  void Controller() override {
+    ++calls;
+    A::Controller();
+  }
+};
+
+struct RateReplay {
+  uint32_t calls = 0;         // Controller() calls, both slots
+  uint32_t busiest = 0;       // most in one tick
+  uint64_t mean_ns = 0;       // per tick, both slots
+  uint64_t worst_ns = 0;      // the slowest tick
+};
+
+// Runs the script's inputs through a pair of applets, with Controller()
+// every tick as before control rates, or through BaseController(). The cost
+// of each tick is the fastest of a few runs, to keep host noise out of the
+// worst case.
+template <class A>
+static RateReplay ReplayControlRate(bool scheduled) {
+  static constexpr int kRuns = 5;
+  std::vector<uint64_t> tick_ns(kTicks, UINT64_MAX);
+  RateReplay replay;
+
+  for (int run = 0; run < kRuns; ++run) {
+    ResetFramework();
+    Counted<A> *slot[2];
+    for (int h = 0; h < 2; ++h) {
+      slot[h] = new Counted<A>();
+      slot[h]->BaseStart(HEM_SIDE(h));
+    }
+
+    for (uint32_t t = 0; t < kTicks; ++t) {
+      int32_t cv[4];
+      ScriptCV(t, cv);
+      for (int ch = 0; ch < 4; ++ch) OC::Host::SetCV(ch, cv[ch]);
+      OC::Host::SetGates(ScriptGates(t));
+      OC::Host::Tick();
+      HS::frame.Load();
+
+      const uint32_t before = slot[0]->calls + slot[1]->calls;
+      const auto start = std::chrono::steady_clock::now();
+      for (int h = 0; h < 2; ++h) {
+        if (scheduled) slot[h]->BaseController();
+        else slot[h]->Controller();
+      }
+      const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start).count();
+      tick_ns[t] = std::min(tick_ns[t], ns);
+      if (run == 0) replay.busiest = std::max(replay.busiest, slot[0]->calls + slot[1]->calls - before);
+
+      for (int h = 0; h < 2; ++h) slot[h]->Idle();
+      HS::buffer_pool.Idle();
+    }
+
+    if (run == 0) replay.calls = slot[0]->calls + slot[1]->calls;
+    for (int h = 0; h < 2; ++h) {
+      slot[h]->Unload();
+      delete slot[h];
+    }
+  }
+
+  for (uint64_t ns : tick_ns) {
+    replay.mean_ns += ns;
+    replay.worst_ns = std::max(replay.worst_ns, ns);
+  }
+  replay.mean_ns /= kTicks;
+  return replay;
+}
+
+template <class... A>
+static void CompareControlRates(const AppletRegistry<A...> &) {
+  auto compare = [](auto *type) {
+    using T = std::remove_pointer_t<decltype(type)>;
+    T probe;
+    const uint8_t rate = probe.ControlRate();
+    if (rate == HemisphereApplet::CONTROL_RATE_TICK) return;
+
+    const RateReplay every = ReplayControlRate<T>(false);
+    const RateReplay sched = ReplayControlRate<T>(true);
+    printf("[   RATE   ] %-10s %-5s %5u -> %5u calls (at most %u -> %u a tick), "
+           "worst tick %5llu -> %5llu ns, mean %4llu -> %4llu ns\n",
+           probe.applet_name(), rate ? ("/" + std::to_string(rate)).c_str() : "event",
+           every.calls, sched.calls, every.busiest, sched.busiest,
+           (unsigned long long)every.worst_ns, (unsigned long long)sched.worst_ns,
+           (unsigned long long)every.mean_ns, (unsigned long long)sched.mean_ns);
+
+    EXPECT_EQ(2 * kTicks, every.calls) << probe.applet_name();
+    EXPECT_LT(sched.calls, every.calls) << probe.applet_name();
+    if (rate) {
+      EXPECT_GE(sched.calls, 2 * kTicks / rate) << probe.applet_name();
+    }
+  };
+  (compare(static_cast<A *>(nullptr)), ...);
+}
+
+// Applets with a reduced control rate, against running them every tick
+TEST(HemisphereApplets, ControlRateReplay) {
+  CompareControlRates(reg);
+}
+
+// The trace can't depend on anything but the script, so not on the applets
+// that ran before it either: they all run again in reverse
+TEST(HemisphereApplets, TraceRepeatable) {
+  std::vector<Trace> forward;
+  for (int index = 0; index < HS::HEMISPHERE_AVAILABLE_APPLETS; ++index) forward.push_back(Play(reg, index));
+  for (int index = 0; index < int(looper_reg.applets.size()); ++index) forward.push_back(Play(looper_reg, index, true));
+  for (int index = looper_reg.applets.size() - 1; index >= 0; --index) {
+    EXPECT_EQ(forward[HS::HEMISPHERE_AVAILABLE_APPLETS + index].lines, Play(looper_reg, index, true).lines)
+        << SectionName(looper_reg, index);
+  }
+  for (int index = HS::HEMISPHERE_AVAILABLE_APPLETS - 1; index >= 0; --index) {
+    EXPECT_EQ(forward[index].lines, Play(reg, index).lines) << SectionName(reg, index);
+  }
+}
+
+} // namespace
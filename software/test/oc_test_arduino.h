@@ -0,0 +1,26 @@
+#ifndef OC_TEST_ARDUINO_H_
+#define OC_TEST_ARDUINO_H_
+
+// Minimal stand-ins for the Arduino/Teensy bits that header-only sources
+// expect, so they can be compiled and exercised on the host.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+
+#ifndef DMAMEM
+#define DMAMEM
+#endif
+
+// Nothing preempts a host test, so there's nothing to hold off
+inline void __disable_irq() { }
+inline void __enable_irq() { }
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+#endif // OC_TEST_ARDUINO_H_
@@ -0,0 +1,215 @@
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "gtest/gtest.h"
+#include "HSAudioKernels.h"
+
+using namespace HS;
+
+// Renders are written here when the test runs from the test directory
+static const char kRenderDir[] = "build/";
+
+static const int kRenderBlocks = 2 * (int)AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE; // ~2s
+
+// A decaying saw pluck every half second, rich enough to hear every kernel
+static std::vector<int16_t> TestSignal() {
+  std::vector<int16_t> signal(kRenderBlocks * AUDIO_BLOCK_SIZE);
+  const int pluck = (int)AUDIO_SAMPLE_RATE / 2;
+  for (size_t n = 0; n < signal.size(); ++n) {
+    const float t = (float)(n % pluck) / AUDIO_SAMPLE_RATE;
+    const float phase = fmodf(t * 220.0f, 1.0f);
+    signal[n] = (int16_t)(20000.0f * (2.0f * phase - 1.0f) * expf(-6.0f * t));
+  }
+  return signal;
+}
+
+static void WriteWav(const char *name, const std::vector<int16_t> &samples) {
+  char path[128];
+  snprintf(path, sizeof(path), "%saudio_%s.wav", kRenderDir, name);
+  FILE *f = fopen(path, "wb");
+  if (!f) return;
+
+  const uint32_t rate = 44118, data_size = samples.size() * 2, riff_size = 36 + data_size;
+  const uint32_t fmt_size = 16, byte_rate = rate * 2;
+  const uint16_t format = 1, channels = 1, align = 2, bits = 16;
+  fwrite("RIFF", 1, 4, f); fwrite(&riff_size, 4, 1, f); fwrite("WAVE", 1, 4, f);
+  fwrite("fmt ", 1, 4, f); fwrite(&fmt_size, 4, 1, f);
+  fwrite(&format, 2, 1, f); fwrite(&channels, 2, 1, f); fwrite(&rate, 4, 1, f);
+  fwrite(&byte_rate, 4, 1, f); fwrite(&align, 2, 1, f); fwrite(&bits, 2, 1, f);
+  fwrite("data", 1, 4, f); fwrite(&data_size, 4, 1, f);
+  fwrite(samples.data(), 2, samples.size(), f);
+  fclose(f);
+}
+
+static uint64_t Cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// Runs a kernel over the test signal block by block, the way the audio
+// update does, calling control() before each block as Controller() would.
+// Reports the cost per block and writes a WAV of the result.
+template <class Control>
+static std::vector<int16_t> Render(const char *name, AudioKernel &kernel, Control control) {
+  std::vector<int16_t> audio = TestSignal();
+  uint64_t cycles = 0;
+  std::chrono::steady_clock::duration elapsed{};
+  for (int b = 0; b < kRenderBlocks; ++b) {
+    control(b);
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t c0 = Cycles();
+    kernel.Process(&audio[b * AUDIO_BLOCK_SIZE]);
+    cycles += Cycles() - c0;
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+  const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / kRenderBlocks;
+  const double block_ns = 1e9 * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE;
+  std::cout << "Audio kernel " << name << ": " << (cycles / kRenderBlocks) << " cycles/block, "
+            << ns << " ns/block (" << 100.0 * ns / block_ns << "% of a block)" << std::endl;
+  WriteWav(name, audio);
+  return audio;
+}
+
+TEST(AudioKernels, ParamBuffer) {
+  struct Pair { int a, b; };
+  ParamBuffer<Pair> buffer;
+  Pair p{0, 0};
+  EXPECT_FALSE(buffer.Read(p));
+
+  buffer.Write({1, -1});
+  buffer.Write({2, -2});
+  EXPECT_TRUE(buffer.Read(p));
+  EXPECT_EQ(2, p.a); // latest wins
+  EXPECT_EQ(-2, p.b);
+  EXPECT_FALSE(buffer.Read(p)); // and p is left alone
+  EXPECT_EQ(2, p.a);
+
+  for (int i = 3; i < 100; ++i) {
+    buffer.Write({i, -i});
+    ASSERT_TRUE(buffer.Read(p));
+    ASSERT_EQ(i, p.a);
+    ASSERT_EQ(-i, p.b);
+  }
+}
+
+TEST(AudioKernels, BitCrush) {
+  BitCrushKernel crush;
+  std::vector<int16_t> dry = TestSignal();
+
+  // rate 1, depth 0 is transparent
+  std::vector<int16_t> clean = Render("crush_off", crush, [](int) {});
+  EXPECT_EQ(dry, clean);
+
+  BitCrushKernel::Params p;
+  std::vector<int16_t> out = Render("crush", crush, [&](int b) {
+    p.rate = 1 + (b / 32) % 8;
+    p.depth = 4 + (b / 64) % 8;
+    crush.Set(p);
+  });
+
+  // every held sample keeps only the top bits, and is held rate times. The
+  // first few samples of a block may still be held from the last one.
+  for (int b = 0; b < kRenderBlocks; ++b) {
+    const int depth = 4 + (b / 64) % 8;
+    for (int n = 8; n < AUDIO_BLOCK_SIZE; ++n)
+      ASSERT_EQ(0, out[b * AUDIO_BLOCK_SIZE + n] & ((1 << depth) - 1));
+  }
+  const int start = 200 * AUDIO_BLOCK_SIZE, rate = 1 + (200 / 32) % 8;
+  int run = 1, longest = 1;
+  for (int n = start + 1; n < start + AUDIO_BLOCK_SIZE; ++n) {
+    run = out[n] == out[n - 1] ? run + 1 : 1;
+    longest = std::max(longest, run);
+  }
+  EXPECT_GE(longest, rate);
+}
+
+TEST(AudioKernels, VcaLpg) {
+  VcaLpgKernel vca;
+  VcaLpgKernel::Params p;
+
+  // unity after the first ramp
+  p.level = 1.0f;
+  vca.Set(p);
+  std::vector<int16_t> dry = TestSignal();
+  std::vector<int16_t> out = Render("vca_unity", vca, [](int) {});
+  for (size_t n = AUDIO_BLOCK_SIZE; n < out.size(); ++n) ASSERT_NEAR(dry[n], out[n], 1);
+
+  // An envelope per pluck, as a gate-driven LPG would get it
+  const int blocks_per_pluck = (int)AUDIO_SAMPLE_RATE / 2 / AUDIO_BLOCK_SIZE;
+  auto envelope = [&](int b) {
+    p.level = expf(-8.0f * (b % blocks_per_pluck) / blocks_per_pluck);
+    return p.level;
+  };
+  p.lowpass = false;
+  std::vector<int16_t> vca_out = Render("vca", vca, [&](int b) { envelope(b); vca.Set(p); });
+  p.lowpass = true;
+  std::vector<int16_t> lpg_out = Render("lpg", vca, [&](int b) { envelope(b); vca.Set(p); });
+
+  // no zipper steps: sample to sample change stays within what the signal does
+  int worst_jump = 0;
+  for (size_t n = 1; n < vca_out.size(); ++n)
+    worst_jump = std::max(worst_jump, abs(vca_out[n] - vca_out[n - 1]) - abs(dry[n] - dry[n - 1]));
+  EXPECT_LT(worst_jump, 600);
+
+  // as the gate closes the LPG loses highs faster than the VCA does:
+  // compare the energy of the first difference to that of the signal
+  auto brightness = [](const std::vector<int16_t> &x, size_t from, size_t to) {
+    double diff = 0, level = 0;
+    for (size_t n = from + 1; n < to; ++n) {
+      const double d = (double)x[n] - x[n - 1];
+      diff += d * d;
+      level += (double)x[n] * x[n];
+    }
+    return diff / (level + 1);
+  };
+  const size_t from = (blocks_per_pluck / 8) * AUDIO_BLOCK_SIZE, to = (blocks_per_pluck / 4) * AUDIO_BLOCK_SIZE;
+  const double vca_brightness = brightness(vca_out, from, to), lpg_brightness = brightness(lpg_out, from, to);
+  std::cout << "Audio kernel lpg: brightness " << lpg_brightness << " vs vca " << vca_brightness << std::endl;
+  EXPECT_LT(lpg_brightness, 0.5 * vca_brightness);
+}
+
+TEST(AudioKernels, Delay) {
+  static int16_t memory[8192];
+  DelayKernel delay;
+  delay.Init(memory, 8192);
+  EXPECT_EQ(8191u, delay.max_time());
+
+  // an impulse comes back after the delay time, quieter on every repeat
+  DelayKernel::Params p;
+  p.time = 1000;
+  p.feedback = 16384;
+  p.mix = 32767;
+  delay.Set(p);
+  int16_t block[AUDIO_BLOCK_SIZE];
+  std::vector<int16_t> out;
+  for (int b = 0; b < 40; ++b) {
+    for (int16_t &s : block) s = 0;
+    if (b == 8) block[0] = 16000;
+    delay.Process(block);
+    out.insert(out.end(), block, block + AUDIO_BLOCK_SIZE);
+  }
+  // the time glides from 1 up to 1000 during the first 1000 samples
+  const int impulse = 8 * AUDIO_BLOCK_SIZE;
+  EXPECT_NEAR(16000, out[impulse + 1000], 2);
+  EXPECT_NEAR(8000, out[impulse + 2000], 2);
+  EXPECT_NEAR(4000, out[impulse + 3000], 2);
+  EXPECT_EQ(0, out[impulse + 1500]);
+
+  // and a render with the time swept
+  static int16_t memory2[32768];
+  DelayKernel sweep;
+  sweep.Init(memory2, 32768);
+  Render("delay", sweep, [&](int b) {
+    p.time = 4000 + 3000 * sinf(b * 0.02f);
+    p.feedback = 22000;
+    p.mix = 12000;
+    sweep.Set(p);
+  });
+}
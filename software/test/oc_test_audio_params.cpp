@@ -0,0 +1,114 @@
+#include <math.h>
+#include "gtest/gtest.h"
+#include "OC_audio_params.h"
+
+using namespace OC::AudioDSP;
+
+static constexpr float kSampleRate = 44117.647f;   // AUDIO_SAMPLE_RATE_EXACT
+static constexpr int kCoreTicksPerSecond = 16667;  // 60us core ISR
+static constexpr int kMaxCV = 9216;
+
+// An LFO into the VCA, with a couple of LSBs of ADC noise
+static int LfoCV(int tick) {
+  const float phase = 2.0f * 3.14159265f * 0.5f * tick / kCoreTicksPerSecond;
+  return static_cast<int>(kMaxCV * 0.5f * (1.0f + sinf(phase))) + (tick * 7) % 5 - 2;
+}
+
+TEST(AudioParams, SetterCallsPerSecond) {
+  ParamBridge<3> params;
+  params.Init();
+  params.SetThreshold(0, 1.0f / 4096);
+
+  // Before: every core tick pushed the new value into the audio object
+  int direct_calls = 0;
+  float last = -1.0f;
+  for (int tick = 0; tick < kCoreTicksPerSecond; ++tick) {
+    const float level = (float)LfoCV(tick) / kMaxCV;
+    if (level != last) ++direct_calls;
+    last = level;
+  }
+
+  // After: the core ISR sets targets, the audio update latches them per block.
+  // Param 1 stays put, param 2 is never touched.
+  int bridge_calls = 0, blocks = 0;
+  double next_block = 0.0;
+  const double ticks_per_block = kCoreTicksPerSecond * kBlockSamples / kSampleRate;
+  for (int tick = 0; tick < kCoreTicksPerSecond; ++tick) {
+    params.Set(0, (float)LfoCV(tick) / kMaxCV);
+    params.Set(1, 0.25f);
+    if (tick >= next_block) {
+      const uint32_t changed = params.Latch();
+      for (int i = 0; i < 3; ++i) bridge_calls += (changed >> i) & 1;
+      ++blocks;
+      next_block += ticks_per_block;
+    }
+  }
+
+  std::cout << "Audio params: " << direct_calls << " setter calls/s direct, "
+            << bridge_calls << " via bridge (" << blocks << " blocks/s)" << std::endl;
+  EXPECT_GT(direct_calls, 10000);
+  EXPECT_LE(bridge_calls, blocks + 1); // the LFO, plus param 1's first move
+  EXPECT_GT(bridge_calls, blocks / 2);
+}
+
+TEST(AudioParams, UnchangedValuesAreSkipped) {
+  ParamBridge<2> params;
+  params.Init(1.0f);
+  params.SetThreshold(1, 0.01f);
+
+  EXPECT_EQ(0u, params.Latch());
+  params.Set(0, 1.0f);
+  EXPECT_EQ(0u, params.Latch());
+
+  params.Set(0, 0.5f);
+  params.Set(0, 0.75f); // only the latest counts
+  EXPECT_EQ(1u, params.Latch());
+  EXPECT_EQ(0.75f, params.value(0));
+  EXPECT_EQ(0u, params.Latch());
+
+  // below the threshold it waits until the drift adds up
+  params.Set(1, 1.006f);
+  EXPECT_EQ(0u, params.Latch());
+  params.Set(1, 1.012f);
+  EXPECT_EQ(2u, params.Latch());
+  EXPECT_EQ(1.012f, params.value(1));
+}
+
+TEST(AudioParams, RampAccuracy) {
+  ParamBridge<1> params;
+  params.Init(0.0f);
+
+  const float targets[] = {1.0f, 1.0f, 0.2f, 0.9f, 0.0f, 0.0f, 1.5f};
+  const int16_t dc = 16384;
+  float expected_prev = 0.0f;
+  float worst_error = 0.0f, worst_step = 0.0f;
+
+  for (float target : targets) {
+    params.Set(0, target);
+    params.Latch();
+    const ParamRamp &ramp = params.ramp(0);
+    EXPECT_EQ(expected_prev, ramp.from);
+
+    int16_t block[kBlockSamples];
+    for (int16_t &s : block) s = dc;
+    ApplyGainRamp(block, ramp);
+
+    // linear from the last block's end to the target, landing on it exactly
+    for (int n = 0; n < kBlockSamples; ++n) {
+      float ideal = dc * (ramp.from + (ramp.to - ramp.from) * (n + 1) / kBlockSamples);
+      if (ideal > 32767.0f) ideal = 32767.0f;
+      worst_error = fmaxf(worst_error, fabsf(block[n] - ideal));
+    }
+    EXPECT_NEAR(fminf(dc * target, 32767.0f), block[kBlockSamples - 1], 1.0f);
+
+    const float step = fabsf(ramp.to - ramp.from) * dc / kBlockSamples;
+    worst_step = fmaxf(worst_step, step);
+    expected_prev = target;
+  }
+
+  // A stepped update would jump by up to the whole range in one sample
+  std::cout << "Audio params: ramp error " << worst_error << " LSB, largest per-sample step "
+            << worst_step << " LSB (stepped: " << dc << ")" << std::endl;
+  EXPECT_LE(worst_error, 1.0f);
+  EXPECT_LT(worst_step, dc / 64.0f);
+}
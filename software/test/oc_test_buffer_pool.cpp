@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include "oc_test_arduino.h"
+#include "HSBufferPool.h"
+
+using HS::BufferPool;
+
+class BufferPoolTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    memset(fast_, 0xee, sizeof(fast_));
+    memset(large_, 0xee, sizeof(large_));
+    pool_.Init(2);
+    pool_.AddRegion(fast_, sizeof(fast_));
+    pool_.AddRegion(large_, sizeof(large_));
+  }
+
+protected:
+  uint8_t fast_[2 * 1024];
+  uint8_t large_[2 * 8192];
+  BufferPool pool_;
+
+  bool Filled(const uint8_t *p, size_t n, uint8_t value) const {
+    for (size_t i = 0; i < n; ++i)
+      if (p[i] != value) return false;
+    return true;
+  }
+};
+
+TEST_F(BufferPoolTest, FastestRegionThatFits) {
+  uint8_t *a = static_cast<uint8_t *>(pool_.Request(0, 1000));
+  uint8_t *b = static_cast<uint8_t *>(pool_.Request(1, 1024));
+  EXPECT_EQ(fast_, a);
+  EXPECT_EQ(fast_ + 1024, b);
+
+  uint8_t *c = static_cast<uint8_t *>(pool_.Request(1, 4096));
+  EXPECT_EQ(large_ + 8192, c);
+  EXPECT_EQ(nullptr, pool_.Request(0, 8193));
+  EXPECT_EQ(nullptr, pool_.Request(2, 16)); // no such slot
+  EXPECT_EQ(8192u, pool_.max_size());
+}
+
+TEST_F(BufferPoolTest, BackgroundFill) {
+  uint8_t *a = static_cast<uint8_t *>(pool_.Request(0, 3000, 127));
+  uint8_t *b = static_cast<uint8_t *>(pool_.Request(1, 500, 0));
+  EXPECT_FALSE(pool_.ready(0));
+  EXPECT_FALSE(pool_.ready(1));
+
+  pool_.Idle(1024);
+  EXPECT_FALSE(pool_.ready(0));
+  EXPECT_TRUE(pool_.ready(1));
+  EXPECT_TRUE(Filled(b, 500, 0));
+  EXPECT_TRUE(Filled(a, 1024, 127));
+  EXPECT_EQ(0xee, a[1024]);
+
+  pool_.Idle(1024);
+  pool_.Idle(1024);
+  EXPECT_TRUE(pool_.ready(0));
+  EXPECT_TRUE(Filled(a, 3000, 127));
+  EXPECT_EQ(0xee, a[3000]); // nothing past the request
+}
+
+TEST_F(BufferPoolTest, NewRequestRestartsFill) {
+  uint8_t *a = static_cast<uint8_t *>(pool_.Request(0, 4000, 1));
+  pool_.Idle(1024);
+  EXPECT_TRUE(Filled(a, 1024, 1));
+
+  // swapped for another applet halfway through
+  uint8_t *b = static_cast<uint8_t *>(pool_.Request(0, 2000, 2));
+  EXPECT_EQ(a, b);
+  EXPECT_FALSE(pool_.ready(0));
+  pool_.Idle(1024);
+  pool_.Idle(1024);
+  EXPECT_TRUE(pool_.ready(0));
+  EXPECT_TRUE(Filled(b, 2000, 2));
+  EXPECT_EQ(0xee, b[2000]); // the first fill never got this far
+}
+
+// The ISR swaps the applet while Idle() is between taking the slot's request
+// and filling it: the old fill is 1024 bytes into the large region, and the
+// new request is in the fast one, where that would be the other slot's share
+TEST_F(BufferPoolTest, RequestDuringFill) {
+  uint8_t *a = static_cast<uint8_t *>(pool_.Request(0, 4000, 1));
+  EXPECT_EQ(large_, a);
+  pool_.Idle(1024);
+
+  uint8_t *b = nullptr;
+  pool_.Idle(1024, [&](int owner) {
+    if (owner == 0 && !b) b = static_cast<uint8_t *>(pool_.Request(0, 1024, 2));
+  });
+  EXPECT_EQ(fast_, b);
+  EXPECT_TRUE(Filled(fast_, sizeof(fast_), 0xee));
+  EXPECT_TRUE(Filled(large_ + 1024, sizeof(large_) - 1024, 0xee));
+  EXPECT_FALSE(pool_.ready(0));
+
+  pool_.Idle(1024);
+  EXPECT_TRUE(pool_.ready(0));
+  EXPECT_TRUE(Filled(b, 1024, 2));
+  EXPECT_TRUE(Filled(fast_ + 1024, 1024, 0xee));
+}
+
+TEST_F(BufferPoolTest, Release) {
+  pool_.Request(0, 100, 5);
+  pool_.Release(0);
+  pool_.Idle();
+  EXPECT_FALSE(pool_.ready(0));
+  EXPECT_TRUE(Filled(fast_, 100, 0xee)); // released buffers aren't touched
+
+  pool_.Request(0, 100, 5);
+  pool_.Idle();
+  EXPECT_TRUE(pool_.ready(0));
+}
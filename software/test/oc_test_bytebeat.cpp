@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+#include "peaks_bytebeat.h"
+
+// Equations that don't divide by t or the last sample, so they're safe to run
+// on hosts that trap on division by zero.
+static const int32_t kEquations[] = { 0, 1, 2, 4, 5, 7, 9, 12 };
+
+// APP_BYTEBEATGEN only calls Configure() when a parameter or mode changed.
+// That has to play the same as configuring on every tick, as it used to.
+class ByteBeatTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    every_tick_.Init();
+    on_change_.Init();
+    for (int i = 0; i < 12; ++i) last_[i] = -1;
+    srand(0x5eed);
+  }
+
+protected:
+  void Set(int32_t equation, int32_t speed) {
+    int32_t s[12] = { equation << 12, speed, 0x4000, 0x8000, 0x2100,
+                      0, 0, 0x0100, 0, 0x0200, 0x0800, 0x0300 };
+    for (int i = 0; i < 12; ++i) s_[i] = s[i];
+  }
+
+  void Run(int ticks, int gate_every, bool stepmode = false, bool loopmode = false) {
+    for (int tick = 0; tick < ticks; ++tick) {
+      uint8_t control = (gate_every && !(tick % gate_every)) ? peaks::CONTROL_GATE_RISING : 0;
+      Tick(control, stepmode, loopmode);
+    }
+  }
+
+  void Tick(uint8_t control, bool stepmode, bool loopmode) {
+    every_tick_.Configure(s_, stepmode, loopmode);
+
+    bool changed = stepmode != stepmode_ || loopmode != loopmode_;
+    for (int i = 0; i < 12; ++i) {
+      if (s_[i] != last_[i]) {
+        last_[i] = s_[i];
+        changed = true;
+      }
+    }
+    if (changed) {
+      stepmode_ = stepmode;
+      loopmode_ = loopmode;
+      on_change_.Configure(last_, stepmode, loopmode);
+    }
+
+    ASSERT_EQ(every_tick_.ProcessSingleSample(control), on_change_.ProcessSingleSample(control));
+    ASSERT_EQ(every_tick_.get_t(), on_change_.get_t());
+  }
+
+  peaks::ByteBeat every_tick_;
+  peaks::ByteBeat on_change_;
+  int32_t s_[12];
+  int32_t last_[12];
+  bool stepmode_ = false, loopmode_ = false;
+};
+
+TEST_F(ByteBeatTest, ConfigureOnChangeMatchesEveryTick) {
+  for (int32_t equation : kEquations) {
+    for (int32_t speed : { 0, 0x8000, 0xf000, 0xffff }) {
+      Set(equation, speed);
+      Run(2000, 0);
+      Run(2000, 37);
+    }
+  }
+}
+
+TEST_F(ByteBeatTest, LoopAndStepModes) {
+  for (int32_t equation : kEquations) {
+    Set(equation, 0xffff);
+    Run(4000, 0, false, true);
+    Run(1000, 3, true, false);
+  }
+}
+
+TEST_F(ByteBeatTest, ParameterChanges) {
+  for (int i = 0; i < 200; ++i) {
+    int32_t equation = kEquations[rand() % (sizeof(kEquations) / sizeof(kEquations[0]))];
+    int32_t s[12] = { equation << 12, 0xfff0, (rand() & 0xfe00) + 0x100, (rand() & 0xfe00) + 0x100,
+                      rand() & 0xffff, 0, 0, 0, 0xff, 0xff, 0xff, rand() & 0xffff };
+    for (int p = 0; p < 12; ++p) s_[p] = s[p];
+    Run(rand() % 50, rand() % 2 ? 0 : 11);
+  }
+}
+
+// CV on p0 moving every tick
+TEST_F(ByteBeatTest, ModulatedParameters) {
+  for (int32_t equation : kEquations) {
+    for (int32_t speed : { 0x8000, 0xffff }) {
+      Set(equation, speed);
+      for (int tick = 0; tick < 3000; ++tick) {
+        s_[2] = 0x100 + ((tick * 0x2300) & 0xfe00);
+        Tick(0, false, false);
+      }
+    }
+  }
+}
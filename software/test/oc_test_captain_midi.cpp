@@ -0,0 +1,315 @@
+#include "gtest/gtest.h"
+
+// Host replay of Captain MIDI's input routing. A dense stream (clock, CC
+// sweeps, chords, bends, and traffic on channels nothing listens to) goes in
+// over USB MIDI, a message per tick, and every tick's outputs have to match
+// the loop Captain MIDI had before its routing tables, which tested every
+// assignment against every message. The time each takes per tick is reported
+// alongside, not checked.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "oc_test_host.h"
+#include "OC_core.h"
+
+// The app's hooks are only referenced from the OC_apps.cpp registry
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#define ENABLE_APP_MIDI
+#include "APP_MIDI.h"
+#pragma GCC diagnostic pop
+
+// The settings menu's edit icon lives in OC_menus.cpp, which draws with the
+// bitmaps and DAC history the host doesn't have. Nothing here draws.
+void OC::menu::DrawEditIcon(weegfx::coord_t, weegfx::coord_t, int, const settings::value_attr &) { }
+
+namespace {
+
+typedef std::array<int, DAC_CHANNEL_LAST> Outputs;
+
+struct Message {
+  uint8_t type, channel, data1, data2;
+};
+
+// The inputs side of a Setup, by output A-D
+struct Setup {
+  int fn[4];
+  int channel[4];
+  int transpose[4];
+  int low[4];
+  int high[4];
+};
+
+static const Setup kNotesAndClock = {
+  { MIDI_IN_NOTE, MIDI_IN_GATE, MIDI_IN_MOD, MIDI_IN_CLOCK_16TH },
+  { 1, 1, 2, 3 },
+  { 12, 0, 0, 0 },
+  { 36, 0, 0, 0 },
+  { 96, 127, 127, 127 },
+};
+
+static const Setup kExpression = {
+  { MIDI_IN_VELOCITY, MIDI_IN_AFTERTOUCH, MIDI_IN_PITCHBEND, MIDI_IN_TRIGGER },
+  { 1, 2, 2, 1 },
+  { 0, 0, 0, 0 },
+  { 0, 0, 0, 0 },
+  { 127, 127, 127, 127 },
+};
+
+static void Apply(CaptainMIDI &app, const Setup &setup) {
+  for (int ch = 0; ch < 4; ++ch) {
+    app.apply_value(ch, setup.fn[ch]);
+    app.apply_value(8 + ch, setup.channel[ch]);
+    app.apply_value(16 + ch, setup.transpose[ch]);
+    app.apply_value(24 + ch, setup.low[ch]);
+    app.apply_value(32 + ch, setup.high[ch]);
+    app.apply_value(4 + ch, MIDI_OUT_OFF);
+    app.apply_value(12 + ch, 0);
+  }
+  app.InvalidateRoutes();
+}
+
+// Clock at 24 PPQN, CC sweeps on three channels, four-note chords on 1 and
+// drums on 10, with bends and aftertouch on 2, back to back
+static std::vector<Message> DenseStream(int count) {
+  std::vector<Message> stream;
+  int chord = 0;
+  for (int i = 0; stream.size() < size_t(count); ++i) {
+    const uint8_t sweep = i % 128;
+    if (i % 6 == 0) stream.push_back({ usbMIDI.Clock, 0, 0, 0 });
+    stream.push_back({ usbMIDI.ControlChange, uint8_t(1 + i % 3), 1, sweep });
+    stream.push_back({ usbMIDI.ControlChange, 1, 11, uint8_t(127 - sweep) });
+    stream.push_back({ usbMIDI.ControlChange, 5, 74, sweep });
+    if (i % 4 == 0) stream.push_back({ usbMIDI.PitchBend, 2, sweep, uint8_t(sweep / 2 + 32) });
+    if (i % 4 == 2) stream.push_back({ usbMIDI.AfterTouchChannel, 2, sweep, 0 });
+    if (i % 48 == 0) {
+      const uint8_t root = 30 + (chord++ * 7) % 60;
+      for (uint8_t n : { 0, 4, 7, 11 }) stream.push_back({ usbMIDI.NoteOn, 1, uint8_t(root + n), uint8_t(40 + n * 5) });
+      stream.push_back({ usbMIDI.NoteOn, 10, 36, 100 });
+    }
+    if (i % 48 == 40) {
+      const uint8_t root = 30 + ((chord - 1) * 7) % 60;
+      for (uint8_t n : { 7, 0, 11, 4 }) stream.push_back({ usbMIDI.NoteOff, 1, uint8_t(root + n), 0 });
+      stream.push_back({ usbMIDI.NoteOff, 10, 36, 0 });
+    }
+  }
+  stream.resize(count);
+  return stream;
+}
+
+// Captain MIDI's Controller() as it was, reading the Setup from the app's
+// values on every message. Clock assignments only fire on MIDI Clock here,
+// as they do now; before, any message on a clock division could fire them.
+class LoopRouting {
+public:
+  explicit LoopRouting(const CaptainMIDI &app_) : app(app_) { }
+
+  void Controller() {
+    if (usbMIDI.read()) {
+      Process(usbMIDI.getType(), usbMIDI.getChannel(), usbMIDI.getData1(), usbMIDI.getData2());
+    }
+    for (int ch = 0; ch < 4; ch++) {
+      if (Value(12 + ch) == 0) continue; // no MIDI Out assignments in these Setups
+    }
+  }
+
+private:
+  const CaptainMIDI &app;
+  int note_in[4] = { -1, -1, -1, -1 };
+  int clock_count = 0;
+
+  int Value(int index) const {
+    return app.get_value(index + app.get_value(MIDI_CURRENT_SETUP) * MIDI_PARAMETER_COUNT);
+  }
+
+  static void Out(int ch, int value) { HS::frame.Out(DAC_CHANNEL(ch), value); }
+  static void GateOut(int ch, bool high) { Out(ch, high ? HSAPP_PULSE_VOLTAGE * (12 << 7) : 0); }
+  static void ClockOut(int ch) { HS::frame.ClockOut(DAC_CHANNEL(ch), 100); }
+
+  void Process(int message, int channel, int data1, int data2) {
+    if (message == HEM_MIDI_CLOCK) {
+      if (++clock_count >= 24) clock_count = 0;
+    }
+
+    bool note_captured = 0;
+    bool gate_captured = 0;
+    for (int ch = 0; ch < 4; ch++) {
+      int in_fn = Value(ch);
+      int in_ch = Value(8 + ch);
+      if (message == HEM_MIDI_NOTE_ON && in_ch == channel) {
+        if (note_in[ch] == -1) {
+          if (in_fn == MIDI_IN_NOTE && !note_captured) {
+            int note = data1 + Value(16 + ch);
+            note = constrain(note, 0, 127);
+            if (note >= Value(24 + ch) && note <= Value(32 + ch)) {
+              Out(ch, MIDIQuantizer::CV(note));
+              note_captured = 1;
+              note_in[ch] = data1;
+            } else note_in[ch] = -1;
+          }
+          if (in_fn == MIDI_IN_GATE && !gate_captured) {
+            GateOut(ch, 1);
+            gate_captured = 1;
+            note_in[ch] = data1;
+          }
+          if (in_fn == MIDI_IN_TRIGGER) {
+            ClockOut(ch);
+            gate_captured = 1;
+          }
+          if (in_fn == MIDI_IN_VELOCITY) Out(ch, Proportion(data2, 127, HSAPPLICATION_5V));
+        }
+      }
+
+      if (message == HEM_MIDI_NOTE_OFF && in_ch == channel) {
+        if (note_in[ch] == data1) {
+          note_in[ch] = -1;
+          if (in_fn == MIDI_IN_GATE) GateOut(ch, 0);
+          else if (in_fn == MIDI_IN_VELOCITY) Out(ch, 0);
+        }
+      }
+
+      bool cc = (in_fn == MIDI_IN_MOD || in_fn >= MIDI_IN_EXPRESSION);
+      if (cc && message == HEM_MIDI_CC && in_ch == channel) {
+        uint8_t cc = 1;
+        if (in_fn == MIDI_IN_EXPRESSION) cc = 11;
+        if (in_fn == MIDI_IN_PAN) cc = 10;
+        if (in_fn == MIDI_IN_HOLD) cc = 64;
+        if (in_fn == MIDI_IN_BREATH) cc = 2;
+        if (in_fn == MIDI_IN_Y_AXIS) cc = 74;
+        if (data1 == cc) {
+          if (in_fn == MIDI_IN_HOLD && data2 > 0) data2 = 127;
+          Out(ch, Proportion(data2, 127, HSAPPLICATION_5V));
+        }
+      }
+
+      if (message == HEM_MIDI_AFTERTOUCH && in_fn == MIDI_IN_AFTERTOUCH && in_ch == channel)
+        Out(ch, Proportion(data1, 127, HSAPPLICATION_5V));
+
+      if (message == HEM_MIDI_PITCHBEND && in_fn == MIDI_IN_PITCHBEND && in_ch == channel) {
+        int data = (data2 << 7) + data1 - 8192;
+        Out(ch, Proportion(data, 0x7fff, HSAPPLICATION_3V));
+      }
+
+      if (in_fn >= MIDI_IN_CLOCK_4TH && message == HEM_MIDI_CLOCK) {
+        uint8_t mod = 1;
+        if (in_fn == MIDI_IN_CLOCK_4TH) mod = 24;
+        if (in_fn == MIDI_IN_CLOCK_8TH) mod = 12;
+        if (in_fn == MIDI_IN_CLOCK_16TH) mod = 6;
+        if (clock_count % mod == 0) ClockOut(ch);
+      }
+    }
+  }
+};
+
+struct Replay {
+  std::vector<Outputs> outputs;
+  std::vector<uint64_t> tick_ns;
+};
+
+static constexpr int kMessages = 12000;
+static constexpr int kRuns = 5;
+
+class CaptainMIDITest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    stream = DenseStream(kMessages);
+  }
+
+  // The stream through the tables or the loop, switching Setups halfway. The
+  // time per tick is the fastest of a few runs, to keep host noise out.
+  Replay Run(bool loop) {
+    Replay replay;
+    replay.tick_ns.assign(kMessages + 100, UINT64_MAX);
+    for (int run = 0; run < kRuns; ++run) {
+      OC::Host::Reset(1);
+      HS::frame = HS::IOFrame();
+      CaptainMIDI &app = captain_midi_instance;
+      app.InitDefaults();
+      app.BaseStart();
+      Apply(app, kNotesAndClock);
+      LoopRouting reference(app);
+      for (const Message &m : stream) usbMIDI.Receive(m.type, m.channel, m.data1, m.data2);
+
+      replay.outputs.clear();
+      for (size_t t = 0; t < replay.tick_ns.size(); ++t) {
+        if (t == kMessages / 2) Apply(app, kExpression);
+        OC::Host::Tick();
+        HS::frame.Load();
+        const auto start = std::chrono::steady_clock::now();
+        if (loop) reference.Controller();
+        else app.Controller();
+        const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        replay.tick_ns[t] = std::min(replay.tick_ns[t], ns);
+        HS::frame.Send();
+
+        Outputs out;
+        for (int ch = 0; ch < DAC_CHANNEL_LAST; ++ch) out[ch] = HS::frame.outputs[ch];
+        replay.outputs.push_back(out);
+      }
+      EXPECT_EQ(0u, usbMIDI.pending());
+    }
+    return replay;
+  }
+
+  // The tables are rebuilt on the first tick after each Setup change, so
+  // those ticks are reported apart from the rest
+  static void Report(const char *name, const Replay &replay) {
+    uint64_t total = 0, worst = 0, setup = 0;
+    for (size_t t = 0; t < kMessages; ++t) {
+      total += replay.tick_ns[t];
+      if (t == 0 || t == kMessages / 2) setup = std::max(setup, replay.tick_ns[t]);
+      else worst = std::max(worst, replay.tick_ns[t]);
+    }
+    printf("[   MIDI   ] %-6s %5.1f ns/message, worst tick %4llu ns, after a Setup change %4llu ns\n",
+           name, double(total) / kMessages, (unsigned long long)worst, (unsigned long long)setup);
+  }
+
+  std::vector<Message> stream;
+};
+
+TEST_F(CaptainMIDITest, TablesMatchTheLoop) {
+  const Replay tables = Run(false);
+  const Replay loop = Run(true);
+  Report("tables", tables);
+  Report("loop", loop);
+
+  ASSERT_EQ(loop.outputs.size(), tables.outputs.size());
+  for (size_t t = 0; t < loop.outputs.size(); ++t) {
+    ASSERT_EQ(loop.outputs[t], tables.outputs[t]) << "tick " << t;
+  }
+
+  // and the stream moved every output in both Setups
+  for (int ch = 0; ch < 4; ++ch) {
+    int first_half = 0, second_half = 0;
+    for (size_t t = 1; t < tables.outputs.size(); ++t) {
+      if (tables.outputs[t][ch] != tables.outputs[t - 1][ch]) ++(t < kMessages / 2 ? first_half : second_half);
+    }
+    EXPECT_GT(first_half, 10) << ch;
+    EXPECT_GT(second_half, 10) << ch;
+  }
+}
+
+// Clock assignments also follow the modulation wheel on their channel
+TEST_F(CaptainMIDITest, ClockInputsFollowModWheel) {
+  OC::Host::Reset(1);
+  HS::frame = HS::IOFrame();
+  CaptainMIDI &app = captain_midi_instance;
+  app.InitDefaults();
+  app.BaseStart();
+  Apply(app, kNotesAndClock);
+
+  usbMIDI.Receive(usbMIDI.ControlChange, 3, 1, 127);
+  app.BaseController();
+  EXPECT_EQ(Proportion(127, 127, HSAPPLICATION_5V), HS::frame.outputs[3]);
+
+  usbMIDI.Receive(usbMIDI.ControlChange, 4, 1, 0); // another channel
+  app.BaseController();
+  EXPECT_EQ(Proportion(127, 127, HSAPPLICATION_5V), HS::frame.outputs[3]);
+}
+
+} // namespace
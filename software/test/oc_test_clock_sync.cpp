@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+
+// Host replay of the ClockManager's MIDI Clock against its own beat, ticked
+// as the apps do it: MIDI Clock goes out first, then ClockSetup runs the
+// clock. Every beat has to get 24 pulses starting on the beat, through tempo
+// changes and a jittery external clock, and MIDI Continue has to pick up
+// from the Song Position.
+
+#include <stdlib.h>
+#include <vector>
+#include "oc_test_host.h"
+#include "OC_core.h"
+#include "HemisphereApplet.h"
+#include "HSicons.h"
+#include "HSClockManager.h"
+
+// ClockSetup.h defines the apps' instance, which oc_test_applets.cpp has already
+#define ClockSetup_instance ClockSyncTest_instance
+#include "applets/ClockSetup.h"
+#undef ClockSetup_instance
+
+namespace {
+
+class ClockSyncTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    OC::Host::Reset(1);
+    HS::frame = HS::IOFrame();
+    HS::clock_m = HS::ClockManager();
+    HS::Init();
+    clock_setup.BaseStart(LEFT_HEMISPHERE);
+    HS::clock_m.SetMultiply(1, 0); // a tock on every beat
+  }
+
+  // Other tests expect the clock stopped
+  void TearDown() override {
+    clock_setup.Unload();
+    HS::clock_m = HS::ClockManager();
+  }
+
+  // One ISR tick, with a clock on Digital 1 if clocked
+  void Tick(bool clocked = false) {
+    OC::Host::SetGates(clocked ? 0x01 : 0);
+    OC::Host::Tick();
+    HS::frame.Load();
+    HS::clock_m.MIDIClockOut();
+    clock_setup.Controller();
+
+    const uint32_t now = OC::CORE::ticks;
+    if (HS::clock_m.MIDITock()) pulses.push_back(now);
+    if (HS::clock_m.Tock(0)) beats.push_back(now);
+  }
+
+  void Run(int ticks) {
+    for (int t = 0; t < ticks; ++t) Tick();
+  }
+
+  // Checks each beat from first up to last against the one after it. The first
+  // pulse has to be within slack ticks of the beat.
+  void ExpectPulsesOnBeats(size_t first, size_t last = SIZE_MAX, uint32_t slack = 1) {
+    if (last > beats.size() - 1) last = beats.size() - 1;
+    ASSERT_LT(first + 2, last);
+    size_t p = 0;
+    for (size_t b = first; b < last; ++b) {
+      while (p < pulses.size() && pulses[p] + slack < beats[b]) ++p;
+      size_t next = p;
+      while (next < pulses.size() && pulses[next] + slack < beats[b + 1]) ++next;
+      ASSERT_LT(p, pulses.size());
+      EXPECT_NEAR(double(beats[b]), double(pulses[p]), slack) << "beat " << b;
+      EXPECT_EQ(24u, next - p) << "beat " << b;
+    }
+  }
+
+  static void MIDIMessage(int message, int data1 = 0, int data2 = 0) {
+    HS::frame.MIDIState.ProcessMIDIMsg(1, message, data1, data2);
+  }
+
+  ClockSetup &clock_setup = ClockSyncTest_instance;
+  std::vector<uint32_t> beats;
+  std::vector<uint32_t> pulses;
+};
+
+TEST_F(ClockSyncTest, TempoChanges) {
+  HS::clock_m.SetTempoBPM(120);
+  HS::clock_m.Start();
+  Run(30000);
+  HS::clock_m.SetTempoBPM(97);
+  const size_t change = beats.size() - 1; // the beat it changed in
+  Run(70000);
+  HS::clock_m.SetTempoBPM(181);
+  const size_t change2 = beats.size() - 1;
+  Run(40000);
+
+  // The beat with the change has pulses at both tempos, and some of the next
+  // beat's went out early
+  ExpectPulsesOnBeats(0, change);
+  ExpectPulsesOnBeats(change + 2, change2);
+  ExpectPulsesOnBeats(change2 + 2);
+}
+
+TEST_F(ClockSyncTest, JitteredExternalClock) {
+  // 4 PPQN at 133 BPM, each clock up to 3 ticks early or late
+  const double interval = HS::MIDI_CLOCK_TICKS_PER_MINUTE / (133.0 * 4);
+  srand(0x36);
+  HS::clock_m.SetClockPPQN(4);
+  HS::clock_m.Start(true); // waits for the first clock
+  for (int clock = 0; clock < 4 * 40; ++clock) {
+    const uint32_t at = uint32_t(clock * interval) + 3 + rand() % 7 - 3;
+    while (OC::CORE::ticks + 1 < at) Tick();
+    Tick(true);
+  }
+  EXPECT_TRUE(HS::clock_m.extsync);
+  // After it locks on, with the beat following the clock's jitter as far as
+  // the 4 ticks the ClockManager lets it drift before nudging it
+  ExpectPulsesOnBeats(4, SIZE_MAX, 4);
+}
+
+TEST_F(ClockSyncTest, ContinueFromSongPosition) {
+  HS::clock_m.SetTempoBPM(150);
+  HS::clock_m.Start();
+  while (pulses.size() < 48) Tick(); // 2 beats
+  HS::clock_m.Stop();
+  const uint32_t played = HS::clock_m.midi_clock.Pulses();
+  EXPECT_EQ(48u, played);
+
+  // Continue picks up where it stopped
+  HS::clock_m.Continue();
+  Tick();
+  EXPECT_EQ(played + 1, HS::clock_m.midi_clock.Pulses());
+  HS::clock_m.Stop();
+
+  // Song Position Pointer then Continue from another device
+  MIDIMessage(usbMIDI.SongPosition, 0x10, 0x01); // MIDI beat 144, bar 10
+  MIDIMessage(usbMIDI.Continue);
+  Tick();
+  EXPECT_TRUE(HS::clock_m.IsRunning());
+  EXPECT_EQ(144u * 6, HS::clock_m.midi_clock.Pulses());
+  EXPECT_FALSE(HS::clock_m.MIDITock()); // it follows, so no MIDI Clock goes out
+  Tick();
+  EXPECT_EQ(144u * 6 + 1, HS::clock_m.midi_clock.Pulses());
+
+  // Start goes back to the top
+  MIDIMessage(usbMIDI.Stop);
+  Tick();
+  MIDIMessage(usbMIDI.Start);
+  Tick();
+  Tick();
+  EXPECT_EQ(1u, HS::clock_m.midi_clock.Pulses());
+}
+
+} // namespace
@@ -0,0 +1,322 @@
+#include <math.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "HSCVStream.h"
+
+using namespace HS;
+
+static const int kTicksPerSecond = 16667; // the core ISR runs every 60us
+
+static std::vector<uint8_t> EncodeAll(const std::vector<CVFrame> &frames) {
+  std::vector<uint8_t> out;
+  CVStreamEncoder encoder;
+  uint8_t buf[CVStreamEncoder::MAX_BYTES];
+  for (const CVFrame &f : frames) {
+    const size_t n = encoder.Encode(f, buf);
+    out.insert(out.end(), buf, buf + n);
+  }
+  const size_t n = encoder.Flush(buf);
+  out.insert(out.end(), buf, buf + n);
+  return out;
+}
+
+static void ExpectRoundTrip(const char *name, const std::vector<CVFrame> &frames) {
+  const std::vector<uint8_t> bytes = EncodeAll(frames);
+  CVStreamDecoder decoder;
+  CVFrame f;
+  for (size_t i = 0; i < frames.size(); ++i) {
+    ASSERT_TRUE(decoder.Next(bytes.data(), bytes.size(), f)) << name << " frame " << i;
+    ASSERT_EQ(frames[i], f) << name << " frame " << i;
+  }
+  EXPECT_FALSE(decoder.Next(bytes.data(), bytes.size(), f)) << name;
+  EXPECT_EQ(bytes.size(), decoder.position()) << name;
+  std::cout << "CV stream " << name << ": " << (double)bytes.size() / frames.size()
+            << " bytes/frame" << std::endl;
+}
+
+static CVFrame Frame(int a, int b, int gates = 0) {
+  CVFrame f;
+  f.cv[0] = a;
+  f.cv[1] = b;
+  f.gates = gates;
+  return f;
+}
+
+TEST(CVStream, RoundTrip) {
+  std::vector<CVFrame> frames;
+
+  // slow LFOs at one sample per 16 ticks
+  for (int i = 0; i < 20000; ++i)
+    frames.push_back(Frame(7680 * sinf(i * 0.002f), 3000 * sinf(i * 0.0007f) - 1000));
+  ExpectRoundTrip("lfo", frames);
+
+  // gates only, with long holds
+  frames.clear();
+  for (int i = 0; i < 20000; ++i) frames.push_back(Frame(0, 0, (i / 700) & 3));
+  ExpectRoundTrip("gates", frames);
+
+  // stepped CV with gates, as from a sequencer
+  frames.clear();
+  for (int i = 0; i < 20000; ++i)
+    frames.push_back(Frame(((i / 500) % 7) * 128 * 7, -((i / 300) % 5) * 1536, (i % 500) < 250));
+  ExpectRoundTrip("steps", frames);
+
+  // every delta size, the edges of each mode, and the extremes of int16
+  frames.clear();
+  const int deltas[] = {0, 1, -1, 7, -8, 8, -9, 127, -128, 128, -129, 30000, -30000};
+  int a = 0, b = 0;
+  for (int da : deltas) {
+    for (int db : deltas) {
+      a = (a + da > 32767 || a + da < -32768) ? a - da : a + da;
+      b = (b + db > 32767 || b + db < -32768) ? b - db : b + db;
+      frames.push_back(Frame(a, b, (da ^ db) & 3));
+    }
+  }
+  frames.push_back(Frame(32767, -32768));
+  frames.push_back(Frame(-32768, 32767));
+  for (int i = 0; i < 300; ++i) frames.push_back(Frame(-32768, 32767, 3)); // runs past 128
+  frames.push_back(Frame(-32768, 32767, 0));
+  ExpectRoundTrip("edges", frames);
+
+  // noise
+  frames.clear();
+  uint32_t seed = 1;
+  for (int i = 0; i < 20000; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    frames.push_back(Frame((int16_t)(seed >> 16), (int16_t)seed, seed >> 30));
+  }
+  ExpectRoundTrip("noise", frames);
+
+  // the first frame may repeat the decoder's starting state
+  frames.assign(200, CVFrame());
+  ExpectRoundTrip("silence", frames);
+}
+
+TEST(CVStream, WaitsForWholeFrames) {
+  const std::vector<CVFrame> frames = {Frame(1000, -1000, 1), Frame(1003, -1001, 1), Frame(1003, -1001, 1)};
+  const std::vector<uint8_t> bytes = EncodeAll(frames);
+  ASSERT_EQ(5u + 2u + 1u, bytes.size());
+
+  CVStreamDecoder decoder;
+  CVFrame f;
+  for (size_t available = 0; available < 5; ++available)
+    ASSERT_FALSE(decoder.Next(bytes.data(), available, f));
+  EXPECT_EQ(0u, decoder.position());
+  ASSERT_TRUE(decoder.Next(bytes.data(), 6, f));
+  EXPECT_EQ(frames[0], f);
+  ASSERT_FALSE(decoder.Next(bytes.data(), 6, f));
+  ASSERT_TRUE(decoder.Next(bytes.data(), bytes.size(), f));
+  EXPECT_EQ(frames[1], f);
+  ASSERT_TRUE(decoder.Next(bytes.data(), bytes.size(), f));
+  EXPECT_EQ(frames[2], f);
+}
+
+// The loop copies pages while the ISR keeps capturing, at the worst case:
+// a frame of the largest kind on every tick.
+TEST(CVStream, WriterKeepsUp) {
+  const int seconds = 10;
+  const int loop_period = kTicksPerSecond / 100; // a sluggish 10ms main loop
+  std::vector<uint8_t> memory(seconds * kTicksPerSecond * 5 + 16);
+  StreamTake take;
+  take.data = memory.data();
+  take.capacity = memory.size();
+  StreamWriter<> writer;
+  writer.Start(take);
+
+  CVStreamEncoder encoder;
+  uint8_t buf[CVStreamEncoder::MAX_BYTES];
+  std::vector<CVFrame> frames;
+  size_t most_queued = 0;
+  for (int tick = 0; tick < seconds * kTicksPerSecond; ++tick) {
+    const CVFrame f = (tick & 1) ? Frame(-30000 + tick % 7, 30000, 1) : Frame(30000, -30000 + tick % 5, 2);
+    frames.push_back(f);
+    const size_t n = encoder.Encode(f, buf);
+    ASSERT_EQ(5u, n);
+    ASSERT_TRUE(writer.Write(buf, n)) << "tick " << tick;
+    most_queued = std::max(most_queued, take.size - take.flushed);
+    if (tick % loop_period == 0) writer.Idle();
+  }
+  writer.Finish();
+  writer.Idle();
+
+  EXPECT_FALSE(writer.overrun());
+  EXPECT_EQ(take.size, take.flushed);
+  std::cout << "CV stream writer: " << 5 * kTicksPerSecond << " bytes/s, at most "
+            << most_queued << " bytes waiting for a " << 1000.0 * loop_period / kTicksPerSecond
+            << "ms loop" << std::endl;
+
+  CVStreamDecoder decoder;
+  CVFrame f;
+  for (size_t i = 0; i < frames.size(); ++i) {
+    ASSERT_TRUE(decoder.Next(take.data, take.flushed, f)) << i;
+    ASSERT_EQ(frames[i], f) << i;
+  }
+}
+
+// CVLooper overdubbing at 400% copies 4 frames a tick. Each can be up to
+// MAX_BYTES, which the default page has to cope with on a sluggish loop.
+TEST(CVStream, WriterKeepsUpWithFastOverdub) {
+  const int seconds = 10;
+  const int loop_period = kTicksPerSecond / 100;
+  const int frames_per_tick = 4;
+  const size_t tick_bytes = frames_per_tick * CVStreamEncoder::MAX_BYTES;
+  std::vector<uint8_t> memory(seconds * kTicksPerSecond * tick_bytes);
+  StreamTake take;
+  take.data = memory.data();
+  take.capacity = memory.size();
+  StreamWriter<> writer;
+  writer.Start(take);
+
+  size_t most_queued = 0;
+  uint8_t next = 0;
+  for (int tick = 0; tick < seconds * kTicksPerSecond; ++tick) {
+    for (int f = 0; f < frames_per_tick; ++f) {
+      uint8_t buf[CVStreamEncoder::MAX_BYTES];
+      for (uint8_t &b : buf) b = next++;
+      ASSERT_TRUE(writer.Write(buf, sizeof(buf))) << "tick " << tick;
+    }
+    most_queued = std::max(most_queued, take.size - take.flushed);
+    if (tick % loop_period == 0) writer.Idle();
+  }
+  writer.Finish();
+  writer.Idle();
+
+  EXPECT_FALSE(writer.overrun());
+  ASSERT_EQ(memory.size(), take.flushed);
+  for (size_t i = 0; i < memory.size(); ++i) ASSERT_EQ(uint8_t(i), memory[i]) << i;
+  std::cout << "CV stream writer at 400%: " << tick_bytes << " bytes/tick, at most "
+            << most_queued << " bytes waiting" << std::endl;
+
+  // where a 1024 byte page would need the loop every 2.5ms
+  StreamWriter<1024> small;
+  small.Start(take);
+  bool ok = true;
+  for (int tick = 0; ok && tick <= loop_period; ++tick) {
+    uint8_t buf[tick_bytes] = {};
+    ok = small.Write(buf, tick_bytes);
+  }
+  EXPECT_FALSE(ok);
+  EXPECT_TRUE(small.overrun());
+}
+
+TEST(CVStream, WriterOverrun) {
+  std::vector<uint8_t> memory(8192, 0xee);
+  StreamTake take;
+  take.data = memory.data();
+  take.capacity = memory.size();
+  StreamWriter<64> writer;
+  writer.Start(take);
+
+  // no loop at all: two pages fill up, then writes are refused
+  const uint8_t bytes[5] = {1, 2, 3, 4, 5};
+  int accepted = 0;
+  while (writer.Write(bytes, 5)) ++accepted;
+  EXPECT_TRUE(writer.overrun());
+  EXPECT_EQ(25, accepted); // 125 of 128 bytes; the next write would need a third page
+  EXPECT_EQ(0u, take.flushed);
+
+  // and nothing queued was lost or overwritten
+  writer.Finish();
+  writer.Idle();
+  ASSERT_EQ(125u, take.flushed);
+  for (int i = 0; i < 125; ++i) ASSERT_EQ(bytes[i % 5], memory[i]) << i;
+  EXPECT_EQ(0xee, memory[125]);
+
+  // the take is full
+  StreamTake small;
+  uint8_t tiny[8];
+  small.data = tiny;
+  small.capacity = sizeof(tiny);
+  writer.Start(small);
+  EXPECT_TRUE(writer.Write(bytes, 5));
+  EXPECT_FALSE(writer.Write(bytes, 5));
+  EXPECT_FALSE(writer.overrun());
+}
+
+// A new pass over a take while a page of the last one is still queued
+TEST(CVStream, WriterPasses) {
+  std::vector<uint8_t> memory(256, 0);
+  StreamTake take;
+  take.data = memory.data();
+  take.capacity = memory.size();
+  StreamWriter<16> writer;
+
+  const uint8_t old_bytes[10] = {9, 9, 9, 9, 9, 9, 9, 9, 9, 9};
+  writer.Start(take);
+  writer.Write(old_bytes, 10);
+  writer.Finish(); // queued, not copied
+
+  const uint8_t new_bytes[4] = {1, 2, 3, 4};
+  writer.Start(take);
+  writer.Write(new_bytes, 4);
+  writer.Idle(); // copies the old page, which mustn't count for the new pass
+  EXPECT_EQ(0u, take.flushed);
+  writer.Finish();
+  writer.Idle();
+  EXPECT_EQ(4u, take.flushed);
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(new_bytes[i], memory[i]);
+}
+
+// Seconds of input a CVLooper take holds before it's full, capturing every
+// 2^rate ticks. Each take is half of a Teensy 4.1 slot's 256K of PSRAM.
+static double TakeSeconds(int rate, CVFrame (*input)(uint32_t tick)) {
+  std::vector<uint8_t> memory(262144 / 2);
+  StreamTake take;
+  take.data = memory.data();
+  take.capacity = memory.size();
+  StreamWriter<> writer;
+  writer.Start(take);
+
+  CVStreamEncoder encoder;
+  uint8_t buf[CVStreamEncoder::MAX_BYTES];
+  uint32_t frames = 0;
+  for (;;) {
+    const size_t n = encoder.Encode(input(frames << rate), buf);
+    if (n && !writer.Write(buf, n)) break;
+    if (++frames % 16 == 0) writer.Idle();
+  }
+  EXPECT_FALSE(writer.overrun());
+  return double(frames << rate) / kTicksPerSecond;
+}
+
+// Both CVs jump by thousands on every frame, at either rate
+static CVFrame FullScaleJumps(uint32_t tick) {
+  const int cv = ((tick * 7735) & 0x7fff) - 16384;
+  return Frame(cv, -cv);
+}
+
+static CVFrame FiveHertzLFOs(uint32_t tick) {
+  const float phase = 2 * 3.14159265f * 5 * tick / kTicksPerSecond;
+  return Frame(7680 * sinf(phase), 7680 * sinf(phase * 1.3f));
+}
+
+static CVFrame HeldGates(uint32_t tick) {
+  return Frame(0, 0, (tick / 100000) & 3);
+}
+
+// The take lengths CVLooper's help promises
+TEST(CVStream, TakeLength) {
+  // the worst case, 5 bytes a frame: the help's 25s at /16, 1.5s at /1
+  const double worst = TakeSeconds(4, FullScaleJumps);
+  EXPECT_GE(worst, 25.0);
+  EXPECT_LT(worst, 26.0);
+  EXPECT_NEAR(1.57, TakeSeconds(0, FullScaleJumps), 0.01);
+
+  const double lfo = TakeSeconds(0, FiveHertzLFOs);
+  EXPECT_GT(lfo, 2.0);
+  EXPECT_LT(lfo, 4.0);
+  EXPECT_GE(TakeSeconds(4, FiveHertzLFOs), 25.0);
+
+  // held gates run far longer than anyone loops; stop at an hour
+  std::vector<uint8_t> bytes;
+  CVStreamEncoder encoder;
+  uint8_t buf[CVStreamEncoder::MAX_BYTES];
+  for (uint32_t tick = 0; tick < 3600u * kTicksPerSecond; tick += 16) {
+    const size_t n = encoder.Encode(HeldGates(tick), buf);
+    bytes.insert(bytes.end(), buf, buf + n);
+  }
+  EXPECT_LT(bytes.size(), 262144u / 2);
+
+  std::cout << "CVLooper take: " << worst << "s worst case at /16, " << lfo
+            << "s of 5Hz LFOs at /1" << std::endl;
+}
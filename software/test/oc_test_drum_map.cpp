@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <stdint.h>
+#include "gtest/gtest.h"
+#include "HSDrumMap.h"
+
+// Both sets of Grids resources, side by side
+namespace grids1 {
+#include "grids_resources.h"
+}
+namespace grids2 {
+#include "grids2_resources.h"
+}
+
+using namespace HS;
+
+// DrumMap's lookup and trigger logic before the cache
+struct OldDrumMap {
+  const uint8_t *(&drum_map)[5][5];
+
+  uint8_t ReadDrumMap(uint8_t step, uint8_t part, uint8_t x, uint8_t y) {
+    uint8_t i = x >> 6;
+    uint8_t j = y >> 6;
+    const uint8_t* a_map = drum_map[i][j];
+    const uint8_t* b_map = drum_map[i + 1][j];
+    const uint8_t* c_map = drum_map[i][j + 1];
+    const uint8_t* d_map = drum_map[i + 1][j + 1];
+    uint8_t offset = (part * 32) + step;
+    uint8_t a = a_map[offset];
+    uint8_t b = b_map[offset];
+    uint8_t c = c_map[offset];
+    uint8_t d = d_map[offset];
+    uint8_t quad_x = x << 2;
+    uint8_t quad_y = y << 2;
+    uint8_t ab_fade = (b * quad_x + a * (255 - quad_x)) >> 8;
+    uint8_t cd_fade = (d * quad_x + c * (255 - quad_x)) >> 8;
+    return (cd_fade * quad_y + ab_fade * (255 - quad_y)) >> 8;
+  }
+
+  bool Fires(int step, int part, int x, int y, uint8_t randomness, int fill, bool accent) {
+    int level = ReadDrumMap(step, part, x, y);
+    level = std::min(std::max(level + randomness, 0), 255);
+    uint8_t threshold = ~fill;
+    if (level > threshold) {
+      if (!accent) return true;
+      if (level > 192) return true;
+    }
+    return false;
+  }
+};
+
+static void ExpectSameTriggers(const uint8_t *(&drum_map)[5][5]) {
+  OldDrumMap old{drum_map};
+  DrumMapCache cache(&drum_map[0][0]);
+
+  // every point on a fine sweep of X/Y, 255 included; fill and chaos on a coarser one
+  int tables = 0;
+  for (int x = 0; x < 256; x += 5) {
+    for (int y = 0; y < 256; y += 3) {
+      const bool sweep = (x % 15 == 0) && (y % 15 == 0);
+
+      // mixed on the spot until the main loop catches up, then from the table
+      for (int pass = 0; pass < 2; ++pass) {
+        ASSERT_EQ(pass == 1, cache.cached(x, y));
+        for (int part = 0; part < DRUMMAP_PARTS; ++part) {
+          for (int step = 0; step < DRUMMAP_STEPS; ++step) {
+            const uint8_t level = cache.Level(step, part, x, y);
+            ASSERT_EQ(old.ReadDrumMap(step, part, x, y), level)
+                << "x " << x << " y " << y << " part " << part << " step " << step;
+            if (!sweep) continue;
+
+            // chaos as the randomness it turns into
+            for (int fill = 0; fill < 256; fill += 17) {
+              for (int chaos = 0; chaos < 256; chaos += 51) {
+                const uint8_t randomness = (chaos >> 2) * (step + 1) / 33;
+                for (int accent = 0; accent < 2; ++accent) {
+                  ASSERT_EQ(old.Fires(step, part, x, y, randomness, fill, accent),
+                            DrumMapFires(level, randomness, fill, accent))
+                      << "x " << x << " y " << y << " fill " << fill << " chaos " << chaos;
+                }
+              }
+            }
+          }
+        }
+        cache.Request(x, y);
+        cache.Update();
+      }
+      ++tables;
+    }
+  }
+  EXPECT_GT(tables, 4000);
+}
+
+TEST(DrumMap, SameTriggersGrids) {
+  ExpectSameTriggers(grids1::grids::drum_map);
+}
+
+TEST(DrumMap, SameTriggersGrids2) {
+  ExpectSameTriggers(grids2::grids::drum_map);
+}
+
+// The table the ISR reads only changes when Update() flips it
+TEST(DrumMap, RequestKeepsTable) {
+  DrumMapCache cache(&grids1::grids::drum_map[0][0]);
+  cache.Request(100, 200);
+  cache.Update();
+  ASSERT_TRUE(cache.cached(100, 200));
+
+  cache.Request(101, 200);
+  EXPECT_TRUE(cache.cached(100, 200));
+  EXPECT_FALSE(cache.cached(101, 200));
+  cache.Update();
+  EXPECT_TRUE(cache.cached(101, 200));
+  cache.Update(); // nothing new
+  EXPECT_TRUE(cache.cached(101, 200));
+}
@@ -0,0 +1,370 @@
+#include "gtest/gtest.h"
+
+// Host replay of Enigma song playback. A long song goes in over SysEx, is
+// edited past step 99 from the Song mode controls or dumped to another
+// Enigma, and is played from the trigger inputs. Every tick's outputs have to match the playback Enigma had
+// before EnigmaSongIndex, which scanned the song for each track's next step.
+// The Makefile builds this at the Teensy 4.x song sizes.
+
+#include <array>
+#include <memory>
+#include <vector>
+#include "oc_test_host.h"
+#include "OC_core.h"
+#include "HemisphereApplet.h"
+
+// The app's hooks are only referenced from the OC_apps.cpp registry
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#define ENABLE_APP_ENIGMA
+#include "APP_ENIGMA.h"
+#pragma GCC diagnostic pop
+
+namespace {
+
+typedef std::array<int, DAC_CHANNEL_LAST> Outputs;
+
+// SongController and ResetSong() as they were, with the linear scans
+class LinearScanPlayback {
+public:
+  void Load(const EnigmaStep *steps, uint16_t total, const EnigmaTrack *tracks) {
+    song_step.assign(steps, steps + total);
+    for (byte t = 0; t < 4; t++) {
+      track[t] = tracks[t];
+      output[t].InitAs(t);
+    }
+    ResetSong();
+  }
+
+  void Controller() {
+    if (Clock(1) || Clock(2)) ResetSong();
+    if (Clock(2)) play = 1;
+    if (Clock(3)) play = 1 - play;
+
+    if (play && Clock(0)) {
+      clock_counter++;
+      for (byte t = 0; t < 4; t++) {
+        if (!playback_end[t] && clock_counter % track[t].divide() == 0) {
+          uint16_t ssi = playback_step_index[t];
+          if (ssi != ENIGMA_NO_STEP_AVAILABLE) {
+            if (playback_step_repeat[t] == 0 && playback_step_beat[t] == 0) {
+              track_tm[t].Init(song_step[ssi].tm());
+            }
+            playback_step_beat[t]++;
+            if (playback_step_beat[t] >= track_tm[t].GetLength()) {
+              playback_step_beat[t] = 0;
+              playback_step_repeat[t]++;
+              if (playback_step_repeat[t] >= song_step[ssi].repeats()) {
+                playback_step_repeat[t] = 0;
+                bool found = 0;
+                for (uint16_t s = ssi + 1; s < song_step.size(); s++) {
+                  if (song_step[s].track() == t) {
+                    playback_step_index[t] = s;
+                    found = 1;
+                    break;
+                  }
+                }
+                if (!found) {
+                  if (track[t].loop()) playback_step_index[t] = GetFirstStep(t);
+                  else playback_end[t] = 1;
+                }
+              }
+            }
+
+            // No MIDI channels are assigned, so SendToMIDI() wouldn't touch the outputs
+            for (byte o = 0; o < 4; o++) {
+              if (output[o].track() == t)
+                output[o].SendToDAC<LinearScanPlayback>(this, track_tm[t].GetRegister(), song_step[ssi].transpose() * 128);
+            }
+            track_tm[t].Advance(song_step[ssi].p());
+          } else {
+            playback_end[t] = 1;
+          }
+        }
+      }
+
+      // The CV inputs stay at 0V
+      bool keep_going = 0;
+      for (byte t = 0; t < 4; t++) if (track[t].loop() || !playback_end[t]) keep_going = 1;
+      if (!keep_going) play = 0;
+    }
+  }
+
+  // What SendToDAC() needs from the app, as HSApplication has them
+  void Out(int ch, int value, int octave = 0) {
+    HS::frame.Out(DAC_CHANNEL(ch), value + (octave * (12 << 7)));
+  }
+  void ClockOut(int ch, int ticks = 100) {
+    HS::frame.ClockOut(DAC_CHANNEL(ch), ticks);
+  }
+  void GateOut(int ch, bool high) {
+    Out(ch, 0, (high ? HSAPP_PULSE_VOLTAGE : 0));
+  }
+
+private:
+  static bool Clock(int ch) {
+    return HS::frame.clocked[ch];
+  }
+
+  void ResetSong() {
+    clock_counter = 0;
+    for (byte t = 0; t < 4; t++) {
+      playback_step_index[t] = GetFirstStep(t);
+      playback_step_repeat[t] = 0;
+      playback_step_beat[t] = 0;
+      playback_end[t] = 0;
+    }
+  }
+
+  uint16_t GetFirstStep(byte t) {
+    for (uint16_t s = 0; s < song_step.size(); s++)
+      if (song_step[s].track() == t) return s;
+    return ENIGMA_NO_STEP_AVAILABLE;
+  }
+
+  std::vector<EnigmaStep> song_step;
+  EnigmaTrack track[4];
+  EnigmaOutput output[4];
+  TuringMachineState track_tm[4];
+  bool play = 0;
+  uint32_t clock_counter = 0;
+  uint16_t playback_step_index[4];
+  byte playback_step_repeat[4];
+  byte playback_step_beat[4];
+  bool playback_end[4];
+};
+
+class EnigmaPlaybackTest : public ::testing::Test {
+protected:
+  static constexpr int kClocks = 6000;
+
+  void SetUp() override {
+    srand(0x31);
+    for (byte tm = 0; tm < HS::TURING_MACHINE_COUNT; tm++) {
+      library[tm].reg = rand() & 0xffff;
+      library[tm].len = 2 + rand() % 15;
+      library[tm].favorite = 0; // so new steps get A-1 without a random pick
+    }
+    Reset();
+
+    // A fifth of the steps on track 1, which takes it past 99 steps
+    total_steps = ENIGMA_MAX_SONG_STEPS - 24;
+    for (uint16_t s = 0; s < total_steps; s++) {
+      song[s].Init(rand() % 5 ? 1 + rand() % 3 : 0);
+      song[s].set_tm(rand() % HS::TURING_MACHINE_COUNT);
+      song[s].set_p(rand() % 4 ? 0 : rand() % 101);
+      song[s].set_repeats(1 + rand() % 3);
+      song[s].set_transpose(rand() % 25 - 12);
+    }
+
+    // Track 1 plays through once; the rest loop, at different divisions
+    for (byte t = 0; t < 4; t++) {
+      track[t].InitAs(t);
+      track[t].set_divide(1 + t % 3);
+      track[t].set_loop(t > 0);
+    }
+
+    app.reset(new EnigmaTMWS);
+    app->BaseStart();
+    SendSong();
+  }
+
+  // The library is shared with EnigmaJr, whose trace starts from an empty one
+  void TearDown() override {
+    memset(HS::user_turing_machines, 0, sizeof(HS::user_turing_machines));
+  }
+
+  uint16_t TrackStep(byte t, int number) {
+    for (uint16_t s = 0; s < total_steps; s++)
+      if (song[s].track() == t && number-- == 0) return s;
+    return ENIGMA_NO_STEP_AVAILABLE;
+  }
+
+  int TrackSteps(byte t) {
+    int steps = 0;
+    for (uint16_t s = 0; s < total_steps; s++) steps += song[s].track() == t;
+    return steps;
+  }
+
+  // As the song editor's InsertStep() and DeleteStep() change it
+  void InsertAfter(uint16_t s) {
+    for (uint16_t i = total_steps; i > s + 1; i--) song[i] = song[i - 1];
+    song[s + 1].Init(song[s].track());
+    total_steps++;
+  }
+  void Delete(uint16_t s) {
+    for (uint16_t i = s; i + 1 < total_steps; i++) song[i] = song[i + 1];
+    total_steps--;
+  }
+
+  void Reset() {
+    OC::Host::Reset(1);
+    HS::frame = HS::IOFrame();
+    HS::Init();
+    HS::random_streams.Reseed(3);
+    memcpy(HS::user_turing_machines, library, sizeof(library));
+  }
+
+  // One ISR tick, as EnigmaTMWS_isr() runs it
+  void Tick(uint32_t gates) {
+    OC::Host::SetGates(gates);
+    OC::Host::Tick();
+    HS::frame.Load();
+  }
+
+  // ReceiveSongSteps() pages and ReceiveTrackSettings(), as older versions sent them
+  void SendSong() {
+    for (uint16_t page = 0; page <= total_steps / 8; page++) {
+      uint8_t V[4 + 8 * 4] = { 's', uint8_t(page), uint8_t(total_steps & 0xff), uint8_t(total_steps >> 8) };
+      for (byte s = 0; s < 8; s++) {
+        const EnigmaStep &step = song[page * 8 + s];
+        V[4 + s * 4] = step.tk;
+        V[5 + s * 4] = step.pr;
+        V[6 + s * 4] = step.re;
+        V[7 + s * 4] = step.tr;
+      }
+      Receive(V, sizeof(V));
+    }
+    uint8_t V[5] = { 't' };
+    for (byte t = 0; t < 4; t++) V[1 + t] = track[t].data;
+    Receive(V, sizeof(V));
+  }
+
+  void Receive(uint8_t *V, int size) {
+    UnpackedData unpacked;
+    unpacked.set_data(size, V);
+    PackedData packed = unpacked.pack();
+    std::vector<uint8_t> sysex = { 0xf0, 0x7d, 0x62, 'T' };
+    sysex.insert(sysex.end(), packed.data, packed.data + packed.size);
+    sysex.push_back(0xf7);
+    Receive(sysex);
+  }
+
+  void Receive(const std::vector<uint8_t> &sysex) {
+    usbMIDI.ReceiveSysEx(sysex.data(), sysex.size());
+    Tick(0);
+    app->Controller();
+  }
+
+  // Clock on Digital 1 every 4 ticks, start with Digital 3, pause and resume
+  // with Digital 4, and reset with Digital 2 part way through
+  template <class Controller>
+  std::vector<Outputs> Play(Controller controller) {
+    Reset();
+    std::vector<Outputs> trace;
+    for (int clock = 0; clock < kClocks; clock++) {
+      uint32_t gates = 0x01;
+      if (clock == 0) gates |= 0x04;
+      if (clock == 1000 || clock == 1100) gates |= 0x08;
+      if (clock == 2500) gates |= 0x02;
+      for (int t = 0; t < 4; t++) {
+        Tick(t < 2 ? gates : 0);
+        controller();
+        Outputs outputs;
+        for (int o = 0; o < DAC_CHANNEL_LAST; o++) outputs[o] = HS::frame.outputs[o];
+        trace.push_back(outputs);
+      }
+    }
+    return trace;
+  }
+
+  void ExpectSamePlayback() {
+    const std::vector<Outputs> played = Play([this] { app->Controller(); });
+
+    LinearScanPlayback reference;
+    reference.Load(song, total_steps, track);
+    const std::vector<Outputs> expected = Play([&reference] { reference.Controller(); });
+
+    ASSERT_EQ(expected.size(), played.size());
+    int changes = 0;
+    for (size_t tick = 0; tick < played.size(); tick++) {
+      ASSERT_EQ(expected[tick], played[tick]) << "tick " << tick;
+      if (tick > 0 && played[tick] != played[tick - 1]) ++changes;
+    }
+    EXPECT_GT(changes, kClocks / 2); // it did play
+  }
+
+  HS::TuringMachine library[HS::TURING_MACHINE_COUNT];
+  EnigmaStep song[ENIGMA_MAX_SONG_STEPS];
+  uint16_t total_steps;
+  EnigmaTrack track[4];
+  std::unique_ptr<EnigmaTMWS> app;
+};
+
+TEST_F(EnigmaPlaybackTest, LongSongMatchesLinearScan) {
+  ASSERT_GT(TrackSteps(0), 99);
+  app->OnLeftButtonPress(); // Assign
+  app->OnLeftButtonPress(); // Song
+  app->OnLeftButtonPress(); // Play
+  ExpectSamePlayback();
+}
+
+TEST_F(EnigmaPlaybackTest, SongDumpAsBlock) {
+  usbMIDI = usb_midi_class();
+  app->OnSendSysEx();
+  const std::vector<std::vector<uint8_t>> dump = usbMIDI.sysex_sent;
+
+  // The song goes as a block, every message flushed before the next
+  size_t block = 0;
+  for (size_t m = 0; m < dump.size(); m++) {
+    EXPECT_LE(dump[m].size(), 60u) << m;
+    EXPECT_EQ(m, usbMIDI.sysex_flushed[m]) << m;
+    if (dump[m][2] == SYSEX_BLOCK_ID) ++block;
+  }
+  EXPECT_EQ(dump.size(), usbMIDI.flushes);
+  EXPECT_EQ(1 + (total_steps * 4u + SYSEX_BLOCK_CHUNK - 1) / SYSEX_BLOCK_CHUNK, block);
+
+  // A fresh Enigma that hears the dump plays the same song
+  app.reset(new EnigmaTMWS);
+  app->BaseStart();
+  for (const std::vector<uint8_t> &sysex : dump) Receive(sysex);
+  app->OnLeftButtonPress(); // Assign
+  app->OnLeftButtonPress(); // Song
+  app->OnLeftButtonPress(); // Play
+  ExpectSamePlayback();
+}
+
+TEST_F(EnigmaPlaybackTest, CorruptSongBlockKeepsTheOldSong) {
+  // Another song, transposed, sent as a block with a flipped bit in a middle chunk
+  EnigmaStep other[ENIGMA_MAX_SONG_STEPS];
+  memcpy(other, song, sizeof(other));
+  for (uint16_t s = 0; s < total_steps; s++) other[s].set_transpose(song[s].transpose() + 5);
+
+  SysExBlockWriter writer(reinterpret_cast<const uint8_t *>(other), total_steps * sizeof(EnigmaStep), 'T');
+  std::vector<std::vector<uint8_t>> block;
+  uint8_t msg[SYSEX_BLOCK_MSG_MAX];
+  while (uint32_t size = writer.Next(msg)) block.push_back(std::vector<uint8_t>(msg, msg + size));
+  ASSERT_GT(block.size(), 4u);
+  block[block.size() / 2][SYSEX_BLOCK_HEADER + 1] ^= 0x01;
+
+  for (const std::vector<uint8_t> &sysex : block) Receive(sysex);
+  app->OnLeftButtonPress(); // Assign
+  app->OnLeftButtonPress(); // Song
+  app->OnLeftButtonPress(); // Play
+  ExpectSamePlayback();
+}
+
+TEST_F(EnigmaPlaybackTest, EditsPastStep99) {
+  const int steps = TrackSteps(0);
+  ASSERT_GT(steps, 150);
+  ASSERT_LT(steps, ENIGMA_MAX_TRACK_STEPS);
+
+  app->OnLeftButtonPress(); // Assign
+  app->OnLeftButtonPress(); // Song
+  app->OnRightEncoderMove(1); // dismisses the help
+
+  // Insert after step 150 of track 1
+  for (int n = 0; n < 149; n++) app->OnRightEncoderMove(1);
+  app->OnUpButtonPress();
+  InsertAfter(TrackStep(0, 149));
+
+  // Selection stops at the last step, which goes
+  for (int n = 0; n < ENIGMA_MAX_TRACK_STEPS; n++) app->OnRightEncoderMove(1);
+  app->OnDownButtonPress();
+  Delete(TrackStep(0, steps));
+
+  app->OnLeftButtonPress(); // Play
+  ExpectSamePlayback();
+}
+
+} // namespace
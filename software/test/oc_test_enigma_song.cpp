@@ -0,0 +1,79 @@
+#include <vector>
+#include "gtest/gtest.h"
+#include "enigma/EnigmaSongIndex.h"
+
+struct TestStep {
+  uint8_t tk;
+  uint8_t track() const { return (tk >> 6) & 0x03; }
+};
+
+class EnigmaSongIndexTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    srand(0xe9);
+  }
+
+protected:
+  void RandomSong(uint16_t length, uint8_t tracks = 4) {
+    total_steps_ = length;
+    for (uint16_t s = 0; s < length; s++) steps_[s].tk = (rand() % tracks) << 6;
+    index_.Rebuild(steps_, total_steps_);
+  }
+
+  // The linear scans the song controller used before the index
+  uint16_t ScanFirst(uint8_t track) const {
+    for (uint16_t s = 0; s < total_steps_; s++)
+      if (steps_[s].track() == track) return s;
+    return ENIGMA_NO_STEP_AVAILABLE;
+  }
+  uint16_t ScanNext(uint16_t step) const {
+    for (uint16_t s = step + 1; s < total_steps_; s++)
+      if (steps_[s].track() == steps_[step].track()) return s;
+    return ENIGMA_NO_STEP_AVAILABLE;
+  }
+
+  TestStep steps_[ENIGMA_MAX_SONG_STEPS];
+  uint16_t total_steps_;
+  EnigmaSongIndex index_;
+};
+
+TEST_F(EnigmaSongIndexTest, MatchesLinearScan) {
+  for (uint16_t length : { 0, 1, 7, 100, ENIGMA_MAX_SONG_STEPS }) {
+    RandomSong(length);
+    for (uint8_t t = 0; t < 4; t++) EXPECT_EQ(ScanFirst(t), index_.First(t));
+    for (uint16_t s = 0; s < length; s++) EXPECT_EQ(ScanNext(s), index_.Next(s)) << s;
+  }
+}
+
+TEST_F(EnigmaSongIndexTest, EmptyTracks) {
+  RandomSong(50, 2);
+  EXPECT_EQ(ENIGMA_NO_STEP_AVAILABLE, index_.First(2));
+  EXPECT_EQ(ENIGMA_NO_STEP_AVAILABLE, index_.First(3));
+}
+
+TEST_F(EnigmaSongIndexTest, LoopingPlaybackReplay) {
+  RandomSong(ENIGMA_MAX_SONG_STEPS);
+  for (uint8_t t = 0; t < 4; t++) {
+    std::vector<uint16_t> scanned, indexed;
+    uint16_t a = ScanFirst(t), b = index_.First(t);
+    for (int i = 0; i < 2000; i++) {
+      scanned.push_back(a);
+      indexed.push_back(b);
+      a = ScanNext(a);
+      if (a == ENIGMA_NO_STEP_AVAILABLE) a = ScanFirst(t);
+      b = index_.Next(b);
+      if (b == ENIGMA_NO_STEP_AVAILABLE) b = index_.First(t);
+    }
+    EXPECT_EQ(scanned, indexed);
+  }
+}
+
+TEST_F(EnigmaSongIndexTest, RebuildAfterEdit) {
+  RandomSong(200);
+  // Delete step 10 the way DeleteStep() does, then re-index
+  memmove(&steps_[10], &steps_[11], sizeof(steps_[0]) * (total_steps_ - 11));
+  total_steps_--;
+  index_.Rebuild(steps_, total_steps_);
+  for (uint8_t t = 0; t < 4; t++) EXPECT_EQ(ScanFirst(t), index_.First(t));
+  for (uint16_t s = 0; s < total_steps_; s++) EXPECT_EQ(ScanNext(s), index_.Next(s));
+}
@@ -0,0 +1,125 @@
+#include "oc_test_host.h"
+#include "OC_core.h"
+#include "OC_ADC.h"
+#include "OC_calibration.h"
+
+// Definitions for the host board in oc_test_host.h, standing in for
+// Main.cpp and the drivers
+
+usb_midi_class usbMIDI;
+FreqMeasureClass FreqMeasure;
+weegfx::Graphics graphics;
+
+uint32_t ARM_DWT_CYCCNT = 0;
+uint32_t ARM_DEMCR = 0;
+uint32_t ARM_DWT_CTRL = 0;
+
+ADC_CHANNEL ADC_CHANNEL_1 = 0, ADC_CHANNEL_2 = 1, ADC_CHANNEL_3 = 2, ADC_CHANNEL_4 = 3;
+
+namespace OC {
+
+namespace CORE {
+volatile uint32_t ticks = 0;
+volatile bool app_isr_enabled = false;
+}
+
+CalibrationData calibration_data;
+bool calibration_data_loaded = false;
+
+static uint32_t host_gates;
+static int32_t host_cv[ADC_CHANNEL_LAST];
+
+uint32_t DigitalInputs::clocked_mask_;
+uint32_t DigitalInputs::gates_;
+
+void DigitalInputs::Scan() {
+    clocked_mask_ = host_gates & ~gates_;
+    gates_ = host_gates;
+}
+
+// Apps send their IO frame to the DAC; nothing reads it back
+DAC::CalibrationData *DAC::calibration_data_ = &calibration_data.dac;
+uint32_t DAC::values_[DAC_CHANNEL_LAST];
+
+uint8_t DAC::get_voltage_scaling(uint8_t) {
+    return VOLTAGE_SCALING_1V_PER_OCT;
+}
+
+// CV goes in as the raw reading the real ADC would give for it, at an offset
+// of 32768 and unity scale, so raw_pitch_value() and value() read it back
+static constexpr uint16_t kHostAdcOffset = 32768;
+
+::ADC ADC::adc_;
+size_t ADC::scan_channel_;
+ADC::CalibrationData *ADC::calibration_data_;
+uint32_t ADC::raw_[ADC_CHANNEL_LAST];
+uint32_t ADC::smoothed_[ADC_CHANNEL_LAST];
+
+void ADC::Init(CalibrationData *calibration_data, bool) {
+    calibration_data_ = calibration_data;
+    for (int i = 0; i < ADC_CHANNEL_LAST; ++i) calibration_data_->offset[i] = kHostAdcOffset;
+    calibration_data_->pitch_cv_scale = 1 << 12;
+    calibration_data_->pitch_cv_offset = 0;
+}
+
+void ADC::Scan_DMA() {
+    for (int i = 0; i < ADC_CHANNEL_LAST; ++i)
+        raw_[i] = smoothed_[i] = uint32_t(kHostAdcOffset - host_cv[i]) << kAdcValueShift;
+}
+
+namespace Host {
+
+static uint32_t random_state;
+
+void Reset(uint32_t seed) {
+    CORE::ticks = 0;
+    host_gates = 0;
+    for (int i = 0; i < ADC_CHANNEL_LAST; ++i) host_cv[i] = 0;
+    DigitalInputs::Init();
+    ADC::Init(&calibration_data.adc);
+    ADC::Scan_DMA();
+    calibration_data.flags = 0;
+    randomSeed(seed);
+    usbMIDI = usb_midi_class();
+}
+
+void SetGates(uint32_t gates) {
+    host_gates = gates;
+}
+
+void SetCV(int channel, int32_t cv) {
+    host_cv[channel] = constrain(cv, -32767, 32767);
+}
+
+void Tick() {
+    ADC::Scan_DMA();
+    DigitalInputs::Scan();
+    ++CORE::ticks;
+}
+
+} // namespace Host
+} // namespace OC
+
+uint32_t millis() {
+    return uint64_t(OC::CORE::ticks) * OC_CORE_TIMER_RATE / 1000;
+}
+
+uint32_t micros() {
+    return OC::CORE::ticks * OC_CORE_TIMER_RATE;
+}
+
+// Arduino's random(), a fixed generator so traces repeat
+void randomSeed(uint32_t seed) {
+    OC::Host::random_state = seed;
+}
+
+int32_t random(int32_t howbig) {
+    if (howbig <= 0) return 0;
+    OC::Host::random_state = OC::Host::random_state * 1664525u + 1013904223u;
+    return (OC::Host::random_state >> 8) % howbig;
+}
+
+int32_t random(int32_t howsmall, int32_t howbig) {
+    if (howsmall >= howbig) return howsmall;
+    return howsmall + random(howbig - howsmall);
+}
@@ -0,0 +1,73 @@
+#ifndef OC_TEST_HOST_H_
+#define OC_TEST_HOST_H_
+
+// A host "board" for the Hemisphere framework: include this before any
+// firmware header. It fills in the drivers the firmware only has for Teensy
+// targets (digital inputs, the ADC, frequency measurement) with versions the
+// harness drives directly. Needs test/host on the include path.
+
+#include <Arduino.h>
+
+// The Teensy ADC library doesn't build on the host; OC::ADC only needs its
+// speed constants and the driver type
+#define OC_UTIL_ADC_H
+#define ADC_HIGH_SPEED_16BITS 3
+#define ADC_HIGH_SPEED 4
+class ADC { };
+
+// No settings are saved
+#define EEPROMSTORAGE_H_
+struct EEPROMStorage {
+    static const size_t LENGTH = 4284;
+    static void update(size_t, const void *, size_t) { }
+    static void write(size_t, const void *, size_t) { }
+    static void read(size_t, void *data, size_t length) { memset(data, 0xff, length); }
+};
+
+class FreqMeasureClass {
+public:
+    void begin(uint8_t = 0) { }
+    uint8_t available() { return 0; }
+    uint32_t read() { return 0; }
+    float countToFrequency(uint32_t count) { return (float)F_BUS / (float)count; }
+    void end() { }
+};
+
+#include "OC_digital_inputs.h"
+
+namespace OC {
+
+// Trigger inputs, as set through Host::SetGates()
+class DigitalInputs {
+public:
+    static void Init() { clocked_mask_ = gates_ = 0; }
+    static void reInit() { Init(); }
+    static void Scan();
+
+    static inline uint32_t clocked() { return clocked_mask_; }
+    template <DigitalInput input> static inline uint32_t clocked() { return clocked(input); }
+    static inline uint32_t clocked(DigitalInput input) { return clocked_mask_ & (0x1 << input); }
+    template <DigitalInput input> static inline bool read_immediate() { return read_immediate(input); }
+    static inline bool read_immediate(DigitalInput input) { return gates_ & (0x1 << input); }
+
+private:
+    static uint32_t clocked_mask_;
+    static uint32_t gates_;
+};
+
+// What the harness drives. Inputs take effect on the next Tick(), as the
+// real drivers sample them in the core ISR.
+namespace Host {
+    // Time back to zero, inputs low and at 0V, Arduino random() seeded
+    void Reset(uint32_t seed);
+    // Trigger input levels, a bit per input; rising edges clock
+    void SetGates(uint32_t gates);
+    // CV input, in pitch units as OC::ADC reads it back
+    void SetCV(int channel, int32_t cv);
+    // One core ISR: scan the inputs and advance OC::CORE::ticks
+    void Tick();
+} // namespace Host
+
+} // namespace OC
+
+#endif // OC_TEST_HOST_H_
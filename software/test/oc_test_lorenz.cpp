@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "gtest/gtest.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "streams_lorenz_generator.h"
+
+static const int64_t kBound = 200LL << 24;
+static const int32_t kInitialX = 0.1 * (1 << 24);
+
+class LorenzTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    lorenz_.Init(0);
+    lorenz_.Init(1);
+    lorenz_.set_rho1(0);
+    lorenz_.set_rho2(0);
+    lorenz_.set_out_a(streams::LORENZ_OUTPUT_X1);
+    lorenz_.set_out_b(streams::LORENZ_OUTPUT_Y1);
+    lorenz_.set_out_c(streams::ROSSLER_OUTPUT_X2);
+    lorenz_.set_out_d(streams::ROSSLER_OUTPUT_Y2);
+  }
+
+protected:
+  bool Bounded(uint8_t index) {
+    for (uint8_t axis = 0; axis < 3; ++axis) {
+      if (llabs(lorenz_.lorenz_state(index, axis)) > kBound) return false;
+      if (llabs(lorenz_.rossler_state(index, axis)) > kBound) return false;
+    }
+    return true;
+  }
+
+  streams::LorenzGenerator lorenz_;
+};
+
+TEST_F(LorenzTest, StableAcrossRhoAndRate) {
+  static const streams::LorenzIntegrator integrators[] = {
+    streams::LORENZ_INTEGRATOR_SEMI_IMPLICIT,
+    streams::LORENZ_INTEGRATOR_RK4,
+  };
+  for (auto integrator : integrators) {
+    for (int rho = 4; rho <= 127; rho += 41) {
+      for (int freq = 0; freq <= 65535; freq += 16383) {
+        SetUp();
+        lorenz_.set_integrator(integrator);
+        lorenz_.set_rho1((rho << 8) | 0xff);
+        lorenz_.set_rho2((rho << 8) | 0xff);
+        for (int i = 0; i < 50000; ++i) {
+          lorenz_.Process(freq, freq, false, false, 4, 4);
+        }
+        EXPECT_TRUE(Bounded(0) && Bounded(1)) << "integrator " << integrator << " rho " << rho << " freq " << freq;
+      }
+    }
+  }
+}
+
+TEST_F(LorenzTest, DecimatedRK4StaysStable) {
+  lorenz_.set_integrator(streams::LORENZ_INTEGRATOR_RK4);
+  lorenz_.set_decimation(0, 4);
+  lorenz_.set_decimation(1, 4);
+  lorenz_.set_rho1(127 << 8);
+  lorenz_.set_rho2(127 << 8);
+  for (int i = 0; i < 200000; ++i) {
+    lorenz_.Process(65535, 65535, false, false, 4, 4);
+  }
+  EXPECT_TRUE(Bounded(0));
+  EXPECT_TRUE(Bounded(1));
+}
+
+TEST_F(LorenzTest, OnlyRoutedSystemsAdvance) {
+  for (int i = 0; i < 100; ++i) lorenz_.Process(40000, 40000, false, false, 2, 2);
+  // Rossler 1 and Lorenz 2 aren't routed
+  EXPECT_EQ(kInitialX, lorenz_.rossler_state(0, 0));
+  EXPECT_EQ(kInitialX, lorenz_.lorenz_state(1, 0));
+  EXPECT_NE(kInitialX, lorenz_.lorenz_state(0, 0));
+  EXPECT_NE(kInitialX, lorenz_.rossler_state(1, 0));
+}
+
+TEST_F(LorenzTest, DisabledGeneratorHolds) {
+  lorenz_.set_generator_enabled(0, false);
+  for (int i = 0; i < 100; ++i) lorenz_.Process(40000, 40000, false, false, 2, 2);
+  EXPECT_EQ(kInitialX, lorenz_.lorenz_state(0, 0));
+  EXPECT_NE(kInitialX, lorenz_.rossler_state(1, 0));
+}
+
+TEST_F(LorenzTest, DecimationStepsEveryNthCall) {
+  lorenz_.set_decimation(0, 4);
+  int changes = 0;
+  int32_t last = lorenz_.lorenz_state(0, 0);
+  for (int i = 0; i < 400; ++i) {
+    lorenz_.Process(40000, 40000, false, false, 2, 2);
+    if (lorenz_.lorenz_state(0, 0) != last) ++changes;
+    last = lorenz_.lorenz_state(0, 0);
+  }
+  EXPECT_EQ(100, changes);
+}
+
+// Rossler Z goes to the DAC as z >> 14, so it wraps from 64.0 up. Euler's
+// attractor swells at the fastest rate and gets there; the apps use
+// semi-implicit Euler, which doesn't.
+TEST_F(LorenzTest, SemiImplicitOutputsDontWrap) {
+  static const streams::LorenzIntegrator integrators[] = {
+    streams::LORENZ_INTEGRATOR_EULER,
+    streams::LORENZ_INTEGRATOR_SEMI_IMPLICIT,
+  };
+  int32_t peak[2] = {0, 0};
+  for (int i = 0; i < 2; ++i) {
+    SetUp();
+    lorenz_.set_integrator(integrators[i]);
+    lorenz_.set_rho2(127 << 8);
+    lorenz_.set_out_c(streams::ROSSLER_OUTPUT_Z2);
+    for (int n = 0; n < 200000; ++n) {
+      lorenz_.Process(65535, 65535, false, false, 4, 4);
+      peak[i] = std::max(peak[i], lorenz_.rossler_state(1, 2));
+    }
+  }
+  EXPECT_GT(peak[0], 64 << 24);
+  EXPECT_LT(peak[1], 64 << 24);
+}
+
+// Cycle counter where the host has one, for a rough cycles-per-step figure
+static uint64_t Cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+TEST_F(LorenzTest, CostPerStep) {
+  static const char *const names[] = {"Euler", "semi-implicit", "RK4"};
+  const int steps = 200000;
+  lorenz_.set_out_c(streams::LORENZ_OUTPUT_X2);
+  lorenz_.set_out_d(streams::LORENZ_OUTPUT_Y2);
+  std::cout << "Lorenz, two generators per step:";
+  for (int i = 0; i < streams::LORENZ_INTEGRATOR_LAST; ++i) {
+    lorenz_.set_integrator(static_cast<streams::LorenzIntegrator>(i));
+    auto start = std::chrono::steady_clock::now();
+    const uint64_t c0 = Cycles();
+    for (int n = 0; n < steps; ++n) lorenz_.Process(30000, 30000, false, false, 2, 2);
+    const uint64_t c1 = Cycles();
+    auto end = std::chrono::steady_clock::now();
+    std::cout << ' ' << names[i] << ' '
+              << std::chrono::duration<double, std::nano>(end - start).count() / steps << " ns, "
+              << double(c1 - c0) / steps << " cycles;";
+  }
+  std::cout << " (" << (lorenz_.dac_code(0) & 1) << ")" << std::endl;
+}
@@ -0,0 +1,141 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "HSMIDIClock.h"
+
+namespace {
+
+static constexpr int kPPQN = 24;
+static constexpr int kBeats = 64;
+
+// The tock path MIDI Clock used to come from: ticks_per_beat truncated from the
+// tempo, pulses at beat_tick + count * ticks_per_beat / 24, restarting each beat
+std::vector<uint32_t> TockPulses(uint16_t bpm, int beats) {
+  std::vector<uint32_t> pulses;
+  const uint32_t ticks_per_beat = HS::MIDI_CLOCK_TICKS_PER_MINUTE / bpm;
+  uint32_t beat_tick = 0;
+  int count = 0;
+  for (uint32_t now = 0; pulses.size() < static_cast<size_t>(beats * kPPQN); ++now) {
+    uint32_t next_tock_tick = beat_tick + count * ticks_per_beat / kPPQN;
+    if (now >= next_tock_tick) {
+      ++count;
+      pulses.push_back(now);
+    }
+    if (count > kPPQN) {
+      beat_tick = now;
+      count = 1;
+    }
+  }
+  return pulses;
+}
+
+std::vector<uint32_t> GeneratorPulses(uint16_t bpm, int beats) {
+  std::vector<uint32_t> pulses;
+  HS::MIDIClockGenerator gen(kPPQN);
+  gen.SetTempoBPM(bpm);
+  gen.Start();
+  for (uint32_t now = 0; pulses.size() < static_cast<size_t>(beats * kPPQN); ++now) {
+    if (gen.Tick()) pulses.push_back(now);
+  }
+  return pulses;
+}
+
+struct Jitter {
+  double max_error; // ticks away from the ideal pulse time
+  uint32_t spread; // longest minus shortest pulse interval, in ticks
+};
+
+Jitter Measure(const std::vector<uint32_t> &pulses, uint16_t bpm) {
+  const double ideal = static_cast<double>(HS::MIDI_CLOCK_TICKS_PER_MINUTE) / (bpm * kPPQN);
+  Jitter j = {0.0, 0};
+  uint32_t shortest = UINT32_MAX, longest = 0;
+  for (size_t i = 0; i < pulses.size(); ++i) {
+    double err = fabs(pulses[i] - i * ideal);
+    if (err > j.max_error) j.max_error = err;
+    if (i) {
+      uint32_t interval = pulses[i] - pulses[i - 1];
+      if (interval < shortest) shortest = interval;
+      if (interval > longest) longest = interval;
+    }
+  }
+  j.spread = longest - shortest;
+  return j;
+}
+
+} // namespace
+
+TEST(MIDIClockGenerator, JitterAgainstTockPath) {
+  for (uint16_t bpm = 30; bpm <= 300; bpm += 9) {
+    Jitter tock = Measure(TockPulses(bpm, kBeats), bpm);
+    Jitter gen = Measure(GeneratorPulses(bpm, kBeats), bpm);
+
+    // every pulse on the tick at or just before its ideal time, and no drift
+    EXPECT_LT(gen.max_error, 1.0) << bpm << " BPM";
+    EXPECT_LE(gen.spread, 1u) << bpm << " BPM";
+    EXPECT_LE(gen.max_error, tock.max_error + 1e-9) << bpm << " BPM";
+
+    if (bpm % 90 == 30) {
+      std::cout << "MIDI Clock @" << bpm << " BPM over " << kBeats << " beats: tock path error "
+                << tock.max_error << " ticks (spread " << tock.spread << "), generator "
+                << gen.max_error << " ticks (spread " << gen.spread << ")" << std::endl;
+    }
+  }
+}
+
+TEST(MIDIClockGenerator, FirstPulseOnStart) {
+  HS::MIDIClockGenerator gen(kPPQN);
+  gen.SetTempoBPM(120);
+  gen.Start();
+  EXPECT_TRUE(gen.Tick());
+  EXPECT_FALSE(gen.Tick());
+  EXPECT_EQ(1u, gen.Pulses());
+}
+
+TEST(MIDIClockGenerator, TicksPerBeat) {
+  HS::MIDIClockGenerator gen(kPPQN);
+  gen.SetTicksPerBeat(8000); // 125 BPM, as measured from an external clock
+  gen.Start();
+  uint32_t now = 0, last = 0;
+  for (int p = 0; p < 24 * 4; ++now) {
+    if (gen.Tick()) {
+      if (p) {
+        EXPECT_NEAR(8000.0 / 24, now - last, 1.0);
+      }
+      last = now;
+      ++p;
+    }
+  }
+  EXPECT_EQ(4u * 8000 - 8000 / 24 - 1, last); // 96th pulse, ending just before beat 5
+}
+
+TEST(MIDIClockGenerator, SongPosition) {
+  HS::MIDIClockGenerator gen(kPPQN);
+  gen.Start(16); // bar 2
+  EXPECT_EQ(16, gen.SongPosition());
+  gen.SetTempoBPM(300);
+  for (int i = 0; i < 20000 && gen.Pulses() < 16 * 6 + 7; ++i) gen.Tick();
+  EXPECT_EQ(16 + 2, gen.SongPosition()); // partway into the 16th, rounds up
+
+  gen.Start(HS::MIDI_SPP_MAX);
+  for (int i = 0; i < 2000; ++i) gen.Tick();
+  EXPECT_EQ(HS::MIDI_SPP_MAX, gen.SongPosition());
+}
+
+TEST(MIDIClockGenerator, NudgeFollowsBeat) {
+  HS::MIDIClockGenerator a(kPPQN), b(kPPQN);
+  a.SetTempoBPM(100);
+  b.SetTempoBPM(100);
+  a.Start();
+  b.Start();
+  b.Nudge(5); // b's beat is 5 ticks later
+
+  std::vector<uint32_t> pa, pb;
+  for (uint32_t now = 0; now < 100000; ++now) {
+    if (a.Tick()) pa.push_back(now);
+    if (b.Tick()) pb.push_back(now);
+  }
+  ASSERT_GT(pa.size(), 10u);
+  for (size_t i = 1; i < 10; ++i) EXPECT_NEAR(pa[i] + 5.0, pb[i], 1.0);
+}
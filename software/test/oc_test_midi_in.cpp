@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+
+// MIDI In notes through MIDIState to a pair of MIDIIn applets, with Note and
+// Gate outputs on one channel in both hemispheres
+
+#include "oc_test_host.h"
+#include "OC_core.h"
+#include "HemisphereApplet.h"
+#include "HSicons.h"
+#include "applets/hMIDIIn.h"
+
+namespace {
+
+class MIDIInTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    OC::Host::Reset(1);
+    HS::frame = HS::IOFrame();
+    HS::Init();
+    for (int h = 0; h < 2; ++h) {
+      midi_in[h].BaseStart(HEM_SIDE(h));
+      midi_in[h].OnDataReceive(NoteAndGate());
+    }
+  }
+
+  void TearDown() override {
+    for (int h = 0; h < 2; ++h) midi_in[h].Unload();
+  }
+
+  // Channel 1 on both outputs, Note# on the first and Gate on the second
+  static uint64_t NoteAndGate(int voice_mode = 0) {
+    return (uint64_t(HEM_MIDI_NOTE_OUT) << 8) | (uint64_t(HEM_MIDI_GATE_OUT) << 11)
+        | (uint64_t(voice_mode) << 28);
+  }
+
+  void Note(bool on, int note) {
+    HS::frame.MIDIState.ProcessMIDIMsg(1, on ? usbMIDI.NoteOn : usbMIDI.NoteOff, note, on ? 100 : 0);
+  }
+
+  int Pitch(int h) const { return HS::frame.MIDIState.outputs[h * 2]; }
+  bool Gate(int h) const { return HS::frame.MIDIState.outputs[h * 2 + 1] > 0; }
+
+  hMIDIIn midi_in[2];
+};
+
+TEST_F(MIDIInTest, UnisonByDefault) {
+  // Both Note outputs follow the latest note, as they did before voices
+  Note(true, 60);
+  Note(true, 64);
+  for (int h = 0; h < 2; ++h) {
+    EXPECT_EQ(MIDIQuantizer::CV(64), Pitch(h)) << h;
+    EXPECT_TRUE(Gate(h)) << h;
+  }
+
+  Note(false, 64);
+  for (int h = 0; h < 2; ++h) {
+    EXPECT_EQ(MIDIQuantizer::CV(60), Pitch(h)) << h;
+    EXPECT_TRUE(Gate(h)) << h;
+  }
+
+  Note(false, 60);
+  for (int h = 0; h < 2; ++h) EXPECT_FALSE(Gate(h)) << h;
+}
+
+TEST_F(MIDIInTest, SavedVoiceModeSplitsNotes) {
+  midi_in[1].OnDataReceive(NoteAndGate(HS::VOICE_LAST));
+  EXPECT_EQ(NoteAndGate(HS::VOICE_LAST), midi_in[1].OnDataRequest() & 0x7fffffff);
+
+  Note(true, 60);
+  Note(true, 64);
+  EXPECT_EQ(MIDIQuantizer::CV(60), Pitch(0));
+  EXPECT_EQ(MIDIQuantizer::CV(64), Pitch(1));
+  EXPECT_TRUE(Gate(0));
+  EXPECT_TRUE(Gate(1));
+
+  // A fresh MIDIIn goes back to Unison
+  midi_in[1].BaseStart(HEM_SIDE(1));
+  midi_in[1].OnDataReceive(NoteAndGate());
+  Note(true, 67);
+  EXPECT_EQ(MIDIQuantizer::CV(67), Pitch(0));
+  EXPECT_EQ(MIDIQuantizer::CV(67), Pitch(1));
+}
+
+} // namespace
@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "gtest/gtest.h"
+#include "HSMIDILoop.h"
+
+using namespace HS;
+
+static const int kTicksPerSecond = 16667; // the core ISR runs every 60us
+
+struct Played {
+  MIDIEvent event;
+  uint32_t at; // pulse it came out on
+};
+
+static MIDIEvent Event(uint32_t time, uint8_t status, uint8_t data1, uint8_t data2 = 0) {
+  MIDIEvent e;
+  e.time = time;
+  e.status = status;
+  e.data1 = data1;
+  e.data2 = (MIDIDataLength(status) == 2) ? data2 : 0;
+  return e;
+}
+
+static bool Same(const MIDIEvent &a, const MIDIEvent &b) {
+  return a.time == b.time && a.status == b.status && a.data1 == b.data1 && a.data2 == b.data2;
+}
+
+// Random traffic on a few channels, about one event per pulse at the densest
+static std::vector<MIDIEvent> RandomEvents(uint32_t seed, int count, uint32_t length) {
+  std::vector<MIDIEvent> events;
+  const uint8_t types[] = {0x90, 0x80, 0x90, 0x80, 0xb0, 0xe0, 0xc0, 0xd0, 0xa0};
+  for (int i = 0; i < count; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    const uint8_t status = types[(seed >> 8) % 9] | ((seed >> 4) & 3);
+    events.push_back(Event((seed >> 12) % length, status, (seed >> 20) & 0x7f, ((seed >> 27) & 0x7f) | 1));
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const MIDIEvent &a, const MIDIEvent &b) { return a.time < b.time; });
+  return events;
+}
+
+static void RecordLayer(MIDILoop &loop, const std::vector<MIDIEvent> &events) {
+  ASSERT_TRUE(loop.BeginLayer());
+  for (const MIDIEvent &e : events) ASSERT_TRUE(loop.Record(e.time, e.status, e.data1, e.data2));
+  loop.EndLayer();
+}
+
+// Runs the player tick by tick at a tempo, as the applet does, from pulse
+// `from` up to, not including, `to`
+static std::vector<Played> Replay(MIDILoopPlayer &player, uint32_t from, uint32_t to, int bpm) {
+  const uint32_t ticks_per_beat = kTicksPerSecond * 60 / bpm;
+  std::vector<Played> played;
+  uint32_t pulse = from, phase = 0;
+  MIDIEvent out[8];
+  while (true) {
+    phase += MIDILOOP_PPQN;
+    while (phase >= ticks_per_beat) {
+      phase -= ticks_per_beat;
+      ++pulse;
+    }
+    if (pulse >= to) break;
+    const int n = player.Advance(pulse, out, 8);
+    for (int i = 0; i < n; ++i) played.push_back({out[i], pulse});
+  }
+  return played;
+}
+
+TEST(MIDILoop, RoundTrip) {
+  std::vector<uint8_t> memory(65536);
+  MIDILoop loop;
+  loop.Init(memory.data(), memory.size());
+
+  std::vector<MIDIEvent> events = RandomEvents(1, 5000, 16 * MIDILOOP_PPQN);
+  // gaps that need every varint length
+  const uint32_t last = events.back().time;
+  const uint32_t gaps[] = {127, 128, 16383, 16384, MIDILoop::MAX_DELTA};
+  uint32_t t = last;
+  for (uint32_t gap : gaps) {
+    t += gap;
+    events.push_back(Event(t, 0x91, 60, 100));
+  }
+  RecordLayer(loop, events);
+
+  MIDIEvent e;
+  size_t pos = loop.layer_start(0);
+  for (size_t i = 0; i < events.size(); ++i) {
+    ASSERT_LT(pos, loop.layer_end(0)) << i;
+    pos = loop.Decode(pos, e);
+    ASSERT_TRUE(Same(events[i], e)) << i;
+  }
+  EXPECT_EQ(loop.size(), pos);
+  std::cout << "MIDI loop: " << (double)loop.size() / events.size() << " bytes/event" << std::endl;
+
+  // only channel messages are taken, and never out of order
+  ASSERT_TRUE(loop.BeginLayer());
+  EXPECT_FALSE(loop.Record(MIDILoop::MAX_DELTA + 1, 0x90, 60, 100));
+  EXPECT_FALSE(loop.Record(10, 0xf8, 0, 0));
+  EXPECT_FALSE(loop.Record(10, 0x40, 0, 0));
+  EXPECT_TRUE(loop.Record(100, 0x90, 60, 100));
+  EXPECT_TRUE(loop.Record(50, 0x80, 60, 0));
+  loop.EndLayer();
+  pos = loop.layer_start(1);
+  e = MIDIEvent();
+  pos = loop.Decode(pos, e);
+  pos = loop.Decode(pos, e);
+  EXPECT_EQ(100u, e.time);
+  EXPECT_EQ(0x80, e.status);
+}
+
+TEST(MIDILoop, Full) {
+  uint8_t memory[64];
+  MIDILoop loop;
+  loop.Init(memory, sizeof(memory));
+  ASSERT_TRUE(loop.BeginLayer());
+  int recorded = 0;
+  while (loop.Record(recorded * 10, 0x90, 60, 100)) ++recorded;
+  EXPECT_GE(recorded, int(sizeof(memory) / 3) - 3);
+  EXPECT_LE(loop.size(), sizeof(memory));
+  loop.EndLayer();
+
+  // layers run out too
+  uint8_t more[256];
+  loop.Init(more, sizeof(more));
+  for (int i = 0; i < MIDILoop::MAX_LAYERS; ++i) {
+    ASSERT_TRUE(loop.BeginLayer());
+    ASSERT_TRUE(loop.Record(0, 0xb0, 1, i));
+    loop.EndLayer();
+  }
+  EXPECT_FALSE(loop.BeginLayer());
+
+  // an empty layer is dropped
+  loop.Init(memory, sizeof(memory));
+  ASSERT_TRUE(loop.BeginLayer());
+  loop.EndLayer();
+  EXPECT_EQ(0, loop.layers());
+}
+
+// Dense recordings in several layers, replayed at the ISR rate: every event
+// comes out once a pass, in order, on its own pulse
+TEST(MIDILoop, DenseReplayIsOnTime) {
+  const uint32_t length = 4 * MIDILOOP_PPQN;
+  std::vector<uint8_t> memory(65536);
+  MIDILoop loop;
+  loop.Init(memory.data(), memory.size());
+  loop.set_length(length);
+
+  std::vector<std::vector<MIDIEvent>> layers;
+  for (int l = 0; l < 3; ++l) {
+    layers.push_back(RandomEvents(10 + l, 1500, length));
+    RecordLayer(loop, layers.back());
+  }
+
+  for (int bpm : {60, 120, 300}) {
+    MIDILoopPlayer player;
+    player.Start(loop, length);
+    const int passes = 3;
+    const std::vector<Played> played = Replay(player, length - 1, length * (passes + 1), bpm);
+
+    // what should come out: all layers merged, stable by layer
+    std::vector<std::pair<MIDIEvent, int>> expected;
+    for (int pass = 1; pass <= passes; ++pass) {
+      for (int l = 0; l < 3; ++l) {
+        for (MIDIEvent e : layers[l]) {
+          e.time += pass * length;
+          expected.push_back({e, l});
+        }
+      }
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const std::pair<MIDIEvent, int> &a, const std::pair<MIDIEvent, int> &b) {
+                       return a.first.time < b.first.time;
+                     });
+
+    ASSERT_EQ(expected.size(), played.size()) << bpm << " bpm";
+    uint32_t latest = 0;
+    for (size_t i = 0; i < played.size(); ++i) {
+      ASSERT_TRUE(Same(expected[i].first, played[i].event)) << bpm << " bpm, event " << i;
+      latest = std::max(latest, played[i].at - played[i].event.time);
+    }
+    EXPECT_EQ(0u, latest) << bpm << " bpm";
+  }
+}
+
+// A burst beyond what one tick hands out is spread over the next few, in order
+TEST(MIDILoop, BurstIsBounded) {
+  const uint32_t length = MIDILOOP_PPQN;
+  std::vector<uint8_t> memory(4096);
+  MIDILoop loop;
+  loop.Init(memory.data(), memory.size());
+  loop.set_length(length);
+  ASSERT_TRUE(loop.BeginLayer());
+  for (int i = 0; i < 200; ++i) ASSERT_TRUE(loop.Record(480, 0x90, i & 0x7f, 1 + i / 128));
+  loop.EndLayer();
+
+  MIDILoopPlayer player;
+  player.Start(loop, 0);
+  MIDIEvent out[8];
+  int calls = 0, total = 0;
+  EXPECT_EQ(0, player.Advance(479, out, 8));
+  while (total < 200) {
+    const int n = player.Advance(480, out, 8);
+    ASSERT_GT(n, 0);
+    for (int i = 0; i < n; ++i, ++total) {
+      EXPECT_EQ(total & 0x7f, out[i].data1);
+      EXPECT_EQ(480u, out[i].time);
+    }
+    ++calls;
+  }
+  EXPECT_EQ(25, calls); // 8 a tick
+  EXPECT_EQ(0, player.Advance(480, out, 8));
+}
+
+TEST(MIDILoop, QuantizeKeepsNoteLengths) {
+  const uint32_t length = 4 * MIDILOOP_PPQN;
+  const uint32_t grid = 240;
+  std::vector<uint8_t> memory(8192);
+  MIDILoop loop;
+  loop.Init(memory.data(), memory.size());
+  loop.set_length(length);
+
+  // notes of all lengths, not on the grid, and a CC stream
+  std::vector<MIDIEvent> events;
+  uint32_t seed = 7;
+  for (uint32_t t = 13; t + 200 < length; t += 97) {
+    seed = seed * 1664525u + 1013904223u;
+    const uint8_t note = 40 + (t / 97) % 40;
+    events.push_back(Event(t, 0x90, note, 100));
+    events.push_back(Event(t + 1 + (seed >> 24) % 150, 0x80, note, 0));
+    events.push_back(Event(t + 50, 0xb0, 1, note));
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const MIDIEvent &a, const MIDIEvent &b) { return a.time < b.time; });
+  RecordLayer(loop, events);
+
+  MIDILoopPlayer player;
+  player.set_quantize(grid);
+  player.Start(loop, length);
+  const std::vector<Played> played = Replay(player, length - grid, 2 * length, 120);
+
+  std::vector<uint32_t> on_at(128, 0), on_was(128, 0);
+  for (const MIDIEvent &e : events) {
+    if (e.status == 0x90) on_was[e.data1] = e.time;
+  }
+  int notes = 0;
+  for (const Played &p : played) {
+    const MIDIEvent &e = p.event;
+    EXPECT_EQ(e.time, p.at); // nothing late, even moved earlier
+    const uint32_t t = e.time - length;
+    if (e.status == 0x90) {
+      EXPECT_EQ(0u, t % grid);
+      on_at[e.data1] = t;
+      ++notes;
+    } else if (e.status == 0x80) {
+      // the note-off moved with its note-on
+      const MIDIEvent *orig = nullptr;
+      for (const MIDIEvent &o : events)
+        if (o.status == 0x80 && o.data1 == e.data1) orig = &o;
+      ASSERT_NE(nullptr, orig);
+      EXPECT_EQ(int(orig->time) - int(on_was[e.data1]), int(t) - int(on_at[e.data1]));
+    }
+  }
+  EXPECT_GT(notes, 30);
+}
+
+TEST(MIDILoop, Undo) {
+  const uint32_t length = MIDILOOP_PPQN;
+  std::vector<uint8_t> memory(4096);
+  MIDILoop loop;
+  loop.Init(memory.data(), memory.size());
+  loop.set_length(length);
+  RecordLayer(loop, {Event(0, 0x90, 60, 100), Event(100, 0x80, 60)});
+  const size_t base_size = loop.size();
+
+  MIDILoopPlayer player;
+  player.Start(loop, 0);
+  // a layer of overdub
+  ASSERT_TRUE(loop.BeginLayer());
+  loop.Record(50, 0x91, 64, 100);
+  loop.Record(150, 0x81, 64, 0);
+  loop.EndLayer();
+  player.AddLayer(length);
+  EXPECT_EQ(2, player.layers());
+
+  // the first layer twice, the overdub once
+  std::vector<Played> played = Replay(player, 0, 2 * length, 120);
+  EXPECT_EQ(6u, played.size());
+
+  // undo it halfway through a pass, with its note-off still to come
+  MIDIEvent out[8];
+  ASSERT_EQ(2, player.Advance(2 * length + 50, out, 8));
+  EXPECT_EQ(64, out[1].data1);
+  EXPECT_TRUE(loop.Undo());
+  player.Drop();
+  EXPECT_EQ(base_size, loop.size());
+  EXPECT_EQ(1, player.layers());
+  played = Replay(player, 2 * length + 50, 4 * length, 120);
+  ASSERT_EQ(3u, played.size());
+  for (const Played &p : played) EXPECT_EQ(60, p.event.data1);
+}
+
+// What recording and playback cost in the ISR, per call
+TEST(MIDILoop, Cost) {
+  const uint32_t length = 8 * MIDILOOP_PPQN;
+  std::vector<uint8_t> memory(1 << 20);
+  MIDILoop loop;
+  loop.Init(memory.data(), memory.size());
+  loop.set_length(length);
+  const std::vector<MIDIEvent> events = RandomEvents(3, 20000, length);
+
+  using clock = std::chrono::steady_clock;
+  auto t0 = clock::now();
+  RecordLayer(loop, events);
+  const double record_ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count() / events.size();
+
+  MIDILoopPlayer player;
+  player.set_quantize(120);
+  player.Start(loop, 0);
+  MIDIEvent out[8];
+  size_t count = 0;
+  t0 = clock::now();
+  for (uint32_t pulse = 0; pulse < 4 * length; ++pulse) count += player.Advance(pulse, out, 8);
+  const double advance_ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count() / (4 * length);
+  EXPECT_GT(count, 3 * events.size());
+
+  std::cout << "MIDI loop cost: " << record_ns << " ns/event recorded, " << advance_ns
+            << " ns/tick played at " << (double)events.size() / length << " events/pulse" << std::endl;
+}
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <iostream>
+#include "gtest/gtest.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "frames_poly_lfo.h"
+
+static const size_t kBlockSize = 4;
+static const size_t kTicks = 4000;
+
+class PolyLfoTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    Configure(block_);
+    Configure(single_);
+  }
+
+protected:
+  void Configure(frames::PolyLfo &lfo) {
+    lfo.Init();
+    lfo.set_freq_range(11);
+    lfo.set_shape(20000);
+    lfo.set_shape_spread(30000);
+    lfo.set_spread(40000);
+    lfo.set_coupling(40000);
+    lfo.set_freq_div_c(frames::POLYLFO_FREQ_MULT_5_OVER_3);
+    lfo.set_c_xor_a(3);
+    lfo.set_d_am_by_c(64);
+  }
+
+  frames::PolyLfo block_;
+  frames::PolyLfo single_;
+};
+
+TEST_F(PolyLfoTest, BlockMatchesSingleSample) {
+  for (size_t tick = 0; tick < kTicks; tick += kBlockSize) {
+    int32_t frequency = 20000 + tick * 8; // Sweep frequency between blocks
+    bool reset = (tick % 1000) == 0;
+    block_.RenderBlock(frequency, reset, false, 0xff, kBlockSize);
+    for (size_t s = 0; s < kBlockSize; ++s) {
+      single_.Render(frequency, reset && !s, false, 0xff);
+      for (uint8_t ch = 0; ch < frames::kNumChannels; ++ch) {
+        ASSERT_EQ(single_.dac_code(ch), block_.block_dac_code(ch, s)) << "tick " << tick + s << " ch " << (int)ch;
+      }
+    }
+  }
+}
+
+// Coupling feeds each channel's value into the next tick's phase of its
+// neighbour, so Rewind() has to put the values back too
+TEST_F(PolyLfoTest, RewindRestoresState) {
+  const uint16_t couplings[] = {40000, 20000};
+  const uint16_t spreads[] = {40000, 20000};
+  for (uint16_t coupling : couplings) {
+    for (uint16_t spread : spreads) {
+      Configure(block_);
+      Configure(single_);
+      block_.set_coupling(coupling);
+      single_.set_coupling(coupling);
+      block_.set_spread(spread);
+      single_.set_spread(spread);
+      for (size_t tick = 0; tick < kTicks; tick += 2) {
+        // Render a whole block, but only use two ticks of it
+        block_.RenderBlock(30000, false, false, 0x4, kBlockSize);
+        single_.Render(30000, false, false, 0x4);
+        single_.Render(30000, false, false, 0x4);
+        for (uint8_t ch = 0; ch < frames::kNumChannels; ++ch) {
+          ASSERT_EQ(single_.dac_code(ch), block_.block_dac_code(ch, 1))
+              << "coupling " << coupling << " spread " << spread << " tick " << tick << " ch " << (int)ch;
+        }
+        block_.Rewind(kBlockSize - 2);
+        for (uint8_t ch = 0; ch < frames::kNumChannels; ++ch) {
+          ASSERT_EQ(single_.dac_code(ch), block_.dac_code(ch));
+          ASSERT_EQ(single_.level(ch), block_.level(ch));
+        }
+      }
+    }
+  }
+}
+
+// Cycle counter where the host has one, for a rough cycles-per-sample figure
+static uint64_t Cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+TEST_F(PolyLfoTest, Cost) {
+  const int rounds = 2000;
+  uint32_t sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  const uint64_t c0 = Cycles();
+  for (int r = 0; r < rounds; ++r) {
+    for (size_t s = 0; s < kBlockSize; ++s) {
+      single_.Render(20000 + r, false, false, 0xff);
+      for (uint8_t ch = 0; ch < frames::kNumChannels; ++ch) sink += single_.dac_code(ch);
+    }
+  }
+  const uint64_t c1 = Cycles();
+  auto mid = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    block_.RenderBlock(20000 + r, false, false, 0xff, kBlockSize);
+    for (size_t s = 0; s < kBlockSize; ++s)
+      for (uint8_t ch = 0; ch < frames::kNumChannels; ++ch) sink += block_.block_dac_code(ch, s);
+  }
+  const uint64_t c2 = Cycles();
+  auto end = std::chrono::steady_clock::now();
+
+  const double channel_samples = double(rounds) * kBlockSize * frames::kNumChannels;
+  std::cout << "PolyLfo per channel-sample: single "
+            << std::chrono::duration<double, std::nano>(mid - start).count() / channel_samples << " ns, "
+            << (c1 - c0) / channel_samples << " cycles; blocks of " << kBlockSize << " "
+            << std::chrono::duration<double, std::nano>(end - mid).count() / channel_samples << " ns, "
+            << (c2 - c1) / channel_samples << " cycles (" << (sink & 1) << ")" << std::endl;
+}
@@ -0,0 +1,186 @@
+#include "gtest/gtest.h"
+
+// Host replay of a preset switch with the clock running, as Quadrants does
+// it: Program Change queues the preset, the main loop stages it, and the ISR
+// commits it at the next beat sync. The main loop only gets a pass every so
+// many ticks, as it does while the screen is drawn, and the switch still has
+// to land on the beat. Applets in slot 0 pass every tock of the clock to
+// output 1, so each tock has to come out exactly once across the switches.
+
+#include <vector>
+#include "oc_test_host.h"
+#include "OC_core.h"
+#include "HemisphereApplet.h"
+#include "HSicons.h"
+#include "HSClockManager.h"
+#include "HSPresetQueue.h"
+#include "applets/ClockDivider.h"
+#include "applets/ClockSkip.h"
+
+namespace {
+
+// The applets the presets can load, an instance per slot as the registry
+// in hemisphere_config.h has them
+enum { CLOCK_DIVIDER, CLOCK_SKIP, APPLET_COUNT };
+static ClockDivider clock_divider[2];
+static ClockSkip clock_skip[2];
+static HemisphereApplet *const kApplets[APPLET_COUNT][2] = {
+  { &clock_divider[0], &clock_divider[1] },
+  { &clock_skip[0], &clock_skip[1] },
+};
+
+struct Preset {
+  int applet[2];
+  uint64_t data[2];
+};
+
+// ClockDivider at /1 x1 and ClockSkip at 100% both pass every clock
+static constexpr uint64_t kDivideBy1 = 0x21212121;
+static constexpr uint64_t kSkipNone = 100 | (100 << 7);
+static const Preset kPresets[] = {
+  { { CLOCK_DIVIDER, CLOCK_SKIP }, { kDivideBy1, kSkipNone } },
+  { { CLOCK_SKIP, CLOCK_DIVIDER }, { kSkipNone, kDivideBy1 } },
+  { { CLOCK_DIVIDER, CLOCK_DIVIDER }, { kDivideBy1, kDivideBy1 } },
+};
+
+typedef Preset StagedPreset;
+
+class PresetQueueTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    OC::Host::Reset(1);
+    HS::frame = HS::IOFrame();
+    HS::clock_m = HS::ClockManager();
+    HS::Init();
+    for (int h = 0; h < 2; ++h) active[h] = nullptr;
+    current = this;
+    Commit(Stage(0));
+  }
+
+  void TearDown() override {
+    for (int h = 0; h < 2; ++h) active[h]->Unload();
+  }
+
+  StagedPreset Stage(int id) {
+    return kPresets[id];
+  }
+
+  // As QuadAppletManager::CommitPreset() loads the applets
+  void Commit(const StagedPreset &preset) {
+    for (int h = 0; h < 2; ++h) {
+      if (active[h]) active[h]->Unload();
+      active[h] = kApplets[preset.applet[h]][h];
+      active[h]->BaseStart(HEM_SIDE(h));
+      active[h]->OnDataReceive(preset.data[h]);
+    }
+    commit_ticks.push_back(uint32_t(OC::CORE::ticks));
+    committed_on_beat.push_back(HS::clock_m.Tock(1));
+  }
+
+  // As QuadAppletManager::Controller() commits a staged preset
+  void CommitQueued() {
+    queue.Commit([this](const StagedPreset &preset) { Commit(preset); });
+  }
+
+  // One ISR tick; a staged preset is committed ahead of the applets
+  void Tick() {
+    OC::Host::Tick();
+    HS::frame.Load();
+    if (HS::clock_m.IsRunning()) HS::clock_m.SyncTrig(false);
+    if (!HS::clock_m.IsRunning()) CommitQueued();
+    if (HS::clock_m.Tock(0)) ++tocks;
+    for (int h = 0; h < 2; ++h) active[h]->BaseController();
+
+    const bool high = HS::frame.outputs[0] > 0;
+    if (high && !output_high) ++pulses;
+    output_high = high;
+  }
+
+  // A pass of the main loop
+  // @return true if it staged a preset
+  bool MainLoop() {
+    if (!queue.Poll([this](StagedPreset &preset, int id) { preset = Stage(id); })) return false;
+    HS::clock_m.BeatSync(&OnBeatSync);
+    return true;
+  }
+
+  static void OnBeatSync() {
+    current->CommitQueued();
+  }
+
+  static PresetQueueTest *current;
+  static HS::PresetQueue<StagedPreset> queue;
+  HemisphereApplet *active[2];
+  std::vector<uint32_t> commit_ticks;
+  std::vector<bool> committed_on_beat;
+  int tocks = 0;
+  int pulses = 0;
+  bool output_high = false;
+};
+
+PresetQueueTest *PresetQueueTest::current;
+HS::PresetQueue<StagedPreset> PresetQueueTest::queue;
+
+// Ticks between passes of the main loop
+static constexpr uint32_t kMainLoopTicks = 97;
+
+TEST_F(PresetQueueTest, SwitchesOnTheBeatWithoutDroppingClocks) {
+  HS::clock_m.SetTempoBPM(120);
+  HS::clock_m.SetMultiply(4, 0);
+  HS::clock_m.SetMultiply(1, 1);
+  HS::clock_m.Start();
+
+  // Requests at odd times, one replacing another before it's staged
+  const uint32_t requests[][2] = {
+    { 3000, 1 }, { 20000, 2 }, { 20000, 0 }, { 41234, 1 }, { 60000, 2 },
+  };
+  size_t next = 0;
+  std::vector<uint32_t> staged_ticks; // by the main loop
+  for (uint32_t t = 1; t <= 100000; ++t) {
+    while (next < ARRAY_SIZE(requests) && requests[next][0] == t) queue.Request(requests[next++][1]);
+    Tick();
+    if (t % kMainLoopTicks == 0) {
+      const size_t commits = commit_ticks.size();
+      if (MainLoop()) staged_ticks.push_back(t);
+      EXPECT_EQ(commits, commit_ticks.size()) << "the main loop doesn't commit";
+    }
+  }
+
+  EXPECT_FALSE(queue.pending());
+  ASSERT_EQ(5U, commit_ticks.size()); // the first load, and 4 switches
+  ASSERT_EQ(4U, staged_ticks.size());
+  for (size_t i = 1; i < commit_ticks.size(); ++i) {
+    // on the first beat after the late main loop staged it
+    EXPECT_GT(commit_ticks[i], staged_ticks[i - 1]);
+    EXPECT_LE(commit_ticks[i] - staged_ticks[i - 1], 8334U); // a beat at 120 BPM
+    EXPECT_TRUE(committed_on_beat[i]) << commit_ticks[i];
+  }
+  EXPECT_GT(tocks, 40);
+  EXPECT_EQ(tocks, pulses);
+}
+
+TEST_F(PresetQueueTest, CommitsOnTheNextTickWithTheClockStopped) {
+  queue.Request(1);
+  Tick();
+  MainLoop();
+  EXPECT_EQ(1U, commit_ticks.size());
+  Tick();
+  ASSERT_EQ(2U, commit_ticks.size());
+  EXPECT_EQ(OC::CORE::ticks, commit_ticks[1]);
+  EXPECT_EQ(&clock_skip[0], active[0]);
+}
+
+TEST_F(PresetQueueTest, StoppingTheClockCommitsAWaitingPreset) {
+  HS::clock_m.Start();
+  for (int t = 0; t < 100; ++t) Tick();
+  queue.Request(1);
+  MainLoop();
+  Tick();
+  EXPECT_TRUE(queue.pending());
+  HS::clock_m.Stop();
+  Tick();
+  EXPECT_FALSE(queue.pending());
+  EXPECT_EQ(2U, commit_ticks.size());
+}
+
+} // namespace
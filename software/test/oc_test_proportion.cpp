@@ -0,0 +1,91 @@
+#include <chrono>
+#include <stdlib.h>
+#include "gtest/gtest.h"
+#include "HSProportion.h"
+
+// Numerators well past the usual CV range; int2simfloat overflows beyond 2^17
+static const int kMaxNumerator = (1 << 17) - 1;
+static const int kMaxValues[] = {1, 62, 255, 9216, 16383, 131071};
+
+template <int D>
+static void ExpectSameAsDivision() {
+  for (int max_value : kMaxValues) {
+    for (int n = -kMaxNumerator; n <= kMaxNumerator; ++n) {
+      // skip what overflows int32 either way
+      if ((int64_t)(std::abs(n) << 14) / D * max_value > INT32_MAX) continue;
+      ASSERT_EQ(Proportion(n, D, max_value), Proportion<D>(n, max_value))
+          << n << " / " << D << " * " << max_value;
+    }
+  }
+}
+
+// The denominators used across the tree, and some awkward ones
+TEST(Proportion, ConstantDenominators) {
+  ExpectSameAsDivision<1>();
+  ExpectSameAsDivision<3>();
+  ExpectSameAsDivision<15>();
+  ExpectSameAsDivision<63>();
+  ExpectSameAsDivision<100>();
+  ExpectSameAsDivision<127>();
+  ExpectSameAsDivision<200>();
+  ExpectSameAsDivision<255>();
+  ExpectSameAsDivision<4608>();
+  ExpectSameAsDivision<8192>();
+  ExpectSameAsDivision<9216>();
+  ExpectSameAsDivision<18432>();
+  ExpectSameAsDivision<0x7fff>();
+}
+
+TEST(Proportion, ReciprocalIsExact) {
+  // every denominator up to 2^16 against the edges of the range, and a
+  // spread of large denominators against pseudo-random numerators
+  const uint32_t edges[] = {0, 1, 2, 0x3fff, 0x4000, 0x7ffffffe, 0x7fffffff};
+  for (uint32_t d = 1; d <= 65536; ++d) {
+    const HS::Reciprocal r = HS::Reciprocal::Of(d);
+    for (uint32_t x : edges) ASSERT_EQ(x / d, r.divide(x)) << x << " / " << d;
+    for (uint32_t k = 1; k < 4; ++k) {
+      const uint64_t x = (uint64_t)d * (0x7fffffffu / d - k) ;
+      ASSERT_EQ(x / d, r.divide(x)) << x << " / " << d;
+      ASSERT_EQ((x - 1) / d, r.divide(x - 1)) << x - 1 << " / " << d;
+    }
+  }
+  uint32_t seed = 1;
+  for (int i = 0; i < 1000000; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    const uint32_t d = (seed >> 8) | 1;
+    seed = seed * 1664525u + 1013904223u;
+    const uint32_t x = seed >> 1;
+    ASSERT_EQ(x / d, HS::Reciprocal::Of(d).divide(x)) << x << " / " << d;
+  }
+}
+
+TEST(Proportion, Cached) {
+  CachedProportion proportion;
+  for (int steps = 1; steps < 40; ++steps) {
+    for (int step = -steps; step <= steps; ++step) {
+      ASSERT_EQ(Proportion(step, steps, 9216), proportion(step, steps, 9216));
+    }
+  }
+  // non-positive denominators fall back to the division
+  EXPECT_EQ(Proportion(5, -10, 100), proportion(5, -10, 100));
+}
+
+TEST(Proportion, Benchmark) {
+  const int rounds = 200;
+  volatile int denominator = 9216; // as the compiler would see a runtime value
+  int sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    for (int n = -9216; n <= 9216; n += 3) sink += Proportion(n, denominator, 255);
+  auto mid = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    for (int n = -9216; n <= 9216; n += 3) sink += Proportion<9216>(n, 255);
+  auto end = std::chrono::steady_clock::now();
+
+  const double calls = rounds * (2 * 9216 / 3 + 1);
+  const double ns_divide = std::chrono::duration<double, std::nano>(mid - start).count() / calls;
+  const double ns_reciprocal = std::chrono::duration<double, std::nano>(end - mid).count() / calls;
+  std::cout << "Proportion: " << ns_divide << " ns/call divide, " << ns_reciprocal
+            << " ns/call reciprocal (" << (sink & 1) << ")" << std::endl;
+}
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include "gtest/gtest.h"
+#include "HSRandom.h"
+
+using HS::Random;
+
+TEST(Random, SeedsAreReproducibleAndIndependent) {
+  Random a(3), b(3), c(4);
+  int same = 0;
+  for (int i = 0; i < 1000; ++i) {
+    const uint32_t x = a.Next();
+    EXPECT_EQ(x, b.Next());
+    if (x == c.Next()) ++same;
+  }
+  EXPECT_EQ(0, same);
+
+  // the zero seed doesn't get stuck
+  Random z(0);
+  uint32_t ored = 0;
+  for (int i = 0; i < 16; ++i) ored |= z.Next();
+  EXPECT_NE(0u, ored);
+
+  // neighbouring streams from one seed differ too
+  HS::RandomStreams streams;
+  streams.Reseed(1);
+  EXPECT_NE(streams[0].Next(), streams[1].Next());
+}
+
+TEST(Random, RangeContract) {
+  Random r(7);
+  EXPECT_EQ(0u, r.Below(0));
+  EXPECT_EQ(5, r.Range(5, 5));
+  EXPECT_EQ(5, r.Range(5, 2));
+  int lo = 1000, hi = -1000;
+  for (int i = 0; i < 100000; ++i) {
+    const int v = r.Range(-3, 4);
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+  }
+  EXPECT_EQ(-3, lo);
+  EXPECT_EQ(3, hi);
+}
+
+TEST(Random, Quality) {
+  Random r(0x41);
+  const int draws = 1 << 20;
+
+  // uniformity of Below(): chi-square over 256 buckets, 255 degrees of freedom
+  static int buckets[256];
+  for (int i = 0; i < draws; ++i) ++buckets[r.Below(256)];
+  double chi2 = 0;
+  const double expected = draws / 256.0;
+  for (int b = 0; b < 256; ++b) chi2 += (buckets[b] - expected) * (buckets[b] - expected) / expected;
+
+  // every output bit is balanced
+  int ones[32] = {0};
+  for (int i = 0; i < draws; ++i) {
+    const uint32_t x = r.Next();
+    for (int b = 0; b < 32; ++b) ones[b] += (x >> b) & 1;
+  }
+  double worst_bit = 0;
+  for (int b = 0; b < 32; ++b) worst_bit = std::max(worst_bit, fabs(ones[b] - draws / 2.0) / sqrt(draws / 4.0));
+
+  // successive values are uncorrelated
+  double sum_xy = 0, sum_x = 0, sum_x2 = 0;
+  double prev = r.Next() / 4294967296.0;
+  for (int i = 0; i < draws; ++i) {
+    const double x = r.Next() / 4294967296.0;
+    sum_xy += prev * x;
+    sum_x += x;
+    sum_x2 += x * x;
+    prev = x;
+  }
+  const double mean = sum_x / draws;
+  const double serial = (sum_xy / draws - mean * mean) / (sum_x2 / draws - mean * mean);
+
+  std::cout << "Random: chi2(255) " << chi2 << ", worst bit " << worst_bit
+            << " sigma, serial correlation " << serial << std::endl;
+  EXPECT_GT(chi2, 170.0);
+  EXPECT_LT(chi2, 350.0);
+  EXPECT_LT(worst_bit, 5.0);
+  EXPECT_LT(fabs(serial), 0.01);
+}
+
+TEST(Random, DrawCost) {
+  const int draws = 10000000;
+  Random r(1);
+  uint32_t sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < draws; ++i) sink += r.Range(0, 100);
+  auto mid = std::chrono::steady_clock::now();
+  for (int i = 0; i < draws; ++i) sink += random() % 100;
+  auto end = std::chrono::steady_clock::now();
+
+  const double ns_stream = std::chrono::duration<double, std::nano>(mid - start).count() / draws;
+  const double ns_libc = std::chrono::duration<double, std::nano>(end - mid).count() / draws;
+  std::cout << "Random: " << ns_stream << " ns/draw, libc random() " << ns_libc
+            << " ns/draw (" << (sink & 1) << ")" << std::endl;
+  EXPECT_LT(ns_stream, 1000.0);
+}
@@ -0,0 +1,154 @@
+#include <string.h>
+#include "gtest/gtest.h"
+#include "HSRouting.h"
+
+using namespace HS;
+
+static const int kThreshold = 15 << 7;
+
+// A frame's worth of arrays, as in HS::IOFrame
+template <int DIG, int ADC, int DAC>
+struct FakeFrame {
+  int inputs[ADC];
+  int outputs[DAC];
+  int bus[DAC];
+  bool gate_high[DIG + ADC];
+  bool clocked[DIG + ADC];
+  bool clockout_q[DAC];
+  bool changed_cv[ADC];
+  bool bus_changed[DAC];
+
+  RouteSources sources() {
+    return {DIG, ADC, DAC, inputs, outputs, bus, gate_high, clocked, clockout_q, changed_cv, bus_changed};
+  }
+
+  // every value distinct, so a route to the wrong place shows
+  void Fill(int seed) {
+    for (int i = 0; i < ADC; ++i) {
+      inputs[i] = seed * 1000 + i * 37 - 500;
+      changed_cv[i] = (seed + i) & 1;
+    }
+    for (int i = 0; i < DAC; ++i) {
+      outputs[i] = seed * 1000 + (i + 1) * 613 - 2000;
+      bus[i] = -seed * 1000 - i * 91;
+      clockout_q[i] = (seed + i) % 3 == 0;
+      bus_changed[i] = (seed + i) % 3 == 1;
+    }
+    for (int i = 0; i < DIG + ADC; ++i) {
+      gate_high[i] = (seed + i) % 3 != 0;
+      clocked[i] = (seed * 7 + i) % 5 == 0;
+    }
+  }
+
+  // The decoding the applets used to do on every call, with busses added
+  int OldIn(int c) {
+    if (!c) return 0;
+    if (c <= ADC) return inputs[c - 1];
+    if (c <= ADC + DAC) return outputs[c - 1 - ADC];
+    return bus[c - 1 - ADC - DAC];
+  }
+  bool OldChanged(int c) {
+    if (c && c <= ADC) return changed_cv[c - 1];
+    if (c > ADC + DAC) return bus_changed[c - 1 - ADC - DAC];
+    return false;
+  }
+  bool OldGate(int t) {
+    const int offset = DIG + ADC;
+    if (!t) return false;
+    return (t <= offset) ? gate_high[t - 1] : (outputs[t - 1 - offset] > kThreshold);
+  }
+  bool OldClock(int t) {
+    const int offset = DIG + ADC;
+    bool c = false;
+    if (t > 0) {
+      if (t <= offset) c = clocked[t - 1];
+      else {
+        c = clockout_q[t - 1 - offset];
+        clockout_q[t - 1 - offset] = false;
+      }
+    }
+    return c;
+  }
+};
+
+template <int DIG, int ADC, int DAC>
+static void ExpectSameAsDecode() {
+  const int cvmap_max = ADC + DAC * 2;
+  const int trigmap_max = DIG + ADC + DAC;
+  FakeFrame<DIG, ADC, DAC> frame, expected;
+
+  for (int c = 0; c <= cvmap_max; ++c) {
+    for (int t = 0; t <= trigmap_max; ++t) {
+      const InputRoute route = CompileRoute(c, t, frame.sources());
+      for (int seed = 0; seed < 6; ++seed) {
+        frame.Fill(seed);
+        expected.Fill(seed);
+        ASSERT_EQ(expected.OldIn(c), route.In()) << "cv " << c;
+        ASSERT_EQ(expected.OldChanged(c), route.Changed()) << "cv " << c;
+        ASSERT_EQ(expected.OldGate(t), route.Gate(kThreshold)) << "trig " << t;
+        ASSERT_EQ(c >= 1 && c <= ADC ? c - 1 : -1, route.adc) << "cv " << c;
+
+        // peeking leaves the queue, clocking consumes it like the old code
+        const bool peek = route.PeekClock();
+        ASSERT_EQ(expected.OldClock(t), peek) << "trig " << t;
+        ASSERT_EQ(peek, route.Clock()) << "trig " << t;
+        ASSERT_EQ(0, memcmp(expected.clockout_q, frame.clockout_q, sizeof(frame.clockout_q))) << "trig " << t;
+        ASSERT_EQ(0, memcmp(expected.clocked, frame.clocked, sizeof(frame.clocked))) << "trig " << t;
+      }
+    }
+  }
+
+  // out of range is treated as unmapped
+  const InputRoute none = CompileRoute(cvmap_max + 1, trigmap_max + 1, frame.sources());
+  frame.Fill(1);
+  EXPECT_EQ(0, none.In());
+  EXPECT_FALSE(none.Gate(kThreshold));
+  EXPECT_FALSE(none.Clock());
+  EXPECT_EQ(-1, none.adc);
+}
+
+TEST(Routing, EveryMappingT3) {
+  ExpectSameAsDecode<4, 4, 4>();
+}
+
+TEST(Routing, EveryMappingT41) {
+  ExpectSameAsDecode<4, 8, 8>();
+}
+
+TEST(Routing, DefaultIsUnmapped) {
+  InputRoute route;
+  EXPECT_EQ(0, route.In());
+  EXPECT_FALSE(route.Changed());
+  EXPECT_FALSE(route.Gate(kThreshold));
+  EXPECT_FALSE(route.PeekClock());
+  EXPECT_FALSE(route.Clock());
+  EXPECT_EQ(-1, route.adc);
+}
+
+// Two slots chained through an output and through its bus, run in either
+// order: the bus lags one tick whichever runs first, the loopback doesn't.
+TEST(Routing, BusLatency) {
+  FakeFrame<4, 4, 4> frame;
+  frame.Fill(0);
+  const int cvmap_out_a = 4 + 1, cvmap_bus_a = 4 + 4 + 1;
+  const InputRoute direct = CompileRoute(cvmap_out_a, 0, frame.sources());
+  const InputRoute bussed = CompileRoute(cvmap_bus_a, 0, frame.sources());
+
+  for (int order = 0; order < 2; ++order) {
+    frame.outputs[0] = 0;
+    int seen_direct = -1, seen_bus = -1;
+    for (int tick = 1; tick <= 4; ++tick) {
+      // as IOFrame::Load() does
+      frame.bus_changed[0] = frame.bus[0] != frame.outputs[0];
+      frame.bus[0] = frame.outputs[0];
+
+      if (order == 1) { seen_direct = direct.In(); seen_bus = bussed.In(); }
+      frame.outputs[0] = tick; // the upstream applet
+      if (order == 0) { seen_direct = direct.In(); seen_bus = bussed.In(); }
+
+      EXPECT_EQ(tick - 1, seen_bus);
+      EXPECT_TRUE(bussed.Changed() || tick == 1);
+      EXPECT_EQ(order == 0 ? tick : tick - 1, seen_direct);
+    }
+  }
+}
@@ -0,0 +1,152 @@
+#include <chrono>
+#include <stdlib.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "HSSysEx.h"
+
+class SysExTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    srand(0x37);
+  }
+
+protected:
+  static std::vector<uint8_t> RandomBlob(uint32_t length) {
+    std::vector<uint8_t> blob(length);
+    for (auto &b : blob) b = rand() & 0xff;
+    return blob;
+  }
+
+  // All the messages of a block, back to back
+  static std::vector<std::vector<uint8_t>> Messages(const std::vector<uint8_t> &blob, char app) {
+    std::vector<std::vector<uint8_t>> messages;
+    SysExBlockWriter writer(blob.data(), blob.size(), app);
+    uint8_t msg[SYSEX_BLOCK_MSG_MAX];
+    uint32_t size;
+    while ((size = writer.Next(msg))) messages.emplace_back(msg, msg + size);
+    EXPECT_EQ(writer.MessageCount(), messages.size());
+    return messages;
+  }
+};
+
+TEST_F(SysExTest, PackMatchesPacketFormat) {
+  const uint8_t raw[9] = {0x80, 0x01, 0xff, 0x7f, 0x00, 0x55, 0xaa, 0xc3, 0x3c};
+  const uint8_t expect[11] = {0x45, 0x00, 0x01, 0x7f, 0x7f, 0x00, 0x55, 0x2a, 0x01, 0x43, 0x3c};
+  uint8_t packed[11];
+  ASSERT_EQ(11u, SysExPackedSize(9));
+  ASSERT_EQ(11u, SysExPack(raw, 9, packed));
+  for (int i = 0; i < 11; i++) EXPECT_EQ(expect[i], packed[i]) << i;
+}
+
+TEST_F(SysExTest, PackRoundTrip) {
+  for (uint32_t n = 0; n < 300; n++) {
+    std::vector<uint8_t> raw = RandomBlob(n);
+    std::vector<uint8_t> packed(SysExPackedSize(n) + 1, 0xee);
+    std::vector<uint8_t> unpacked(n + 1, 0xee);
+
+    const uint32_t psize = SysExPack(raw.data(), n, packed.data());
+    ASSERT_EQ(SysExPackedSize(n), psize);
+    EXPECT_EQ(0xee, packed[psize]); // nothing written past the end
+    for (uint32_t i = 0; i < psize; i++) ASSERT_LT(packed[i], 0x80);
+
+    ASSERT_EQ(n, SysExUnpack(packed.data(), psize, unpacked.data(), n));
+    EXPECT_EQ(0xee, unpacked[n]);
+    for (uint32_t i = 0; i < n; i++) ASSERT_EQ(raw[i], unpacked[i]);
+  }
+}
+
+TEST_F(SysExTest, UnpackRespectsCapacity) {
+  std::vector<uint8_t> raw = RandomBlob(50);
+  uint8_t packed[64], unpacked[32];
+  memset(unpacked, 0xee, sizeof(unpacked));
+  const uint32_t psize = SysExPack(raw.data(), 50, packed);
+  EXPECT_EQ(20u, SysExUnpack(packed, psize, unpacked, 20));
+  EXPECT_EQ(0xee, unpacked[20]);
+}
+
+TEST_F(SysExTest, BlockRoundTrip) {
+  const uint32_t lengths[] = {0, 1, 41, 42, 43, 48, 200, 1024, 4099};
+  for (uint32_t length : lengths) {
+    std::vector<uint8_t> blob = RandomBlob(length);
+    std::vector<uint8_t> dest(length + 8, 0xee);
+    SysExBlockReader reader;
+    reader.Begin(dest.data(), length, 'T');
+
+    auto messages = Messages(blob, 'T');
+    for (size_t m = 0; m < messages.size(); m++) {
+      const auto &msg = messages[m];
+      ASSERT_LE(msg.size(), 60u); // fits the Teensy 3.2 receive buffer
+      for (size_t i = 1; i + 1 < msg.size(); i++) ASSERT_LT(msg[i], 0x80);
+      SysExBlockStatus status = reader.Feed(msg.data(), msg.size());
+      ASSERT_EQ(m + 1 == messages.size() ? SYSEX_BLOCK_COMPLETE : SYSEX_BLOCK_PENDING, status) << length << " " << m;
+    }
+    EXPECT_EQ(length, reader.Length());
+    for (uint32_t i = 0; i < length; i++) ASSERT_EQ(blob[i], dest[i]);
+    EXPECT_EQ(0xee, dest[length]);
+  }
+}
+
+TEST_F(SysExTest, BlockErrors) {
+  std::vector<uint8_t> blob = RandomBlob(500);
+  std::vector<uint8_t> dest(500);
+  SysExBlockReader reader;
+  auto messages = Messages(blob, 'N');
+
+  // someone else's block, and a legacy single message
+  reader.Begin(dest.data(), dest.size(), 'T');
+  EXPECT_EQ(SYSEX_BLOCK_IGNORED, reader.Feed(messages[0].data(), messages[0].size()));
+  const uint8_t legacy[] = {0xf0, 0x7d, 0x62, 'N', 0x00, 0x01, 0xf7};
+  reader.Begin(dest.data(), dest.size(), 'N');
+  EXPECT_EQ(SYSEX_BLOCK_IGNORED, reader.Feed(legacy, sizeof(legacy)));
+
+  // too long for the buffer
+  reader.Begin(dest.data(), 499, 'N');
+  EXPECT_EQ(SYSEX_BLOCK_ERROR, reader.Feed(messages[0].data(), messages[0].size()));
+  EXPECT_EQ(SYSEX_BLOCK_ERROR, reader.Feed(messages[1].data(), messages[1].size()));
+
+  // dropped message
+  reader.Begin(dest.data(), dest.size(), 'N');
+  EXPECT_EQ(SYSEX_BLOCK_PENDING, reader.Feed(messages[0].data(), messages[0].size()));
+  EXPECT_EQ(SYSEX_BLOCK_ERROR, reader.Feed(messages[2].data(), messages[2].size()));
+
+  // truncated message
+  reader.Begin(dest.data(), dest.size(), 'N');
+  reader.Feed(messages[0].data(), messages[0].size());
+  EXPECT_EQ(SYSEX_BLOCK_ERROR, reader.Feed(messages[1].data(), messages[1].size() - 5));
+
+  // corrupted byte is caught by the CRC, and a resend recovers
+  reader.Begin(dest.data(), dest.size(), 'N');
+  SysExBlockStatus status = SYSEX_BLOCK_PENDING;
+  for (size_t m = 0; m < messages.size(); m++) {
+    std::vector<uint8_t> msg = messages[m];
+    if (m == 5) msg[20] ^= 0x10;
+    status = reader.Feed(msg.data(), msg.size());
+  }
+  EXPECT_EQ(SYSEX_BLOCK_ERROR, status);
+  for (auto &msg : messages) status = reader.Feed(msg.data(), msg.size());
+  EXPECT_EQ(SYSEX_BLOCK_COMPLETE, status);
+}
+
+TEST_F(SysExTest, Throughput) {
+  const uint32_t length = 64 * 1024;
+  std::vector<uint8_t> blob = RandomBlob(length);
+  std::vector<uint8_t> dest(length);
+  const int passes = 20;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int p = 0; p < passes; p++) {
+    SysExBlockWriter writer(blob.data(), length, 'H');
+    SysExBlockReader reader;
+    reader.Begin(dest.data(), length, 'H');
+    uint8_t msg[SYSEX_BLOCK_MSG_MAX];
+    uint32_t size;
+    SysExBlockStatus status = SYSEX_BLOCK_PENDING;
+    while ((size = writer.Next(msg))) status = reader.Feed(msg, size);
+    ASSERT_EQ(SYSEX_BLOCK_COMPLETE, status);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+  const double mb_per_s = static_cast<double>(length) * passes / elapsed.count();
+  std::cout << "SysEx block round trip: " << mb_per_s << " MB/s" << std::endl;
+  EXPECT_EQ(0, memcmp(blob.data(), dest.data(), length));
+}
@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+#include "oc_test_arduino.h"
+#include "vector_osc/HSVectorOscillator.h"
+
+static const int kScale = (12 << 7) * 3;
+static const int kTicksPerSecond = 16667;
+
+class VectorOscillatorTest : public ::testing::Test {
+protected:
+  VectorOscillator MakeOscillator(bool phase_mode, uint32_t frequency) {
+    VectorOscillator osc;
+    osc.SetSegment(HS::VOSegment {0xff, 1}); // Triangle
+    osc.SetSegment(HS::VOSegment {0x00, 1});
+    osc.PhaseMode(phase_mode);
+    osc.SetScale(kScale);
+    osc.SetFrequency(frequency);
+    osc.Reset();
+    return osc;
+  }
+
+  // Counts cycles over the specified number of ticks
+  int CountCycles(VectorOscillator &osc, int ticks) {
+    int cycles = 0;
+    for (int i = 0; i < ticks; i++) {
+      osc.Next();
+      if (osc.GetEOC()) cycles++;
+    }
+    return cycles;
+  }
+};
+
+TEST_F(VectorOscillatorTest, ShapeMatchesRiseMethod) {
+  VectorOscillator legacy = MakeOscillator(false, 1000); // 10 Hz
+  VectorOscillator phase = MakeOscillator(true, 1000);
+
+  int max_error = 0;
+  for (int i = 0; i < 1666; i++) { // One cycle
+    int error = abs(legacy.Next() - phase.Next());
+    if (error > max_error) max_error = error;
+  }
+  // Within 1% of full scale
+  EXPECT_LT(max_error, kScale / 50);
+}
+
+TEST_F(VectorOscillatorTest, ReachesPeaks) {
+  VectorOscillator osc = MakeOscillator(true, 1000);
+  int32_t lo = 0, hi = 0;
+  for (int i = 0; i < 1667; i++) {
+    int32_t v = osc.Next();
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+  }
+  EXPECT_NEAR(kScale, hi, kScale / 100);
+  EXPECT_NEAR(-kScale - kScale / 127, lo, kScale / 100);
+}
+
+TEST_F(VectorOscillatorTest, FrequencyAccuracy) {
+  static const uint32_t frequencies[] = {8, 100, 1234, 44000, 100000};
+  for (uint32_t f : frequencies) {
+    VectorOscillator legacy = MakeOscillator(false, f);
+    VectorOscillator phase = MakeOscillator(true, f);
+    int seconds = f < 100 ? 200 : 20;
+    int expected = (f * seconds) / 100;
+    int legacy_cycles = CountCycles(legacy, kTicksPerSecond * seconds);
+    int phase_cycles = CountCycles(phase, kTicksPerSecond * seconds);
+    EXPECT_NEAR(expected, phase_cycles, 1 + expected / 1000) << "frequency " << f;
+    EXPECT_LE(abs(expected - phase_cycles), abs(expected - legacy_cycles) + 1) << "frequency " << f;
+  }
+}
+
+TEST_F(VectorOscillatorTest, FrequencyChangeKeepsPhase) {
+  VectorOscillator osc = MakeOscillator(true, 1000);
+  int32_t before = 0;
+  for (int i = 0; i < 400; i++) before = osc.Next();
+  osc.SetFrequency(1001);
+  int32_t after = osc.Next();
+  EXPECT_LT(abs(after - before), kScale / 50);
+}
+
+TEST_F(VectorOscillatorTest, PhaseLookup) {
+  VectorOscillator legacy = MakeOscillator(false, 1000);
+  VectorOscillator phase = MakeOscillator(true, 1000);
+  for (int degrees = 0; degrees < 3600; degrees += 10) {
+    EXPECT_NEAR(legacy.Phase(degrees), phase.Phase(degrees), kScale / 50) << "degrees " << degrees;
+  }
+}
+
+TEST_F(VectorOscillatorTest, OneShotHoldsLastLevel) {
+  VectorOscillator osc = MakeOscillator(true, 10000);
+  osc.Cycle(0);
+  osc.Start();
+  int32_t last = 0;
+  for (int i = 0; i < 500; i++) last = osc.Next();
+  EXPECT_TRUE(osc.GetEOC());
+  EXPECT_EQ(last, osc.Next());
+}
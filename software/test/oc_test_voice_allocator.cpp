@@ -0,0 +1,228 @@
+#include <chrono>
+#include <stdlib.h>
+#include "gtest/gtest.h"
+#include "HSVoiceAllocator.h"
+
+using HS::VoiceAllocator;
+
+class VoiceAllocatorTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    srand(0x35);
+  }
+
+protected:
+  VoiceAllocator alloc_;
+
+  void Setup(HS::VoiceAllocMode mode, int voices) {
+    alloc_.Init(mode);
+    alloc_.set_voice_count(voices);
+  }
+
+  int CountGates() const {
+    int gates = 0;
+    for (int v = 0; v < alloc_.get_voice_count(); ++v)
+      if (alloc_.voice(v).gate) ++gates;
+    return gates;
+  }
+
+  bool Sounding(int note) const {
+    for (int v = 0; v < alloc_.get_voice_count(); ++v)
+      if (alloc_.voice(v).gate && alloc_.voice(v).note == note) return true;
+    return false;
+  }
+};
+
+TEST_F(VoiceAllocatorTest, MonoLastNoteReturnsToHeldNote) {
+  Setup(HS::VOICE_LAST, 1);
+  alloc_.NoteOn(60, 100);
+  EXPECT_TRUE(alloc_.voice(0).gate);
+  EXPECT_EQ(60, alloc_.voice(0).note);
+  EXPECT_EQ(1, alloc_.triggered_voices());
+
+  alloc_.NoteOn(64, 90);
+  EXPECT_EQ(64, alloc_.voice(0).note);
+  EXPECT_EQ(90, alloc_.voice(0).velocity);
+  EXPECT_EQ(1, alloc_.triggered_voices());
+
+  // releasing the top note falls back to the held one, legato
+  alloc_.NoteOff(64);
+  EXPECT_TRUE(alloc_.voice(0).gate);
+  EXPECT_EQ(60, alloc_.voice(0).note);
+  EXPECT_EQ(1, alloc_.changed_voices());
+  EXPECT_EQ(0, alloc_.triggered_voices());
+
+  alloc_.NoteOff(60);
+  EXPECT_FALSE(alloc_.voice(0).gate);
+  EXPECT_EQ(60, alloc_.voice(0).note); // pitch holds through the release
+  EXPECT_EQ(1, alloc_.changed_voices());
+}
+
+TEST_F(VoiceAllocatorTest, MonoLowAndHighPriority) {
+  Setup(HS::VOICE_LOW, 1);
+  alloc_.NoteOn(60, 100);
+  alloc_.NoteOn(67, 100);
+  EXPECT_EQ(60, alloc_.voice(0).note);
+  EXPECT_EQ(0, alloc_.changed_voices());
+  alloc_.NoteOn(55, 100);
+  EXPECT_EQ(55, alloc_.voice(0).note);
+  alloc_.NoteOff(55);
+  EXPECT_EQ(60, alloc_.voice(0).note);
+
+  Setup(HS::VOICE_HIGH, 1);
+  alloc_.NoteOn(60, 100);
+  alloc_.NoteOn(55, 100);
+  EXPECT_EQ(60, alloc_.voice(0).note);
+  alloc_.NoteOn(72, 100);
+  EXPECT_EQ(72, alloc_.voice(0).note);
+  alloc_.NoteOff(72);
+  EXPECT_EQ(60, alloc_.voice(0).note);
+}
+
+TEST_F(VoiceAllocatorTest, HeldNotesKeepTheirVoice) {
+  Setup(HS::VOICE_LAST, 4);
+  alloc_.NoteOn(60, 100);
+  alloc_.NoteOn(64, 100);
+  alloc_.NoteOn(67, 100);
+  EXPECT_EQ(60, alloc_.voice(0).note);
+  EXPECT_EQ(64, alloc_.voice(1).note);
+  EXPECT_EQ(67, alloc_.voice(2).note);
+  EXPECT_EQ(3, CountGates());
+
+  alloc_.NoteOff(64);
+  EXPECT_FALSE(alloc_.voice(1).gate);
+  EXPECT_EQ(1 << 1, alloc_.changed_voices());
+
+  // the next note takes a free voice, and nobody else moves
+  alloc_.NoteOn(71, 100);
+  EXPECT_EQ(60, alloc_.voice(0).note);
+  EXPECT_EQ(67, alloc_.voice(2).note);
+  EXPECT_TRUE(Sounding(71));
+  EXPECT_EQ(3, CountGates());
+  EXPECT_EQ(alloc_.changed_voices(), alloc_.triggered_voices());
+}
+
+TEST_F(VoiceAllocatorTest, StealingAndReclaim) {
+  Setup(HS::VOICE_LAST, 2);
+  alloc_.NoteOn(60, 100);
+  alloc_.NoteOn(62, 100);
+  alloc_.NoteOn(64, 100); // steals the voice playing 60
+  EXPECT_FALSE(Sounding(60));
+  EXPECT_TRUE(Sounding(62));
+  EXPECT_TRUE(Sounding(64));
+
+  alloc_.NoteOff(64); // 60 is still held and comes back
+  EXPECT_TRUE(Sounding(60));
+  EXPECT_TRUE(Sounding(62));
+  EXPECT_EQ(2, CountGates());
+}
+
+TEST_F(VoiceAllocatorTest, RoundRobinRotates) {
+  Setup(HS::VOICE_ROUND_ROBIN, 3);
+  for (int i = 0; i < 6; ++i) {
+    alloc_.NoteOn(60, 100);
+    EXPECT_EQ(1 << (i % 3), alloc_.triggered_voices());
+    alloc_.NoteOff(60);
+    EXPECT_EQ(0, CountGates());
+  }
+}
+
+TEST_F(VoiceAllocatorTest, UnisonFollowsLastNote) {
+  Setup(HS::VOICE_UNISON, 4);
+  alloc_.NoteOn(48, 100);
+  alloc_.NoteOn(55, 80);
+  for (int v = 0; v < 4; ++v) {
+    EXPECT_TRUE(alloc_.voice(v).gate);
+    EXPECT_EQ(55, alloc_.voice(v).note);
+  }
+  EXPECT_EQ(0x0f, alloc_.triggered_voices());
+  alloc_.NoteOff(55);
+  EXPECT_EQ(48, alloc_.voice(3).note);
+  alloc_.NoteOff(48);
+  EXPECT_EQ(0, CountGates());
+}
+
+TEST_F(VoiceAllocatorTest, StackOverflowAndStrayNoteOff) {
+  const int stack_size = VoiceAllocator::STACK_SIZE;
+  Setup(HS::VOICE_LAST, 1);
+  for (int n = 0; n < stack_size + 4; ++n) alloc_.NoteOn(40 + n, 100);
+  EXPECT_EQ(stack_size, alloc_.held_notes());
+
+  alloc_.NoteOff(40); // already forgotten
+  EXPECT_EQ(0, alloc_.changed_voices());
+  alloc_.NoteOn(41, 0); // velocity 0 is a Note Off, also forgotten
+  EXPECT_EQ(stack_size, alloc_.held_notes());
+
+  alloc_.AllNotesOff();
+  EXPECT_EQ(0, alloc_.held_notes());
+  EXPECT_EQ(0, CountGates());
+}
+
+// Random note streams in every mode: the sounding notes must always be exactly
+// the ones the priority rule picks from what is held, each on a single voice
+TEST_F(VoiceAllocatorTest, RandomStreams) {
+  for (int mode = 0; mode < HS::VOICE_MODE_COUNT; ++mode) {
+    for (int voices = 1; voices <= VoiceAllocator::MAX_VOICES; ++voices) {
+      Setup(static_cast<HS::VoiceAllocMode>(mode), voices);
+      int held[128] = {0};
+      int order = 0;
+
+      for (int i = 0; i < 2000; ++i) {
+        const int note = 48 + rand() % 24;
+        if (rand() & 1) {
+          if (!held[note] && alloc_.held_notes() == VoiceAllocator::STACK_SIZE) continue;
+          alloc_.NoteOn(note, 1 + rand() % 127);
+          held[note] = ++order;
+        } else {
+          alloc_.NoteOff(note);
+          held[note] = 0;
+        }
+
+        // work out which notes should sound
+        int expect[128] = {0};
+        int want = (mode == HS::VOICE_UNISON) ? 1 : voices;
+        for (int k = 0; k < want; ++k) {
+          int best = -1;
+          for (int n = 0; n < 128; ++n) {
+            if (!held[n] || expect[n]) continue;
+            if (best < 0
+                || ((mode == HS::VOICE_LAST || mode == HS::VOICE_ROUND_ROBIN || mode == HS::VOICE_UNISON) && held[n] > held[best])
+                || (mode == HS::VOICE_LOW && n < best)
+                || (mode == HS::VOICE_HIGH && n > best))
+              best = n;
+          }
+          if (best >= 0) expect[best] = 1;
+        }
+
+        int sounding[128] = {0};
+        for (int v = 0; v < voices; ++v) {
+          if (alloc_.voice(v).gate) ++sounding[alloc_.voice(v).note];
+        }
+        for (int n = 0; n < 128; ++n) {
+          const int copies = (mode == HS::VOICE_UNISON && expect[n]) ? voices : expect[n];
+          ASSERT_EQ(copies, sounding[n]) << "mode " << mode << " voices " << voices << " event " << i << " note " << n;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(VoiceAllocatorTest, EventCost) {
+  Setup(HS::VOICE_HIGH, VoiceAllocator::MAX_VOICES);
+  const int events = 200000;
+  uint32_t sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < events; ++i) {
+    const int note = 36 + (i * 7) % 48;
+    if (i & 1) alloc_.NoteOff(note - 7);
+    else alloc_.NoteOn(note, 100);
+    sink += alloc_.changed_voices();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+  const double ns_per_event = static_cast<double>(elapsed.count()) / events;
+  std::cout << "VoiceAllocator: " << ns_per_event << " ns/event (" << sink << ")" << std::endl;
+  // Very loose; on the host this is well under a microsecond
+  EXPECT_LT(ns_per_event, 20000.0);
+}
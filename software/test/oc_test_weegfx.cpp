@@ -0,0 +1,189 @@
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+#include "gtest/gtest.h"
+#include "src/drivers/weegfx.h"
+
+using weegfx::Graphics;
+
+static bool FormatMatches(const char *fmt, ...) {
+  char expected[64], actual[64];
+  va_list args, copy;
+  va_start(args, fmt);
+  va_copy(copy, args);
+  vsnprintf(expected, sizeof(expected), fmt, copy);
+  const bool handled = weegfx::format(actual, sizeof(actual), fmt, args);
+  va_end(copy);
+  va_end(args);
+  EXPECT_TRUE(handled) << fmt;
+  EXPECT_STREQ(expected, actual) << fmt;
+  return handled && !strcmp(expected, actual);
+}
+
+TEST(WeegfxFormat, MatchesSnprintf) {
+  // The conversions used by the UI
+  const int values[] = {0, 1, -1, 7, -42, 99, 100, 12345, -32768, 2147483647};
+  for (int v : values) {
+    FormatMatches("%d|%i|%2d|%03d|%02d|%+i|%+5d|%-4d|% d", v, v, v, v, v, v, v, v, v);
+    FormatMatches("%u %3u %6u %02u %4x %02X", (unsigned)v, (unsigned)v, (unsigned)v, (unsigned)v, (unsigned)v, (unsigned)v);
+    FormatMatches("%ld %5ld %lu %3lu %03lu %5lu", (long)v, (long)v, (unsigned long)v, (unsigned long)v, (unsigned long)v, (unsigned long)v);
+  }
+  FormatMatches("CORE%3lu/%3lu/%3lu %2lu%%", 12UL, 15UL, 40UL, 25UL);
+  FormatMatches("%s:%c %5s|%-5s|", "abc", 'x', "ab", "ab");
+}
+
+static bool Format(char *buf, size_t size, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  const bool handled = weegfx::format(buf, size, fmt, args);
+  va_end(args);
+  return handled;
+}
+
+TEST(WeegfxFormat, FallbackAndTruncation) {
+  char buf[16];
+  EXPECT_FALSE(Format(buf, sizeof(buf), "%.2f", 1.5));
+  EXPECT_FALSE(Format(buf, sizeof(buf), "%*d", 3, 1));
+  EXPECT_TRUE(Format(buf, 4, "%d", 123456));
+  EXPECT_STREQ("123", buf);
+
+  char small[6];
+  EXPECT_EQ(5u, weegfx::format_int(small, sizeof(small), 1234567));
+  EXPECT_STREQ("12345", small);
+  EXPECT_EQ(4u, weegfx::format_int(buf, sizeof(buf), -12, 4));
+  EXPECT_STREQ(" -12", buf);
+}
+
+TEST(WeegfxFormat, Voltage) {
+  // Same digits as the old piecewise gfxPrintVoltage
+  for (int v = -1200; v <= 1200; ++v) {
+    char expected[16], actual[16];
+    const int a = v < 0 ? -v : v;
+    snprintf(expected, sizeof(expected), "%c%d.%s%dV", v < 0 ? '-' : '+', a / 100, (a % 100) < 10 ? "0" : "", a % 100);
+    weegfx::format_centivolts(actual, sizeof(actual), v);
+    ASSERT_STREQ(expected, actual);
+  }
+}
+
+TEST(WeegfxTextStrip, RendersOnlyOnChange) {
+  weegfx::TextStrip<8> strip;
+  EXPECT_TRUE(strip.Set("Clk Div"));
+  EXPECT_FALSE(strip.Set("Clk Div"));
+  EXPECT_EQ(7 * weegfx::kFixedFontW, strip.width());
+  EXPECT_TRUE(strip.Set("Clk Dix"));
+  EXPECT_TRUE(strip.Set("TooLongToFit"));
+  EXPECT_EQ(8 * weegfx::kFixedFontW, strip.width());
+  EXPECT_FALSE(strip.Set("TooLongTo")); // same after truncation
+
+  EXPECT_TRUE(strip.Set(120L, 4));
+  EXPECT_FALSE(strip.Set(120L, 4));
+  EXPECT_TRUE(strip.Set(121L, 4));
+  EXPECT_EQ(4 * weegfx::kFixedFontW, strip.width());
+}
+
+// A representative Hemisphere screen: two applets with a header each, and a
+// few lines of numbers, voltages and labels, most of them on unaligned rows.
+class HemisphereScreen {
+public:
+  HemisphereScreen() { memset(frame_, 0, sizeof(frame_)); }
+
+  // The way weegfx drew text before: one clipped blit per glyph, vsnprintf,
+  // and voltages printed piece by piece
+  void DrawBefore(int tick) {
+    gfx_.Begin(frame_, weegfx::CLEAR_FRAME_ENABLE);
+    for (int h = 0; h < 2; ++h) {
+      const int x0 = h * 64;
+      const char *name = h ? "Palimpsest" : "EuclidX";
+      const int x = h ? x0 + 62 - (int)strlen(name) * 6 : x0 + 1;
+      PrintBefore(x, 2, name);
+      gfx_.drawHLinePattern(x0, 10, 63, 2);
+
+      char buf[32];
+      snprintf(buf, sizeof(buf), "Len %2d", 8 + (tick >> 6) % 24);
+      PrintBefore(x0 + 1, 15, buf);
+      snprintf(buf, sizeof(buf), "Hit %2d Rot %d", 3 + h, (tick >> 7) % 8);
+      PrintBefore(x0 + 1, 25, buf);
+      VoltageBefore(x0 + 1, 35, ((tick * 7) % 2400) - 1200);
+      VoltageBefore(x0 + 1, 45, 512 - h * 300);
+      PrintBefore(x0 + 1, 56, h ? "Mod" : "Clk");
+      gfx_.setPrintPos(x0 + 25, 56);
+      gfx_.print((int)(tick % 100));
+    }
+    gfx_.End();
+  }
+
+  void DrawAfter(int tick) {
+    gfx_.Begin(frame_, weegfx::CLEAR_FRAME_ENABLE);
+    for (int h = 0; h < 2; ++h) {
+      const int x0 = h * 64;
+      header_[h].Set(h ? "Palimpsest" : "EuclidX");
+      gfx_.setPrintPos(h ? x0 + 62 - header_[h].width() : x0 + 1, 2);
+      gfx_.print(header_[h]);
+      gfx_.drawHLinePattern(x0, 10, 63, 2);
+
+      gfx_.setPrintPos(x0 + 1, 15);
+      gfx_.printf("Len %2d", 8 + (tick >> 6) % 24);
+      gfx_.setPrintPos(x0 + 1, 25);
+      gfx_.printf("Hit %2d Rot %d", 3 + h, (tick >> 7) % 8);
+      char buf[12];
+      weegfx::format_centivolts(buf, sizeof(buf), ((tick * 7) % 2400) - 1200);
+      gfx_.setPrintPos(x0 + 1, 35);
+      gfx_.print(buf);
+      weegfx::format_centivolts(buf, sizeof(buf), 512 - h * 300);
+      gfx_.setPrintPos(x0 + 1, 45);
+      gfx_.print(buf);
+      gfx_.setPrintPos(x0 + 1, 56);
+      gfx_.print(h ? "Mod" : "Clk");
+      gfx_.setPrintPos(x0 + 25, 56);
+      gfx_.print((int)(tick % 100));
+    }
+    gfx_.End();
+  }
+
+  const uint8_t *frame() const { return frame_; }
+
+private:
+  Graphics gfx_;
+  uint8_t frame_[Graphics::kFrameSize];
+  weegfx::TextStrip<12> header_[2];
+
+  void PrintBefore(int x, int y, const char *s) {
+    gfx_.setPrintPos(x, y);
+    while (*s) gfx_.print(*s++);
+  }
+
+  void VoltageBefore(int x, int y, int v) {
+    gfx_.setPrintPos(x, y);
+    const bool neg = v < 0;
+    if (neg) v = -v;
+    const int wv = v / 100;
+    const int dv = v - wv * 100;
+    gfx_.print(neg ? "-" : "+");
+    gfx_.print(wv);
+    gfx_.print(".");
+    if (dv < 10) gfx_.print("0");
+    gfx_.print(dv);
+    gfx_.print("V");
+  }
+};
+
+TEST(WeegfxText, HemisphereScreenBenchmark) {
+  HemisphereScreen before, after;
+  for (int tick = 0; tick < 4096; tick += 37) {
+    before.DrawBefore(tick);
+    after.DrawAfter(tick);
+    ASSERT_EQ(0, memcmp(before.frame(), after.frame(), Graphics::kFrameSize)) << "tick " << tick;
+  }
+
+  const int frames = 20000;
+  auto start = std::chrono::steady_clock::now();
+  for (int tick = 0; tick < frames; ++tick) before.DrawBefore(tick);
+  auto mid = std::chrono::steady_clock::now();
+  for (int tick = 0; tick < frames; ++tick) after.DrawAfter(tick);
+  auto end = std::chrono::steady_clock::now();
+
+  const double ns_before = std::chrono::duration<double, std::nano>(mid - start).count() / frames;
+  const double ns_after = std::chrono::duration<double, std::nano>(end - mid).count() / frames;
+  std::cout << "Hemisphere screen text: " << ns_before << " ns/frame before, "
+            << ns_after << " ns/frame after" << std::endl;
+}